@@ -2,6 +2,7 @@
 #include <SDLAudioDevice.h>
 #include <SDLVideoDevice.h>
 #include <MessageCenter.h>
+#include <MediaEngine.h>
 
 SDLMediaPlayer *mediaPlayer = nullptr;
 
@@ -47,5 +48,9 @@ int main() {
     mediaPlayer->setDataSource("/Users/biezhihua/Desktop/行尸走肉.mkv");
     mediaPlayer->start();
     mediaPlayer->eventLoop();
+    SDLMediaPlayer *player = mediaPlayer;
+    mediaPlayer = nullptr;
+    delete player;
+    MediaEngine::shutdown();
     return SUCCESS;
 }
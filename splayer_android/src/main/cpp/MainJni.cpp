@@ -6,6 +6,8 @@
 #include "AndroidMediaPlayer.h"
 #include "AndroidMediaSync.h"
 #include "AndroidAudioDevice.h"
+#include "ThumbnailExtractor.h"
+#include "MediaEngine.h"
 #include "Log.h"
 
 extern "C" {
@@ -19,6 +21,14 @@ struct fields_t {
 
 static fields_t fields;
 
+struct thumbnail_fields_t {
+    jfieldID context;
+    jmethodID post_thumbnail;
+    jmethodID post_complete;
+};
+
+static thumbnail_fields_t thumbnailFields;
+
 static bool JNI_DEBUG = false;
 
 static JavaVM *javaVM = nullptr;
@@ -33,6 +43,7 @@ static JNIEnv *getJNIEnv() {
 }
 
 const char *CLASS_NAME = "com/bzh/splayer/MediaPlayer";
+const char *THUMBNAIL_CLASS_NAME = "com/bzh/splayer/ThumbnailExtractor";
 const char *TAG = "[MP][JNI][Main]";
 
 class MessageListener : public IMessageListener {
@@ -105,12 +116,98 @@ public:
             case Msg::MSG_VIDEO_ROTATION_CHANGED:
             case Msg::MSG_SEEK_START:
             case Msg::MSG_SEEK_COMPLETE:
+            case Msg::MSG_OPEN_TIMING:
+            case Msg::MSG_VARIANT_CHANGED:
+            case Msg::MSG_LIVE_LATENCY:
+            case Msg::MSG_DECODER_THREADS:
                 onNotify(msg->what, msg->arg1I, msg->arg2I, nullptr);
                 break;
         }
     }
 };
 
+class ThumbnailListener : public IThumbnailListener {
+    const char *const TAG = "[MP][JNI][Thumbnail]";
+
+private:
+    jclass mClass;
+    jobject mObject;
+
+public:
+
+    ThumbnailListener(JNIEnv *env, jobject thiz, jobject weak_thiz) {
+        jclass clazz = env->GetObjectClass(thiz);
+        mClass = (jclass) env->NewGlobalRef(clazz);
+        // 使用弱引用，ThumbnailExtractor对象可以被回收
+        mObject = env->NewGlobalRef(weak_thiz);
+    }
+
+    ~ThumbnailListener() {
+        JNIEnv *env = getJNIEnv();
+        env->DeleteGlobalRef(mObject);
+        env->DeleteGlobalRef(mClass);
+    }
+
+    // 在工作线程中回调，复制成紧凑的RGBA数组交给Java层
+    void onThumbnail(int index, int64_t timestamp, int64_t pts, const uint8_t *data,
+                     int width, int height, int linesize) override {
+        JNIEnv *env = getJNIEnv();
+
+        bool status = (javaVM->AttachCurrentThread(&env, nullptr) >= 0);
+
+        int rowSize = width * 4;
+        jbyteArray pixels = env->NewByteArray(rowSize * height);
+        if (pixels != nullptr) {
+            for (int y = 0; y < height; y++) {
+                env->SetByteArrayRegion(pixels, y * rowSize, rowSize,
+                                        (const jbyte *) (data + y * linesize));
+            }
+            env->CallStaticVoidMethod(mClass, thumbnailFields.post_thumbnail, mObject, index,
+                                      (jlong) (timestamp / 1000), (jlong) (pts / 1000),
+                                      width, height, pixels);
+            env->DeleteLocalRef(pixels);
+        }
+
+        if (env->ExceptionCheck()) {
+            jthrowable exc = env->ExceptionOccurred();
+            ALOGE(TAG, "[%s] An exception occurred while posting a thumbnail", __func__);
+            jniLogException(env, ANDROID_LOG_ERROR, TAG, exc);
+            env->ExceptionClear();
+        }
+
+        if (status) {
+            javaVM->DetachCurrentThread();
+        }
+    }
+
+    void onThumbnailComplete(int count, float thumbnailsPerSecond) override {
+        JNIEnv *env = getJNIEnv();
+
+        bool status = (javaVM->AttachCurrentThread(&env, nullptr) >= 0);
+
+        env->CallStaticVoidMethod(mClass, thumbnailFields.post_complete, mObject, count,
+                                  thumbnailsPerSecond);
+
+        if (env->ExceptionCheck()) {
+            jthrowable exc = env->ExceptionOccurred();
+            ALOGE(TAG, "[%s] An exception occurred while posting completion", __func__);
+            jniLogException(env, ANDROID_LOG_ERROR, TAG, exc);
+            env->ExceptionClear();
+        }
+
+        if (status) {
+            javaVM->DetachCurrentThread();
+        }
+    }
+};
+
+/**
+ * Java层的ThumbnailExtractor持有的Native对象
+ */
+struct ThumbnailContext {
+    ThumbnailExtractor *extractor;
+    ThumbnailListener *listener;
+};
 
 static MediaPlayer *getMediaPlayer(JNIEnv *env, jobject thiz) {
     MediaPlayer *mp = (MediaPlayer *) env->GetLongField(thiz, fields.context);
@@ -496,6 +593,64 @@ void MediaPlayer_seekTo(JNIEnv *env, jobject thiz, jfloat timeMs) {
     mp->seekTo(timeMs);
 }
 
+void MediaPlayer_startScrub(JNIEnv *env, jobject thiz) {
+    if (JNI_DEBUG) {
+        ALOGD(TAG, "[%s]", __func__);
+    }
+    MediaPlayer *mp = getMediaPlayer(env, thiz);
+    if (mp == nullptr) {
+        ALOGE(TAG, "[%s] mp=%p", __func__, mp);
+        jniThrowException(env, "java/lang/IllegalStateException");
+        return;
+    }
+    mp->startScrub();
+}
+
+void MediaPlayer_scrubTo(JNIEnv *env, jobject thiz, jlong msec) {
+    MediaPlayer *mp = getMediaPlayer(env, thiz);
+    if (mp == nullptr) {
+        ALOGE(TAG, "[%s] mp=%p", __func__, mp);
+        jniThrowException(env, "java/lang/IllegalStateException");
+        return;
+    }
+    mp->scrubTo(msec);
+}
+
+void MediaPlayer_stopScrub(JNIEnv *env, jobject thiz) {
+    if (JNI_DEBUG) {
+        ALOGD(TAG, "[%s]", __func__);
+    }
+    MediaPlayer *mp = getMediaPlayer(env, thiz);
+    if (mp == nullptr) {
+        ALOGE(TAG, "[%s] mp=%p", __func__, mp);
+        jniThrowException(env, "java/lang/IllegalStateException");
+        return;
+    }
+    mp->stopScrub();
+}
+
+void MediaPlayer_prepareNext(JNIEnv *env, jobject thiz, jstring path_) {
+    MediaPlayer *mp = getMediaPlayer(env, thiz);
+    if (mp == nullptr) {
+        ALOGE(TAG, "[%s] mp=%p", __func__, mp);
+        jniThrowException(env, "java/lang/IllegalStateException");
+        return;
+    }
+    if (path_ == nullptr) {
+        jniThrowException(env, "java/lang/IllegalArgumentException");
+        return;
+    }
+    const char *path = env->GetStringUTFChars(path_, 0);
+    if (path == nullptr) {
+        return;
+    }
+    if (JNI_DEBUG) {
+        ALOGD(TAG, "[%s] path = %s", __func__, path);
+    }
+    mp->prepareNext(path);
+    env->ReleaseStringUTFChars(path_, path);
+}
+
 void MediaPlayer_setMute(JNIEnv *env, jobject thiz, jboolean mute) {
     if (JNI_DEBUG) {
         ALOGD(TAG, "[%s] mute=%d", __func__, mute);
@@ -655,6 +810,113 @@ void MediaPlayer_setOptionLong(JNIEnv *env,
     env->ReleaseStringUTFChars(type_, type);
 }
 
+void ThumbnailExtractor_init(JNIEnv *env) {
+    jclass clazz = env->FindClass(THUMBNAIL_CLASS_NAME);
+    if (clazz == nullptr) {
+        ALOGE(TAG, "[%s] not find class, class=%s", __func__, THUMBNAIL_CLASS_NAME);
+        return;
+    }
+
+    thumbnailFields.context = env->GetFieldID(clazz, "mNativeContext", "J");
+    if (thumbnailFields.context == nullptr) {
+        ALOGE(TAG, "[%s] not find field mNativeContext", __func__);
+        return;
+    }
+
+    thumbnailFields.post_thumbnail = env->GetStaticMethodID(clazz,
+                                                            "postThumbnailFromNative",
+                                                            "(Ljava/lang/Object;IJJII[B)V");
+    if (thumbnailFields.post_thumbnail == nullptr) {
+        ALOGE(TAG, "[%s] not find static method postThumbnailFromNative", __func__);
+        return;
+    }
+
+    thumbnailFields.post_complete = env->GetStaticMethodID(clazz,
+                                                           "postCompleteFromNative",
+                                                           "(Ljava/lang/Object;IF)V");
+    if (thumbnailFields.post_complete == nullptr) {
+        ALOGE(TAG, "[%s] not find static method postCompleteFromNative", __func__);
+        return;
+    }
+
+    env->DeleteLocalRef(clazz);
+}
+
+static ThumbnailContext *getThumbnailContext(JNIEnv *env, jobject thiz) {
+    return (ThumbnailContext *) env->GetLongField(thiz, thumbnailFields.context);
+}
+
+void ThumbnailExtractor_create(JNIEnv *env, jobject thiz, jobject extractorThis) {
+    if (JNI_DEBUG) {
+        ALOGD(TAG, "[%s]", __func__);
+    }
+    auto *context = new ThumbnailContext();
+    context->extractor = new ThumbnailExtractor();
+    context->listener = new ThumbnailListener(env, thiz, extractorThis);
+    context->extractor->setListener(context->listener);
+    env->SetLongField(thiz, thumbnailFields.context, (jlong) context);
+}
+
+void ThumbnailExtractor_start(JNIEnv *env, jobject thiz, jstring path_, jlongArray timestampsMs,
+                              jint width, jint height, jint workers) {
+    ThumbnailContext *context = getThumbnailContext(env, thiz);
+    if (context == nullptr) {
+        jniThrowException(env, "java/lang/IllegalStateException");
+        return;
+    }
+    if (path_ == nullptr || timestampsMs == nullptr) {
+        jniThrowException(env, "java/lang/IllegalArgumentException");
+        return;
+    }
+    const char *path = env->GetStringUTFChars(path_, 0);
+    if (path == nullptr) {
+        return;
+    }
+    int count = env->GetArrayLength(timestampsMs);
+    std::vector<int64_t> timestamps((size_t) count);
+    jlong *values = env->GetLongArrayElements(timestampsMs, nullptr);
+    for (int i = 0; i < count; i++) {
+        timestamps[i] = values[i] * 1000;
+    }
+    env->ReleaseLongArrayElements(timestampsMs, values, JNI_ABORT);
+    if (JNI_DEBUG) {
+        ALOGD(TAG, "[%s] path = %s count = %d size = %dx%d", __func__, path, count, width, height);
+    }
+    int result = context->extractor->start(path, timestamps, width, height, workers);
+    env->ReleaseStringUTFChars(path_, path);
+    if (result < 0) {
+        jniThrowException(env, "java/lang/IllegalArgumentException");
+    }
+}
+
+void ThumbnailExtractor_cancel(JNIEnv *env, jobject thiz) {
+    ThumbnailContext *context = getThumbnailContext(env, thiz);
+    if (context != nullptr) {
+        context->extractor->cancel();
+    }
+}
+
+void ThumbnailExtractor_release(JNIEnv *env, jobject thiz) {
+    if (JNI_DEBUG) {
+        ALOGD(TAG, "[%s]", __func__);
+    }
+    ThumbnailContext *context = getThumbnailContext(env, thiz);
+    if (context != nullptr) {
+        context->extractor->cancel();
+        delete context->extractor;
+        delete context->listener;
+        delete context;
+        env->SetLongField(thiz, thumbnailFields.context, 0);
+    }
+}
+
+static const JNINativeMethod gThumbnailMethods[] = {
+        {"_native_init", "()V",                                     (void *) ThumbnailExtractor_init},
+        {"_create",      "(Ljava/lang/Object;)V",                   (void *) ThumbnailExtractor_create},
+        {"_start",       "(Ljava/lang/String;[JIII)V",              (void *) ThumbnailExtractor_start},
+        {"_cancel",      "()V",                                     (void *) ThumbnailExtractor_cancel},
+        {"_release",     "()V",                                     (void *) ThumbnailExtractor_release}
+};
 
 static const JNINativeMethod gMethods[] = {
         {"_setDataSource",      "(Ljava/lang/String;)V",                                       (void *) MediaPlayer_setDataSource},
@@ -669,6 +931,10 @@ static const JNINativeMethod gMethods[] = {
         {"_getVideoWidth",      "()I",                                                         (void *) MediaPlayer_getVideoWidth},
         {"_getVideoHeight",     "()I",                                                         (void *) MediaPlayer_getVideoHeight},
         {"_seekTo",             "(F)V",                                                        (void *) MediaPlayer_seekTo},
+        {"_prepareNext",        "(Ljava/lang/String;)V",                                       (void *) MediaPlayer_prepareNext},
+        {"_startScrub",         "()V",                                                         (void *) MediaPlayer_startScrub},
+        {"_scrubTo",            "(J)V",                                                        (void *) MediaPlayer_scrubTo},
+        {"_stopScrub",          "()V",                                                         (void *) MediaPlayer_stopScrub},
         {"_pause",              "()V",                                                         (void *) MediaPlayer_pause},
         {"_isPlaying",          "()Z",                                                         (void *) MediaPlayer_isPlaying},
         {"_getCurrentPosition", "()J",                                                         (void *) MediaPlayer_getCurrentPosition},
@@ -703,6 +969,23 @@ static int registerMediaPlayerMethod(JNIEnv *env) {
     return JNI_OK;
 }
 
+static int registerThumbnailExtractorMethod(JNIEnv *env) {
+    int numMethods = (sizeof(gThumbnailMethods) / sizeof((gThumbnailMethods)[0]));
+    jclass clazz = env->FindClass(THUMBNAIL_CLASS_NAME);
+    if (clazz == nullptr) {
+        ALOGE(TAG, "[%s] Native registration unable to find class '%s'", __func__,
+              THUMBNAIL_CLASS_NAME);
+        return JNI_ERR;
+    }
+    if (env->RegisterNatives(clazz, gThumbnailMethods, numMethods) < 0) {
+        ALOGE(TAG, "[%s] Native registration unable to find class '%s'", __func__,
+              THUMBNAIL_CLASS_NAME);
+        return JNI_ERR;
+    }
+    env->DeleteLocalRef(clazz);
+    return JNI_OK;
+}
+
 extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved) {
     av_jni_set_java_vm(vm, nullptr);
     javaVM = vm;
@@ -713,6 +996,13 @@ extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved) {
     if (registerMediaPlayerMethod(env) != JNI_OK) {
         return -1;
     }
+    if (registerThumbnailExtractorMethod(env) != JNI_OK) {
+        return -1;
+    }
     return JNI_VERSION_1_4;
 }
 
+extern "C" JNIEXPORT void JNICALL JNI_OnUnload(JavaVM *vm, void *reserved) {
+    // 类加载器卸载时播放器都已经释放，回收线程池的工作线程
+    MediaEngine::shutdown();
+}
@@ -2,6 +2,7 @@
 #define SPLAYER_ANDROID_SLESAUDIODEVICE_H
 
 #include "AudioDevice.h"
+#include "ThreadPool.h"
 #include <SLES/OpenSLES.h>
 #include <SLES/OpenSLES_Android.h>
 #include <SLES/OpenSLES_AndroidConfiguration.h>
@@ -102,7 +103,7 @@ private:
     size_t buffer_capacity;
 
     /// 音频播放线程
-    Thread *audioThread = nullptr;
+    ThreadTask *audioThread = nullptr;
 
     /// 终止标志
     int abortRequest;
@@ -9,7 +9,7 @@ class AndroidMediaSync : public MediaSync {
 private:
 
     /// 同步线程
-    Thread *syncThread = nullptr;
+    ThreadTask *syncThread = nullptr;
 
     /// 退出标记
     bool isQuit;
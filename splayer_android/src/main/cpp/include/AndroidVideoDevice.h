@@ -68,6 +68,8 @@ public:
     int onUpdateYUV(uint8_t *yData, int yPitch, uint8_t *uData, int uPitch, uint8_t *vData,
                     int vPitch) override;
 
+    int onUpdateNV(uint8_t *yData, int yPitch, uint8_t *uvData, int uvPitch) override;
+
     int onUpdateARGB(uint8_t *rgba, int pitch) override;
 
     void onRequestRenderStart(Frame *frame) override;
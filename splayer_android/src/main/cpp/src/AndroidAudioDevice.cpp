@@ -244,7 +244,7 @@ void AndroidAudioDevice::start() {
         abortRequest = 0;
         pauseRequest = 0;
         if (!audioThread) {
-            audioThread = new Thread(this, Priority_High);
+            audioThread = new ThreadTask(this, Priority_High);
             audioThread->start();
         }
     } else {
@@ -6,7 +6,7 @@ void AndroidMediaSync::start(VideoDecoder *videoDecoder, AudioDecoder *audioDeco
     isQuit = false;
     mutex.unlock();
     if (videoDecoder && !syncThread) {
-        syncThread = new Thread(this);
+        syncThread = new ThreadTask(this);
         syncThread->start();
         if (ENGINE_DEBUG) {
             ALOGD(TAG, "[%s] sync thread already started", __func__);
@@ -111,13 +111,11 @@ int AndroidVideoDevice::onInitTexture(int initTexture,
     // 进而查询是哪个Surface draw和哪个Surface read绑定到了这个Context C上。
     eglHelper->makeCurrent(eglSurface);
 
-    // 初始化输入渲染节点
+    // 初始化输入渲染节点，格式变化时切换输入滤镜
     if (renderNode == nullptr) {
         renderNode = new InputRenderNode();
-        if (renderNode != nullptr) {
-            renderNode->initFilter(videoTexture);
-        }
     }
+    renderNode->initFilter(videoTexture);
 
     mutex.unlock();
     return SUCCESS;
@@ -141,8 +139,29 @@ AndroidVideoDevice::onUpdateYUV(uint8_t *yData, int yPitch,
         eglHelper->makeCurrent(eglSurface);
         renderNode->uploadTexture(videoTexture);
     }
-    // 设置像素实际的宽度，即linesize的值
-    videoTexture->width = yPitch;
+    // 设置像素实际的宽度，即linesize的值，10位格式每个像素两个字节
+    videoTexture->width = videoTexture->format == FMT_YUV420P10 ? yPitch / 2 : yPitch;
+    mutex.unlock();
+    return SUCCESS;
+}
+
+int AndroidVideoDevice::onUpdateNV(uint8_t *yData, int yPitch, uint8_t *uvData, int uvPitch) {
+    if (!haveEGlContext) {
+        return ERROR;
+    }
+    mutex.lock();
+    videoTexture->pitches[0] = (uint16_t) (yPitch);
+    videoTexture->pitches[1] = (uint16_t) (uvPitch);
+    videoTexture->pitches[2] = 0;
+    videoTexture->pixels[0] = yData;
+    videoTexture->pixels[1] = uvData;
+    videoTexture->pixels[2] = nullptr;
+    if (renderNode != nullptr && eglSurface != EGL_NO_SURFACE) {
+        eglHelper->makeCurrent(eglSurface);
+        renderNode->uploadTexture(videoTexture);
+    }
+    // 设置像素实际的宽度，即linesize的值，P010每个像素两个字节
+    videoTexture->width = videoTexture->format == FMT_P010 ? yPitch / 2 : yPitch;
     mutex.unlock();
     return SUCCESS;
 }
@@ -192,6 +211,11 @@ int AndroidVideoDevice::onRequestRenderEnd(Frame *frame, bool flip) {
         // 这个方法将会交换surface内部的前端缓冲(front-buffer)和后端缓冲(back-surface)。
         // 后端缓冲用于存储渲染结果，前端缓冲则用于底层窗口系统，底层窗口系统将缓冲中的颜色信息显示到设备上。
         eglHelper->swapBuffers(eglSurface);
+
+        // 交换缓冲不保证阻塞到vsync，只上报显示时间用于统计抖动
+        if (displayClock) {
+            displayClock->onPresent(av_gettime_relative() / 1000000.0, false);
+        }
     }
 
     mutex.unlock();
@@ -233,6 +257,7 @@ void AndroidVideoDevice::destroy(bool releaseContext) {
         if (renderNode) {
             renderNode->destroy();
             delete renderNode;
+            renderNode = nullptr;
         }
         eglHelper->release();
         haveEGlContext = false;
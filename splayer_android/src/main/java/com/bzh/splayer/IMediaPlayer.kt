@@ -91,6 +91,24 @@ interface IMediaPlayer {
     @Throws(IllegalStateException::class)
     fun seekTo(msec: Float)
 
+    /**
+     * 后台预加载下一个播放地址，之后用同一地址setDataSource并start时直接使用预加载的结果
+     */
+    @Throws(IllegalStateException::class)
+    fun prepareNext(@NonNull path: String)
+
+    /**
+     * 开始拖动进度，拖动期间只显示关键帧，stopScrub时精确定位到最后的位置
+     */
+    @Throws(IllegalStateException::class)
+    fun startScrub()
+
+    @Throws(IllegalStateException::class)
+    fun scrubTo(msec: Long)
+
+    @Throws(IllegalStateException::class)
+    fun stopScrub()
+
     fun release()
 
     fun reset()
@@ -198,7 +216,19 @@ interface IMediaPlayer {
         MSG_TIMED_TEXT(1020),
 
         // 当前时钟
-        MSG_CURRENT_POSITION(1021);
+        MSG_CURRENT_POSITION(1021),
+
+        // 打开耗时，arg1为阶段(0打开文件，1查找媒体流信息，2首个数据包)，arg2为耗时(毫秒)
+        MSG_OPEN_TIMING(1022),
+
+        // 多码率切换完成，arg1为码率(kbps)，arg2为视频高度
+        MSG_VARIANT_CHANGED(1023),
+
+        // 直播低延时模式定期上报，arg1为延时(毫秒)，arg2为播放速度的百分比
+        MSG_LIVE_LATENCY(1024),
+
+        // 解码器打开，arg1为流索引，arg2为实际使用的解码线程数量
+        MSG_DECODER_THREADS(1025);
 
         companion object {
             fun toString(value: Int): String {
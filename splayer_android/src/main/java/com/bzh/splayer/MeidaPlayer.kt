@@ -227,6 +227,22 @@ class MediaPlayer : IMediaPlayer {
         _seekTo(msec)
     }
 
+    override fun prepareNext(@NonNull path: String) {
+        _prepareNext(path)
+    }
+
+    override fun startScrub() {
+        _startScrub()
+    }
+
+    override fun scrubTo(msec: Long) {
+        _scrubTo(msec)
+    }
+
+    override fun stopScrub() {
+        _stopScrub()
+    }
+
     override fun release() {
         stayAwake(false)
         updateSurfaceScreenOn()
@@ -390,6 +406,34 @@ class MediaPlayer : IMediaPlayer {
                     return
                 }
 
+                IMediaPlayer.MsgType.MSG_OPEN_TIMING.value -> {
+                    if (ANDROID_DEBUG) {
+                        Log.d(TAG, "open timing stage=" + msg.arg1 + " cost=" + msg.arg2 + "ms")
+                    }
+                    return
+                }
+
+                IMediaPlayer.MsgType.MSG_VARIANT_CHANGED.value -> {
+                    if (ANDROID_DEBUG) {
+                        Log.d(TAG, "variant changed bitrate=" + msg.arg1 + "kbps height=" + msg.arg2)
+                    }
+                    return
+                }
+
+                IMediaPlayer.MsgType.MSG_LIVE_LATENCY.value -> {
+                    if (ANDROID_DEBUG) {
+                        Log.d(TAG, "live latency=" + msg.arg1 + "ms speed=" + msg.arg2 + "%")
+                    }
+                    return
+                }
+
+                IMediaPlayer.MsgType.MSG_DECODER_THREADS.value -> {
+                    if (ANDROID_DEBUG) {
+                        Log.d(TAG, "decoder stream=" + msg.arg1 + " threads=" + msg.arg2)
+                    }
+                    return
+                }
+
                 IMediaPlayer.MsgType.MSG_CURRENT_POSITION.value -> {
                     mOnListener?.onCurrentPosition(
                         msg.arg1.toLong(),
@@ -479,6 +523,18 @@ class MediaPlayer : IMediaPlayer {
     @Throws(IllegalStateException::class)
     private external fun _seekTo(msec: Float)
 
+    @Throws(IllegalStateException::class)
+    private external fun _prepareNext(path: String)
+
+    @Throws(IllegalStateException::class)
+    private external fun _startScrub()
+
+    @Throws(IllegalStateException::class)
+    private external fun _scrubTo(msec: Long)
+
+    @Throws(IllegalStateException::class)
+    private external fun _stopScrub()
+
     @Throws(IllegalStateException::class)
     private external fun _getCurrentPosition(): Long
 
@@ -0,0 +1,145 @@
+@file:Suppress("FunctionName")
+
+package com.bzh.splayer
+
+import android.graphics.Bitmap
+import android.os.Handler
+import android.os.Looper
+import android.util.Log
+import androidx.annotation.NonNull
+import com.bzh.splayer.annotations.AccessedByNative
+import com.bzh.splayer.annotations.CalledByNative
+import java.lang.ref.WeakReference
+import java.nio.ByteBuffer
+
+/**
+ * 缩略图提取
+ * 不创建播放器，在独立的工作线程中解码每个时间戳之前最近的关键帧，结果在创建线程的Looper上回调
+ */
+class ThumbnailExtractor {
+
+    /**
+     * 缩略图回调
+     */
+    interface IOnThumbnailListener {
+
+        /**
+         * @param index 时间戳在请求列表中的下标
+         * @param timestampMs 请求的时间戳，毫秒
+         * @param ptsMs 实际解码的关键帧时间戳，毫秒
+         */
+        fun onThumbnail(index: Int, timestampMs: Long, ptsMs: Long, bitmap: Bitmap)
+
+        // 所有时间戳处理完成，count为成功提取的数量
+        fun onComplete(count: Int, thumbnailsPerSecond: Float)
+    }
+
+    @AccessedByNative
+    private val mNativeContext: Long = 0
+
+    private val mHandler: Handler = Handler(Looper.myLooper() ?: Looper.getMainLooper())
+
+    private var mListener: IOnThumbnailListener? = null
+
+    init {
+        _create(WeakReference(this))
+    }
+
+    fun setOnThumbnailListener(listener: IOnThumbnailListener?) {
+        mListener = listener
+    }
+
+    /**
+     * 开始提取，之前的提取被取消
+     * @param timestampsMs 时间戳，毫秒，相对媒体开始时间
+     * @param height 为0时按宽度保持宽高比
+     */
+    @Throws(IllegalStateException::class, IllegalArgumentException::class)
+    fun start(
+        @NonNull path: String,
+        @NonNull timestampsMs: LongArray,
+        width: Int,
+        height: Int = 0,
+        workers: Int = DEFAULT_WORKERS
+    ) {
+        _start(path, timestampsMs, width, height, workers)
+    }
+
+    // 取消提取并等待工作线程结束
+    fun cancel() {
+        _cancel()
+    }
+
+    fun release() {
+        mListener = null
+        _release()
+    }
+
+    protected fun finalize() {
+        _release()
+    }
+
+    @Throws(IllegalStateException::class)
+    private external fun _create(extractorThis: Any)
+
+    @Throws(IllegalStateException::class, IllegalArgumentException::class)
+    private external fun _start(
+        path: String,
+        timestampsMs: LongArray,
+        width: Int,
+        height: Int,
+        workers: Int
+    )
+
+    private external fun _cancel()
+
+    private external fun _release()
+
+    companion object {
+
+        private const val TAG = "[MP][LIB][ThumbnailExtractor]"
+
+        const val DEFAULT_WORKERS = 2
+
+        init {
+            // 依赖MediaPlayer加载Native库
+            MediaPlayer.ANDROID_DEBUG
+            _native_init()
+        }
+
+        @JvmStatic
+        private external fun _native_init()
+
+        @JvmStatic
+        @CalledByNative
+        fun postThumbnailFromNative(
+            extractorRef: Any,
+            index: Int,
+            timestampMs: Long,
+            ptsMs: Long,
+            width: Int,
+            height: Int,
+            pixels: ByteArray
+        ) {
+            val extractor = (extractorRef as WeakReference<*>).get() as ThumbnailExtractor? ?: return
+            // ARGB_8888在内存中的顺序就是RGBA
+            val bitmap = Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888)
+            bitmap.copyPixelsFromBuffer(ByteBuffer.wrap(pixels))
+            extractor.mHandler.post {
+                extractor.mListener?.onThumbnail(index, timestampMs, ptsMs, bitmap)
+            }
+        }
+
+        @JvmStatic
+        @CalledByNative
+        fun postCompleteFromNative(extractorRef: Any, count: Int, thumbnailsPerSecond: Float) {
+            val extractor = (extractorRef as WeakReference<*>).get() as ThumbnailExtractor? ?: return
+            if (MediaPlayer.ANDROID_DEBUG) {
+                Log.d(TAG, "complete count=$count speed=$thumbnailsPerSecond/s")
+            }
+            extractor.mHandler.post {
+                extractor.mListener?.onComplete(count, thumbnailsPerSecond)
+            }
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * 多码率自适应：本地HTTP服务器提供三个码率的HLS，播放过程中限速再恢复
+ * 对比打开和关闭adaptiveBitrate，输出码率切换的时间线、卡顿次数和卡顿时长
+ * 没有缓冲消息，按相邻两帧的显示间隔超过ABR_STALL_GAP计为卡顿
+ * 用法：bench_abr [媒体目录]
+ */
+#include <cstdlib>
+#include <sys/stat.h>
+#include "BenchMedia.h"
+#include "BenchPlayer.h"
+#include "BenchServer.h"
+
+/// 播放时长，毫秒
+#define ABR_PLAY_TIME                               36000
+
+/// 限速区间，毫秒，从第一帧开始计算
+#define ABR_THROTTLE_START                          8000
+
+#define ABR_THROTTLE_END                            24000
+
+/// 不限速和限速时的带宽，bps
+#define ABR_FAST_RATE                               (12 * 1000 * 1000)
+
+#define ABR_SLOW_RATE                               (2 * 1000 * 1000)
+
+/// 两帧的显示间隔超过该值计为卡顿，毫秒
+#define ABR_STALL_GAP                               250.0
+
+typedef struct AbrResult {
+    /// 打开到第一帧显示，毫秒
+    double startup = 0;
+    int switches = 0;
+    int stalls = 0;
+    /// 卡顿总时长，毫秒
+    double stallTime = 0;
+    double maxGap = 0;
+    int64_t bytes = 0;
+    int failures = 0;
+} AbrResult;
+
+static void runPlayback(BenchServer *server, const std::string &url, bool adaptive,
+                        AbrResult *result) {
+    BenchPlayer player;
+    if (player.create() < 0) {
+        result->failures++;
+        return;
+    }
+    player.setOption(OPT_CATEGORY_PLAYER, "adaptiveBitrate", adaptive ? 1 : 0);
+    server->setRate(ABR_FAST_RATE);
+    int64_t bytes = server->getBytesSent();
+    int64_t openTime = BenchUtils::now();
+    if (player.open(url.c_str()) < 0 || !player.getVideoDevice()->waitPresents(1, 15000)) {
+        result->failures++;
+        return;
+    }
+    int64_t firstPresent = player.getVideoDevice()->getFirstPresentTime();
+    result->startup = (firstPresent - openTime) / 1000.0;
+
+    bool throttled = false;
+    int switches = player.getMsgCount(Msg::MSG_VARIANT_CHANGED);
+    while (BenchUtils::now() - firstPresent < ABR_PLAY_TIME * 1000LL) {
+        int64_t elapsed = (BenchUtils::now() - firstPresent) / 1000;
+        bool throttle = elapsed >= ABR_THROTTLE_START && elapsed < ABR_THROTTLE_END;
+        if (throttle != throttled) {
+            throttled = throttle;
+            server->setRate(throttle ? ABR_SLOW_RATE : ABR_FAST_RATE);
+            printf("  %6.1f s  rate -> %d kbps\n", elapsed / 1000.0,
+                   (throttle ? ABR_SLOW_RATE : ABR_FAST_RATE) / 1000);
+        }
+        int count = player.getMsgCount(Msg::MSG_VARIANT_CHANGED);
+        if (count != switches) {
+            switches = count;
+            printf("  %6.1f s  variant -> %d kbps %dp\n",
+                   (player.getMsgTime(Msg::MSG_VARIANT_CHANGED) - firstPresent) / 1000000.0,
+                   player.getMsgArg1(Msg::MSG_VARIANT_CHANGED),
+                   player.getMsgArg2(Msg::MSG_VARIANT_CHANGED));
+        }
+        BenchUtils::sleepUs(50000);
+    }
+
+    BenchStats intervals;
+    player.getVideoDevice()->getIntervals(firstPresent, &intervals);
+    result->switches = switches;
+    result->stalls = intervals.countAbove(ABR_STALL_GAP);
+    result->stallTime = intervals.sumAbove(ABR_STALL_GAP);
+    result->maxGap = intervals.max();
+    result->bytes = server->getBytesSent() - bytes;
+    player.stop(5000);
+}
+
+int main(int argc, char **argv) {
+    std::string dir = BenchUtils::mediaDir(argc, argv);
+    std::string hlsDir = dir + "/abr";
+    mkdir(hlsDir.c_str(), 0755);
+    BenchMediaSpec variants[] = {
+            {"hls", 320,  180, 30, 40, 60, 400000},
+            {"hls", 640,  360, 30, 40, 60, 1200000},
+            {"hls", 1280, 720, 30, 40, 60, 3000000},
+    };
+    if (BenchMedia::generateHls(hlsDir, variants, 3, 2) < 0) {
+        fprintf(stderr, "generate hls failure\n");
+        return EXIT_FAILURE;
+    }
+
+    BenchServer server(dir);
+    if (server.start() < 0) {
+        fprintf(stderr, "start server failure\n");
+        return EXIT_FAILURE;
+    }
+    std::string url = server.getUrl("abr/master.m3u8");
+
+    AbrResult results[2];
+    for (int adaptive = 1; adaptive >= 0; --adaptive) {
+        printf("adaptiveBitrate = %d, %d kbps, %d kbps during %d-%d s\n", adaptive,
+               ABR_FAST_RATE / 1000, ABR_SLOW_RATE / 1000, ABR_THROTTLE_START / 1000,
+               ABR_THROTTLE_END / 1000);
+        runPlayback(&server, url, adaptive != 0, &results[adaptive]);
+    }
+    server.stop();
+
+    printf("%-9s %10s %9s %7s %13s %11s %10s\n", "adaptive", "startup ms", "switches", "stalls",
+           "stall time ms", "max gap ms", "MB");
+    int failures = 0;
+    for (int adaptive = 1; adaptive >= 0; --adaptive) {
+        AbrResult &result = results[adaptive];
+        failures += result.failures;
+        printf("%-9d %10.1f %9d %7d %13.1f %11.1f %10.1f%s\n", adaptive, result.startup,
+               result.switches, result.stalls, result.stallTime, result.maxGap,
+               result.bytes / 1048576.0, result.failures > 0 ? "  FAILED" : "");
+    }
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
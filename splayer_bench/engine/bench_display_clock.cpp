@@ -0,0 +1,103 @@
+/**
+ * 显示时钟：30fps的视频，模拟60Hz的vsync
+ * 对比同步线程按显示时钟等待到下一帧，和之前每REFRESH_RATE轮询一次
+ * 播放时输出显示间隔、间隔不均匀的帧数、进程和同步线程的CPU占用、同步线程每秒循环次数，
+ * 暂停时输出CPU占用和循环次数
+ * 用法：bench_display_clock [媒体目录]
+ */
+#include <cstdlib>
+#include "BenchMedia.h"
+#include "BenchPlayer.h"
+
+/// 每个阶段的测量时长，毫秒
+#define CLOCK_MEASURE_TIME                          5000
+
+/// 开始播放或者暂停之后等待稳定的时长，毫秒
+#define CLOCK_SETTLE_TIME                           1000
+
+/// 视频帧率
+#define CLOCK_VIDEO_FPS                             30
+
+typedef struct PhaseResult {
+    /// 进程的CPU占用，百分比
+    double cpu = 0;
+    /// 同步线程的CPU占用，百分比
+    double syncCpu = 0;
+    /// 同步线程每秒循环次数
+    double loops = 0;
+    /// 显示间隔，毫秒
+    BenchStats intervals;
+    /// 显示间隔和帧间隔相差超过半个vsync的帧数
+    int uneven = 0;
+} PhaseResult;
+
+static void measure(BenchPlayer *player, bool playing, PhaseResult *result) {
+    BenchMediaSync *mediaSync = player->getMediaSync();
+    BenchUtils::sleepUs(CLOCK_SETTLE_TIME * 1000LL);
+
+    int64_t syncCpu = mediaSync->getThreadCpuTime();
+    int loops = mediaSync->getLoopCount();
+    int64_t startTime = BenchUtils::now();
+    CpuWindow window;
+    window.begin();
+    BenchUtils::sleepUs(CLOCK_MEASURE_TIME * 1000LL);
+    result->cpu = window.end();
+    double elapsed = window.getElapsed();
+    result->syncCpu = (mediaSync->getThreadCpuTime() - syncCpu) / 10000.0 / elapsed;
+    result->loops = (mediaSync->getLoopCount() - loops) / elapsed;
+    if (playing) {
+        // 30fps在60Hz上每一帧应该正好显示两个vsync
+        double frameInterval = 1000.0 / CLOCK_VIDEO_FPS;
+        double halfVsync = 500.0 / BENCH_REFRESH_RATE;
+        player->getVideoDevice()->getIntervals(startTime, &result->intervals);
+        result->uneven = result->intervals.countAbove(frameInterval + halfVsync) +
+                         result->intervals.count() -
+                         result->intervals.countAbove(frameInterval - halfVsync);
+    }
+}
+
+static int runClock(const std::string &path, int refreshMode, PhaseResult *playing,
+                    PhaseResult *paused) {
+    BenchPlayer player(refreshMode, BENCH_REFRESH_RATE);
+    if (player.create() < 0 || player.open(path.c_str()) < 0 ||
+        !player.getVideoDevice()->waitPresents(1, 10000)) {
+        return -1;
+    }
+    measure(&player, true, playing);
+    player.getPlayer()->pause();
+    measure(&player, false, paused);
+    player.stop(5000);
+    return playing->intervals.count() > 0 ? 0 : -1;
+}
+
+int main(int argc, char **argv) {
+    std::string path = BenchUtils::mediaDir(argc, argv) + "/clock_360p.ts";
+    BenchMediaSpec spec = {"mpegts", 640, 360, CLOCK_VIDEO_FPS, 30, 30, 1000000};
+    if (BenchMedia::generate(path, spec) < 0) {
+        fprintf(stderr, "generate %s failure\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    printf("display clock, %d fps video on %.0f Hz vsync, %d ms each phase\n", CLOCK_VIDEO_FPS,
+           BENCH_REFRESH_RATE, CLOCK_MEASURE_TIME);
+    printf("%-8s %-8s %9s %9s %9s %7s %7s %9s %8s\n", "refresh", "state", "interval",
+           "p95 ms", "max ms", "uneven", "cpu %", "sync cpu", "loops/s");
+    int failures = 0;
+    const int modes[] = {BENCH_REFRESH_DISPLAY_CLOCK, BENCH_REFRESH_POLLING};
+    for (int mode : modes) {
+        PhaseResult playing;
+        PhaseResult paused;
+        int ret = runClock(path, mode, &playing, &paused);
+        if (ret < 0) {
+            failures++;
+        }
+        const char *name = mode == BENCH_REFRESH_DISPLAY_CLOCK ? "clock" : "polling";
+        printf("%-8s %-8s %9.2f %9.2f %9.2f %7d %7.1f %9.1f %8.1f%s\n", name, "playing",
+               playing.intervals.mean(), playing.intervals.percentile(95),
+               playing.intervals.max(), playing.uneven, playing.cpu, playing.syncCpu,
+               playing.loops, ret < 0 ? "  FAILED" : "");
+        printf("%-8s %-8s %9s %9s %9s %7s %7.1f %9.1f %8.1f\n", name, "paused", "-", "-", "-",
+               "-", paused.cpu, paused.syncCpu, paused.loops);
+    }
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/**
+ * 直播延迟：本地HTTP服务器按码率实时发送TS，没有Content-Length，连接时先发送1秒的数据
+ * 播放8秒之后网络中断3秒，中断期间的数据在恢复之后一次到达
+ * 延迟为服务器已经产生的媒体时长减去播放位置，对比打开和关闭lowLatency，
+ * 输出稳定延迟、中断之后的最大延迟、恢复到稳定延迟的耗时和最后的延迟
+ * 用法：bench_live [媒体目录]
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <sys/stat.h>
+#include "BenchMedia.h"
+#include "BenchPlayer.h"
+#include "BenchServer.h"
+
+/// 播放时长，毫秒，从第一帧开始计算
+#define LIVE_PLAY_TIME                              26000
+
+/// 网络中断的开始时间和时长，毫秒
+#define LIVE_STALL_START                            8000
+
+#define LIVE_STALL_DURATION                         3000
+
+/// 稳定延迟的统计区间开始时间，毫秒
+#define LIVE_STEADY_START                           4000
+
+/// 延迟回到稳定延迟加上该值时认为已经恢复，秒
+#define LIVE_RECOVERED_ERROR                        0.3
+
+/// 最后的延迟的统计时长，毫秒
+#define LIVE_LAST_TIME                             3000
+
+/// 采样间隔，毫秒
+#define LIVE_SAMPLE_INTERVAL                        100
+
+/// 两帧的显示间隔超过该值计为卡顿，毫秒
+#define LIVE_STALL_GAP                              250.0
+
+typedef struct LiveResult {
+    double steady = 0;
+    double peak = 0;
+    /// 网络恢复到延迟恢复的耗时，秒，没有恢复时为-1
+    double recovery = -1;
+    double last = 0;
+    int stalls = 0;
+    /// 播放器上报的延迟消息数量，最后一次上报的速度(%)
+    int reports = 0;
+    int speed = 0;
+    int failures = 0;
+} LiveResult;
+
+static void runLive(BenchServer *server, const std::string &url, bool lowLatency,
+                    LiveResult *result) {
+    BenchPlayer player;
+    if (player.create() < 0) {
+        result->failures++;
+        return;
+    }
+    player.setOption(OPT_CATEGORY_PLAYER, "lowLatency", lowLatency ? 1 : 0);
+    if (player.open(url.c_str()) < 0 || !player.getVideoDevice()->waitPresents(1, 15000)) {
+        result->failures++;
+        return;
+    }
+    int64_t firstPresent = player.getVideoDevice()->getFirstPresentTime();
+
+    BenchStats steady;
+    BenchStats last;
+    bool stalled = false;
+    int64_t elapsed;
+    while ((elapsed = (BenchUtils::now() - firstPresent) / 1000) < LIVE_PLAY_TIME) {
+        if (!stalled && elapsed >= LIVE_STALL_START) {
+            stalled = true;
+            server->stallLive(LIVE_STALL_DURATION);
+        }
+        double latency = server->getLiveEdge() -
+                         player.getPlayer()->getCurrentPosition() / 1000.0;
+        if (elapsed >= LIVE_STEADY_START && elapsed < LIVE_STALL_START) {
+            steady.add(latency);
+        } else if (elapsed >= LIVE_STALL_START) {
+            result->peak = std::max(result->peak, latency);
+            if (result->recovery < 0 && elapsed >= LIVE_STALL_START + LIVE_STALL_DURATION &&
+                latency <= steady.mean() + LIVE_RECOVERED_ERROR) {
+                result->recovery = (elapsed - LIVE_STALL_START - LIVE_STALL_DURATION) / 1000.0;
+            }
+        }
+        if (elapsed >= LIVE_PLAY_TIME - LIVE_LAST_TIME) {
+            last.add(latency);
+        }
+        BenchUtils::sleepUs(LIVE_SAMPLE_INTERVAL * 1000);
+    }
+
+    BenchStats intervals;
+    player.getVideoDevice()->getIntervals(firstPresent, &intervals);
+    result->steady = steady.mean();
+    result->last = last.mean();
+    result->stalls = intervals.countAbove(LIVE_STALL_GAP);
+    result->reports = player.getMsgCount(Msg::MSG_LIVE_LATENCY);
+    result->speed = player.getMsgArg2(Msg::MSG_LIVE_LATENCY);
+    player.stop(5000);
+}
+
+int main(int argc, char **argv) {
+    std::string dir = BenchUtils::mediaDir(argc, argv);
+    std::string path = dir + "/live_360p.ts";
+    BenchMediaSpec spec = {"mpegts", 640, 360, 30, 40, 30, 1000000};
+    struct stat st;
+    if (BenchMedia::generate(path, spec) < 0 || stat(path.c_str(), &st) != 0) {
+        fprintf(stderr, "generate %s failure\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    BenchServer server(dir);
+    if (server.start() < 0) {
+        fprintf(stderr, "start server failure\n");
+        return EXIT_FAILURE;
+    }
+    // 按文件的平均码率发送，包括TS封装的开销
+    server.setLiveBitRate((int64_t) st.st_size * 8 / spec.duration);
+    std::string url = server.getUrl("live/live_360p.ts");
+
+    printf("live latency, network stall %d ms at %d ms\n", LIVE_STALL_DURATION, LIVE_STALL_START);
+    printf("%-11s %9s %9s %12s %9s %7s %8s %8s\n", "lowLatency", "steady s", "peak s",
+           "recovery s", "last s", "stalls", "reports", "speed %");
+    int failures = 0;
+    for (int lowLatency = 1; lowLatency >= 0; --lowLatency) {
+        LiveResult result;
+        runLive(&server, url, lowLatency != 0, &result);
+        failures += result.failures;
+        printf("%-11d %9.2f %9.2f %12.1f %9.2f %7d %8d %8d%s\n", lowLatency, result.steady,
+               result.peak, result.recovery, result.last, result.stalls, result.reports,
+               result.speed, result.failures > 0 ? "  FAILED" : "");
+    }
+    server.stop();
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+/**
+ * 数据包队列竞争：读包线程入队，解码线程出队，两个线程同时运行
+ * 和Stream/MediaDecoder一样，读包线程每个数据包查询队列的包数量、内存大小和时长，
+ * 队列满时等待读包事件，解码线程出队之后发出读包事件并查询序列
+ * 对比单生产者单消费者的PacketQueue和之前加锁的队列
+ * 满载：读包线程不限速入队，输出每秒数据包数量和CPU占用
+ * 4K60：按4K60视频加音频的包速率入队，输出入队到出队的延迟和CPU占用
+ * 用法：bench_packet_contention [媒体目录]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <Event.h>
+#include <PacketQueue.h>
+#include <Thread.h>
+#include "BenchUtils.h"
+#include "LegacyPacketQueue.h"
+
+/// 满载时入队的数据包数量
+#define CONTENTION_PACKET_COUNT                     1000000
+
+/// 队列最多缓存的数据包数量，超过时读包线程等待
+#define CONTENTION_QUEUE_DEPTH                      256
+
+/// 4K60的测量时长，毫秒
+#define CONTENTION_PACED_TIME                       5000
+
+/// 4K60视频每秒的包数量和包大小(约40Mbps)
+#define CONTENTION_VIDEO_RATE                       60
+
+#define CONTENTION_VIDEO_SIZE                       83000
+
+/// 48kHz的AAC每秒的包数量和包大小
+#define CONTENTION_AUDIO_RATE                       47
+
+#define CONTENTION_AUDIO_SIZE                       400
+
+typedef struct ContentionResult {
+    /// 每秒数据包数量
+    double rate = 0;
+    double cpu = 0;
+    /// 入队到出队的延迟，微秒
+    BenchStats latency;
+    int failures = 0;
+} ContentionResult;
+
+/**
+ * 解码线程，出队count个数据包，数据包的pts为入队时间
+ */
+template<class Queue>
+class Consumer : public Runnable {
+
+public:
+
+    Consumer(Queue *queue, Event *readEvent, int count, ContentionResult *result)
+            : queue(queue), readEvent(readEvent), count(count), result(result) {
+    }
+
+    void run() override {
+        AVPacket pkt;
+        for (int i = 0; i < count; ++i) {
+            if (queue->getPacket(&pkt) < 0) {
+                result->failures++;
+                return;
+            }
+            readEvent->signal();
+            if (queue->getFirstSeekSerial() != queue->getLastSeekSerial()) {
+                result->failures++;
+            }
+            if (pkt.pts > 0) {
+                result->latency.add(BenchUtils::now() - pkt.pts);
+            }
+        }
+    }
+
+private:
+
+    Queue *queue;
+
+    Event *readEvent;
+
+    int count;
+
+    ContentionResult *result;
+};
+
+template<class Queue>
+static bool isQueueFull(Queue *queue) {
+    // 和Stream::isNotReadMore一样每次查询内存大小、包数量和时长
+    int memorySize = queue->getSize();
+    int64_t duration = queue->getDuration();
+    return queue->getPacketSize() >= CONTENTION_QUEUE_DEPTH && memorySize > 0 && duration > 0;
+}
+
+/**
+ * 入队一个数据包，队列满时等待解码线程的读包事件
+ */
+template<class Queue>
+static void push(Queue *queue, Event *readEvent, int size, int64_t pts) {
+    static uint8_t data[64];
+    while (isQueueFull(queue)) {
+        readEvent->wait();
+    }
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = data;
+    pkt.size = size;
+    pkt.duration = 1;
+    pkt.pts = pts;
+    queue->pushPacket(&pkt);
+}
+
+template<class Queue>
+static void runContention(bool paced, ContentionResult *result) {
+    AVPacket flushPacket;
+    av_init_packet(&flushPacket);
+    flushPacket.data = (uint8_t *) &flushPacket;
+    Queue queue(&flushPacket);
+    Event readEvent;
+    queue.start();
+    AVPacket pkt;
+    queue.getPacket(&pkt, 0);
+
+    int rate = CONTENTION_VIDEO_RATE + CONTENTION_AUDIO_RATE;
+    int count = paced ? (int) ((int64_t) rate * CONTENTION_PACED_TIME / 1000)
+                      : CONTENTION_PACKET_COUNT;
+    Consumer<Queue> consumer(&queue, &readEvent, count, result);
+    Thread thread(&consumer);
+    CpuWindow window;
+    window.begin();
+    int64_t startTime = BenchUtils::now();
+    thread.start();
+    if (paced) {
+        // 视频和音频按各自的间隔交错入队
+        int video = 0;
+        int audio = 0;
+        while (video + audio < count) {
+            int64_t videoTime = startTime + (int64_t) video * 1000000 / CONTENTION_VIDEO_RATE;
+            int64_t audioTime = startTime + (int64_t) audio * 1000000 / CONTENTION_AUDIO_RATE;
+            bool isVideo = videoTime <= audioTime;
+            BenchUtils::sleepUntil(isVideo ? videoTime : audioTime);
+            push(&queue, &readEvent, isVideo ? CONTENTION_VIDEO_SIZE : CONTENTION_AUDIO_SIZE,
+                 BenchUtils::now());
+            isVideo ? video++ : audio++;
+        }
+    } else {
+        for (int i = 0; i < count; ++i) {
+            push(&queue, &readEvent, CONTENTION_VIDEO_SIZE, 0);
+        }
+    }
+    thread.join();
+    result->cpu = window.end();
+    result->rate = count / window.getElapsed();
+    if (queue.getPacketSize() != 0) {
+        result->failures++;
+    }
+}
+
+int main(int argc, char **argv) {
+    printf("packet queue contention, depth %d, 4K60 %d video + %d audio packets/s\n",
+           CONTENTION_QUEUE_DEPTH, CONTENTION_VIDEO_RATE, CONTENTION_AUDIO_RATE);
+    printf("%-10s %-7s %12s %7s %11s %10s %10s\n", "load", "queue", "packets/s", "cpu %",
+           "latency us", "p95 us", "max us");
+    int failures = 0;
+    for (int paced = 0; paced <= 1; ++paced) {
+        for (int spsc = 1; spsc >= 0; --spsc) {
+            ContentionResult result;
+            if (spsc) {
+                runContention<PacketQueue>(paced != 0, &result);
+            } else {
+                runContention<LegacyPacketQueue>(paced != 0, &result);
+            }
+            failures += result.failures;
+            const char *name = paced ? "4K60" : "saturated";
+            const char *queue = spsc ? "spsc" : "legacy";
+            const char *failed = result.failures > 0 ? "  FAILED" : "";
+            if (paced) {
+                printf("%-10s %-7s %12.0f %7.1f %11.1f %10.1f %10.1f%s\n", name, queue,
+                       result.rate, result.cpu, result.latency.mean(),
+                       result.latency.percentile(95), result.latency.max(), failed);
+            } else {
+                printf("%-10s %-7s %12.0f %7.1f %11s %10s %10s%s\n", name, queue, result.rate,
+                       result.cpu, "-", "-", "-", failed);
+            }
+        }
+    }
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
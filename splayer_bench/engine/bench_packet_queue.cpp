@@ -0,0 +1,107 @@
+/**
+ * 数据包队列入队出队开销：单线程按批次入队再全部出队，批次大小对应队列中缓存的包数量
+ * 对比PacketQueue从节点池获取节点，和之前每个节点av_malloc、出队时av_free的队列
+ * 数据包不带缓冲区，只测量队列本身的开销
+ * 用法：bench_packet_queue [媒体目录]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <PacketQueue.h>
+#include "BenchUtils.h"
+#include "LegacyPacketQueue.h"
+
+/// 每种批次大小入队出队的包数量
+#define QUEUE_PACKET_COUNT                          2000000
+
+/// 重复测量的次数，取最好的一次
+#define QUEUE_ROUNDS                                5
+
+typedef struct QueueResult {
+    /// 每个数据包入队加出队的耗时，纳秒
+    double cost = 0;
+    /// 节点池容量，预热之后的扩容节点数量，之前的队列没有节点池
+    int poolSize = -1;
+    int poolGrowth = 0;
+    int failures = 0;
+} QueueResult;
+
+static int getPoolSize(PacketQueue *queue) {
+    return queue->getPoolSize();
+}
+
+static int getPoolSize(LegacyPacketQueue *) {
+    return -1;
+}
+
+template<class Queue>
+static double runRound(Queue *queue, int batch, AVPacket *packet, int *failures) {
+    AVPacket pkt;
+    int64_t startTime = BenchUtils::now();
+    for (int count = 0; count < QUEUE_PACKET_COUNT; count += batch) {
+        for (int i = 0; i < batch; ++i) {
+            AVPacket copy = *packet;
+            if (queue->pushPacket(&copy) < 0) {
+                (*failures)++;
+            }
+        }
+        for (int i = 0; i < batch; ++i) {
+            if (queue->getPacket(&pkt, 0) < 0 || pkt.size != packet->size) {
+                (*failures)++;
+            }
+        }
+    }
+    return (BenchUtils::now() - startTime) * 1000.0 / QUEUE_PACKET_COUNT;
+}
+
+template<class Queue>
+static void runQueue(int batch, QueueResult *result) {
+    AVPacket flushPacket;
+    av_init_packet(&flushPacket);
+    flushPacket.data = (uint8_t *) &flushPacket;
+    AVPacket packet;
+    av_init_packet(&packet);
+    static uint8_t data[64];
+    packet.data = data;
+    packet.size = 100000;
+    packet.duration = 1;
+
+    Queue queue(&flushPacket);
+    queue.start();
+    AVPacket pkt;
+    queue.getPacket(&pkt, 0);
+    // 第一轮预热，节点池扩容到批次大小
+    runRound(&queue, batch, &packet, &result->failures);
+    int poolSize = getPoolSize(&queue);
+    for (int round = 0; round < QUEUE_ROUNDS; ++round) {
+        double cost = runRound(&queue, batch, &packet, &result->failures);
+        if (round == 0 || cost < result->cost) {
+            result->cost = cost;
+        }
+    }
+    result->poolSize = getPoolSize(&queue);
+    result->poolGrowth = result->poolSize - poolSize;
+    if (queue.getPacketSize() != 0) {
+        result->failures++;
+    }
+}
+
+int main(int argc, char **argv) {
+    printf("packet queue push + pop, %d packets, best of %d rounds\n", QUEUE_PACKET_COUNT,
+           QUEUE_ROUNDS);
+    printf("%-7s %12s %12s %9s %7s %7s\n", "batch", "pooled ns", "legacy ns", "speedup", "pool",
+           "growth");
+    const int batches[] = {1, 16, 256, 2048};
+    int failures = 0;
+    for (int batch : batches) {
+        QueueResult pooled;
+        QueueResult legacy;
+        runQueue<PacketQueue>(batch, &pooled);
+        runQueue<LegacyPacketQueue>(batch, &legacy);
+        // 预热之后节点池不应该再扩容
+        failures += pooled.failures + legacy.failures + (pooled.poolGrowth > 0 ? 1 : 0);
+        printf("%-7d %12.1f %12.1f %8.2fx %7d %7d%s\n", batch, pooled.cost, legacy.cost,
+               legacy.cost / pooled.cost, pooled.poolSize, pooled.poolGrowth,
+               pooled.failures + legacy.failures > 0 ? "  FAILED" : "");
+    }
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+/**
+ * 多实例扩展性：同时播放N个本地文件，输出每个实例的CPU占用、常驻内存、线程数量和占用的工作线程数量
+ * 组件的循环在播放期间独占工作线程，每个实例的工作线程数量不随实例数量减少
+ * 用法：bench_players [媒体目录] [最大实例数量]
+ */
+#include <cstdlib>
+#include <MediaEngine.h>
+#include "BenchMedia.h"
+#include "BenchPlayer.h"
+
+/// 每个实例数量的测量时长，秒
+#define PLAYERS_MEASURE_SECONDS                     5
+
+/// 开始播放之后等待稳定的时长，秒
+#define PLAYERS_SETTLE_SECONDS                      1
+
+/// 默认的最大实例数量
+#define PLAYERS_MAX_COUNT                           8
+
+int main(int argc, char **argv) {
+    std::string dir = BenchUtils::mediaDir(argc, argv);
+    int maxCount = argc > 2 ? atoi(argv[2]) : PLAYERS_MAX_COUNT;
+    std::string path = dir + "/players_360p.ts";
+    BenchMediaSpec spec = {"mpegts", 640, 360, 30, 30, 60, 1000000};
+    if (BenchMedia::generate(path, spec) < 0) {
+        fprintf(stderr, "generate %s failure\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // 第一个实例创建之前的基准，线程池还没有工作线程
+    int64_t baseRss = BenchUtils::processRss();
+    int baseThreads = BenchUtils::processThreads();
+    printf("baseline: rss = %lld KB threads = %d\n", (long long) baseRss, baseThreads);
+    printf("%9s %10s %12s %12s %14s %9s %14s %6s %14s %8s\n", "instances", "cpu %",
+           "cpu %/inst", "rss KB", "rss KB/inst", "threads", "threads/inst", "pool",
+           "workers/inst", "fps/inst");
+
+    int failures = 0;
+    for (int count = 1; count <= maxCount; count *= 2) {
+        std::vector<BenchPlayer *> players;
+        for (int i = 0; i < count; ++i) {
+            auto *player = new BenchPlayer();
+            if (player->create() < 0 || player->open(path.c_str()) < 0) {
+                failures++;
+            }
+            players.push_back(player);
+        }
+        for (BenchPlayer *player : players) {
+            if (!player->getVideoDevice()->waitPresents(1, 10000)) {
+                failures++;
+            }
+        }
+        BenchUtils::sleepUs(PLAYERS_SETTLE_SECONDS * 1000000LL);
+
+        std::vector<int> presents;
+        for (BenchPlayer *player : players) {
+            presents.push_back(player->getVideoDevice()->getPresentCount());
+        }
+        CpuWindow window;
+        window.begin();
+        BenchUtils::sleepUs(PLAYERS_MEASURE_SECONDS * 1000000LL);
+        double cpu = window.end();
+
+        EngineStats stats;
+        MediaEngine::getStats(&stats);
+        double fps = 0;
+        for (int i = 0; i < count; ++i) {
+            fps += (players[i]->getVideoDevice()->getPresentCount() - presents[i]) /
+                   window.getElapsed();
+        }
+        int64_t rss = stats.processRss - baseRss;
+        int threads = stats.processThreads - baseThreads;
+        printf("%9d %10.1f %12.1f %12lld %14lld %9d %14.1f %6d %14.1f %8.1f\n", count, cpu,
+               cpu / count, (long long) rss, (long long) (rss / count), stats.processThreads,
+               (double) threads / count, stats.poolSize, (double) stats.activeCount / count,
+               fps / count);
+
+        for (BenchPlayer *player : players) {
+            delete player;
+        }
+    }
+
+    EngineStats stats;
+    MediaEngine::getStats(&stats);
+    printf("after destroy: instances = %d threads = %d pool = %d\n", stats.instanceCount,
+           stats.processThreads, stats.poolSize);
+    if (MediaEngine::shutdown() < 0) {
+        failures++;
+    }
+    MediaEngine::getStats(&stats);
+    printf("after shutdown: threads = %d pool = %d\n", stats.processThreads, stats.poolSize);
+    if (stats.poolSize != 0 || stats.processThreads > baseThreads) {
+        fprintf(stderr, "pool workers not joined\n");
+        failures++;
+    }
+    if (failures > 0) {
+        fprintf(stderr, "%d failures\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+/**
+ * 读包事件：队列满时的空闲唤醒次数和定位到显示第一帧的耗时
+ * 读包线程在队列满、读到结尾和读包出错时等待读包事件，由解码器取出数据包、定位、暂停、退出唤醒，
+ * 之前的实现每10ms轮询一次，只读包线程每秒就至少唤醒100次
+ * 输出播放中(队列已满)和暂停时进程每秒的唤醒次数和CPU占用，以及定位到显示目标附近画面的耗时
+ * 用法：bench_read_event [媒体目录]
+ */
+#include <cmath>
+#include <cstdlib>
+#include "BenchMedia.h"
+#include "BenchPlayer.h"
+
+/// 开始播放或者暂停之后等待队列填满的时长，毫秒
+#define READ_SETTLE_TIME                            2000
+
+/// 每个空闲阶段的测量时长，毫秒
+#define READ_MEASURE_TIME                           5000
+
+/// 定位次数
+#define READ_SEEK_COUNT                             20
+
+/// 等待显示定位目标的最长时间，毫秒
+#define READ_SEEK_TIMEOUT                           5000
+
+/// 显示的帧和目标的差距小于该值时认为到达目标，秒，不是精确定位，可能显示目标之前的关键帧
+#define READ_SEEK_ERROR                             1.1
+
+typedef struct IdleResult {
+    /// 每秒唤醒次数
+    double wakeups = 0;
+    double cpu = 0;
+} IdleResult;
+
+static void measureIdle(IdleResult *result) {
+    BenchUtils::sleepUs(READ_SETTLE_TIME * 1000LL);
+    int64_t wakeups = BenchUtils::processWakeups();
+    CpuWindow window;
+    window.begin();
+    BenchUtils::sleepUs(READ_MEASURE_TIME * 1000LL);
+    result->cpu = window.end();
+    result->wakeups = (BenchUtils::processWakeups() - wakeups) / window.getElapsed();
+}
+
+/**
+ * 定位到固定种子的伪随机目标，每次定位之后等待显示目标附近的画面
+ * @return 没有到达目标的次数
+ */
+static int runSeeks(BenchPlayer *player, BenchStats *latency) {
+    MediaPlayer *mediaPlayer = player->getPlayer();
+    BenchVideoDevice *videoDevice = player->getVideoDevice();
+    double duration = mediaPlayer->getDuration() / 1000.0;
+    int failures = 0;
+    uint32_t seed = 12345;
+    for (int i = 0; i < READ_SEEK_COUNT; ++i) {
+        seed = seed * 1103515245 + 12345;
+        // 目标在10%~90%之间，和上一个目标至少相差10%，避免上一次的画面被误认为到达
+        double target = duration * (0.1 + (i % 2) * 0.4 + ((seed >> 8) % 1000) / 1000.0 * 0.4);
+        int64_t startTime = BenchUtils::now();
+        mediaPlayer->seekTo((float) (target - mediaPlayer->getCurrentPosition() / 1000.0));
+        bool reached = false;
+        while (BenchUtils::now() - startTime < READ_SEEK_TIMEOUT * 1000LL) {
+            if (std::fabs(videoDevice->getLastPts() - target) < READ_SEEK_ERROR) {
+                latency->add((BenchUtils::now() - startTime) / 1000.0);
+                reached = true;
+                break;
+            }
+            BenchUtils::sleepUs(1000);
+        }
+        if (!reached) {
+            failures++;
+        }
+        BenchUtils::sleepUs(300000);
+    }
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    // MP4的起始时间为0，显示帧的pts就是播放位置
+    std::string path = BenchUtils::mediaDir(argc, argv) + "/read_360p.mp4";
+    BenchMediaSpec spec = {"mp4", 640, 360, 30, 60, 30, 1000000};
+    if (BenchMedia::generate(path, spec) < 0) {
+        fprintf(stderr, "generate %s failure\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    BenchPlayer player;
+    if (player.create() < 0 || player.open(path.c_str()) < 0 ||
+        !player.getVideoDevice()->waitPresents(1, 10000)) {
+        fprintf(stderr, "open %s failure\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+    IdleResult playing;
+    IdleResult paused;
+    measureIdle(&playing);
+    player.getPlayer()->pause();
+    measureIdle(&paused);
+    player.getPlayer()->play();
+    BenchStats latency;
+    int failures = runSeeks(&player, &latency);
+    player.stop(5000);
+
+    printf("read event, queues full while playing, %d ms each phase\n", READ_MEASURE_TIME);
+    printf("%-8s %11s %7s\n", "state", "wakeups/s", "cpu %");
+    printf("%-8s %11.1f %7.1f\n", "playing", playing.wakeups, playing.cpu);
+    printf("%-8s %11.1f %7.1f\n", "paused", paused.wakeups, paused.cpu);
+    printf("seek to first frame, %d seeks: mean %.1f ms, p95 %.1f ms, max %.1f ms, missed %d\n",
+           READ_SEEK_COUNT, latency.mean(), latency.percentile(95), latency.max(), failures);
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,124 @@
+/**
+ * 拖动进度条：3秒内从10%匀速拖到90%，每秒60次拖动事件
+ * 对比拖动模式(startScrub/scrubTo/stopScrub)和之前每个事件调用一次seekTo的方式
+ * 输出拖动期间显示的帧率、显示画面和手指位置的差距、CPU占用，以及松手之后到显示目标帧的耗时
+ * 用法：bench_scrub [媒体目录]
+ */
+#include <cmath>
+#include <cstdlib>
+#include "BenchMedia.h"
+#include "BenchPlayer.h"
+
+/// 拖动时长，毫秒
+#define SCRUB_DRAG_TIME                             3000
+
+/// 拖动事件频率，Hz
+#define SCRUB_EVENT_RATE                            60
+
+/// 松手之后等待显示目标帧的最长时间，毫秒
+#define SCRUB_RELEASE_TIMEOUT                       3000
+
+/// 显示的帧和目标的差距小于该值时认为到达目标，秒
+#define SCRUB_REACHED_ERROR                         0.1
+
+typedef struct ScrubResult {
+    int events = 0;
+    int presents = 0;
+    /// 拖动期间显示的帧率
+    double fps = 0;
+    double cpu = 0;
+    /// 每个拖动事件时显示的画面和手指位置的差距，秒
+    BenchStats trackingError;
+    /// 松手到显示目标帧的耗时，毫秒，没有到达时为-1
+    double releaseLatency = -1;
+    /// 松手之后稳定显示的画面和目标的差距，秒
+    double finalError = 0;
+    int failures = 0;
+} ScrubResult;
+
+static void runDrag(BenchPlayer *player, bool scrub, ScrubResult *result) {
+    MediaPlayer *mediaPlayer = player->getPlayer();
+    BenchVideoDevice *videoDevice = player->getVideoDevice();
+    double duration = mediaPlayer->getDuration() / 1000.0;
+    double from = duration * 0.1;
+    double to = duration * 0.9;
+    int events = SCRUB_DRAG_TIME * SCRUB_EVENT_RATE / 1000;
+
+    if (scrub && mediaPlayer->startScrub() < 0) {
+        result->failures++;
+        return;
+    }
+    int presents = videoDevice->getPresentCount();
+    CpuWindow window;
+    window.begin();
+    int64_t startTime = BenchUtils::now();
+    double target = from;
+    for (int i = 0; i <= events; ++i) {
+        BenchUtils::sleepUntil(startTime + (int64_t) i * 1000000 / SCRUB_EVENT_RATE);
+        target = from + (to - from) * i / events;
+        if (scrub) {
+            mediaPlayer->scrubTo((int64_t) (target * 1000));
+        } else {
+            // 之前的方式：相对主时钟的增量定位，上一次定位没有完成时被丢弃
+            mediaPlayer->seekTo((float) (target - mediaPlayer->getCurrentPosition() / 1000.0));
+        }
+        result->events++;
+        double pts = videoDevice->getLastPts();
+        if (!std::isnan(pts)) {
+            result->trackingError.add(std::fabs(pts - target));
+        }
+    }
+    result->cpu = window.end();
+    result->presents = videoDevice->getPresentCount() - presents;
+    result->fps = result->presents / window.getElapsed();
+
+    int64_t releaseTime = BenchUtils::now();
+    if (scrub) {
+        mediaPlayer->stopScrub();
+    }
+    while (BenchUtils::now() - releaseTime < SCRUB_RELEASE_TIMEOUT * 1000LL) {
+        if (std::fabs(videoDevice->getLastPts() - target) < SCRUB_REACHED_ERROR) {
+            result->releaseLatency = (BenchUtils::now() - releaseTime) / 1000.0;
+            break;
+        }
+        BenchUtils::sleepUs(2000);
+    }
+    // 继续播放，记录稳定之后和目标的差距，扣除松手之后播放的时长
+    BenchUtils::sleepUs(500000);
+    double played = (BenchUtils::now() - releaseTime) / 1000000.0;
+    result->finalError = std::fabs(videoDevice->getLastPts() - played - target);
+}
+
+int main(int argc, char **argv) {
+    std::string dir = BenchUtils::mediaDir(argc, argv);
+    // MP4的起始时间为0，显示帧的pts就是播放位置
+    std::string path = dir + "/scrub_720p.mp4";
+    BenchMediaSpec spec = {"mp4", 1280, 720, 30, 60, 30, 3000000};
+    if (BenchMedia::generate(path, spec) < 0) {
+        fprintf(stderr, "generate %s failure\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    printf("drag 10%% -> 90%% in %d ms, %d events/s\n", SCRUB_DRAG_TIME, SCRUB_EVENT_RATE);
+    printf("%-8s %7s %9s %7s %7s %12s %12s %12s %11s\n", "mode", "events", "presents", "fps",
+           "cpu %", "track avg s", "track p95 s", "release ms", "final err s");
+    int failures = 0;
+    for (int scrub = 1; scrub >= 0; --scrub) {
+        BenchPlayer player;
+        ScrubResult result;
+        if (player.create() < 0 || player.open(path.c_str()) < 0 ||
+            !player.waitMsg(Msg::MSG_PLAY_STARTED, 1, 10000) ||
+            !player.getVideoDevice()->waitPresents(30, 10000)) {
+            result.failures++;
+        } else {
+            runDrag(&player, scrub != 0, &result);
+            player.stop(5000);
+        }
+        failures += result.failures;
+        printf("%-8s %7d %9d %7.1f %7.1f %12.3f %12.3f %12.1f %11.3f%s\n",
+               scrub ? "scrub" : "seekTo", result.events, result.presents, result.fps,
+               result.cpu, result.trackingError.mean(), result.trackingError.percentile(95),
+               result.releaseLatency, result.finalError, result.failures > 0 ? "  FAILED" : "");
+    }
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
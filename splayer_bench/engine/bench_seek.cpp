@@ -0,0 +1,221 @@
+/**
+ * 关键帧索引的定位耗时：定位到目标并解码出目标时间的第一帧
+ * 对比解复用器原生的定位和按关键帧索引的字节定位，使用原生索引不完善的TS和FLV，
+ * 分别读取本地文件和模拟网络延迟的HTTP，HTTP的每次跳转都是一次新的Range请求
+ * 用法：bench_seek [媒体目录]
+ */
+#include <cstdlib>
+#include <KeyframeIndex.h>
+#include "BenchMedia.h"
+#include "BenchServer.h"
+#include "BenchUtils.h"
+
+/// 定位次数
+#define SEEK_COUNT                                  30
+
+/// 模拟的网络往返时间，毫秒
+#define SEEK_HTTP_LATENCY                           20
+
+/// 一次定位最多读取的数据包数量，超过认为定位失败
+#define SEEK_MAX_PACKETS                            3000
+
+typedef struct SeekContext {
+    AVFormatContext *formatContext = nullptr;
+    AVCodecContext *codecContext = nullptr;
+    AVPacket *packet = nullptr;
+    AVFrame *frame = nullptr;
+    int streamIndex = -1;
+} SeekContext;
+
+typedef struct SeekResult {
+    /// 定位到解码出目标帧的耗时，毫秒
+    BenchStats time;
+    /// 读取的数据量，KB
+    BenchStats bytes;
+    /// 读取的数据包数量
+    BenchStats packets;
+    /// 索引没有命中，退回原生定位的次数
+    int fallbacks = 0;
+    int failures = 0;
+} SeekResult;
+
+static void closeContext(SeekContext *ctx) {
+    av_frame_free(&ctx->frame);
+    av_packet_free(&ctx->packet);
+    avcodec_free_context(&ctx->codecContext);
+    avformat_close_input(&ctx->formatContext);
+}
+
+static int openContext(SeekContext *ctx, const char *url) {
+    if (avformat_open_input(&ctx->formatContext, url, nullptr, nullptr) < 0 ||
+        avformat_find_stream_info(ctx->formatContext, nullptr) < 0) {
+        return ERROR;
+    }
+    ctx->streamIndex = av_find_best_stream(ctx->formatContext, AVMEDIA_TYPE_VIDEO, -1, -1,
+                                           nullptr, 0);
+    if (ctx->streamIndex < 0) {
+        return ERROR;
+    }
+    AVCodecParameters *codecpar = ctx->formatContext->streams[ctx->streamIndex]->codecpar;
+    const AVCodec *codec = avcodec_find_decoder(codecpar->codec_id);
+    ctx->codecContext = avcodec_alloc_context3(codec);
+    ctx->packet = av_packet_alloc();
+    ctx->frame = av_frame_alloc();
+    if (!codec || !ctx->codecContext || !ctx->packet || !ctx->frame ||
+        avcodec_parameters_to_context(ctx->codecContext, codecpar) < 0 ||
+        avcodec_open2(ctx->codecContext, codec, nullptr) < 0) {
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/**
+ * 读取整个文件建立索引，关闭时保存到媒体文件旁边
+ */
+static int buildIndex(const char *path) {
+    SeekContext ctx;
+    KeyframeIndex index;
+    int ret = openContext(&ctx, path);
+    if (ret >= 0) {
+        ret = index.open(ctx.formatContext, ctx.streamIndex, path, nullptr);
+    }
+    while (ret >= 0 && av_read_frame(ctx.formatContext, ctx.packet) >= 0) {
+        index.addPacket(ctx.packet);
+        av_packet_unref(ctx.packet);
+    }
+    index.close();
+    closeContext(&ctx);
+    return ret;
+}
+
+/**
+ * 定位并解码到目标时间，和播放器的精确定位一样丢弃目标之前的帧
+ */
+static int seekAndDecode(SeekContext *ctx, KeyframeIndex *index, int64_t target,
+                         SeekResult *result) {
+    AVStream *stream = ctx->formatContext->streams[ctx->streamIndex];
+    int64_t frameDuration = av_rescale_q(1, av_inv_q(stream->avg_frame_rate), AV_TIME_BASE_Q);
+    int64_t bytesRead = ctx->formatContext->pb->bytes_read;
+    int64_t startTime = BenchUtils::now();
+    int64_t keyframePts;
+    int64_t keyframePos;
+    int ret = -1;
+
+    if (index) {
+        if (index->find(target, &keyframePts, &keyframePos)) {
+            ret = avformat_seek_file(ctx->formatContext, -1, keyframePos, keyframePos,
+                                     keyframePos, AVSEEK_FLAG_BYTE);
+        } else {
+            result->fallbacks++;
+        }
+    }
+    if (ret < 0) {
+        ret = avformat_seek_file(ctx->formatContext, -1, INT64_MIN, target, INT64_MAX, 0);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+    avcodec_flush_buffers(ctx->codecContext);
+
+    int packets = 0;
+    bool reached = false;
+    while (!reached && packets < SEEK_MAX_PACKETS &&
+           av_read_frame(ctx->formatContext, ctx->packet) >= 0) {
+        packets++;
+        if (ctx->packet->stream_index == ctx->streamIndex) {
+            avcodec_send_packet(ctx->codecContext, ctx->packet);
+            while (avcodec_receive_frame(ctx->codecContext, ctx->frame) == 0) {
+                int64_t pts = av_rescale_q(ctx->frame->best_effort_timestamp, stream->time_base,
+                                           AV_TIME_BASE_Q);
+                av_frame_unref(ctx->frame);
+                if (pts >= target - frameDuration / 2) {
+                    reached = true;
+                    break;
+                }
+            }
+        }
+        av_packet_unref(ctx->packet);
+    }
+    if (!reached) {
+        return ERROR;
+    }
+    result->time.add((BenchUtils::now() - startTime) / 1000.0);
+    result->bytes.add((ctx->formatContext->pb->bytes_read - bytesRead) / 1024.0);
+    result->packets.add(packets);
+    return SUCCESS;
+}
+
+static void runSeeks(const char *url, KeyframeIndex *index, const char *indexPath,
+                     SeekResult *result) {
+    SeekContext ctx;
+    if (openContext(&ctx, url) < 0 ||
+        (index && index->open(ctx.formatContext, ctx.streamIndex, indexPath, nullptr) < 0)) {
+        result->failures++;
+        closeContext(&ctx);
+        return;
+    }
+    int64_t start = ctx.formatContext->start_time != AV_NOPTS_VALUE ?
+                    ctx.formatContext->start_time : 0;
+    int64_t duration = ctx.formatContext->duration;
+    // 固定种子的伪随机目标，每种方式的目标相同
+    uint32_t seed = 12345;
+    for (int i = 0; i < SEEK_COUNT; ++i) {
+        seed = seed * 1103515245 + 12345;
+        // 目标在5%~95%之间
+        int64_t target = start + duration / 20 +
+                         (int64_t) ((seed >> 8) % 1000) * duration * 9 / 10000;
+        if (seekAndDecode(&ctx, index, target, result) < 0) {
+            result->failures++;
+        }
+    }
+    closeContext(&ctx);
+}
+
+int main(int argc, char **argv) {
+    std::string dir = BenchUtils::mediaDir(argc, argv);
+    av_log_set_level(AV_LOG_ERROR);
+    avformat_network_init();
+    BenchMediaSpec specs[] = {
+            {"mpegts", 640, 360, 30, 120, 60, 1500000},
+            {"flv",    640, 360, 30, 120, 60, 1500000},
+    };
+    const char *names[] = {"seek_360p.ts", "seek_360p.flv"};
+
+    BenchServer server(dir);
+    if (server.start() < 0) {
+        fprintf(stderr, "start server failure\n");
+        return EXIT_FAILURE;
+    }
+    server.setLatency(SEEK_HTTP_LATENCY);
+
+    printf("seek to target and decode the target frame, %d targets each\n", SEEK_COUNT);
+    printf("%-14s %-6s %-8s %9s %9s %9s %10s %9s %6s\n", "file", "io", "method", "mean ms",
+           "p95 ms", "max ms", "read KB", "packets", "miss");
+    int failures = 0;
+    for (int i = 0; i < 2; ++i) {
+        std::string path = dir + "/" + names[i];
+        if (BenchMedia::generate(path, specs[i]) < 0 || buildIndex(path.c_str()) < 0) {
+            fprintf(stderr, "prepare %s failure\n", path.c_str());
+            failures++;
+            continue;
+        }
+        std::string urls[] = {path, server.getUrl(names[i])};
+        const char *ios[] = {"local", "http"};
+        for (int io = 0; io < 2; ++io) {
+            for (int indexed = 0; indexed < 2; ++indexed) {
+                SeekResult result;
+                // 从保存的索引文件加载，和第二次打开同一个文件一样
+                KeyframeIndex index;
+                runSeeks(urls[io].c_str(), indexed ? &index : nullptr, path.c_str(), &result);
+                failures += result.failures;
+                printf("%-14s %-6s %-8s %9.1f %9.1f %9.1f %10.1f %9.1f %6d%s\n", names[i],
+                       ios[io], indexed ? "index" : "native", result.time.mean(),
+                       result.time.percentile(95), result.time.max(), result.bytes.mean(),
+                       result.packets.mean(), result.fallbacks,
+                       result.failures > 0 ? "  FAILED" : "");
+            }
+        }
+    }
+    server.stop();
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
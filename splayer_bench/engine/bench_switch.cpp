@@ -0,0 +1,117 @@
+/**
+ * 切换下一个媒体的耗时：停止当前媒体到下一个媒体显示第一帧
+ * 对比直接切换和切换之前prepareNext预加载，分别使用本地文件和模拟网络延迟的HTTP
+ * 用法：bench_switch [媒体目录]
+ */
+#include <cstdlib>
+#include "BenchMedia.h"
+#include "BenchPlayer.h"
+#include "BenchServer.h"
+
+/// 每种方式的切换次数
+#define SWITCH_COUNT                                6
+
+/// 每个媒体播放的时长，毫秒
+#define SWITCH_PLAY_TIME                            2000
+
+/// 切换之前多久开始预加载，毫秒
+#define SWITCH_PRELOAD_AHEAD                        1500
+
+/// 模拟的网络往返时间，毫秒
+#define SWITCH_HTTP_LATENCY                         80
+
+/// 模拟的网络带宽，bps
+#define SWITCH_HTTP_RATE                            (20 * 1000 * 1000)
+
+typedef struct SwitchResult {
+    /// 停止到第一帧显示，毫秒
+    BenchStats latency;
+    /// 打开到读到第一个数据包，毫秒
+    BenchStats firstPacket;
+    int failures = 0;
+} SwitchResult;
+
+static void runSwitches(BenchPlayer *player, const std::string *urls, bool preload,
+                        SwitchResult *result) {
+    int current = 0;
+    if (player->open(urls[current].c_str()) < 0 ||
+        !player->getVideoDevice()->waitPresents(1, 10000)) {
+        result->failures++;
+        return;
+    }
+    for (int i = 0; i < SWITCH_COUNT; ++i) {
+        int next = 1 - current;
+        BenchUtils::sleepUs((SWITCH_PLAY_TIME - SWITCH_PRELOAD_AHEAD) * 1000LL);
+        if (preload) {
+            player->getPlayer()->prepareNext(urls[next].c_str());
+        }
+        BenchUtils::sleepUs(SWITCH_PRELOAD_AHEAD * 1000LL);
+
+        int timings = player->getMsgCount(Msg::MSG_OPEN_TIMING);
+        int64_t switchTime = BenchUtils::now();
+        if (player->stop(5000) < 0 || player->open(urls[next].c_str()) < 0 ||
+            !player->getVideoDevice()->waitPresents(1, 10000)) {
+            result->failures++;
+            return;
+        }
+        result->latency.add((player->getVideoDevice()->getFirstPresentTime() - switchTime) / 1000.0);
+        // 第一个数据包是最后一个打开阶段
+        if (player->waitMsg(Msg::MSG_OPEN_TIMING, timings + 1, 1000) &&
+            player->getMsgArg1(Msg::MSG_OPEN_TIMING) == Msg::OPEN_STAGE_FIRST_PACKET) {
+            result->firstPacket.add(player->getMsgArg2(Msg::MSG_OPEN_TIMING));
+        }
+        current = next;
+    }
+    player->stop(5000);
+}
+
+int main(int argc, char **argv) {
+    std::string dir = BenchUtils::mediaDir(argc, argv);
+    BenchMediaSpec specA = {"mp4", 1280, 720, 30, 20, 30, 2000000};
+    BenchMediaSpec specB = {"mpegts", 1280, 720, 30, 20, 30, 2000000};
+    if (BenchMedia::generate(dir + "/switch_a.mp4", specA) < 0 ||
+        BenchMedia::generate(dir + "/switch_b.ts", specB) < 0) {
+        fprintf(stderr, "generate media failure\n");
+        return EXIT_FAILURE;
+    }
+
+    BenchServer server(dir);
+    if (server.start() < 0) {
+        fprintf(stderr, "start server failure\n");
+        return EXIT_FAILURE;
+    }
+    server.setLatency(SWITCH_HTTP_LATENCY);
+    server.setRate(SWITCH_HTTP_RATE);
+
+    std::string local[2] = {dir + "/switch_a.mp4", dir + "/switch_b.ts"};
+    std::string http[2] = {server.getUrl("switch_a.mp4"), server.getUrl("switch_b.ts")};
+    struct {
+        const char *name;
+        const std::string *urls;
+        bool preload;
+    } cases[] = {
+            {"local",         local, false},
+            {"local preload", local, true},
+            {"http",          http,  false},
+            {"http preload",  http,  true},
+    };
+
+    printf("switch latency (stop -> first frame of next item), %d switches each\n", SWITCH_COUNT);
+    printf("%-14s %10s %10s %10s %14s\n", "case", "mean ms", "p95 ms", "max ms", "1st pkt ms");
+    int failures = 0;
+    for (auto &c : cases) {
+        BenchPlayer player;
+        SwitchResult result;
+        if (player.create() < 0) {
+            result.failures++;
+        } else {
+            runSwitches(&player, c.urls, c.preload, &result);
+        }
+        failures += result.failures;
+        printf("%-14s %10.1f %10.1f %10.1f %14.1f%s\n", c.name, result.latency.mean(),
+               result.latency.percentile(95), result.latency.max(), result.firstPacket.mean(),
+               result.failures > 0 ? "  FAILED" : "");
+    }
+    server.stop();
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,227 @@
+/**
+ * 缩略图提取吞吐量：在时长内均匀分布的时间戳，每个时间戳输出一张160宽的缩略图
+ * 对比ThumbnailExtractor不同工作线程数量，和额外播放器的做法：
+ * 原分辨率解码所有帧，精确定位到目标帧之后缩放
+ * 输出每秒缩略图数量、开始提取到每张缩略图返回的耗时和CPU占用
+ * 用法：bench_thumbnails [媒体目录]
+ */
+#include <cstdlib>
+#include <Condition.h>
+#include <ThumbnailExtractor.h>
+#include "BenchMedia.h"
+#include "BenchUtils.h"
+
+extern "C" {
+#include <libavutil/cpu.h>
+};
+
+/// 每次提取的时间戳数量
+#define THUMBS_COUNT                                40
+
+/// 缩略图宽度，高度按宽高比计算
+#define THUMBS_WIDTH                                160
+
+/// 等待提取完成的最长时间，毫秒
+#define THUMBS_TIMEOUT                              120000
+
+typedef struct ThumbResult {
+    /// 每秒缩略图数量
+    double rate = 0;
+    double cpu = 0;
+    /// 开始提取到每张缩略图返回，毫秒
+    BenchStats latency;
+    int count = 0;
+    int failures = 0;
+} ThumbResult;
+
+/**
+ * 记录每张缩略图的返回时间，提取完成时通知主线程
+ */
+class ThumbListener : public IThumbnailListener {
+
+public:
+
+    ThumbListener(ThumbResult *result) : result(result) {
+    }
+
+    void onThumbnail(int index, int64_t timestamp, int64_t pts, const uint8_t *data,
+                     int width, int height, int linesize) override {
+        result->latency.add((BenchUtils::now() - startTime) / 1000.0);
+        if (width != THUMBS_WIDTH || height <= 0 || !data) {
+            result->failures++;
+        }
+    }
+
+    void onThumbnailComplete(int count, float thumbnailsPerSecond) override {
+        Mutex::Autolock lock(mutex);
+        result->count = count;
+        finished = true;
+        condition.signal();
+    }
+
+    void begin() {
+        startTime = BenchUtils::now();
+    }
+
+    bool wait(int timeoutMs) {
+        Mutex::Autolock lock(mutex);
+        int64_t deadline = BenchUtils::now() + timeoutMs * 1000LL;
+        while (!finished && BenchUtils::now() < deadline) {
+            condition.waitRelative(mutex, (deadline - BenchUtils::now()) * 1000);
+        }
+        return finished;
+    }
+
+private:
+
+    Mutex mutex;
+
+    Condition condition;
+
+    ThumbResult *result;
+
+    int64_t startTime = 0;
+
+    bool finished = false;
+};
+
+static void runExtractor(const char *path, const std::vector<int64_t> &timestamps, int workers,
+                         ThumbResult *result) {
+    ThumbListener listener(result);
+    ThumbnailExtractor extractor;
+    extractor.setListener(&listener);
+    CpuWindow window;
+    window.begin();
+    listener.begin();
+    if (extractor.start(path, timestamps, THUMBS_WIDTH, 0, workers) < 0 ||
+        !listener.wait(THUMBS_TIMEOUT)) {
+        result->failures++;
+    }
+    result->cpu = window.end();
+    result->rate = result->count / window.getElapsed();
+    extractor.setListener(nullptr);
+}
+
+/**
+ * 额外播放器的做法：原分辨率解码每一帧，定位到目标帧之后缩放
+ */
+static void runPlayerStyle(const char *path, const std::vector<int64_t> &timestamps,
+                           ThumbResult *result) {
+    AVFormatContext *formatContext = nullptr;
+    AVCodecContext *codecContext = nullptr;
+    SwsContext *swsContext = nullptr;
+    AVPacket *packet = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+    uint8_t *data[4] = {nullptr};
+    int linesize[4] = {0};
+    CpuWindow window;
+    window.begin();
+    int64_t startTime = BenchUtils::now();
+
+    int streamIndex = -1;
+    if (avformat_open_input(&formatContext, path, nullptr, nullptr) >= 0 &&
+        avformat_find_stream_info(formatContext, nullptr) >= 0) {
+        streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    }
+    const AVCodec *codec = nullptr;
+    if (streamIndex >= 0) {
+        codec = avcodec_find_decoder(formatContext->streams[streamIndex]->codecpar->codec_id);
+        codecContext = avcodec_alloc_context3(codec);
+    }
+    if (!codec || !codecContext ||
+        avcodec_parameters_to_context(codecContext,
+                                      formatContext->streams[streamIndex]->codecpar) < 0 ||
+        avcodec_open2(codecContext, codec, nullptr) < 0) {
+        result->failures++;
+    } else {
+        AVStream *stream = formatContext->streams[streamIndex];
+        int width = THUMBS_WIDTH;
+        int height = codecContext->height * width / codecContext->width;
+        av_image_alloc(data, linesize, width, height, AV_PIX_FMT_RGBA, 16);
+        for (int64_t timestamp : timestamps) {
+            int64_t target = av_rescale_q(timestamp, AV_TIME_BASE_Q, stream->time_base);
+            if (av_seek_frame(formatContext, streamIndex, target, AVSEEK_FLAG_BACKWARD) < 0) {
+                result->failures++;
+                continue;
+            }
+            avcodec_flush_buffers(codecContext);
+            bool reached = false;
+            while (!reached && av_read_frame(formatContext, packet) >= 0) {
+                if (packet->stream_index == streamIndex) {
+                    avcodec_send_packet(codecContext, packet);
+                    while (!reached && avcodec_receive_frame(codecContext, frame) == 0) {
+                        if (frame->best_effort_timestamp >= target) {
+                            swsContext = sws_getCachedContext(
+                                    swsContext, frame->width, frame->height,
+                                    (AVPixelFormat) frame->format, width, height,
+                                    AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr, nullptr, nullptr);
+                            sws_scale(swsContext, frame->data, frame->linesize, 0, frame->height,
+                                      data, linesize);
+                            reached = true;
+                        }
+                        av_frame_unref(frame);
+                    }
+                }
+                av_packet_unref(packet);
+            }
+            if (reached) {
+                result->count++;
+                result->latency.add((BenchUtils::now() - startTime) / 1000.0);
+            } else {
+                result->failures++;
+            }
+        }
+    }
+    result->cpu = window.end();
+    result->rate = result->count / window.getElapsed();
+
+    av_freep(&data[0]);
+    sws_freeContext(swsContext);
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&codecContext);
+    avformat_close_input(&formatContext);
+}
+
+int main(int argc, char **argv) {
+    std::string path = BenchUtils::mediaDir(argc, argv) + "/thumbs_720p.mp4";
+    BenchMediaSpec spec = {"mp4", 1280, 720, 30, 60, 60, 4000000};
+    if (BenchMedia::generate(path, spec) < 0) {
+        fprintf(stderr, "generate %s failure\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+    av_log_set_level(AV_LOG_ERROR);
+
+    // 时间戳在时长内均匀分布，避开最后一个关键帧间隔
+    std::vector<int64_t> timestamps;
+    int64_t duration = (int64_t) (spec.duration - 2) * AV_TIME_BASE;
+    for (int i = 0; i < THUMBS_COUNT; ++i) {
+        timestamps.push_back(duration * i / THUMBS_COUNT);
+    }
+
+    printf("thumbnails, %d timestamps of %dx%d %d s video, %d px wide, %d cpus\n", THUMBS_COUNT,
+           spec.width, spec.height, spec.duration, THUMBS_WIDTH, av_cpu_count());
+    printf("%-16s %8s %8s %10s %9s %7s\n", "method", "count", "thumbs/s", "latency ms",
+           "p95 ms", "cpu %");
+    int failures = 0;
+    const int workers[] = {1, 2, 4};
+    for (int i = -1; i < 3; ++i) {
+        ThumbResult result;
+        char name[32];
+        if (i < 0) {
+            snprintf(name, sizeof(name), "player-style");
+            runPlayerStyle(path.c_str(), timestamps, &result);
+        } else {
+            snprintf(name, sizeof(name), "extractor x%d", workers[i]);
+            runExtractor(path.c_str(), timestamps, workers[i], &result);
+        }
+        if (result.count != THUMBS_COUNT) {
+            result.failures++;
+        }
+        failures += result.failures;
+        printf("%-16s %8d %8.1f %10.1f %9.1f %7.1f%s\n", name, result.count, result.rate,
+               result.latency.mean(), result.latency.percentile(95), result.cpu,
+               result.failures > 0 ? "  FAILED" : "");
+    }
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#ifndef BENCH_MEDIA_H
+#define BENCH_MEDIA_H
+
+#include <string>
+#include "Errors.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+};
+
+/**
+ * 合成媒体的参数
+ */
+typedef struct BenchMediaSpec {
+    /// 封装格式，mpegts、flv或mp4
+    const char *format;
+    int width;
+    int height;
+    int fps;
+    /// 时长，秒
+    int duration;
+    /// 关键帧间隔，帧数
+    int gop;
+    /// 视频码率，bps
+    int64_t bitRate;
+} BenchMediaSpec;
+
+/**
+ * 生成基准测试用的合成视频，不依赖外部的测试文件
+ * 使用FFmpeg内置的编码器：TS和HLS使用MPEG-2，FLV使用FLV1，MP4使用MPEG-4
+ * 画面是移动的渐变和方块，每一帧都不同，解码和显示的耗时接近真实视频
+ */
+class BenchMedia {
+
+public:
+
+    // 生成视频文件，文件已经存在时直接返回
+    static int generate(const std::string &path, const BenchMediaSpec &spec);
+
+    /**
+     * 生成多码率HLS，dir下为master.m3u8、每个码率的variant_<n>.m3u8和分片，master.m3u8已经存在时直接返回
+     * @param variants 每个码率的参数，format忽略
+     * @param segmentDuration 分片时长，秒
+     */
+    static int generateHls(const std::string &dir, const BenchMediaSpec *variants, int count,
+                           int segmentDuration);
+
+private:
+
+    static int encode(const char *path, const char *format, const BenchMediaSpec &spec,
+                      AVDictionary **muxerOpts);
+
+    static void fillFrame(AVFrame *frame, int index);
+};
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef BENCH_PLAYER_H
+#define BENCH_PLAYER_H
+
+#include <atomic>
+#include <map>
+#include <vector>
+#include <MediaPlayer.h>
+#include <MediaSync.h>
+#include <VideoDevice.h>
+#include <IMessageListener.h>
+#include "BenchUtils.h"
+
+/// 刷新方式，按显示时钟等待到下一帧，现在的实现
+#define BENCH_REFRESH_DISPLAY_CLOCK                 0
+
+/// 刷新方式，每REFRESH_RATE轮询一次，显示时钟之前的实现，作为对比
+#define BENCH_REFRESH_POLLING                       1
+
+/// 模拟的显示刷新率，Hz
+#define BENCH_REFRESH_RATE                          60.0
+
+/**
+ * 不显示的视频输出设备
+ * 显示画面时阻塞到模拟的vsync，和SDL的PRESENTVSYNC一样上报给显示时钟，并记录每一帧的显示时间
+ */
+class BenchVideoDevice : public VideoDevice {
+
+public:
+
+    // refreshRate为0时不模拟vsync
+    explicit BenchVideoDevice(double refreshRate);
+
+    ~BenchVideoDevice() override;
+
+    int onRequestRenderEnd(Frame *frame, bool flip) override;
+
+    // 清空显示记录
+    void reset();
+
+    int getPresentCount();
+
+    // 第一帧的显示时间，微秒，还没有显示时为0
+    int64_t getFirstPresentTime();
+
+    // 最近一帧的pts，秒
+    double getLastPts();
+
+    // 等待显示的帧数达到count，超时返回false
+    bool waitPresents(int count, int timeoutMs);
+
+    // 从from开始(微秒)的相邻两帧的显示间隔，毫秒
+    void getIntervals(int64_t from, BenchStats *intervals);
+
+private:
+
+    double refreshRate;
+
+    int64_t vsyncOrigin;
+
+    std::vector<int64_t> presentTimes;
+
+    double lastPts = NAN;
+};
+
+/**
+ * 独立的同步线程，和AndroidMediaSync一样循环刷新画面
+ * 统计刷新线程的循环次数和CPU时间
+ */
+class BenchMediaSync : public MediaSync {
+
+public:
+
+    explicit BenchMediaSync(int refreshMode);
+
+    ~BenchMediaSync() override;
+
+    void start(VideoDecoder *videoDecoder, AudioDecoder *audioDecoder) override;
+
+    void stop() override;
+
+    void run() override;
+
+    // 刷新线程累计的CPU时间，微秒
+    int64_t getThreadCpuTime();
+
+    // 刷新线程累计的循环次数
+    int getLoopCount();
+
+private:
+
+    int refreshMode;
+
+    ThreadTask *syncThread = nullptr;
+
+    std::atomic<bool> quit;
+
+    std::atomic<int64_t> threadCpuTime;
+
+    std::atomic<int> loopCount;
+};
+
+/**
+ * 不显示、不播放声音的播放器，记录收到的消息，用于基准测试
+ * 没有音频设备，不打开音频解码器，主时钟为外部时钟
+ */
+class BenchPlayer : public IMessageListener {
+
+    const char *const TAG = "[MP][BENCH][Player]";
+
+    typedef struct MsgRecord {
+        int count;
+        int64_t time;
+        int arg1;
+        int arg2;
+    } MsgRecord;
+
+public:
+
+    explicit BenchPlayer(int refreshMode = BENCH_REFRESH_DISPLAY_CLOCK,
+                         double refreshRate = BENCH_REFRESH_RATE);
+
+    virtual ~BenchPlayer();
+
+    int create();
+
+    // 设置播放器参数，在create之后、open之前调用，停止之后参数恢复默认值
+    void setOption(int category, const char *type, int64_t option);
+
+    void setOption(int category, const char *type, const char *option);
+
+    // 设置媒体并开始播放
+    int open(const char *url);
+
+    // 停止并等待停止完成
+    int stop(int timeoutMs);
+
+    void destroy();
+
+    // 等待消息的次数达到count，超时返回false
+    bool waitMsg(int what, int count, int timeoutMs);
+
+    int getMsgCount(int what);
+
+    // 最近一次收到消息的时间，微秒
+    int64_t getMsgTime(int what);
+
+    int getMsgArg1(int what);
+
+    int getMsgArg2(int what);
+
+    void onMessage(Msg *msg) override;
+
+    MediaPlayer *getPlayer();
+
+    BenchVideoDevice *getVideoDevice();
+
+    BenchMediaSync *getMediaSync();
+
+private:
+
+    MediaPlayer *mediaPlayer = nullptr;
+
+    BenchVideoDevice *videoDevice = nullptr;
+
+    BenchMediaSync *mediaSync = nullptr;
+
+    bool created = false;
+
+    Mutex mutex;
+
+    Condition condition;
+
+    std::map<int, MsgRecord> records;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef BENCH_SERVER_H
+#define BENCH_SERVER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <Thread.h>
+#include <Mutex.h>
+
+/// 发送数据的分块大小
+#define BENCH_SERVER_CHUNK_SIZE                     (16 * 1024)
+
+/// 限速时允许的突发时长，微秒
+#define BENCH_SERVER_BURST_TIME                     100000
+
+/// 直播路径的前缀
+#define BENCH_SERVER_LIVE_PREFIX                    "/live"
+
+/// 直播连接建立时立即发送的时长，微秒
+#define BENCH_SERVER_LIVE_BURST                     1000000
+
+/**
+ * 本地HTTP服务器，为基准测试模拟网络
+ * 只支持GET，支持Range和keep-alive；可以设置每个请求的响应延迟和所有连接共享的带宽
+ * /live/下的文件按码率实时发送，没有Content-Length，模拟直播流
+ */
+class BenchServer : public Runnable {
+
+    const char *const TAG = "[MP][BENCH][Server]";
+
+public:
+
+    // root为提供文件的目录
+    explicit BenchServer(const std::string &root);
+
+    ~BenchServer() override;
+
+    // 监听127.0.0.1的随机端口
+    int start();
+
+    void stop();
+
+    // 文件的地址，name相对于root
+    std::string getUrl(const std::string &name);
+
+    // 所有连接共享的带宽，bps，0为不限速
+    void setRate(int64_t bitRate);
+
+    // 每个请求的响应延迟，模拟网络往返时间，毫秒
+    void setLatency(int latencyMs);
+
+    // 直播的码率，bps
+    void setLiveBitRate(int64_t bitRate);
+
+    // 直播中断发送，中断期间的数据在恢复之后一次发出，模拟网络卡顿
+    void stallLive(int durationMs);
+
+    // 直播已经产生的媒体时长，秒，包括还没有发出的部分
+    double getLiveEdge();
+
+    int getRequestCount();
+
+    int64_t getBytesSent();
+
+    void run() override;
+
+private:
+
+    /**
+     * 一个客户端连接
+     */
+    class Connection : public Runnable {
+
+    public:
+
+        Connection(BenchServer *server, int fd);
+
+        void run() override;
+
+        BenchServer *server;
+
+        int fd;
+
+        Thread *thread = nullptr;
+
+        std::atomic<bool> finished;
+    };
+
+    void handle(int fd);
+
+    int sendFile(int fd, const std::string &path, int64_t start, int64_t end);
+
+    int sendLive(int fd, const std::string &path, int64_t fileSize);
+
+    int sendAll(int fd, const char *data, size_t size);
+
+    // 预留发送size字节的带宽，返回可以发送的时间，微秒
+    int64_t reserve(size_t size);
+
+    // 回收已经结束的连接
+    void reapConnections(bool all);
+
+private:
+
+    std::string root;
+
+    int listenFd = -1;
+
+    int port = 0;
+
+    Thread *acceptThread = nullptr;
+
+    std::atomic<bool> quit;
+
+    Mutex mutex;
+
+    std::vector<Connection *> connections;
+
+    int64_t bitRate = 0;
+
+    int64_t nextSendTime = 0;
+
+    std::atomic<int> latencyMs;
+
+    std::atomic<int64_t> liveBitRate;
+
+    /// 直播开始的时间，微秒
+    std::atomic<int64_t> liveStartTime;
+
+    std::atomic<int64_t> liveSize;
+
+    /// 直播恢复发送的时间，微秒
+    std::atomic<int64_t> liveStallEnd;
+
+    std::atomic<int> requestCount;
+
+    std::atomic<int64_t> bytesSent;
+};
+
+#endif
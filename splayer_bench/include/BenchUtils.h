@@ -0,0 +1,101 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// 媒体目录的默认值，第一个命令行参数可以指定其他目录
+#define BENCH_MEDIA_DIR                             "bench_media"
+
+/**
+ * 基准测试的公共工具，只依赖POSIX，渲染的基准测试不链接FFmpeg也可以使用
+ */
+class BenchUtils {
+
+public:
+
+    // 单调时钟，微秒
+    static int64_t now();
+
+    // 进程的CPU时间，包括用户态和内核态，微秒
+    static int64_t processCpuTime();
+
+    // 当前线程的CPU时间，微秒
+    static int64_t threadCpuTime();
+
+    // 进程所有线程累计的主动让出CPU次数，即阻塞等待之后被唤醒的次数
+    static int64_t processWakeups();
+
+    // 进程常驻内存，KB，不支持时为-1
+    static int64_t processRss();
+
+    // 进程线程数量，不支持时为-1
+    static int processThreads();
+
+    static void sleepUs(int64_t us);
+
+    // 睡眠到指定的单调时钟时间，微秒
+    static void sleepUntil(int64_t time);
+
+    // 媒体目录，不存在时创建
+    static std::string mediaDir(int argc, char **argv);
+
+    static bool exists(const std::string &path);
+
+private:
+    BenchUtils() = default;
+};
+
+/**
+ * 一组采样值的统计
+ */
+class BenchStats {
+
+public:
+
+    void add(double value);
+
+    void clear();
+
+    int count() const;
+
+    double mean() const;
+
+    double max() const;
+
+    // 百分位数，p为0~100
+    double percentile(double p) const;
+
+    // 大于threshold的采样数量
+    int countAbove(double threshold) const;
+
+    // 大于threshold的采样之和
+    double sumAbove(double threshold) const;
+
+private:
+    std::vector<double> values;
+};
+
+/**
+ * CPU占用的测量窗口，按墙上时间计算进程的CPU占用，100%表示占满一个核
+ */
+class CpuWindow {
+
+public:
+
+    void begin();
+
+    // 结束测量，返回进程CPU占用，百分比
+    double end();
+
+    // 窗口时长，秒
+    double getElapsed() const;
+
+private:
+    int64_t startTime = 0;
+    int64_t startCpu = 0;
+    double elapsed = 0;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef BENCH_LEGACY_PACKET_QUEUE_H
+#define BENCH_LEGACY_PACKET_QUEUE_H
+
+#include <Mutex.h>
+#include <Condition.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+};
+
+typedef struct LegacyPacketData {
+    AVPacket pkt;
+    struct LegacyPacketData *next;
+    int serial;
+} LegacyPacketData;
+
+/**
+ * 之前的数据包队列，作为对比
+ * 每个节点用av_malloc分配、出队时释放，入队、出队和所有查询都加锁
+ */
+class LegacyPacketQueue {
+
+public:
+    explicit LegacyPacketQueue(AVPacket *flushPacket);
+
+    virtual ~LegacyPacketQueue();
+
+    int pushPacket(AVPacket *pkt);
+
+    void flush();
+
+    void abort();
+
+    void start();
+
+    int getPacket(AVPacket *pkt);
+
+    int getPacket(AVPacket *pkt, int block);
+
+    int getPacketSize();
+
+    int getSize();
+
+    int64_t getDuration();
+
+    bool isAbort();
+
+    int getLastSeekSerial();
+
+    int getFirstSeekSerial();
+
+private:
+    int put(AVPacket *pkt);
+
+private:
+
+    Mutex mutex;
+
+    Condition condition;
+
+    LegacyPacketData *firstPacket = nullptr;
+
+    LegacyPacketData *lastPacket = nullptr;
+
+    int packetSize = 0;
+
+    int memorySize = 0;
+
+    int64_t duration = 0;
+
+    bool abortRequest = false;
+
+    int lastSeekSerial = 0;
+
+    int firstSeekSerial = -1;
+
+    AVPacket *flushPacket;
+};
+
+#endif
@@ -0,0 +1,221 @@
+/**
+ * OpenGLES纹理上传：1080p和4K的YUV420P，每一帧上传并绘制到离屏表面
+ * 对比GLInputYUV420PFilter只在尺寸变化时分配纹理存储、之后用glTexSubImage2D更新，
+ * 和之前每一帧对三个平面调用glTexImage2D重新分配
+ * OpenGLES 3.0时再对比经过像素缓冲对象上传和直接从内存上传，决定默认是否使用像素缓冲对象
+ * 使用EGL的pbuffer表面，不需要窗口，Linux上可以使用Mesa的软件实现
+ * 用法：bench_gl_upload
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLInputYUV420PFilter.h>
+#include "BenchUtils.h"
+
+/// 每种方式的帧数
+#define GL_UPLOAD_FRAMES                            120
+
+/// 预热的帧数，不计入统计
+#define GL_UPLOAD_WARMUP_FRAMES                     5
+
+/// 交替上传的画面数量，避免每次上传同一块内存
+#define GL_UPLOAD_PICTURES                          2
+
+/// 离屏表面的大小
+#define GL_SURFACE_WIDTH                            1280
+
+#define GL_SURFACE_HEIGHT                           720
+
+/// 上传方式
+#define GL_UPLOAD_PIXEL_BUFFER                      0
+
+#define GL_UPLOAD_SUBIMAGE                          1
+
+#define GL_UPLOAD_TEXIMAGE                          2
+
+/**
+ * 之前的上传方式，每一帧对每个平面调用glTexImage2D，驱动每次重新分配纹理存储
+ */
+class LegacyYUV420PFilter : public GLInputYUV420PFilter {
+
+public:
+
+    GLboolean uploadTexture(Texture *texture) override {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glUseProgram((GLuint) programHandle);
+        const GLsizei heights[3] = {texture->height, texture->height / 2, texture->height / 2};
+        for (int i = 0; i < 3; ++i) {
+            glActiveTexture((GLenum) GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, texture->pitches[i], heights[i], 0,
+                         GL_LUMINANCE, GL_UNSIGNED_BYTE, texture->pixels[i]);
+            glUniform1i(inputTextureHandle[i], i);
+        }
+        return GL_TRUE;
+    }
+};
+
+typedef struct Picture {
+    std::vector<uint8_t> planes[3];
+    Texture texture;
+} Picture;
+
+typedef struct UploadResult {
+    /// 上传耗时，毫秒，只包括提交命令的时间
+    BenchStats upload;
+    /// 上传、绘制并等待GPU完成，毫秒
+    BenchStats frame;
+} UploadResult;
+
+static void fillPicture(Picture *picture, int width, int height, int index) {
+    Texture &texture = picture->texture;
+    texture = Texture();
+    texture.width = width;
+    texture.height = height;
+    texture.frameWidth = width;
+    texture.frameHeight = height;
+    texture.format = FMT_YUV420P;
+    texture.blendMode = BLEND_NONE;
+    texture.direction = FLIP_NONE;
+    int heights[3] = {height, (height + 1) / 2, (height + 1) / 2};
+    for (int i = 0; i < 3; ++i) {
+        texture.pitches[i] = (uint16_t) (i == 0 ? width : (width + 1) / 2);
+        picture->planes[i].resize((size_t) texture.pitches[i] * heights[i]);
+        for (size_t j = 0; j < picture->planes[i].size(); ++j) {
+            picture->planes[i][j] = (uint8_t) (j * (i + 1) + index * 17);
+        }
+        texture.pixels[i] = picture->planes[i].data();
+    }
+}
+
+static void runUpload(GLInputYUV420PFilter *filter, Picture *pictures, UploadResult *result) {
+    float vertices[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    float textureVertices[] = {0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+    filter->initProgram();
+    filter->setDisplaySize(GL_SURFACE_WIDTH, GL_SURFACE_HEIGHT);
+    glViewport(0, 0, GL_SURFACE_WIDTH, GL_SURFACE_HEIGHT);
+    for (int i = 0; i < GL_UPLOAD_WARMUP_FRAMES + GL_UPLOAD_FRAMES; ++i) {
+        Texture *texture = &pictures[i % GL_UPLOAD_PICTURES].texture;
+        filter->setTextureSize(texture->width, texture->height);
+        int64_t startTime = BenchUtils::now();
+        filter->uploadTexture(texture);
+        int64_t uploadTime = BenchUtils::now();
+        filter->renderTexture(texture, vertices, textureVertices);
+        glFinish();
+        int64_t endTime = BenchUtils::now();
+        if (i >= GL_UPLOAD_WARMUP_FRAMES) {
+            result->upload.add((uploadTime - startTime) / 1000.0);
+            result->frame.add((endTime - startTime) / 1000.0);
+        }
+    }
+    filter->destroyProgram();
+}
+
+/**
+ * 优先使用Mesa的surfaceless平台，没有显示服务器时也可以创建显示
+ */
+static EGLDisplay openDisplay() {
+    EGLDisplay display = EGL_NO_DISPLAY;
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+            eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+#endif
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display != EGL_NO_DISPLAY && !eglInitialize(display, nullptr, nullptr)) {
+        display = EGL_NO_DISPLAY;
+    }
+    return display;
+}
+
+int main(int argc, char **argv) {
+    EGLDisplay display = openDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        fprintf(stderr, "egl display not available\n");
+        return EXIT_FAILURE;
+    }
+    // 优先创建OpenGLES 3.0的上下文，才能测量像素缓冲对象
+    EGLint configAttribs[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_NONE
+    };
+    const EGLint surfaceAttribs[] = {
+            EGL_WIDTH, GL_SURFACE_WIDTH,
+            EGL_HEIGHT, GL_SURFACE_HEIGHT,
+            EGL_NONE
+    };
+    EGLint contextAttribs[] = {
+            EGL_CONTEXT_CLIENT_VERSION, 3,
+            EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    EGLSurface surface = EGL_NO_SURFACE;
+    EGLContext context = EGL_NO_CONTEXT;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount < 1) {
+        configAttribs[3] = EGL_OPENGL_ES2_BIT;
+        contextAttribs[1] = 2;
+    }
+    if (!eglBindAPI(EGL_OPENGL_ES_API) ||
+        !eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount < 1 ||
+        (surface = eglCreatePbufferSurface(display, config, surfaceAttribs)) == EGL_NO_SURFACE ||
+        (context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs)) ==
+        EGL_NO_CONTEXT ||
+        !eglMakeCurrent(display, surface, surface, context)) {
+        fprintf(stderr, "create egl context failure: 0x%x\n", eglGetError());
+        eglTerminate(display);
+        return EXIT_FAILURE;
+    }
+
+    printf("renderer: %s, %s, %d frames each\n", (const char *) glGetString(GL_RENDERER),
+           (const char *) glGetString(GL_VERSION), GL_UPLOAD_FRAMES);
+    printf("%-6s %-12s %11s %11s %10s %10s\n", "size", "upload", "upload ms", "upload p95",
+           "frame ms", "frame p95");
+
+    int sizes[][2] = {{1920, 1080}, {3840, 2160}};
+    const char *names[] = {"1080p", "4K"};
+    const char *modeNames[] = {"pbo", "subimage", "teximage"};
+    int failures = 0;
+    for (int i = 0; i < 2; ++i) {
+        Picture pictures[GL_UPLOAD_PICTURES];
+        for (int j = 0; j < GL_UPLOAD_PICTURES; ++j) {
+            fillPicture(&pictures[j], sizes[i][0], sizes[i][1], j);
+        }
+        for (int mode = GL_UPLOAD_PIXEL_BUFFER; mode <= GL_UPLOAD_TEXIMAGE; ++mode) {
+            if (mode == GL_UPLOAD_PIXEL_BUFFER && !OpenGLUtils::isGLES3()) {
+                continue;
+            }
+            UploadResult result;
+            GLInputYUV420PFilter *filter = mode == GL_UPLOAD_TEXIMAGE
+                                           ? new LegacyYUV420PFilter()
+                                           : new GLInputYUV420PFilter();
+            filter->setPixelBufferEnabled(mode == GL_UPLOAD_PIXEL_BUFFER);
+            runUpload(filter, pictures, &result);
+            delete filter;
+            GLenum error = glGetError();
+            if (error != GL_NO_ERROR) {
+                failures++;
+            }
+            printf("%-6s %-12s %11.2f %11.2f %10.2f %10.2f%s\n", names[i],
+                   modeNames[mode], result.upload.mean(),
+                   result.upload.percentile(95), result.frame.mean(), result.frame.percentile(95),
+                   error != GL_NO_ERROR ? "  FAILED" : "");
+        }
+    }
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglDestroySurface(display, surface);
+    eglTerminate(display);
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+/**
+ * SDL纹理上传：1080p和4K的YUV420P，每一帧初始化纹理并上传
+ * 对比SDLVideoDevice保留流式纹理、锁定之后直接写入，
+ * 和之前每一帧重新创建纹理再用SDL_UpdateYUVTexture上传
+ * 没有显示环境时使用SDL的dummy驱动和软件渲染器
+ * 用法：bench_sdl_upload [媒体目录]
+ */
+#include <cstdlib>
+#include <vector>
+#include <SDLVideoDevice.h>
+#include "BenchUtils.h"
+
+/// 每种方式上传的帧数
+#define SDL_UPLOAD_FRAMES                           120
+
+/// 交替上传的画面数量，避免每次上传同一块内存
+#define SDL_UPLOAD_PICTURES                         2
+
+typedef struct Picture {
+    std::vector<uint8_t> planes[3];
+    int pitches[3];
+} Picture;
+
+typedef struct UploadResult {
+    /// 初始化纹理和上传，毫秒
+    BenchStats upload;
+    /// 上传加上绘制到渲染目标，毫秒
+    BenchStats frame;
+    int failures = 0;
+} UploadResult;
+
+static void fillPicture(Picture *picture, int width, int height, int index) {
+    int widths[3] = {width, (width + 1) / 2, (width + 1) / 2};
+    int heights[3] = {height, (height + 1) / 2, (height + 1) / 2};
+    for (int i = 0; i < 3; ++i) {
+        picture->pitches[i] = (widths[i] + 63) & ~63;
+        picture->planes[i].resize((size_t) picture->pitches[i] * heights[i]);
+        for (size_t j = 0; j < picture->planes[i].size(); ++j) {
+            picture->planes[i][j] = (uint8_t) (j * (i + 1) + index * 17);
+        }
+    }
+}
+
+/**
+ * 现在的实现：纹理不变时onInitTexture直接返回，onUpdateYUV锁定纹理直接写入
+ */
+static void runPersistent(SDLVideoDevice *device, Picture *pictures, int width, int height,
+                          UploadResult *result) {
+    for (int i = 0; i < SDL_UPLOAD_FRAMES; ++i) {
+        Picture &picture = pictures[i % SDL_UPLOAD_PICTURES];
+        int64_t startTime = BenchUtils::now();
+        if (device->onInitTexture(0, width, height, FMT_YUV420P, BLEND_NONE, 0) < 0 ||
+            device->onUpdateYUV(picture.planes[0].data(), picture.pitches[0],
+                                picture.planes[1].data(), picture.pitches[1],
+                                picture.planes[2].data(), picture.pitches[2]) < 0) {
+            result->failures++;
+            return;
+        }
+        int64_t uploadTime = BenchUtils::now();
+        SDL_RenderCopy(device->renderer, device->videoTexture, nullptr, nullptr);
+        SDL_RenderFlush(device->renderer);
+        int64_t endTime = BenchUtils::now();
+        result->upload.add((uploadTime - startTime) / 1000.0);
+        result->frame.add((endTime - startTime) / 1000.0);
+    }
+}
+
+/**
+ * 之前的实现：每一帧销毁并重新创建纹理，再用SDL_UpdateYUVTexture复制
+ */
+static void runRecreate(SDLVideoDevice *device, Picture *pictures, int width, int height,
+                        UploadResult *result) {
+    device->destroyVideoTexture();
+    for (int i = 0; i < SDL_UPLOAD_FRAMES; ++i) {
+        Picture &picture = pictures[i % SDL_UPLOAD_PICTURES];
+        int64_t startTime = BenchUtils::now();
+        SDL_Texture *texture = SDL_CreateTexture(device->renderer, SDL_PIXELFORMAT_IYUV,
+                                                 SDL_TEXTUREACCESS_STREAMING, width, height);
+        if (!texture ||
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE) < 0 ||
+            SDL_UpdateYUVTexture(texture, nullptr,
+                                 picture.planes[0].data(), picture.pitches[0],
+                                 picture.planes[1].data(), picture.pitches[1],
+                                 picture.planes[2].data(), picture.pitches[2]) < 0) {
+            if (texture) {
+                SDL_DestroyTexture(texture);
+            }
+            result->failures++;
+            return;
+        }
+        int64_t uploadTime = BenchUtils::now();
+        SDL_RenderCopy(device->renderer, texture, nullptr, nullptr);
+        SDL_RenderFlush(device->renderer);
+        SDL_DestroyTexture(texture);
+        int64_t endTime = BenchUtils::now();
+        result->upload.add((uploadTime - startTime) / 1000.0);
+        result->frame.add((endTime - startTime) / 1000.0);
+    }
+}
+
+int main(int argc, char **argv) {
+    // 没有显示环境时使用dummy驱动，create同时初始化了音频，音频也使用dummy驱动
+    if (!getenv("DISPLAY") && !getenv("WAYLAND_DISPLAY")) {
+        setenv("SDL_VIDEODRIVER", "dummy", 0);
+        setenv("SDL_AUDIODRIVER", "dummy", 0);
+    }
+    SDLVideoDevice device;
+    device.surfaceWidth = 640;
+    device.surfaceHeight = 360;
+    if (device.create() < 0) {
+        fprintf(stderr, "create sdl video device failure: %s\n", SDL_GetError());
+        return EXIT_FAILURE;
+    }
+    printf("renderer: %s, %d frames each\n", device.rendererInfo.name, SDL_UPLOAD_FRAMES);
+    printf("%-6s %-10s %11s %11s %10s %10s\n", "size", "texture", "upload ms", "upload p95",
+           "frame ms", "frame p95");
+
+    int sizes[][2] = {{1920, 1080}, {3840, 2160}};
+    const char *names[] = {"1080p", "4K"};
+    int failures = 0;
+    for (int i = 0; i < 2; ++i) {
+        int width = sizes[i][0];
+        int height = sizes[i][1];
+        Picture pictures[SDL_UPLOAD_PICTURES];
+        for (int j = 0; j < SDL_UPLOAD_PICTURES; ++j) {
+            fillPicture(&pictures[j], width, height, j);
+        }
+        for (int persistent = 1; persistent >= 0; --persistent) {
+            UploadResult result;
+            if (persistent) {
+                runPersistent(&device, pictures, width, height, &result);
+            } else {
+                runRecreate(&device, pictures, width, height, &result);
+            }
+            failures += result.failures;
+            printf("%-6s %-10s %11.2f %11.2f %10.2f %10.2f%s\n", names[i],
+                   persistent ? "persistent" : "recreate", result.upload.mean(),
+                   result.upload.percentile(95), result.frame.mean(), result.frame.percentile(95),
+                   result.failures > 0 ? "  FAILED" : "");
+        }
+    }
+    device.destroy();
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
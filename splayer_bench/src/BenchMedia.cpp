@@ -0,0 +1,204 @@
+#include "BenchMedia.h"
+#include "BenchUtils.h"
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/opt.h>
+};
+
+static const char *const TAG = "[MP][BENCH][Media]";
+
+int BenchMedia::generate(const std::string &path, const BenchMediaSpec &spec) {
+    if (BenchUtils::exists(path)) {
+        return SUCCESS;
+    }
+    // 先写临时文件，中断时不会留下不完整的媒体
+    std::string temp = path + ".tmp";
+    int ret = encode(temp.c_str(), spec.format, spec, nullptr);
+    if (ret < 0) {
+        remove(temp.c_str());
+        return ret;
+    }
+    if (rename(temp.c_str(), path.c_str()) != 0) {
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+int BenchMedia::generateHls(const std::string &dir, const BenchMediaSpec *variants, int count,
+                            int segmentDuration) {
+    std::string master = dir + "/master.m3u8";
+    if (BenchUtils::exists(master)) {
+        return SUCCESS;
+    }
+    for (int i = 0; i < count; ++i) {
+        char playlist[512];
+        char segments[512];
+        snprintf(playlist, sizeof(playlist), "%s/variant_%d.m3u8", dir.c_str(), i);
+        snprintf(segments, sizeof(segments), "%s/variant_%d_%%03d.ts", dir.c_str(), i);
+        AVDictionary *opts = nullptr;
+        av_dict_set_int(&opts, "hls_time", segmentDuration, 0);
+        av_dict_set_int(&opts, "hls_list_size", 0, 0);
+        av_dict_set(&opts, "hls_playlist_type", "vod", 0);
+        av_dict_set(&opts, "hls_segment_filename", segments, 0);
+        int ret = encode(playlist, "hls", variants[i], &opts);
+        av_dict_free(&opts);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    // 主播放列表最后写入，存在时说明所有码率都已经生成
+    std::string temp = master + ".tmp";
+    FILE *file = fopen(temp.c_str(), "w");
+    if (!file) {
+        return ERROR;
+    }
+    fprintf(file, "#EXTM3U\n");
+    for (int i = 0; i < count; ++i) {
+        // 码率加上TS封装的开销
+        fprintf(file, "#EXT-X-STREAM-INF:BANDWIDTH=%lld,RESOLUTION=%dx%d\nvariant_%d.m3u8\n",
+                (long long) (variants[i].bitRate * 11 / 10), variants[i].width,
+                variants[i].height, i);
+    }
+    fclose(file);
+    if (rename(temp.c_str(), master.c_str()) != 0) {
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/**
+ * 编码并封装，固定码率，没有B帧，关键帧间隔由spec指定
+ */
+int BenchMedia::encode(const char *path, const char *format, const BenchMediaSpec &spec,
+                       AVDictionary **muxerOpts) {
+    AVFormatContext *formatContext = nullptr;
+    AVCodecContext *codecContext = nullptr;
+    AVFrame *frame = nullptr;
+    AVPacket *packet = nullptr;
+    AVStream *stream;
+    const AVCodec *codec;
+    AVCodecID codecId = AV_CODEC_ID_MPEG2VIDEO;
+    int frames = spec.fps * spec.duration;
+    int ret = ERROR;
+
+    if (!strcmp(format, "flv")) {
+        codecId = AV_CODEC_ID_FLV1;
+    } else if (!strcmp(format, "mp4")) {
+        codecId = AV_CODEC_ID_MPEG4;
+    }
+
+    if (avformat_alloc_output_context2(&formatContext, nullptr, format, path) < 0) {
+        fprintf(stderr, "%s: unsupported format %s\n", TAG, format);
+        return ERROR;
+    }
+    codec = avcodec_find_encoder(codecId);
+    if (!codec) {
+        fprintf(stderr, "%s: encoder %s not found\n", TAG, avcodec_get_name(codecId));
+        goto end;
+    }
+    stream = avformat_new_stream(formatContext, nullptr);
+    codecContext = avcodec_alloc_context3(codec);
+    if (!stream || !codecContext) {
+        goto end;
+    }
+    codecContext->width = spec.width;
+    codecContext->height = spec.height;
+    codecContext->time_base = av_make_q(1, spec.fps);
+    codecContext->framerate = av_make_q(spec.fps, 1);
+    codecContext->gop_size = spec.gop;
+    codecContext->max_b_frames = 0;
+    codecContext->pix_fmt = AV_PIX_FMT_YUV420P;
+    codecContext->bit_rate = spec.bitRate;
+    codecContext->rc_max_rate = spec.bitRate;
+    codecContext->rc_min_rate = spec.bitRate;
+    codecContext->rc_buffer_size = (int) spec.bitRate;
+    if (formatContext->oformat->flags & AVFMT_GLOBALHEADER) {
+        codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    if (avcodec_open2(codecContext, codec, nullptr) < 0) {
+        fprintf(stderr, "%s: open encoder failure\n", TAG);
+        goto end;
+    }
+    avcodec_parameters_from_context(stream->codecpar, codecContext);
+    stream->time_base = codecContext->time_base;
+
+    if (!(formatContext->oformat->flags & AVFMT_NOFILE) &&
+        avio_open(&formatContext->pb, path, AVIO_FLAG_WRITE) < 0) {
+        fprintf(stderr, "%s: open %s failure\n", TAG, path);
+        goto end;
+    }
+    if (avformat_write_header(formatContext, muxerOpts) < 0) {
+        goto end;
+    }
+
+    frame = av_frame_alloc();
+    packet = av_packet_alloc();
+    if (!frame || !packet) {
+        goto end;
+    }
+    frame->format = codecContext->pix_fmt;
+    frame->width = codecContext->width;
+    frame->height = codecContext->height;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        goto end;
+    }
+
+    // 最后一次循环送入空帧，取出编码器中剩余的数据包
+    for (int i = 0; i <= frames; ++i) {
+        if (i < frames) {
+            av_frame_make_writable(frame);
+            fillFrame(frame, i);
+            frame->pts = i;
+        }
+        if (avcodec_send_frame(codecContext, i < frames ? frame : nullptr) < 0) {
+            goto end;
+        }
+        while (avcodec_receive_packet(codecContext, packet) == 0) {
+            av_packet_rescale_ts(packet, codecContext->time_base, stream->time_base);
+            packet->stream_index = stream->index;
+            if (av_interleaved_write_frame(formatContext, packet) < 0) {
+                goto end;
+            }
+        }
+    }
+    if (av_write_trailer(formatContext) == 0) {
+        ret = SUCCESS;
+    }
+
+    end:
+    av_packet_free(&packet);
+    av_frame_free(&frame);
+    avcodec_free_context(&codecContext);
+    if (!(formatContext->oformat->flags & AVFMT_NOFILE)) {
+        avio_closep(&formatContext->pb);
+    }
+    avformat_free_context(formatContext);
+    return ret;
+}
+
+/**
+ * 斜向移动的亮度渐变，加上一个水平移动的方块，色度随时间变化
+ */
+void BenchMedia::fillFrame(AVFrame *frame, int index) {
+    int width = frame->width;
+    int height = frame->height;
+    int size = FFMAX(height / 6, 8);
+    int left = (index * 8) % FFMAX(width - size, 1);
+    int top = (height - size) / 2;
+    for (int y = 0; y < height; ++y) {
+        uint8_t *line = frame->data[0] + y * frame->linesize[0];
+        for (int x = 0; x < width; ++x) {
+            line[x] = (uint8_t) (x + y + index * 3);
+        }
+        if (y >= top && y < top + size) {
+            memset(line + left, 235, (size_t) size);
+        }
+    }
+    for (int y = 0; y < height / 2; ++y) {
+        memset(frame->data[1] + y * frame->linesize[1], 128 + (index % 64), (size_t) width / 2);
+        memset(frame->data[2] + y * frame->linesize[2], 128 - (index % 64), (size_t) width / 2);
+    }
+}
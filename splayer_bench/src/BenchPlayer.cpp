@@ -0,0 +1,254 @@
+#include "BenchPlayer.h"
+
+BenchVideoDevice::BenchVideoDevice(double refreshRate) : refreshRate(refreshRate) {
+    vsyncOrigin = av_gettime_relative();
+}
+
+BenchVideoDevice::~BenchVideoDevice() = default;
+
+/**
+ * 阻塞到下一个模拟的vsync再返回，返回的时间作为vsync上报给显示时钟
+ */
+int BenchVideoDevice::onRequestRenderEnd(Frame *frame, bool flip) {
+    int64_t now = av_gettime_relative();
+    if (refreshRate > 0) {
+        auto period = (int64_t) (1000000 / refreshRate);
+        int64_t vsync = vsyncOrigin + ((now - vsyncOrigin) / period + 1) * period;
+        BenchUtils::sleepUs(vsync - now);
+        now = av_gettime_relative();
+    }
+    if (displayClock) {
+        displayClock->setRefreshRate(refreshRate);
+        displayClock->onPresent(now / 1000000.0, refreshRate > 0);
+    }
+    mutex.lock();
+    presentTimes.push_back(now);
+    if (frame) {
+        lastPts = frame->pts;
+    }
+    condition.signal();
+    mutex.unlock();
+    return SUCCESS;
+}
+
+void BenchVideoDevice::reset() {
+    mutex.lock();
+    presentTimes.clear();
+    lastPts = NAN;
+    mutex.unlock();
+}
+
+int BenchVideoDevice::getPresentCount() {
+    Mutex::Autolock lock(mutex);
+    return (int) presentTimes.size();
+}
+
+int64_t BenchVideoDevice::getFirstPresentTime() {
+    Mutex::Autolock lock(mutex);
+    return presentTimes.empty() ? 0 : presentTimes.front();
+}
+
+double BenchVideoDevice::getLastPts() {
+    Mutex::Autolock lock(mutex);
+    return lastPts;
+}
+
+bool BenchVideoDevice::waitPresents(int count, int timeoutMs) {
+    int64_t deadline = av_gettime_relative() + (int64_t) timeoutMs * 1000;
+    Mutex::Autolock lock(mutex);
+    while ((int) presentTimes.size() < count) {
+        int64_t remaining = deadline - av_gettime_relative();
+        if (remaining <= 0) {
+            return false;
+        }
+        condition.waitRelative(mutex, (nsecs_t) remaining * 1000);
+    }
+    return true;
+}
+
+void BenchVideoDevice::getIntervals(int64_t from, BenchStats *intervals) {
+    Mutex::Autolock lock(mutex);
+    for (size_t i = 1; i < presentTimes.size(); ++i) {
+        if (presentTimes[i - 1] >= from) {
+            intervals->add((presentTimes[i] - presentTimes[i - 1]) / 1000.0);
+        }
+    }
+}
+
+BenchMediaSync::BenchMediaSync(int refreshMode) : refreshMode(refreshMode) {
+    quit = true;
+    threadCpuTime = 0;
+    loopCount = 0;
+}
+
+BenchMediaSync::~BenchMediaSync() = default;
+
+void BenchMediaSync::start(VideoDecoder *videoDecoder, AudioDecoder *audioDecoder) {
+    MediaSync::start(videoDecoder, audioDecoder);
+    quit = false;
+    if (videoDecoder && !syncThread) {
+        syncThread = new ThreadTask(this);
+        syncThread->start();
+    }
+}
+
+void BenchMediaSync::stop() {
+    MediaSync::stop();
+    quit = true;
+    if (syncThread) {
+        syncThread->join();
+        delete syncThread;
+        syncThread = nullptr;
+    }
+}
+
+/**
+ * 显示时钟模式和AndroidMediaSync一样，轮询模式和显示时钟之前的实现一样，最多等待REFRESH_RATE
+ */
+void BenchMediaSync::run() {
+    int64_t startCpu = BenchUtils::threadCpuTime();
+    int64_t baseCpu = threadCpuTime;
+    resetRemainingTime();
+    while (!quit) {
+        int ret;
+        if (refreshMode == BENCH_REFRESH_POLLING) {
+            BenchUtils::sleepUs((int64_t) (FFMIN(getRemainingTime(), REFRESH_RATE) * 1000000));
+            ret = updateVideo();
+        } else {
+            ret = refreshVideo();
+        }
+        loopCount++;
+        threadCpuTime = baseCpu + BenchUtils::threadCpuTime() - startCpu;
+        if (ret < 0) {
+            break;
+        }
+    }
+}
+
+int64_t BenchMediaSync::getThreadCpuTime() {
+    return threadCpuTime;
+}
+
+int BenchMediaSync::getLoopCount() {
+    return loopCount;
+}
+
+BenchPlayer::BenchPlayer(int refreshMode, double refreshRate) {
+    mediaPlayer = new MediaPlayer();
+    videoDevice = new BenchVideoDevice(refreshRate);
+    mediaSync = new BenchMediaSync(refreshMode);
+    mediaPlayer->setMediaSync(mediaSync);
+    mediaPlayer->setVideoDevice(videoDevice);
+    mediaPlayer->setMessageListener(this);
+}
+
+BenchPlayer::~BenchPlayer() {
+    destroy();
+}
+
+int BenchPlayer::create() {
+    created = true;
+    return mediaPlayer->create();
+}
+
+void BenchPlayer::setOption(int category, const char *type, int64_t option) {
+    mediaPlayer->setOption(category, type, option);
+}
+
+void BenchPlayer::setOption(int category, const char *type, const char *option) {
+    mediaPlayer->setOption(category, type, option);
+}
+
+int BenchPlayer::open(const char *url) {
+    videoDevice->reset();
+    int ret = mediaPlayer->setDataSource(url);
+    if (ret < 0) {
+        return ret;
+    }
+    return mediaPlayer->start();
+}
+
+int BenchPlayer::stop(int timeoutMs) {
+    int count = getMsgCount(Msg::MSG_STATUS_STOPPED);
+    mediaPlayer->stop();
+    return waitMsg(Msg::MSG_STATUS_STOPPED, count + 1, timeoutMs) ? SUCCESS : ERROR;
+}
+
+/**
+ * 销毁之后播放器不再持有同步器和输出设备，由这里释放；没有创建过时由播放器的析构函数释放
+ */
+void BenchPlayer::destroy() {
+    if (!mediaPlayer) {
+        return;
+    }
+    if (created) {
+        mediaPlayer->destroy();
+    }
+    delete mediaPlayer;
+    mediaPlayer = nullptr;
+    if (created) {
+        delete mediaSync;
+        delete videoDevice;
+    }
+    mediaSync = nullptr;
+    videoDevice = nullptr;
+}
+
+bool BenchPlayer::waitMsg(int what, int count, int timeoutMs) {
+    int64_t deadline = BenchUtils::now() + (int64_t) timeoutMs * 1000;
+    Mutex::Autolock lock(mutex);
+    while (records[what].count < count) {
+        int64_t remaining = deadline - BenchUtils::now();
+        if (remaining <= 0) {
+            return false;
+        }
+        condition.waitRelative(mutex, (nsecs_t) remaining * 1000);
+    }
+    return true;
+}
+
+int BenchPlayer::getMsgCount(int what) {
+    Mutex::Autolock lock(mutex);
+    return records[what].count;
+}
+
+int64_t BenchPlayer::getMsgTime(int what) {
+    Mutex::Autolock lock(mutex);
+    return records[what].time;
+}
+
+int BenchPlayer::getMsgArg1(int what) {
+    Mutex::Autolock lock(mutex);
+    return records[what].arg1;
+}
+
+int BenchPlayer::getMsgArg2(int what) {
+    Mutex::Autolock lock(mutex);
+    return records[what].arg2;
+}
+
+void BenchPlayer::onMessage(Msg *msg) {
+    if (msg->what == Msg::MSG_ERROR) {
+        ALOGE(TAG, "[%s] error = %d", __func__, msg->arg1I);
+    }
+    mutex.lock();
+    MsgRecord &record = records[msg->what];
+    record.count++;
+    record.time = BenchUtils::now();
+    record.arg1 = msg->arg1I;
+    record.arg2 = msg->arg2I;
+    condition.signal();
+    mutex.unlock();
+}
+
+MediaPlayer *BenchPlayer::getPlayer() {
+    return mediaPlayer;
+}
+
+BenchVideoDevice *BenchPlayer::getVideoDevice() {
+    return videoDevice;
+}
+
+BenchMediaSync *BenchPlayer::getMediaSync() {
+    return mediaSync;
+}
@@ -0,0 +1,358 @@
+#include "BenchServer.h"
+#include "BenchUtils.h"
+#include "Errors.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+BenchServer::Connection::Connection(BenchServer *server, int fd) : server(server), fd(fd) {
+    finished = false;
+}
+
+void BenchServer::Connection::run() {
+    server->handle(fd);
+    finished = true;
+}
+
+BenchServer::BenchServer(const std::string &root) : root(root) {
+    quit = true;
+    latencyMs = 0;
+    liveBitRate = 0;
+    liveStartTime = 0;
+    liveSize = 0;
+    liveStallEnd = 0;
+    requestCount = 0;
+    bytesSent = 0;
+}
+
+BenchServer::~BenchServer() {
+    stop();
+}
+
+int BenchServer::start() {
+    // 客户端关闭连接时send返回错误，不终止进程
+    signal(SIGPIPE, SIG_IGN);
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        return ERROR;
+    }
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t length = sizeof(addr);
+    if (bind(listenFd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+        listen(listenFd, 16) < 0 ||
+        getsockname(listenFd, (struct sockaddr *) &addr, &length) < 0) {
+        close(listenFd);
+        listenFd = -1;
+        return ERROR;
+    }
+    port = ntohs(addr.sin_port);
+    quit = false;
+    acceptThread = new Thread(this);
+    acceptThread->start();
+    return SUCCESS;
+}
+
+void BenchServer::stop() {
+    if (!acceptThread) {
+        return;
+    }
+    quit = true;
+    // 关闭读写让accept和recv返回
+    shutdown(listenFd, SHUT_RDWR);
+    acceptThread->join();
+    delete acceptThread;
+    acceptThread = nullptr;
+    close(listenFd);
+    listenFd = -1;
+    mutex.lock();
+    for (Connection *connection : connections) {
+        shutdown(connection->fd, SHUT_RDWR);
+    }
+    mutex.unlock();
+    reapConnections(true);
+}
+
+std::string BenchServer::getUrl(const std::string &name) {
+    return "http://127.0.0.1:" + std::to_string(port) + "/" + name;
+}
+
+void BenchServer::setRate(int64_t bitRate) {
+    Mutex::Autolock lock(mutex);
+    this->bitRate = bitRate;
+    nextSendTime = 0;
+}
+
+void BenchServer::setLatency(int latencyMs) {
+    this->latencyMs = latencyMs;
+}
+
+void BenchServer::setLiveBitRate(int64_t bitRate) {
+    liveBitRate = bitRate;
+}
+
+void BenchServer::stallLive(int durationMs) {
+    liveStallEnd = BenchUtils::now() + (int64_t) durationMs * 1000;
+}
+
+double BenchServer::getLiveEdge() {
+    if (liveStartTime <= 0 || liveBitRate <= 0) {
+        return 0;
+    }
+    double edge = (BenchUtils::now() - liveStartTime + BENCH_SERVER_LIVE_BURST) / 1000000.0;
+    return std::min(edge, liveSize * 8.0 / liveBitRate);
+}
+
+int BenchServer::getRequestCount() {
+    return requestCount;
+}
+
+int64_t BenchServer::getBytesSent() {
+    return bytesSent;
+}
+
+void BenchServer::run() {
+    while (!quit) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        reapConnections(false);
+        auto *connection = new Connection(this, fd);
+        connection->thread = new Thread(connection);
+        mutex.lock();
+        connections.push_back(connection);
+        mutex.unlock();
+        connection->thread->start();
+    }
+}
+
+void BenchServer::reapConnections(bool all) {
+    std::vector<Connection *> finished;
+    mutex.lock();
+    for (auto it = connections.begin(); it != connections.end();) {
+        if (all || (*it)->finished) {
+            finished.push_back(*it);
+            it = connections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    mutex.unlock();
+    for (Connection *connection : finished) {
+        connection->thread->join();
+        delete connection->thread;
+        close(connection->fd);
+        delete connection;
+    }
+}
+
+/**
+ * 同一个连接上依次处理请求，客户端关闭或者请求Connection: close时结束
+ */
+void BenchServer::handle(int fd) {
+    std::string buffer;
+    char data[4096];
+    while (!quit) {
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t size = recv(fd, data, sizeof(data), 0);
+            if (size <= 0) {
+                return;
+            }
+            buffer.append(data, (size_t) size);
+        }
+        std::string header = buffer.substr(0, headerEnd);
+        buffer.erase(0, headerEnd + 4);
+        requestCount++;
+
+        char method[16] = {0};
+        char target[1024] = {0};
+        if (sscanf(header.c_str(), "%15s %1023s", method, target) != 2 ||
+            strcmp(method, "GET") != 0) {
+            return;
+        }
+        int64_t rangeStart = 0;
+        int64_t rangeEnd = -1;
+        bool hasRange = false;
+        const char *range = strcasestr(header.c_str(), "\r\nRange: bytes=");
+        if (range) {
+            long long first = 0, last = -1;
+            int count = sscanf(range + strlen("\r\nRange: bytes="), "%lld-%lld", &first, &last);
+            if (count >= 1) {
+                hasRange = true;
+                rangeStart = first;
+                rangeEnd = count == 2 ? last : -1;
+            }
+        }
+        bool keepAlive = !strcasestr(header.c_str(), "\r\nConnection: close");
+
+        if (latencyMs > 0) {
+            BenchUtils::sleepUs((int64_t) latencyMs * 1000);
+        }
+
+        bool live = !strncmp(target, BENCH_SERVER_LIVE_PREFIX "/",
+                             strlen(BENCH_SERVER_LIVE_PREFIX "/"));
+        std::string path = root + (live ? target + strlen(BENCH_SERVER_LIVE_PREFIX) : target);
+        struct stat st;
+        if (strstr(target, "..") || stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            const char *notFound = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+            if (sendAll(fd, notFound, strlen(notFound)) < 0) {
+                return;
+            }
+            continue;
+        }
+        int64_t fileSize = st.st_size;
+        if (live) {
+            // 直播不支持Range，发送到文件结束时关闭连接
+            const char *header = "HTTP/1.1 200 OK\r\nContent-Type: video/mp2t\r\n"
+                                 "Connection: close\r\n\r\n";
+            if (sendAll(fd, header, strlen(header)) >= 0) {
+                sendLive(fd, path, fileSize);
+            }
+            return;
+        }
+        if (rangeEnd < 0 || rangeEnd >= fileSize) {
+            rangeEnd = fileSize - 1;
+        }
+        if (rangeStart >= fileSize) {
+            char response[256];
+            snprintf(response, sizeof(response),
+                     "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */%lld\r\n"
+                     "Content-Length: 0\r\n\r\n", (long long) fileSize);
+            if (sendAll(fd, response, strlen(response)) < 0) {
+                return;
+            }
+            continue;
+        }
+
+        const char *contentType = "application/octet-stream";
+        if (strstr(target, ".m3u8")) {
+            contentType = "application/vnd.apple.mpegurl";
+        } else if (strstr(target, ".ts")) {
+            contentType = "video/mp2t";
+        }
+        char response[512];
+        if (hasRange) {
+            snprintf(response, sizeof(response),
+                     "HTTP/1.1 206 Partial Content\r\nContent-Type: %s\r\nAccept-Ranges: bytes\r\n"
+                     "Content-Range: bytes %lld-%lld/%lld\r\nContent-Length: %lld\r\n\r\n",
+                     contentType, (long long) rangeStart, (long long) rangeEnd,
+                     (long long) fileSize, (long long) (rangeEnd - rangeStart + 1));
+        } else {
+            snprintf(response, sizeof(response),
+                     "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nAccept-Ranges: bytes\r\n"
+                     "Content-Length: %lld\r\n\r\n", contentType, (long long) fileSize);
+        }
+        if (sendAll(fd, response, strlen(response)) < 0 ||
+            sendFile(fd, path, rangeStart, rangeEnd) < 0 || !keepAlive) {
+            return;
+        }
+    }
+}
+
+int BenchServer::sendFile(int fd, const std::string &path, int64_t start, int64_t end) {
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return ERROR;
+    }
+    char data[BENCH_SERVER_CHUNK_SIZE];
+    int64_t position = start;
+    int ret = SUCCESS;
+    while (position <= end && !quit) {
+        size_t size = (size_t) std::min<int64_t>(sizeof(data), end - position + 1);
+        ssize_t count = pread(file, data, size, position);
+        if (count <= 0 || sendAll(fd, data, (size_t) count) < 0) {
+            ret = ERROR;
+            break;
+        }
+        position += count;
+    }
+    close(file);
+    return ret;
+}
+
+/**
+ * 开始时发送BENCH_SERVER_LIVE_BURST的数据，之后按码率发送
+ * 中断期间不发送，恢复之后补发中断期间产生的数据
+ */
+int BenchServer::sendLive(int fd, const std::string &path, int64_t fileSize) {
+    int64_t bitRate = liveBitRate;
+    if (bitRate <= 0) {
+        return ERROR;
+    }
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return ERROR;
+    }
+    liveSize = fileSize;
+    liveStartTime = BenchUtils::now();
+    char data[BENCH_SERVER_CHUNK_SIZE];
+    int64_t position = 0;
+    int ret = SUCCESS;
+    while (position < fileSize && !quit) {
+        int64_t now = BenchUtils::now();
+        int64_t produced = (now - liveStartTime + BENCH_SERVER_LIVE_BURST) * bitRate / 8 / 1000000;
+        if (now < liveStallEnd || produced <= position) {
+            BenchUtils::sleepUs(10000);
+            continue;
+        }
+        size_t size = (size_t) std::min<int64_t>(sizeof(data),
+                                                 std::min(produced, fileSize) - position);
+        ssize_t count = pread(file, data, size, position);
+        if (count <= 0 || sendAll(fd, data, (size_t) count) < 0) {
+            ret = ERROR;
+            break;
+        }
+        position += count;
+    }
+    close(file);
+    return ret;
+}
+
+int BenchServer::sendAll(int fd, const char *data, size_t size) {
+    BenchUtils::sleepUntil(reserve(size));
+    while (size > 0) {
+        ssize_t count = send(fd, data, size, 0);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return ERROR;
+        }
+        data += count;
+        size -= count;
+        bytesSent += count;
+    }
+    return SUCCESS;
+}
+
+/**
+ * 所有连接共享一个发送时间线，空闲之后最多积累BENCH_SERVER_BURST_TIME的突发
+ */
+int64_t BenchServer::reserve(size_t size) {
+    Mutex::Autolock lock(mutex);
+    if (bitRate <= 0) {
+        return 0;
+    }
+    int64_t now = BenchUtils::now();
+    nextSendTime = std::max(nextSendTime, now - BENCH_SERVER_BURST_TIME);
+    int64_t sendTime = nextSendTime;
+    nextSendTime += (int64_t) size * 8 * 1000000 / bitRate;
+    return sendTime;
+}
@@ -0,0 +1,170 @@
+#include "BenchUtils.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+int64_t BenchUtils::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int64_t BenchUtils::processCpuTime() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (int64_t) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+int64_t BenchUtils::processWakeups() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_nvcsw;
+}
+
+int64_t BenchUtils::threadCpuTime() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Linux从/proc读取，其他平台不支持
+ */
+static int64_t readProcStatus(const char *format) {
+    int64_t result = -1;
+#if defined(__linux__)
+    FILE *file = fopen("/proc/self/status", "r");
+    if (file) {
+        char line[128];
+        long value;
+        while (fgets(line, sizeof(line), file)) {
+            if (sscanf(line, format, &value) == 1) {
+                result = value;
+                break;
+            }
+        }
+        fclose(file);
+    }
+#endif
+    return result;
+}
+
+int64_t BenchUtils::processRss() {
+    return readProcStatus("VmRSS: %ld");
+}
+
+int BenchUtils::processThreads() {
+    return (int) readProcStatus("Threads: %ld");
+}
+
+void BenchUtils::sleepUs(int64_t us) {
+    if (us <= 0) {
+        return;
+    }
+    struct timespec ts;
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000;
+    while (nanosleep(&ts, &ts) != 0) {
+    }
+}
+
+void BenchUtils::sleepUntil(int64_t time) {
+    sleepUs(time - now());
+}
+
+std::string BenchUtils::mediaDir(int argc, char **argv) {
+    std::string dir = argc > 1 ? argv[1] : BENCH_MEDIA_DIR;
+    mkdir(dir.c_str(), 0755);
+    return dir;
+}
+
+bool BenchUtils::exists(const std::string &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+void BenchStats::add(double value) {
+    values.push_back(value);
+}
+
+void BenchStats::clear() {
+    values.clear();
+}
+
+int BenchStats::count() const {
+    return (int) values.size();
+}
+
+double BenchStats::mean() const {
+    if (values.empty()) {
+        return 0;
+    }
+    double sum = 0;
+    for (double value : values) {
+        sum += value;
+    }
+    return sum / values.size();
+}
+
+double BenchStats::max() const {
+    if (values.empty()) {
+        return 0;
+    }
+    return *std::max_element(values.begin(), values.end());
+}
+
+double BenchStats::percentile(double p) const {
+    if (values.empty()) {
+        return 0;
+    }
+    std::vector<double> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    auto index = (size_t) (p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+int BenchStats::countAbove(double threshold) const {
+    int count = 0;
+    for (double value : values) {
+        if (value > threshold) {
+            count++;
+        }
+    }
+    return count;
+}
+
+double BenchStats::sumAbove(double threshold) const {
+    double sum = 0;
+    for (double value : values) {
+        if (value > threshold) {
+            sum += value;
+        }
+    }
+    return sum;
+}
+
+void CpuWindow::begin() {
+    startTime = BenchUtils::now();
+    startCpu = BenchUtils::processCpuTime();
+    elapsed = 0;
+}
+
+double CpuWindow::end() {
+    int64_t wall = BenchUtils::now() - startTime;
+    int64_t cpu = BenchUtils::processCpuTime() - startCpu;
+    elapsed = wall / 1000000.0;
+    return wall > 0 ? cpu * 100.0 / wall : 0;
+}
+
+double CpuWindow::getElapsed() const {
+    return elapsed;
+}
@@ -0,0 +1,153 @@
+#include "LegacyPacketQueue.h"
+#include "Errors.h"
+
+LegacyPacketQueue::LegacyPacketQueue(AVPacket *flushPacket) : flushPacket(flushPacket) {
+}
+
+LegacyPacketQueue::~LegacyPacketQueue() {
+    abort();
+    flush();
+    flushPacket = nullptr;
+}
+
+int LegacyPacketQueue::put(AVPacket *pkt) {
+    LegacyPacketData *packetData;
+
+    if (abortRequest) {
+        return EXIT;
+    }
+
+    packetData = (LegacyPacketData *) av_malloc(sizeof(LegacyPacketData));
+    if (!packetData) {
+        return ERROR_NOT_MEMORY;
+    }
+    packetData->pkt = *pkt;
+    packetData->next = nullptr;
+
+    if (pkt == flushPacket) {
+        lastSeekSerial++;
+    }
+    packetData->serial = lastSeekSerial;
+
+    if (!lastPacket) {
+        firstPacket = packetData;
+    } else {
+        lastPacket->next = packetData;
+    }
+    lastPacket = packetData;
+    packetSize++;
+    memorySize += packetData->pkt.size + sizeof(*packetData);
+    duration += packetData->pkt.duration;
+    return SUCCESS;
+}
+
+int LegacyPacketQueue::pushPacket(AVPacket *pkt) {
+    int ret;
+    mutex.lock();
+    ret = put(pkt);
+    condition.signal();
+    mutex.unlock();
+    if (ret < 0) {
+        av_packet_unref(pkt);
+    }
+    return ret;
+}
+
+void LegacyPacketQueue::flush() {
+    LegacyPacketData *pkt, *pkt1;
+    mutex.lock();
+    for (pkt = firstPacket; pkt; pkt = pkt1) {
+        pkt1 = pkt->next;
+        av_packet_unref(&pkt->pkt);
+        av_freep(&pkt);
+    }
+    lastPacket = nullptr;
+    firstPacket = nullptr;
+    packetSize = 0;
+    memorySize = 0;
+    duration = 0;
+    condition.signal();
+    mutex.unlock();
+}
+
+void LegacyPacketQueue::abort() {
+    mutex.lock();
+    abortRequest = true;
+    condition.signal();
+    mutex.unlock();
+}
+
+void LegacyPacketQueue::start() {
+    mutex.lock();
+    abortRequest = false;
+    put(flushPacket);
+    condition.signal();
+    mutex.unlock();
+}
+
+int LegacyPacketQueue::getPacket(AVPacket *pkt) { return getPacket(pkt, 1); }
+
+int LegacyPacketQueue::getPacket(AVPacket *pkt, int block) {
+    LegacyPacketData *pkt1;
+    int ret;
+    mutex.lock();
+    for (;;) {
+        if (abortRequest) {
+            ret = EXIT;
+            break;
+        }
+
+        pkt1 = firstPacket;
+        if (pkt1) {
+            firstPacket = pkt1->next;
+            if (!firstPacket) {
+                lastPacket = nullptr;
+            }
+            packetSize--;
+            memorySize -= pkt1->pkt.size + sizeof(*pkt1);
+            duration -= pkt1->pkt.duration;
+            *pkt = pkt1->pkt;
+            firstSeekSerial = pkt1->serial;
+            av_free(pkt1);
+            ret = SUCCESS;
+            break;
+        } else if (!block) {
+            ret = SUCCESS;
+            break;
+        } else {
+            condition.wait(mutex);
+        }
+    }
+    mutex.unlock();
+    return ret;
+}
+
+int LegacyPacketQueue::getPacketSize() {
+    Mutex::Autolock lock(mutex);
+    return packetSize;
+}
+
+int LegacyPacketQueue::getSize() {
+    Mutex::Autolock lock(mutex);
+    return memorySize;
+}
+
+int64_t LegacyPacketQueue::getDuration() {
+    Mutex::Autolock lock(mutex);
+    return duration;
+}
+
+bool LegacyPacketQueue::isAbort() {
+    Mutex::Autolock lock(mutex);
+    return abortRequest;
+}
+
+int LegacyPacketQueue::getLastSeekSerial() {
+    Mutex::Autolock lock(mutex);
+    return lastSeekSerial;
+}
+
+int LegacyPacketQueue::getFirstSeekSerial() {
+    Mutex::Autolock lock(mutex);
+    return firstSeekSerial;
+}
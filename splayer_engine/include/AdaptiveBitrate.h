@@ -0,0 +1,152 @@
+#ifndef ENGINE_ADAPTIVE_BITRATE_H
+#define ENGINE_ADAPTIVE_BITRATE_H
+
+#include <vector>
+#include "MessageCenter.h"
+#include "Log.h"
+#include "Errors.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/time.h>
+};
+
+/// 检查码率的间隔，微秒
+#define ABR_CHECK_INTERVAL                          (500 * 1000)
+
+/// 两次切换的最小间隔，微秒，降低码率时缓冲不足不受限制
+#define ABR_SWITCH_INTERVAL                         (5 * 1000 * 1000)
+
+/// 新码率一直没有读到关键帧时放弃切换，微秒
+#define ABR_SWITCH_TIMEOUT                          (15 * 1000 * 1000)
+
+/// 带宽采样的最小读包耗时，微秒
+#define ABR_SAMPLE_TIME                             (200 * 1000)
+
+/// 缓冲低于该时长时只使用带宽的一半，微秒
+#define ABR_LOW_BUFFER                              (500 * 1000)
+
+/// 缓冲高于该时长或者队列已满时才提高码率，微秒
+#define ABR_HIGH_BUFFER                             (3 * 1000 * 1000)
+
+/// 码率占带宽的比例
+#define ABR_BANDWIDTH_FACTOR                        0.8
+
+#define ABR_LOW_BUFFER_FACTOR                       0.5
+
+/**
+ * HLS多码率自适应
+ * FFmpeg的HLS解复用器为每个码率创建一个AVProgram，只下载没有被丢弃的流，
+ * 重新启用一个码率时从当前时间所在的分片开始下载，停用的码率在下一个分片边界停止下载
+ * 根据读包耗时估算带宽，结合数据包队列的缓冲时长选择码率，切换时新旧码率同时读取，
+ * 新码率读到视频关键帧之后停用旧码率，编码参数一致时数据包直接送入原来的解码器
+ */
+class AdaptiveBitrate {
+
+    const char *const TAG = "[MP][NATIVE][AdaptiveBitrate]";
+
+    typedef struct Variant {
+        int64_t bitrate;
+        int videoIndex;
+        int audioIndex;
+        int width;
+        int height;
+    } Variant;
+
+public:
+
+    AdaptiveBitrate(MessageCenter *messageCenter);
+
+    virtual ~AdaptiveBitrate();
+
+    // 是否有多个码率
+    static bool isSupported(AVFormatContext *formatContext);
+
+    /**
+     * 建立码率列表
+     * @param formatContext
+     * @param videoIndex 视频解码器的流索引，没有时为-1
+     * @param audioIndex 音频解码器的流索引，没有时为-1
+     * @return 当前流不属于任何码率时返回ERROR
+     */
+    int open(AVFormatContext *formatContext, int videoIndex, int audioIndex);
+
+    // 读包的字节数和耗时，用于估算带宽
+    void addSample(int64_t bytes, int64_t cost);
+
+    /**
+     * 根据带宽和缓冲选择码率，需要切换时启用新码率的流
+     * @param bufferDuration 数据包队列中缓冲的时长，微秒
+     * @param bufferFull 队列已满，读包线程在等待
+     */
+    void update(int64_t bufferDuration, bool bufferFull);
+
+    // 过滤数据包，需要送入解码器时返回true，并把流索引改成解码器的流索引
+    bool filterPacket(AVPacket *pkt);
+
+    // 定位时立即完成正在进行的切换
+    void flush();
+
+    // 估算的带宽，bit/s
+    int64_t getBandwidth();
+
+private:
+
+    bool isCompatible(const Variant &variant);
+
+    void startSwitch(int index);
+
+    void finishSwitch();
+
+    void cancelSwitch();
+
+    void setDiscard(const Variant &variant, const Variant &other, AVDiscard discard);
+
+    bool isPrimary(const Variant &variant, int streamIndex);
+
+    void remap(AVPacket *pkt, const Variant &variant);
+
+    void attachExtradata(AVPacket *pkt);
+
+private:
+
+    MessageCenter *messageCenter = nullptr;
+
+    AVFormatContext *formatContext = nullptr;
+
+    /// 解码器的流索引，切换之后数据包的流索引改为该值
+    int videoIndex = -1;
+
+    int audioIndex = -1;
+
+    /// 按码率从低到高排序
+    std::vector<Variant> variants;
+
+    int current = -1;
+
+    /// 正在切换的码率，没有时为-1
+    int pending = -1;
+
+    /// 解码器当前使用的扩展数据，切换到扩展数据不同的码率时通过数据包附加数据更新
+    const AVCodecParameters *activeParams = nullptr;
+
+    bool extradataPending = false;
+
+    int64_t switchStartTime = 0;
+
+    int64_t lastSwitchTime = 0;
+
+    int64_t lastCheckTime = 0;
+
+    /// 当前采样窗口
+    int64_t sampleBytes = 0;
+
+    int64_t sampleTime = 0;
+
+    /// 快速和慢速平滑的带宽，取较小值
+    double fastBandwidth = 0;
+
+    double slowBandwidth = 0;
+};
+
+#endif
@@ -14,7 +14,7 @@ public:
                  int streamIndex,
                  PlayerInfoStatus *playerState,
                  AVPacket *flushPacket,
-                 Condition *pCondition,
+                 Event *readEvent,
                  AVDictionary *opts,
                  MessageCenter *messageCenter);
 
@@ -38,6 +38,8 @@ public:
 
     int64_t getFrameQueueLastPos();
 
+    int64_t getFrameQueueMemorySize();
+
 private:
 
     /// 解复用上下文
@@ -47,7 +49,7 @@ private:
     FrameQueue *frameQueue;
 
     /// 解码线程
-    Thread *decodeThread;
+    ThreadTask *decodeThread;
 
 private:
 
@@ -116,6 +116,8 @@ private:
 
     int audioFrameReSample();
 
+    int changeTempo(int dataSize, double speed);
+
 private:
 
     AVFrame *srcFrame = nullptr;
@@ -133,6 +135,9 @@ private:
     /// 变速变调处理
     SoundTouchWrapper *soundTouchWrapper = nullptr;
 
+    /// 低延时模式追赶时的播放速度
+    double tempo = 1.0;
+
     int convertAudio(int wantedNbSamples, AVFrame *frame) const;
 
     int initConvertSwrContext(int64_t desireChannelLayout, AVFrame *frame) const;
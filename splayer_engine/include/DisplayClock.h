@@ -0,0 +1,137 @@
+#ifndef ENGINE_DISPLAY_CLOCK_H
+#define ENGINE_DISPLAY_CLOCK_H
+
+#include <math.h>
+#include "Mutex.h"
+#include "Condition.h"
+#include "IDisplayClockListener.h"
+#include "Log.h"
+#include "Errors.h"
+
+extern "C" {
+#include <libavutil/common.h>
+#include <libavutil/time.h>
+};
+
+/// 有效的刷新率范围，超出时认为设备没有提供
+#define DISPLAY_CLOCK_MIN_REFRESH_RATE              20.0
+
+#define DISPLAY_CLOCK_MAX_REFRESH_RATE              500.0
+
+/// vsync之后唤醒的余量，覆盖线程调度的延时，秒
+#define DISPLAY_CLOCK_WAKE_UP_MARGIN                0.001
+
+/// 超过该时长没有显示画面时vsync的相位不再可信，秒
+#define DISPLAY_CLOCK_VSYNC_TIMEOUT                 1.0
+
+/// 播放时的最长等待，时钟速度和丢帧需要定期检查，秒
+#define DISPLAY_CLOCK_MAX_WAIT                      0.1
+
+/// 暂停时的最长等待，暂停、定位和强制刷新会唤醒，秒
+#define DISPLAY_CLOCK_IDLE_WAIT                     0.5
+
+/// 输出显示抖动和CPU占用的间隔，秒
+#define DISPLAY_CLOCK_STAT_INTERVAL                 5.0
+
+/**
+ * 显示时钟
+ * 设备提供刷新率并且显示画面时阻塞到vsync(SDL的PRESENTVSYNC)时，按显示完成的时间推算vsync的相位，
+ * 现在提交的画面在下一个vsync显示，帧的显示时间取整到最近的vsync，在目标vsync的前一个vsync之后唤醒提交，
+ * 设备没有提供vsync时直接使用当前时间，和原来按时间轮询的行为一致
+ * 刷新线程在条件变量上精确等待到下一帧的显示时间，暂停时一直等待到被唤醒，不再按REFRESH_RATE轮询
+ * 统计帧实际显示时间和计划时间的偏差以及刷新线程和进程的CPU占用，ENGINE_DEBUG时定期输出，区分暂停和播放
+ * onPresent、getDisplayTime、getWaitTime和updateStats在刷新线程调用，wakeUp可以在任意线程调用
+ */
+class DisplayClock {
+
+    const char *const TAG = "[MP][NATIVE][DisplayClock]";
+
+public:
+
+    DisplayClock();
+
+    virtual ~DisplayClock();
+
+    // 重新开始统计，vsync的相位保留
+    void reset();
+
+    // 设置显示设备的刷新率，0表示未知
+    void setRefreshRate(double refreshRate);
+
+    double getRefreshRate();
+
+    /**
+     * 画面已经提交显示
+     * @param time 显示完成的时间，秒，av_gettime_relative的时间基准
+     * @param vsync 提交时阻塞到vsync，time可以作为vsync的时间
+     */
+    void onPresent(double time, bool vsync);
+
+    // 设置下一次显示的画面计划的显示时间，用于统计抖动
+    void setTargetTime(double time);
+
+    // 现在提交的画面预计的显示时间，取整到最近的vsync之后与帧的计划显示时间比较
+    double getDisplayTime(double now);
+
+    // 计划在time显示的画面需要等待多久提交
+    double getWaitTime(double now, double time);
+
+    // 等待指定的时长，被wakeUp唤醒时提前返回
+    void wait(double seconds);
+
+    // 唤醒刷新线程，在等待之前调用时下一次等待立即返回
+    void wakeUp();
+
+    void setListener(IDisplayClockListener *listener);
+
+    // 刷新线程每次循环调用，按间隔输出统计
+    void updateStats(bool paused);
+
+private:
+
+    bool hasVsync(double now);
+
+    double getNextVsync(double now);
+
+    void resetStats(double now, bool paused);
+
+private:
+
+    Mutex mutex;
+
+    Condition condition;
+
+    bool wakeUpRequest = false;
+
+    IDisplayClockListener *listener = nullptr;
+
+    /// 显示周期，秒，0表示未知
+    double period = 0;
+
+    /// 最近一次vsync的时间，秒
+    double lastVsync = NAN;
+
+    /// 当前画面计划的显示时间
+    double targetTime = NAN;
+
+    /// 统计窗口
+    bool statPaused = false;
+
+    double statStartTime = 0;
+
+    int64_t statThreadCpu = 0;
+
+    int64_t statProcessCpu = 0;
+
+    int presentCount = 0;
+
+    int waitCount = 0;
+
+    int jitterCount = 0;
+
+    double jitterSum = 0;
+
+    double jitterMax = 0;
+};
+
+#endif
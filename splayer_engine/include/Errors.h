@@ -40,6 +40,7 @@
 #define  ERROR_NOT_OPEN_AUDIO_DEVICE        -34
 #define  ERROR_PERMISSION_DENIED            -35
 #define  ERROR_INVALID_OPERATION            -36
+#define  ERROR_MSG_QUEUE_FULL               -37
 
 
 #endif
@@ -0,0 +1,83 @@
+#ifndef ENGINE_EVENT_H
+#define ENGINE_EVENT_H
+
+#include <atomic>
+#include "Mutex.h"
+#include "Condition.h"
+
+/**
+ * 自动复位事件
+ * signal之后，下一次wait立即返回并清除事件；没有线程等待时signal不加锁
+ * 先检查条件再wait不会错过检查之后发出的signal
+ */
+class Event {
+
+public:
+
+    Event();
+
+    ~Event();
+
+    void signal();
+
+    void wait();
+
+    int waitRelative(nsecs_t reltime);
+
+private:
+    Mutex mutex;
+
+    Condition condition;
+
+    std::atomic<bool> signaled;
+
+    std::atomic<bool> waiting;
+};
+
+inline Event::Event() {
+    signaled = false;
+    waiting = false;
+}
+
+inline Event::~Event() {
+}
+
+inline void Event::signal() {
+    signaled = true;
+    if (waiting) {
+        mutex.lock();
+        condition.broadcast();
+        mutex.unlock();
+    }
+}
+
+inline void Event::wait() {
+    if (signaled.exchange(false)) {
+        return;
+    }
+    mutex.lock();
+    waiting = true;
+    while (!signaled.exchange(false)) {
+        condition.wait(mutex);
+    }
+    waiting = false;
+    mutex.unlock();
+}
+
+inline int Event::waitRelative(nsecs_t reltime) {
+    if (signaled.exchange(false)) {
+        return 0;
+    }
+    int ret = 0;
+    mutex.lock();
+    waiting = true;
+    if (!signaled.exchange(false)) {
+        ret = condition.waitRelative(mutex, reltime);
+        signaled = false;
+    }
+    waiting = false;
+    mutex.unlock();
+    return ret;
+}
+
+#endif
@@ -12,6 +12,13 @@ extern "C" {
 #include <libavutil/opt.h>
 #include "Log.h"
 
+/// 探测参数的选项名，调用者通过解复用参数设置
+#define OPT_PROBE_SIZE                              "probesize"
+
+#define OPT_ANALYZE_DURATION                        "analyzeduration"
+
+#define OPT_FPS_PROBE_SIZE                          "fpsprobesize"
+
 AVDictionary *filterCodecOptions(AVDictionary *opts, enum AVCodecID codec_id,
                                  AVFormatContext *formatContext, AVStream *stream, AVCodec *codec);
 
@@ -30,6 +37,9 @@ double getRotation(AVStream *st);
 // 是否实时流
 int isRealTime(AVFormatContext *s);
 
+// 整型选项是否还是FFmpeg的默认值，用于只调整调用者没有设置过的选项
+int isDefaultOption(void *obj, const char *name);
+
 #ifdef __cplusplus
 };
 #endif
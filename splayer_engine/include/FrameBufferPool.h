@@ -0,0 +1,74 @@
+#ifndef ENGINE_FRAME_BUFFER_POOL_H
+#define ENGINE_FRAME_BUFFER_POOL_H
+
+#include <atomic>
+#include "Mutex.h"
+#include "Log.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+};
+
+/// 图像每行字节数和平面起始地址的对齐，满足SIMD和纹理上传的要求
+#define FRAME_BUFFER_ALIGN                          64
+
+/**
+ * 视频解码帧缓冲池，通过get_buffer2安装到解码上下文，每个视频流一个
+ * 每个图像平面使用一个按大小分配的AVBufferPool，FrameQueue释放帧之后缓冲回到池中，
+ * 稳定播放时解码不再分配图像内存；分辨率或者像素格式变化时重建缓冲池
+ * 帧级多线程解码时get_buffer2在解码线程中并发调用，重建缓冲池需要加锁
+ */
+class FrameBufferPool {
+
+    const char *const TAG = "[MP][NATIVE][FrameBufferPool]";
+
+public:
+
+    FrameBufferPool();
+
+    virtual ~FrameBufferPool();
+
+    // 安装到解码上下文，解码器不支持自定义缓冲时返回false
+    static bool install(AVCodecContext *codecContext, AVCodec *codec);
+
+    // 获取解码上下文上安装的缓冲池
+    static FrameBufferPool *from(AVCodecContext *codecContext);
+
+    // 缓冲分配次数
+    int getAllocCount();
+
+private:
+
+    static int getBuffer2(AVCodecContext *codecContext, AVFrame *frame, int flags);
+
+    static AVBufferRef *allocBuffer(void *opaque, int size);
+
+    int getVideoBuffer(AVCodecContext *codecContext, AVFrame *frame);
+
+    int updatePools(AVCodecContext *codecContext, AVFrame *frame);
+
+    void releasePools();
+
+private:
+
+    Mutex mutex;
+
+    AVBufferPool *pools[4];
+
+    int linesize[4];
+
+    int planes = 0;
+
+    int format = -1;
+
+    int width = 0;
+
+    int height = 0;
+
+    std::atomic<int> allocCount;
+};
+
+#endif
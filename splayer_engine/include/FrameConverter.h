@@ -0,0 +1,142 @@
+#ifndef ENGINE_FRAME_CONVERTER_H
+#define ENGINE_FRAME_CONVERTER_H
+
+#include <vector>
+#include "Mutex.h"
+#include "Condition.h"
+#include "Thread.h"
+#include "ThreadPool.h"
+#include "Log.h"
+#include "Errors.h"
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/time.h>
+#include <libswscale/swscale.h>
+};
+
+/// 转换的输出格式，视频设备按BGRA上传
+#define FRAME_CONVERTER_FORMAT                      AV_PIX_FMT_BGRA
+
+/// 转换使用的最大线程数，包括解码线程
+#define FRAME_CONVERTER_MAX_THREADS                 4
+
+/// 每个分片的最小行数，图像较小时减少线程
+#define FRAME_CONVERTER_MIN_SLICE_HEIGHT            128
+
+/// 分片起始行的对齐，保证色度平面按整行切分
+#define FRAME_CONVERTER_SLICE_ALIGN                 16
+
+/// 输出每行字节数的对齐，满足swscale的SIMD输出
+#define FRAME_CONVERTER_LINE_ALIGN                  64
+
+/// 统计转换耗时的帧数
+#define FRAME_CONVERTER_STAT_FRAMES                 120
+
+/**
+ * 视频设备不能直接渲染的像素格式在解码线程转换成BGRA，同步线程只负责上传
+ * 图像按行切成多个分片，每个分片使用独立的SwsContext，由工作线程并行转换，解码线程转换第一个分片
+ * 尺寸不变，只做像素格式转换，使用SWS_FAST_BILINEAR，swscale按CPU自动选择SIMD实现
+ * 输出缓冲来自按尺寸建立的AVBufferPool，帧队列释放帧之后缓冲回到池中，分辨率变化时重建缓冲池
+ */
+class FrameConverter {
+
+    const char *const TAG = "[MP][NATIVE][FrameConverter]";
+
+    /// 一个分片，工作线程的Runnable
+    typedef struct Slice : public Runnable {
+        FrameConverter *converter;
+        int index;
+        /// 已经处理过的任务序号
+        int generation;
+        /// 分片的起始行和行数
+        int y;
+        int height;
+        SwsContext *swsContext;
+        ThreadTask *task;
+
+        void run() override {
+            converter->runSlice(this);
+        }
+    } Slice;
+
+public:
+
+    FrameConverter();
+
+    virtual ~FrameConverter();
+
+    // 启动工作线程
+    void start();
+
+    // 停止并等待工作线程退出
+    void stop();
+
+    /**
+     * 转换成BGRA
+     * @param src 解码输出的帧
+     * @param dst 转换后的帧，复制src的时间戳等属性
+     * @return 不支持的格式或者没有内存时返回ERROR
+     */
+    int convert(const AVFrame *src, AVFrame *dst);
+
+private:
+
+    int prepare(const AVFrame *src);
+
+    int convertSlice(Slice *slice);
+
+    void runSlice(Slice *slice);
+
+    void updateConvertCost(int64_t startTime);
+
+private:
+
+    Mutex mutex;
+
+    /// 有新的任务或者停止
+    Condition condition;
+
+    /// 工作线程完成分片
+    Condition doneCondition;
+
+    bool abortRequest = false;
+
+    std::vector<Slice *> slices;
+
+    /// 当前任务的分片数量
+    int sliceCount = 0;
+
+    /// 任务序号，每转换一帧加一
+    int generation = 0;
+
+    /// 工作线程还没有完成的分片数量
+    int pending = 0;
+
+    /// 有分片转换失败
+    bool failed = false;
+
+    /// 当前任务
+    const AVFrame *srcFrame = nullptr;
+
+    AVFrame *dstFrame = nullptr;
+
+    /// 输出缓冲池，按尺寸建立
+    AVBufferPool *bufferPool = nullptr;
+
+    int poolWidth = 0;
+
+    int poolHeight = 0;
+
+    int dstLinesize = 0;
+
+    /// 转换耗时统计，微秒
+    int64_t convertTime = 0;
+
+    int convertCount = 0;
+};
+
+#endif
@@ -1,10 +1,12 @@
 #ifndef ENGINE_FRAMEQUEUE_H
 #define ENGINE_FRAMEQUEUE_H
 
+#include <atomic>
 #include "Mutex.h"
 #include "Condition.h"
 #include "Log.h"
 #include "PacketQueue.h"
+#include "Event.h"
 #include "PlayerInfoStatus.h"
 
 extern "C" {
@@ -52,6 +54,9 @@ typedef struct Frame {
     /// 上载
     int uploaded;
 
+    /// 解码线程已经转换成BGRA
+    int converted;
+
     /// 反转
     int flipVertical;
 
@@ -59,15 +64,22 @@ typedef struct Frame {
 
 /// 解码后的帧队列
 /// https://www.jianshu.com/p/6014de9c47ea
+/// 单生产者单消费者环形队列：
+/// 生产者为解码线程，调用peekWritable/pushFrame
+/// 消费者为MediaSync或者音频回调，调用peek*/popFrame
+/// 帧数量为原子变量，只有队列满或者空的时候才在condition上等待
 class FrameQueue {
     const char *const TAG = "[MP][NATIVE][FrameQueue]";
 
 private:
-    bool _condWriteableWait = false;
-    bool _condReadableWait = false;
+    /// 生产者是否在等待可写
+    std::atomic<bool> _condWriteableWait;
+
+    /// 消费者是否在等待可读
+    std::atomic<bool> _condReadableWait;
 
 public:
-    FrameQueue(int max_size, int keep_last, PacketQueue *packetQueue);
+    FrameQueue(int max_size, int keep_last, PacketQueue *packetQueue, Event *readEvent);
 
     virtual ~FrameQueue();
 
@@ -89,10 +101,15 @@ public:
 
     void popFrame();
 
+    // 刷新，只能在消费者线程或者没有消费者时调用
+    // seek时不需要刷新，消费者会根据seekSerial丢弃seek之前的帧
     void flush();
 
     int getFrameSize();
 
+    // 队列中帧数据占用的内存大小
+    int64_t getMemorySize();
+
     int isShownIndex() const;
 
     Mutex *getMutex();
@@ -102,6 +119,14 @@ public:
 private:
     void unrefFrame(Frame *frame);
 
+    // 计算帧数据占用的内存大小
+    int64_t frameMemorySize(Frame *frame);
+
+    // 唤醒等待中的生产者或者消费者
+    void wakeWaiter(std::atomic<bool> &waiting);
+
+    bool isAbort();
+
 private:
 
     /// 锁对象
@@ -110,10 +135,10 @@ private:
     /// 条件对象
     Condition condition;
 
-    bool abortRequest;
+    std::atomic<bool> abortRequest;
 
-    /// queue是存储Frame的数组
-    Frame queue[FRAME_QUEUE_SIZE];
+    /// queue是存储Frame的数组，长度为maxSize
+    Frame *queue;
 
     /// 是读帧数据索引， 相当于是队列的队首
     int readIndex;
@@ -122,19 +147,25 @@ private:
     int writeIndex;
 
     /// 是存储在这个队列的Frame的数量
-    int size;
+    std::atomic<int> size;
 
     /// 是可以存储Frame的最大数量
     int maxSize;
 
+    /// 帧数据占用的内存大小
+    std::atomic<int64_t> memorySize;
+
     /// 保持上一个
     int keepPreviousFrame;
 
     /// 表示当前是否有帧在显示
-    int readIndexShown;
+    std::atomic<int> readIndexShown;
 
     /// 指向各自数据包(ES包)的队列
     PacketQueue *packetQueue;
+
+    /// 读包事件，出队后通知读包线程重新检查缓冲状态
+    Event *readEvent;
 };
 
 
@@ -0,0 +1,11 @@
+#ifndef ENGINE__IDISPLAY_CLOCK_LISTENER_H
+#define ENGINE__IDISPLAY_CLOCK_LISTENER_H
+
+class IDisplayClockListener {
+
+public:
+    // 需要立即刷新画面，在调用wakeUp的线程中回调，自己等待事件的刷新线程(比如SDL)用来结束等待
+    virtual void onWakeUp() = 0;
+};
+
+#endif
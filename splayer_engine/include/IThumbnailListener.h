@@ -0,0 +1,23 @@
+#ifndef ENGINE__ITHUMBNAIL_LISTENER_H
+#define ENGINE__ITHUMBNAIL_LISTENER_H
+
+#include <cstdint>
+
+class IThumbnailListener {
+
+public:
+    /**
+     * 缩略图提取完成，在工作线程中回调，同一时间只有一个回调
+     * @param index 时间戳在请求列表中的下标
+     * @param timestamp 请求的时间戳，微秒
+     * @param pts 实际解码的关键帧时间戳，微秒
+     * @param data RGBA数据，只在回调期间有效
+     */
+    virtual void onThumbnail(int index, int64_t timestamp, int64_t pts, const uint8_t *data,
+                             int width, int height, int linesize) = 0;
+
+    // 所有时间戳处理完成，count为成功提取的数量
+    virtual void onThumbnailComplete(int count, float thumbnailsPerSecond) = 0;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef ENGINE_KEYFRAME_INDEX_H
+#define ENGINE_KEYFRAME_INDEX_H
+
+#include <map>
+#include <string>
+#include "Log.h"
+#include "Errors.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/avstring.h>
+};
+
+#define KEYFRAME_INDEX_MAGIC                        0x53504B49
+
+/// 索引文件后缀，本地文件保存在媒体文件旁边，网络资源保存在缓存目录中
+#define KEYFRAME_INDEX_SUFFIX                       ".kfi"
+
+/**
+ * 关键帧索引，记录视频流关键帧的时间戳和字节位置
+ * 读包时增量建立，只有连续读取过的区间才认为是完整的，定位目标落在完整区间内时
+ * 直接按字节定位到目标之前最近的关键帧，不依赖解复用器的二分查找
+ * 只用于原生索引不完善且支持字节定位的格式，比如TS、FLV
+ */
+class KeyframeIndex {
+
+    const char *const TAG = "[MP][NATIVE][KeyframeIndex]";
+
+public:
+
+    KeyframeIndex();
+
+    virtual ~KeyframeIndex();
+
+    static bool isSupported(AVFormatContext *formatContext);
+
+    /**
+     * 打开索引并加载保存过的索引文件
+     * @param formatContext
+     * @param streamIndex 建立索引的视频流
+     * @param url
+     * @param cacheDir 网络资源的索引保存目录，为空时只在内存中建立
+     * @return
+     */
+    int open(AVFormatContext *formatContext, int streamIndex, const char *url,
+             const char *cacheDir);
+
+    // 保存索引文件
+    void close();
+
+    // 读包线程读到数据包时调用
+    void addPacket(const AVPacket *pkt);
+
+    // 定位之后读取不再连续，重新开始一个区间
+    void discontinue();
+
+    /**
+     * 查找目标时间之前最近的关键帧
+     * @param target 目标时间，微秒
+     * @param pts 关键帧时间戳，微秒
+     * @param pos 关键帧字节位置
+     * @return 目标时间不在完整区间内时返回false
+     */
+    bool find(int64_t target, int64_t *pts, int64_t *pos);
+
+private:
+
+    void commitSpan();
+
+    void load();
+
+    void save();
+
+private:
+
+    /// 索引文件路径，为空时不保存
+    std::string path;
+
+    int streamIndex = -1;
+
+    AVRational timeBase;
+
+    /// 媒体大小和修改时间，和索引文件中的不一致时丢弃索引
+    int64_t mediaSize = 0;
+
+    int64_t mediaTime = 0;
+
+    /// 关键帧，时间戳 -> 字节位置
+    std::map<int64_t, int64_t> keyframes;
+
+    /// 连续读取过的区间，起始时间戳 -> 结束时间戳
+    std::map<int64_t, int64_t> spans;
+
+    /// 当前连续区间，从读到的第一个关键帧开始
+    int64_t spanStart = AV_NOPTS_VALUE;
+
+    int64_t spanEnd = AV_NOPTS_VALUE;
+
+    bool dirty = false;
+};
+
+#endif
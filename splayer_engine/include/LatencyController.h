@@ -0,0 +1,145 @@
+#ifndef ENGINE_LATENCY_CONTROLLER_H
+#define ENGINE_LATENCY_CONTROLLER_H
+
+#include <atomic>
+#include <math.h>
+#include "MessageCenter.h"
+#include "Log.h"
+#include "Errors.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/time.h>
+};
+
+/// 低延时模式的探测参数，只在调用者没有设置时使用
+#define LOW_LATENCY_PROBE_SIZE                      (128 * 1024)
+
+#define LOW_LATENCY_ANALYZE_DURATION                (AV_TIME_BASE / 5)
+
+#define LOW_LATENCY_FPS_PROBE_SIZE                  3
+
+/// 低延时模式的解复用最大缓冲延时，微秒
+#define LOW_LATENCY_MAX_DELAY                       (AV_TIME_BASE / 10)
+
+/// 低延时模式的数据包队列最大内存
+#define LOW_LATENCY_MAX_QUEUE_SIZE                  (2 * 1024 * 1024)
+
+/// 计算延时和调整速度的间隔，秒
+#define LOW_LATENCY_CHECK_INTERVAL                  0.1
+
+/// 延时超过目标不到该值时不追赶，秒
+#define LOW_LATENCY_TOLERANCE                       0.2
+
+/// 超出目标的延时按该时长追回，秒，决定追赶速度
+#define LOW_LATENCY_CATCH_UP_TIME                   4.0
+
+/// 追赶的最大速度
+#define LOW_LATENCY_MAX_SPEED                       1.25
+
+/// 每次调整速度的最大步进
+#define LOW_LATENCY_SPEED_STEP                      0.02
+
+/// 直播边缘后退超过该值时认为时间戳不连续，秒
+#define LOW_LATENCY_DISCONTINUITY                   10.0
+
+/// 两次丢弃数据包的最小间隔，秒
+#define LOW_LATENCY_DROP_INTERVAL                   2.0
+
+/// 上报延时的间隔，秒
+#define LOW_LATENCY_NOTIFY_INTERVAL                 1.0
+
+/**
+ * 直播低延时控制
+ * 延时为读到的最新数据包(直播边缘)和播放时钟的差值，也就是客户端缓冲的时长，
+ * 源站提供发送端的绝对时间(RTSP的RTCP)时上报端到端延时
+ * 延时超过目标时在限定范围内加快主时钟，音频通过SoundTouch变速不变调，视频由同步器丢帧追上，
+ * 延时超过上限时由读包线程清空队列，从下一个关键帧继续播放
+ * onPacket在读包线程调用，update在主时钟所在的线程调用(音频回调或者视频同步线程)
+ */
+class LatencyController {
+
+    const char *const TAG = "[MP][NATIVE][LatencyController]";
+
+public:
+
+    LatencyController();
+
+    virtual ~LatencyController();
+
+    /**
+     * 开始控制延时
+     * @param formatContext
+     * @param targetLatency 目标延时，毫秒
+     * @param maxLatency 最大延时，毫秒，超过时丢弃数据包
+     */
+    void open(MessageCenter *messageCenter, AVFormatContext *formatContext,
+              int64_t targetLatency, int64_t maxLatency);
+
+    void close();
+
+    bool isEnabled() const;
+
+    // 送入解码器的数据包，更新直播边缘
+    void onPacket(const AVPacket *pkt, AVRational timeBase);
+
+    /**
+     * 根据主时钟计算延时，返回主时钟应该使用的速度
+     * @param masterClock 主时钟，秒
+     */
+    double update(double masterClock);
+
+    // 延时是否超过上限，需要丢弃队列中的数据包
+    bool isStale();
+
+    // 丢弃数据包之后重新计算延时
+    void reset();
+
+    // 当前速度
+    double getSpeed() const;
+
+    // 当前延时，毫秒，没有时为-1
+    int64_t getLatency() const;
+
+private:
+
+    MessageCenter *messageCenter = nullptr;
+
+    std::atomic<bool> enabled;
+
+    /// 目标延时和最大延时，秒
+    double targetLatency = 0;
+
+    double maxLatency = 0;
+
+    /// 发送端的绝对时间，微秒，没有时为AV_NOPTS_VALUE
+    int64_t startTimeRealtime = AV_NOPTS_VALUE;
+
+    int64_t startTime = AV_NOPTS_VALUE;
+
+    /// 直播边缘，秒
+    std::atomic<double> liveEdge;
+
+    /// 平滑后的延时，秒，NAN表示还没有计算
+    std::atomic<double> latency;
+
+    /// 端到端延时，秒
+    double endToEndLatency = NAN;
+
+    std::atomic<double> speed;
+
+    std::atomic<bool> resetRequest;
+
+    double lastCheckTime = 0;
+
+    double lastNotifyTime = 0;
+
+    double lastDropTime = 0;
+
+    /// 统计追赶和丢弃的次数
+    int catchUpCount = 0;
+
+    int dropCount = 0;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef ENGINE_LOCAL_FILE_IO_H
+#define ENGINE_LOCAL_FILE_IO_H
+
+#include <string>
+#include "Log.h"
+#include "Errors.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/avstring.h>
+};
+
+/// 内存映射时AVIOContext的缓冲大小，大块读取直接从映射内存复制
+#define LOCAL_FILE_MAP_BUFFER_SIZE                  (64 * 1024)
+
+/// 不能映射时每次pread的大小
+#define LOCAL_FILE_READ_BUFFER_SIZE                 (512 * 1024)
+
+/// 修改时间超过该值的文件才映射，正在写入的文件被截断时读取映射会触发SIGBUS，秒
+#define LOCAL_FILE_STABLE_TIME                      10
+
+/**
+ * 本地文件读取
+ * 替换FFmpeg的file协议，优先把整个文件只读映射到内存，读取时只有一次内存复制，没有系统调用；
+ * 映射失败(比如32位进程中的超大文件)或者文件正在写入时使用大块pread，并通过posix_fadvise提示内核顺序预读
+ * 读到结尾时重新获取文件大小，正在录制的文件继续读取新写入的数据，超出映射范围的部分使用pread
+ * 只在读包线程中使用
+ */
+class LocalFileIO {
+
+    const char *const TAG = "[MP][NATIVE][LocalFileIO]";
+
+public:
+
+    LocalFileIO();
+
+    virtual ~LocalFileIO();
+
+    // 是否本地文件
+    static bool isSupported(const char *url);
+
+    // 打开文件并设置为formatContext的自定义IO
+    int openInput(AVFormatContext *formatContext, const char *url);
+
+    // 关闭文件，需要在avformat_close_input之后调用
+    void closeInput();
+
+private:
+
+    int read(uint8_t *buf, int size);
+
+    int64_t seek(int64_t offset, int whence);
+
+    // 重新获取文件大小，文件增长或者被截断时更新
+    int64_t updateSize();
+
+    static int readPacket(void *opaque, uint8_t *buf, int size);
+
+    static int64_t seekPacket(void *opaque, int64_t offset, int whence);
+
+private:
+
+    std::string path;
+
+    int fd = -1;
+
+    /// 映射的文件内容，为空时使用pread
+    uint8_t *data = nullptr;
+
+    int64_t size = 0;
+
+    /// 映射的长度，文件增长之后超出的部分使用pread
+    int64_t mappedSize = 0;
+
+    /// 当前读取位置
+    int64_t position = 0;
+
+    AVIOContext *ioContext = nullptr;
+
+    /// 读取统计，read_packet调用次数、实际的read系统调用次数和读取的字节数
+    int64_t readCount = 0;
+
+    int64_t syscallCount = 0;
+
+    int64_t readBytes = 0;
+};
+
+#endif
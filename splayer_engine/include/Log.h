@@ -94,6 +94,8 @@ LOG_MUTEX->unlock(); \
 
 #else
 
+#include <stdio.h>
+
 #define _ALOGD(TAG, ...) (void)printf(__VA_ARGS__);
 #define _ALOGI(TAG, ...) (void)printf(__VA_ARGS__);
 #define _ALOGE(TAG, ...) (void)printf(__VA_ARGS__);
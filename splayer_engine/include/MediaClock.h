@@ -2,6 +2,7 @@
 #define ENGINE_MEDIACLOCK_H
 
 #include <math.h>
+#include <atomic>
 #include "PlayerInfoStatus.h"
 
 extern "C" {
@@ -15,7 +16,7 @@ public:
 
     virtual ~MediaClock();
 
-    void init(int *queueSeekSerial);
+    void init(std::atomic<int> *queueSeekSerial);
 
     // 获取时钟
     double getClock();
@@ -64,7 +65,7 @@ private:
     int seekSerial;
 
     /// 指向当前包队列串行的指针，用于过时的时钟检测
-    int *queueSerial;
+    std::atomic<int> *queueSerial;
 };
 
 
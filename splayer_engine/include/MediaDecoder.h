@@ -1,12 +1,15 @@
 #ifndef ENGINE_MEDIA_DECODER_H
 #define ENGINE_MEDIA_DECODER_H
 
-#include "Thread.h"
+#include <atomic>
+#include "ThreadPool.h"
 #include "Log.h"
 #include "PlayerInfoStatus.h"
 #include "PacketQueue.h"
 #include "FrameQueue.h"
+#include "FrameBufferPool.h"
 #include "MessageCenter.h"
+#include "Event.h"
 
 class MediaDecoder : public Runnable {
     const char *const TAG = "[MP][NATIVE][MediaDecoder]";
@@ -17,7 +20,7 @@ public:
                  int streamIndex,
                  PlayerInfoStatus *playerState,
                  AVPacket *flushPacket,
-                 Condition *readWaitCond,
+                 Event *readEvent,
                  AVDictionary *opts,
                  MessageCenter *messageCenter);
 
@@ -59,6 +62,9 @@ public:
 
     void setStartPtsTb(const AVRational &startPtsTb);
 
+    // 设置精确定位的目标时间，需要在放入刷新包之前调用
+    void setSeekTarget(int64_t seekTarget);
+
     int notifyMsg(int what);
 
     int notifyMsg(int what, int arg1);
@@ -91,8 +97,8 @@ protected:
     /// 刷新包
     AVPacket *flushPacket = nullptr;
 
-    /// 流读取通知
-    Condition *readWaitCond = nullptr;
+    /// 读包事件，取出数据包或者解码结束时通知读包线程
+    Event *readEvent = nullptr;
 
     /// 发送解码失败，延迟处理数据包
     bool isPendingPacket;
@@ -117,7 +123,30 @@ protected:
 
     MessageCenter *messageCenter = nullptr;
 
+    /// 精确定位的目标时间，微秒，AV_NOPTS_VALUE表示不需要精确定位
+    std::atomic<int64_t> seekTarget;
+
+    /// 解码线程处理刷新包时取出的定位目标，到达之前丢弃解码出的帧
+    int64_t accurateSeekPts = AV_NOPTS_VALUE;
+
+    /// 开始精确定位的时间，微秒
+    int64_t accurateSeekStart = 0;
+
+    /// 精确定位期间丢弃的帧数量
+    int accurateSeekDrops = 0;
+
+protected:
+
+    // 处理刷新包时开始精确定位
+    void startAccurateSeek();
 
+    /**
+     * 帧是否在定位目标之前，目标帧到达时结束精确定位
+     * @param pts 帧时间戳，微秒
+     * @param duration 帧时长，微秒
+     * @return 在目标之前，需要丢弃
+     */
+    bool isBeforeSeekTarget(int64_t pts, int64_t duration);
 };
 
 
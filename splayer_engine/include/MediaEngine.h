@@ -0,0 +1,57 @@
+#ifndef ENGINE_MEDIA_ENGINE_H
+#define ENGINE_MEDIA_ENGINE_H
+
+#include "Mutex.h"
+#include "ThreadPool.h"
+#include "Log.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+};
+
+/// 引擎统计信息，多实例运行时观察资源占用
+typedef struct EngineStats {
+    /// 播放器实例数量
+    int instanceCount;
+    /// 线程池工作线程数量
+    int poolSize;
+    /// 线程池中正在执行任务的线程数量
+    int activeCount;
+    /// 进程线程数量，不支持时为-1
+    int processThreads;
+    /// 进程常驻内存，KB，不支持时为-1
+    int64_t processRss;
+} EngineStats;
+
+/**
+ * 多个播放器实例共享的引擎全局资源
+ * FFmpeg网络模块在第一个实例创建时初始化，最后一个实例销毁时反初始化
+ * 工作线程由ThreadPool复用，实例销毁之后线程留给下一个实例，同时播放的实例仍然各自占用工作线程
+ */
+class MediaEngine {
+
+public:
+
+    // 播放器实例创建时调用
+    static int acquire();
+
+    // 播放器实例销毁时调用
+    static int release();
+
+    // 所有播放器实例销毁之后调用，回收线程池的工作线程
+    static int shutdown();
+
+    static int getInstanceCount();
+
+    static void getStats(EngineStats *stats);
+
+    static void dumpStats(const char *tag);
+
+private:
+
+    static Mutex mutex;
+
+    static int instanceCount;
+};
+
+#endif
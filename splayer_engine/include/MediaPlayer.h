@@ -3,6 +3,8 @@
 
 class Stream;
 
+#include <atomic>
+#include <ctime>
 #include "Stream.h"
 #include "MediaClock.h"
 #include "PlayerInfoStatus.h"
@@ -12,6 +14,7 @@ class Stream;
 #include "VideoDevice.h"
 #include "MediaSync.h"
 #include "AudioResample.h"
+#include "StreamPreloader.h"
 #include "Log.h"
 #include "MessageCenter.h"
 #include "IStreamListener.h"
@@ -22,12 +25,6 @@ class MediaPlayer : public ISyncMediaPlayer, IMediaPlayer, IStreamListener {
 
     const char *const TAG = "[MP][NATIVE][MediaPlayer]";
 
-    const char *const OPT_LOW_RESOLUTION = "lowResolution";
-
-    const char *const OPT_THREADS = "threads";
-
-    const char *const OPT_REF_COUNTED_FRAMES = "refcounted_frames";
-
 protected:
 
     Mutex mutex;
@@ -35,7 +32,7 @@ protected:
     Condition condition;
 
     /// 播放器状态
-    PlayerStatus playerStatus = IDLED;
+    std::atomic<PlayerStatus> playerStatus{IDLED};
 
     /// 播放器信息状态
     PlayerInfoStatus *playerInfoStatus = nullptr;
@@ -70,6 +67,20 @@ protected:
     /// 消息监听回调
     IMessageListener *messageListener = nullptr;
 
+    /// 下一个媒体的预加载
+    StreamPreloader *streamPreloader = nullptr;
+
+    /// 拖动结束后是否恢复播放
+    bool scrubResume = false;
+
+    /// 拖动的最后位置，微秒
+    int64_t scrubPosition = AV_NOPTS_VALUE;
+
+    /// 开始拖动的时间和进程CPU时间，用于统计
+    int64_t scrubStartTime = 0;
+
+    clock_t scrubStartCpu = 0;
+
 public:
     MediaPlayer();
 
@@ -89,8 +100,21 @@ public:
 
     int setDataSource(const char *url, int64_t offset = 0, const char *headers = nullptr);
 
+    int prepareNext(const char *url, int64_t offset = 0, const char *headers = nullptr);
+
+    StreamPreloader *getStreamPreloader();
+
     int seekTo(float timeMs);
 
+    // 开始拖动进度，拖动期间暂停播放，只解码并显示关键帧
+    int startScrub();
+
+    // 拖动到指定位置，毫秒，只保留最新的位置
+    int scrubTo(int64_t positionMs);
+
+    // 结束拖动，精确定位到最后的位置并恢复拖动前的播放状态
+    int stopScrub();
+
     void setLooping(int looping);
 
     void setVolume(float leftVolume, float rightVolume);
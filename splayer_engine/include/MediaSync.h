@@ -7,6 +7,8 @@
 #include "AudioDecoder.h"
 #include "VideoDevice.h"
 #include "MessageCenter.h"
+#include "LatencyController.h"
+#include "DisplayClock.h"
 
 /**
  * 视频同步器
@@ -53,6 +55,10 @@ public:
 
     MediaClock *getExternalClock();
 
+    LatencyController *getLatencyController();
+
+    DisplayClock *getDisplayClock();
+
     void setPlayerInfoStatus(PlayerInfoStatus *playerState);
 
     int togglePause();
@@ -65,8 +71,15 @@ public:
 
     void resetRemainingTime();
 
+    // 等待到下一次刷新的时间之后刷新，用于独立的同步线程
     int refreshVideo();
 
+    // 立即刷新，不等待，调用者按getRemainingTime自己等待(比如SDL等待事件)
+    int updateVideo();
+
+    // 距离下一次刷新的时间，秒
+    double getRemainingTime();
+
     void setForceRefresh(int forceRefresh);
 
     void setMessageCenter(MessageCenter *pMessageCenter);
@@ -112,6 +125,12 @@ protected:
     /// 外部时钟
     MediaClock *externalClock = nullptr;
 
+    /// 直播低延时控制
+    LatencyController *latencyController = nullptr;
+
+    /// 显示时钟
+    DisplayClock *displayClock = nullptr;
+
     /// 视频解码器
     VideoDecoder *videoDecoder = nullptr;
 
@@ -130,15 +149,12 @@ protected:
     /// 视频时钟
     double frameTimer;
 
+    /// 以视频为主时钟时低延时模式的播放速度，按速度缩短帧的显示时长
+    double videoSpeed = 1.0;
+
     /// 视频输出设备
     VideoDevice *videoDevice = nullptr;
 
-    AVFrame *frameARGB = nullptr;
-
-    uint8_t *buffer = nullptr;
-
-    SwsContext *swsContext = nullptr;
-
     /// 帧间隔时间
     double remainingTime = 0.0;
 
@@ -1,7 +1,7 @@
 #ifndef ENGINE_MESSAGE_CENTER_H
 #define ENGINE_MESSAGE_CENTER_H
 
-#include "Thread.h"
+#include "ThreadPool.h"
 #include "IMessageListener.h"
 #include "MessageQueue.h"
 #include "IMediaPlayer.h"
@@ -17,7 +17,7 @@ private:
 
     bool abortRequest = false;
 
-    Thread *msgThread = nullptr;
+    ThreadTask *msgThread = nullptr;
 
     IMediaPlayer *mediaPlayer = nullptr;
 
@@ -54,8 +54,6 @@ public:
 
     int notifyMsg(int what, int arg1, int arg2);
 
-    int removeMsg(int what);
-
     void executeMsg(bool block);
 
     PlayerStatus getStatus(int arg);
@@ -1,31 +1,94 @@
 #ifndef ENGINE_MESSAGE_QUEUE_H
 #define ENGINE_MESSAGE_QUEUE_H
 
-#include <list>
-#include <queue>
+#include <atomic>
 #include "Mutex.h"
 #include "Condition.h"
+#include "Event.h"
 #include "Log.h"
 #include "Msg.h"
 #include "IMessageListener.h"
 
-using namespace std;
-
+/// 消息队列容量，必须是2的幂
+#define MSG_QUEUE_SIZE                              256
+
+/// 可合并的消息类型数量上限
+#define MSG_COALESCE_SIZE                           8
+
+/// 溢出队列容量，在创建时分配，溢出队列也满时丢弃消息
+#define MSG_OVERFLOW_SIZE                           256
+
+/// 消息队列的存储单元
+typedef struct MsgCell {
+    /// 序号，用于判断单元是否可写或者可读
+    std::atomic<size_t> sequence;
+    Msg msg;
+} MsgCell;
+
+/// 可合并的消息，同类型的消息在被处理之前只保留最新的参数
+typedef struct CoalesceMsg {
+    int what;
+    /// 是否已经有一条该类型的消息在队列中
+    std::atomic<bool> pending;
+    /// 两个整型参数放在一个原子变量中，保证读到的是同一次投递的参数
+    std::atomic<int64_t> argsI;
+    std::atomic<float> arg1F;
+} CoalesceMsg;
+
+/**
+ * 固定容量的多生产者单消费者无锁消息队列
+ * 消息内联存储在队列中，投递不分配内存，可合并消息的标志和参数也是原子变量，不加锁
+ * 队列满时消息放入预先分配的溢出队列，溢出队列清空之前的消息都进入溢出队列，保证顺序
+ * 溢出队列由锁保护，只在队列满这种少见的路径上加锁
+ * 消费者为MessageCenter线程，队列为空时在事件上等待
+ */
 class MessageQueue {
 
     const char *const TAG = "[MP][NATIVE][MsgCenter]";
 
 private:
 
+    /// 消息存储单元
+    MsgCell *cells = nullptr;
+
+    /// 下一个写入位置
+    std::atomic<size_t> enqueuePos;
+
+    /// 下一个读取位置，只有消费者访问
+    size_t dequeuePos;
+
+    /// 消息事件
+    Event event;
+
+    /// 保护溢出队列
     Mutex mutex;
 
-    Condition condition;
+    /// 可合并的消息
+    CoalesceMsg coalesceMsgs[MSG_COALESCE_SIZE];
+
+    int coalesceSize = 0;
+
+    /// 队列满时的溢出队列，环形存储
+    Msg *overflowMsgs = nullptr;
+
+    /// 溢出队列的读取位置，只在锁内访问
+    int overflowHead = 0;
 
-    list<Msg *> *queue = nullptr;
+    std::atomic<int> overflowSize;
 
 private:
 
-    int _putMsg(Msg *msg);
+    int _putMsg(const Msg *msg);
+
+    bool _getMsg(Msg *msg);
+
+    // 读取下一条消息，先读环形队列再读溢出队列
+    bool _nextMsg(Msg *msg);
+
+    // 写入溢出队列
+    int putOverflowMsg(const Msg *msg);
+
+    CoalesceMsg *findCoalesceMsg(int what);
 
 public:
 
@@ -37,12 +100,16 @@ public:
 
     int getMsg(Msg *msg, bool block);
 
-    int removeMsg(int what);
-
     int clearMsgQueue(IMessageListener *pListener);
 
     int startMsgQueue();
 
+    // 唤醒等待中的消费者
+    void wakeUp();
+
+    // 设置可合并的消息类型，需要在投递消息之前设置
+    int addCoalesceMsg(int what);
+
     int notifyMsg(int what);
 
     int notifyMsg(int what, int arg1);
@@ -124,6 +124,27 @@ public:
     /// 当前时钟
     static const int MSG_CURRENT_POSITION = 1021;
 
+    /// 打开耗时，arg1为阶段OPEN_STAGE_*，arg2为耗时(毫秒)
+    static const int MSG_OPEN_TIMING = 1022;
+
+    /// 打开文件(avformat_open_input)
+    static const int OPEN_STAGE_INPUT = 0;
+
+    /// 查找媒体流信息(avformat_find_stream_info或者命中缓存)
+    static const int OPEN_STAGE_STREAM_INFO = 1;
+
+    /// 读到首个数据包，从开始打开媒体算起
+    static const int OPEN_STAGE_FIRST_PACKET = 2;
+
+    /// 多码率切换完成，arg1为码率(kbps)，arg2为视频高度
+    static const int MSG_VARIANT_CHANGED = 1023;
+
+    /// 直播低延时模式定期上报，arg1为延时(毫秒)，arg2为播放速度的百分比
+    static const int MSG_LIVE_LATENCY = 1024;
+
+    /// 解码器打开，arg1为流索引，arg2为实际使用的解码线程数量
+    static const int MSG_DECODER_THREADS = 1025;
+
     /////////////////////////////////////////////
     /////////////////////////////////////////////
     ///  请求消息范围 20000 ~ 29999
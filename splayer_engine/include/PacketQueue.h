@@ -1,7 +1,7 @@
 #ifndef ENGINE_PACKETQUEUE_H
 #define ENGINE_PACKETQUEUE_H
 
-#include <queue>
+#include <atomic>
 #include "Mutex.h"
 #include "Condition.h"
 #include "Log.h"
@@ -10,14 +10,34 @@ extern "C" {
 #include <libavcodec/avcodec.h>
 };
 
+/// 节点池初始容量
+#define PACKET_POOL_INIT_SIZE                       64
+
+/// 节点池每次扩容的节点数量
+#define PACKET_POOL_GROW_SIZE                       64
+
 typedef struct PacketData {
     AVPacket pkt;
-    struct PacketData *next;
+    std::atomic<PacketData *> next;
     int serial;
 } PacketData;
 
+/// 节点池内存块，每次扩容分配一块，队列销毁时统一释放
+typedef struct PacketBlock {
+    PacketData *packets;
+    struct PacketBlock *next;
+} PacketBlock;
+
 /**
  * 备注：这里不用std::queue是为了方便计算队列占用内存和队列的时长，在解码的时候要用到
+ * 队列节点从队列自有的节点池中获取，出队后归还到节点池，稳定播放时不再调用内存分配器
+ *
+ * 单生产者单消费者无锁队列：
+ * 生产者为Stream的读包线程，调用pushPacket/putNullPacket/flush/start
+ * 消费者为解码线程，调用getPacket
+ * 入队出队只操作原子变量，消费者仅在队列为空时才在condition上等待
+ * 包数量、内存大小和时长由生产者和消费者各自累加，查询时相减，不需要加锁
+ * 刷新之后包数量和时长立即归零，内存大小在消费者丢弃数据包之后才减少
  */
 class PacketQueue {
 
@@ -34,7 +54,7 @@ public:
     // 入队空数据包
     int putNullPacket(int stream_index);
 
-    // 刷新
+    // 刷新，由生产者线程调用，已入队的数据包由消费者出队时丢弃
     void flush();
 
     // 终止
@@ -51,6 +71,7 @@ public:
 
     int getPacketSize();
 
+    // 占用内存大小，包括刷新之后还没有释放的数据包
     int getSize();
 
     int64_t getDuration();
@@ -59,44 +80,98 @@ public:
 
     int getLastSeekSerial();
 
-    int *getPointLastSeekSerial();
+    std::atomic<int> *getPointLastSeekSerial();
 
     int getFirstSeekSerial();
 
     int signal();
 
+    /// 节点池容量
+    int getPoolSize();
+
+    /// 节点池使用峰值
+    int getPoolHighWaterMark();
+
 private:
     int put(AVPacket *pkt);
 
+    // 取出一个未被刷新的数据包，只在消费者线程调用
+    bool take(AVPacket *pkt);
+
+    // 唤醒等待中的消费者
+    void wakeConsumer();
+
+    PacketData *obtainPacketData();
+
+    void recyclePacketData(PacketData *packetData);
+
+    void growPool(int size);
+
+    void releasePool();
+
 private:
 
     Mutex mutex;
 
     Condition condition;
 
-    PacketData *firstPacket;
-
+    /// 队尾节点，只有生产者访问
     PacketData *lastPacket;
 
-    /// 包数量，也就是队列元素数量
-    int packetSize;
+    /// 已出队的哨兵节点，消费者写入，生产者读取后回收其之前的节点
+    std::atomic<PacketData *> firstPacket;
+
+    /// 可回收节点的起始位置，只有生产者访问
+    PacketData *recyclePacket;
 
-    /// 占用内存大小
-    int memorySize;
+    /// 生产者最近一次读取到的firstPacket
+    PacketData *recycleLimit;
 
-    /// 持续时长
-    int64_t duration;
+    /// 入队累计的包数量、内存大小和时长，只有生产者写入
+    std::atomic<int64_t> pushPacketSize;
+
+    std::atomic<int64_t> pushMemorySize;
+
+    std::atomic<int64_t> pushDuration;
+
+    /// 出队累计的包数量、内存大小和时长，只有消费者写入
+    std::atomic<int64_t> popPacketSize;
+
+    std::atomic<int64_t> popMemorySize;
+
+    std::atomic<int64_t> popDuration;
+
+    /// 刷新时的入队累计值，出队累计值小于它的数据包都需要丢弃
+    /// 内存大小不记录刷新值，丢弃的数据包释放之前仍然计入
+    std::atomic<int64_t> flushPacketSize;
+
+    std::atomic<int64_t> flushDuration;
+
+    /// 消费者是否在condition上等待
+    std::atomic<bool> waiting;
 
     /// 用户退出请求标志
-    bool abortRequest;
+    std::atomic<bool> abortRequest;
 
     /// 序列，seek时使用，向PacketQueue中存储Packet时，被更新为队尾的seekSerial
-    int lastSeekSerial;
+    std::atomic<int> lastSeekSerial;
 
     /// 序列，seek时使用，从PacketQueue从获取Packet时，被更新为队首的seekSerial
-    int firstSeekSerial = -1;
+    std::atomic<int> firstSeekSerial;
 
     AVPacket *flushPacket;
+
+    /// 空闲节点链表
+    PacketData *freePacket = nullptr;
+
+    /// 节点池内存块链表
+    PacketBlock *packetBlock = nullptr;
+
+    /// 节点池容量
+    std::atomic<int> poolSize;
+
+    /// 节点池使用峰值
+    std::atomic<int> poolHighWaterMark;
 };
 
 
@@ -1,6 +1,7 @@
 #ifndef  ENGINE_PLAYER_STATE_H
 #define  ENGINE_PLAYER_STATE_H
 
+#include <atomic>
 #include "Mutex.h"
 #include "Condition.h"
 #include "Thread.h"
@@ -18,15 +19,46 @@ extern "C" {
 #include <libswscale/swscale.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/avstring.h>
+#include <libavutil/cpu.h>
 };
 
 
+/// 以下为队列参数的默认值，可以通过播放器参数修改
+/// 视频帧队列长度，参数videoQueueSize
 #define VIDEO_QUEUE_SIZE                            3
-#define AUDIO_QUEUE_SIZE                           9
+/// 音频帧队列长度，参数audioQueueSize
+#define AUDIO_QUEUE_SIZE                            9
 
+/// 数据包队列最大内存，参数maxQueueSize
 #define MAX_QUEUE_SIZE                              (15 * 1024 * 1024)
+/// 数据包队列最少包数量，参数minFrames
 #define MIN_FRAMES                                  25
-#define FRAME_QUEUE_SIZE                            10
+/// 帧队列最大内存，0表示不限制，参数maxFrameQueueSize
+#define MAX_FRAME_QUEUE_SIZE                        0
+
+/// 解码线程数量，0表示根据分辨率、CPU核数和是否实时流自动选择，参数videoDecodeThreads/audioDecodeThreads
+#define DECODE_THREADS_AUTO                         0
+/// 解码线程模式，0表示自动选择，否则为FF_THREAD_FRAME/FF_THREAD_SLICE，参数videoThreadType/audioThreadType
+#define DECODE_THREAD_TYPE_AUTO                     0
+
+/// 网络流磁盘缓存容量上限，参数cacheMaxSize，缓存目录参数cacheDir为空时不使用缓存
+#define CACHE_MAX_SIZE                              (512 * 1024 * 1024LL)
+
+/// 预加载下一个媒体时读取的数据包时长，毫秒，参数preloadDuration
+#define PRELOAD_DURATION                            5000
+
+/// 快速起播，参数fastStart，打开时复用缓存的媒体流信息，没有缓存时使用较小的探测参数
+#define FAST_START                                  0
+
+/// HLS多码率自适应，参数adaptiveBitrate，根据带宽和缓冲切换码率
+#define ADAPTIVE_BITRATE                            1
+
+/// 直播低延时模式，参数lowLatency，减小探测和缓冲，延时超过目标时加速追赶
+#define LOW_LATENCY                                 0
+/// 低延时模式的目标延时，毫秒，参数targetLatency
+#define LOW_LATENCY_TARGET                          1000
+/// 低延时模式的最大延时，毫秒，超过时丢弃数据包，参数maxLatency
+#define LOW_LATENCY_MAX                             5000
 
 /// 最小音频缓冲
 /// Minimum SDL audio buffer size, in samples.
@@ -114,12 +146,17 @@ public:
 
     void setOptionLong(int category, const char *type, int64_t option);
 
+    // 复制打开媒体和解码器使用的参数，用于预加载，需要持有播放器的锁
+    void copyOpenOptions(PlayerInfoStatus *playerState);
+
 private:
 
     void init();
 
     void parse_string(const char *type, const char *option);
 
+    int parse_thread_type(const char *option);
+
 public:
     void setFormatContext(AVFormatContext *formatContext);
 
@@ -238,6 +275,22 @@ public:
     /// 定位偏移
     int64_t seekRel;
 
+    /// 精确定位请求，只对下一次定位生效
+    volatile int accurateSeekRequest;
+
+    /// 是否正在拖动进度
+    volatile int scrubbing;
+
+    /// 拖动的最新目标，微秒，读包线程取走后置为AV_NOPTS_VALUE
+    std::atomic<int64_t> scrubTarget;
+
+    /// 拖动期间的请求次数、实际定位次数、显示的帧数
+    std::atomic<int> scrubRequests;
+
+    std::atomic<int> scrubSeeks;
+
+    std::atomic<int> scrubFrames;
+
     /// 结束播放时自动退出
     /// exit at the end
     int autoExit;
@@ -276,6 +329,59 @@ public:
     /// 音频流索引
     int audioIndex;
 
+    /// 视频帧队列长度
+    int videoQueueSize;
+
+    /// 音频帧队列长度
+    int audioQueueSize;
+
+    /// 数据包队列最大内存
+    int64_t maxQueueSize;
+
+    /// 数据包队列最少包数量
+    int minFrames;
+
+    /// 帧队列最大内存，0表示不限制
+    int64_t maxFrameQueueSize;
+
+    /// 视频解码线程数量，0表示自动
+    int videoDecodeThreads;
+
+    /// 音频解码线程数量，0表示自动
+    int audioDecodeThreads;
+
+    /// 视频解码线程模式，0表示自动
+    int videoThreadType;
+
+    /// 音频解码线程模式，0表示自动
+    int audioThreadType;
+
+    /// 网络流磁盘缓存目录，为空时不使用缓存
+    char *cacheDir = nullptr;
+
+    /// 网络流磁盘缓存容量上限
+    int64_t cacheMaxSize;
+
+    /// 预加载下一个媒体时读取的数据包时长，毫秒
+    int64_t preloadDuration;
+
+    /// 快速起播
+    int fastStart;
+
+    /// 精确定位，定位后丢弃目标之前的帧，到达目标前只解码参考帧
+    int accurateSeek;
+
+    /// HLS多码率自适应
+    int adaptiveBitrate;
+
+    /// 直播低延时模式
+    int lowLatency;
+
+    /// 低延时模式的目标延时和最大延时，毫秒
+    int64_t targetLatency;
+
+    int64_t maxLatency;
+
     const char *getSyncType();
 
     void setAbortRequest(int abortRequest);
@@ -0,0 +1,125 @@
+#ifndef ENGINE_PROBE_CACHE_H
+#define ENGINE_PROBE_CACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Mutex.h"
+#include "Log.h"
+#include "FFmpegUtils.h"
+
+extern "C" {
+#include <libavutil/avstring.h>
+};
+
+/// 最多缓存的媒体数量，超过时淘汰最久未使用的
+#define PROBE_CACHE_MAX_ENTRIES                     32
+
+/// 快速探测时读取的最大字节数
+#define FAST_PROBE_SIZE                             (512 * 1024)
+
+/// 快速探测时分析的最大时长，微秒
+#define FAST_ANALYZE_DURATION                       (AV_TIME_BASE / 2)
+
+/// 快速探测时用于计算帧率的帧数
+#define FAST_FPS_PROBE_SIZE                         5
+
+/**
+ * 缓存的媒体流信息
+ */
+class ProbeEntry {
+
+public:
+
+    struct StreamInfo {
+        AVCodecParameters *codecpar;
+        AVRational avgFrameRate;
+        AVRational rFrameRate;
+        AVRational sampleAspectRatio;
+        int64_t duration;
+        int64_t startTime;
+    };
+
+    ProbeEntry();
+
+    virtual ~ProbeEntry();
+
+public:
+
+    /// 解复用器名称
+    std::string formatName;
+
+    int64_t duration = AV_NOPTS_VALUE;
+
+    int64_t startTime = AV_NOPTS_VALUE;
+
+    int64_t bitRate = 0;
+
+    std::vector<StreamInfo> streams;
+
+    /// 最近使用的序号，用于淘汰
+    int64_t lastUsed = 0;
+};
+
+/**
+ * 媒体流信息缓存
+ * 以地址和偏移量为键(本地文件加上文件大小和修改时间)，保存avformat_find_stream_info得到的编码参数、
+ * 流布局和时长，再次打开同一媒体时直接恢复，跳过探测
+ * 没有缓存时使用较小的probesize/analyzeduration探测，参数不完整时再按默认值继续探测
+ */
+class ProbeCache {
+
+    const char *const TAG = "[MP][NATIVE][ProbeCache]";
+
+public:
+
+    static ProbeCache *getInstance();
+
+    /**
+     * 查找媒体流信息
+     * @param formatContext 已经打开的解复用上下文
+     * @param url
+     * @param offset
+     * @param codecOpts
+     * @param fastStart 是否使用缓存和快速探测
+     * @param hit 是否命中缓存
+     * @return avformat_find_stream_info的返回值
+     */
+    int findStreamInfo(AVFormatContext *formatContext, const char *url, int64_t offset,
+                       AVDictionary *codecOpts, bool fastStart, bool *hit);
+
+    void clear();
+
+private:
+
+    ProbeCache();
+
+    virtual ~ProbeCache();
+
+    std::string getKey(const char *url, int64_t offset);
+
+    // 媒体能否缓存，实时流和HLS的流信息每次打开都可能不同
+    bool isCacheable(AVFormatContext *formatContext);
+
+    // 恢复缓存的流信息，流布局和缓存不一致时返回false
+    bool restore(const std::string &key, AVFormatContext *formatContext);
+
+    void store(const std::string &key, AVFormatContext *formatContext);
+
+    // 快速探测，参数不完整时按原来的探测大小继续
+    int probe(AVFormatContext *formatContext, AVDictionary *codecOpts, bool fastStart);
+
+    static int doFindStreamInfo(AVFormatContext *formatContext, AVDictionary *codecOpts);
+
+    static bool hasCodecParameters(AVCodecParameters *codecpar);
+
+private:
+
+    Mutex mutex;
+
+    std::map<std::string, ProbeEntry *> entries;
+
+    int64_t useCount = 0;
+};
+
+#endif
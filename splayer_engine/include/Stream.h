@@ -4,32 +4,31 @@
 class MediaPlayer;
 
 #include "MediaPlayer.h"
-#include "Thread.h"
+#include "ThreadPool.h"
+#include "MediaEngine.h"
 #include "PlayerInfoStatus.h"
 #include "AudioDecoder.h"
 #include "VideoDecoder.h"
 #include "MediaSync.h"
 #include "IStreamListener.h"
+#include "Event.h"
+#include "StreamOpener.h"
+#include "StreamPreloader.h"
+#include "KeyframeIndex.h"
+#include "AdaptiveBitrate.h"
 
 class Stream : public Runnable {
 
     const char *const TAG = "[MP][NATIVE][Stream]";
 
-    const char *const OPT_SCALL_ALL_PMTS = "scan_all_pmts";
-
-    const char *const OPT_HEADERS = "headers";
-
     const char *const FORMAT_OGG = "ogg";
 
-    const char *const FORMAT_RTMP = "rtmp";
-
-    const char *const FORMAT_RTSP = "rtsp";
-
-    const char *const OPT_KEY_TIMEOUT = "timeout";
+    /// 读包出错(非结尾)时立即重试的次数，超过之后等待读包事件
+    const int READ_RETRY_COUNT = 3;
 
 private:
     /// 读数据包线程
-    Thread *readThread = nullptr;
+    ThreadTask *readThread = nullptr;
 
     /// 播放器
     MediaPlayer *mediaPlayer = nullptr;
@@ -51,14 +50,43 @@ private:
     /// 解码上下文
     AVFormatContext *formatContext = nullptr;
 
+    /// 打开媒体的自定义IO和解码器参数，在解复用上下文关闭之后释放
+    StreamOpener *streamOpener = nullptr;
+
+    /// 视频关键帧索引，只用于原生索引不完善的格式
+    KeyframeIndex *keyframeIndex = nullptr;
+
+    /// HLS多码率自适应
+    AdaptiveBitrate *adaptiveBitrate = nullptr;
+
+    /// 预加载的数据包，读包时优先使用
+    std::deque<AVPacket> preloadPackets;
+
+    /// 预加载时打开的解码器，打开解码器时优先使用
+    std::vector<PreparedCodec> preparedCodecs;
+
+    /// 开始打开媒体的时间，微秒
+    int64_t openStartTime = 0;
+
+    /// 是否已经读到首个数据包
+    bool firstPacketRead = false;
+
+    /// 是否命中媒体流信息缓存
+    bool probeCacheHit = false;
+
+    /// 拖动时是否已经送入当前目标的关键帧
+    bool scrubKeyframeRead = false;
+
+    /// 低延时模式丢弃数据包之后等待视频关键帧
+    bool latencyKeyframeWait = false;
+
     /// 刷新的包,用于在SEEK时，刷新数据队列
     AVPacket flushPacket;
 
     IStreamListener *streamListener = nullptr;
 
-    Mutex waitMutex;
-
-    Condition waitCondition;
+    /// 读包事件，队列有空间、定位、暂停、退出时通知读包线程
+    Event readEvent;
 
     Mutex mutex;
 
@@ -86,7 +114,7 @@ public:
 
     void setMediaSync(MediaSync *mediaSync);
 
-    Condition *getWaitCondition();
+    Event *getReadEvent();
 
     AVPacket *getFlushPacket();
 
@@ -94,6 +122,9 @@ public:
 
     void setMessageCenter(MessageCenter *messageCenter);
 
+    // 打开解码器，优先使用预加载时打开的解码器
+    int openCodec(int streamIndex, AVCodecContext **codecContext, AVDictionary **opts);
+
 private:
 
     int readPackets();
@@ -104,6 +135,14 @@ private:
 
     int openStream();
 
+    int openInput();
+
+    int openPreparedInput();
+
+    int readFrame(AVPacket *pkt);
+
+    void clearPreloadPackets();
+
     int notifyMsg(int what);
 
     int notifyMsg(int what, int arg1);
@@ -112,6 +151,10 @@ private:
 
     void doSeek() ;
 
+    void doScrub();
+
+    void dropStalePackets();
+
     void doPause() const;
 
     int doAttachment() const;
@@ -119,6 +162,8 @@ private:
     void doRetryPlay();
 
     bool isNotReadMore() const;
+
+    int64_t getBufferDuration() const;
 };
 
 
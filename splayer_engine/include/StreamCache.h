@@ -0,0 +1,207 @@
+#ifndef ENGINE_STREAM_CACHE_H
+#define ENGINE_STREAM_CACHE_H
+
+#include <atomic>
+#include <map>
+#include <set>
+#include <string>
+#include "Mutex.h"
+#include "Log.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/avstring.h>
+};
+
+/// 缓存AVIOContext的读缓冲大小
+#define STREAM_CACHE_IO_BUFFER_SIZE                 (32 * 1024)
+
+/// 校验资源是否变化的HEAD请求超时，微秒
+#define STREAM_CACHE_VALIDATE_TIMEOUT               (3 * 1000 * 1000)
+
+/// HEAD请求最多跟随的重定向次数
+#define STREAM_CACHE_MAX_REDIRECTS                  3
+
+/// HEAD响应头的最大行长度
+#define STREAM_CACHE_MAX_LINE                       4096
+
+class StreamCache;
+
+/**
+ * 单个网络资源的磁盘缓存
+ * 数据保存在和资源等长的稀疏文件中，通过mmap读取，通过pwrite写入，磁盘已满时写入失败不会触发SIGBUS；
+ * 已下载的字节区间和资源的ETag/Last-Modified保存在索引文件中，重播时资源没有变化才复用
+ * 读取时优先从已下载区间返回，未命中时才从网络读取，读到的数据写入缓存并合并区间
+ * 只在读包线程中使用
+ */
+class CacheFile {
+
+    const char *const TAG = "[MP][NATIVE][CacheFile]";
+
+    friend class StreamCache;
+
+public:
+
+    /**
+     * @param validator 资源当前的ETag/Last-Modified，和索引中保存的不同时丢弃之前的缓存
+     * @param validate 是否校验validator，HLS分片的地址不会指向变化的内容，不校验
+     */
+    CacheFile(StreamCache *streamCache, AVIOContext *upstream, const std::string &path,
+              const std::string &validator, bool validate);
+
+    virtual ~CacheFile();
+
+private:
+
+    int open();
+
+    void close();
+
+    int read(uint8_t *buf, int size);
+
+    int64_t seek(int64_t offset, int whence);
+
+    // 通过pwrite写入从网络读到的数据，失败时返回ERROR并停止写入
+    int writeData(const uint8_t *buf, int64_t pos, int length);
+
+    // 从pos开始连续已缓存的字节数
+    int64_t getCachedLength(int64_t pos);
+
+    // pos之后第一个已缓存区间的起始位置
+    int64_t getNextCachedPos(int64_t pos);
+
+    void addRange(int64_t start, int64_t end);
+
+    // 读取索引，ETag/Last-Modified和当前资源不一致时返回false
+    bool loadIndex();
+
+    void saveIndex();
+
+    static int readPacket(void *opaque, uint8_t *buf, int size);
+
+    static int64_t seekPacket(void *opaque, int64_t offset, int whence);
+
+private:
+
+    StreamCache *streamCache = nullptr;
+
+    /// 网络数据源
+    AVIOContext *upstream = nullptr;
+
+    /// 提供给解复用器的AVIOContext
+    AVIOContext *ioContext = nullptr;
+
+    /// 数据文件路径，索引文件为路径加上.index
+    std::string path;
+
+    int fd = -1;
+
+    uint8_t *data = nullptr;
+
+    /// 资源大小
+    int64_t size = 0;
+
+    /// 当前读取位置
+    int64_t position = 0;
+
+    /// 已缓存的区间，起始位置 -> 结束位置
+    std::map<int64_t, int64_t> ranges;
+
+    /// 资源的ETag/Last-Modified
+    std::string validator;
+
+    bool validate = false;
+
+    /// 写入失败(磁盘已满等)之后不再写入，只读取已缓存的区间
+    bool writeFailed = false;
+};
+
+/**
+ * 网络流磁盘缓存
+ * 替换AVFormatContext的io_open/io_close，主输入和HLS分片等嵌套打开的资源都经过缓存，
+ * 大小未知、不能seek或者m3u8播放列表直接使用网络数据源
+ * 分片使用自定义的AVIOContext，HLS不能复用分片的http连接，打开时需要设置http_persistent为0
+ * 主输入打开时发送HEAD请求读取ETag/Last-Modified，和缓存时保存的不同时丢弃缓存
+ * 缓存目录中的文件按最近使用时间淘汰，总占用不超过maxSize
+ */
+class StreamCache {
+
+    const char *const TAG = "[MP][NATIVE][StreamCache]";
+
+    friend class CacheFile;
+
+public:
+
+    StreamCache(const char *cacheDir, int64_t maxSize);
+
+    virtual ~StreamCache();
+
+    // 是否可以使用缓存
+    static bool isSupported(const char *url);
+
+    // 单个资源是否缓存
+    static bool isCacheable(const char *url);
+
+    // 替换formatContext的io_open/io_close，主输入可以缓存时直接打开并使用自定义IO
+    int openInput(AVFormatContext *formatContext, const char *url, AVDictionary **options);
+
+    // 关闭主输入，需要在avformat_close_input之后调用
+    void closeInput();
+
+    /// 缓存命中的字节数
+    int64_t getHitBytes();
+
+    /// 从网络读取的字节数
+    int64_t getMissBytes();
+
+    // 资源在缓存目录中的数据文件路径，同一资源的其他缓存文件以它为前缀
+    static std::string getCachePath(const std::string &cacheDir, const char *url);
+
+private:
+
+    static int ioOpen(AVFormatContext *s, AVIOContext **pb, const char *url, int flags,
+                      AVDictionary **options);
+
+    static void ioClose(AVFormatContext *s, AVIOContext *pb);
+
+    int open(AVFormatContext *s, AVIOContext **pb, const char *url, int flags,
+             AVDictionary **options, bool validate);
+
+    /**
+     * 发送HEAD请求读取资源的ETag和Last-Modified，FFmpeg的http协议不导出这两个响应头
+     * @param upstream 已经打开的网络数据源，从中读取重定向之后的地址和请求头
+     * @return 两个响应头拼接的字符串，请求失败或者服务器都没有返回时为空
+     */
+    static std::string fetchValidator(AVFormatContext *s, AVIOContext *upstream, const char *url);
+
+    void close(AVIOContext *pb);
+
+    // 按最近使用时间淘汰缓存文件
+    void trim();
+
+private:
+
+    Mutex mutex;
+
+    std::string cacheDir;
+
+    int64_t maxSize;
+
+    /// 解复用上下文默认的打开和关闭回调
+    int (*defaultIoOpen)(AVFormatContext *s, AVIOContext **pb, const char *url, int flags,
+                         AVDictionary **options) = nullptr;
+
+    void (*defaultIoClose)(AVFormatContext *s, AVIOContext *pb) = nullptr;
+
+    /// 主输入
+    AVIOContext *inputContext = nullptr;
+
+    /// 正在使用的缓存文件路径，淘汰时跳过
+    std::set<std::string> openPaths;
+
+    std::atomic<int64_t> hitBytes;
+
+    std::atomic<int64_t> missBytes;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef ENGINE_STREAM_OPENER_H
+#define ENGINE_STREAM_OPENER_H
+
+#include <vector>
+#include "PlayerInfoStatus.h"
+#include "StreamCache.h"
+#include "LocalFileIO.h"
+#include "ProbeCache.h"
+#include "LatencyController.h"
+#include "FrameBufferPool.h"
+#include "FFmpegUtils.h"
+#include "Log.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/avstring.h>
+#include <libavutil/cpu.h>
+};
+
+/**
+ * 预先打开的解码器
+ */
+typedef struct PreparedCodec {
+    int streamIndex;
+    AVCodecContext *codecContext;
+    /// avcodec_open2没有使用的解码参数，和解码器一起交给AudioDecoder/VideoDecoder
+    AVDictionary *opts;
+} PreparedCodec;
+
+/**
+ * 打开媒体的公共步骤，Stream和StreamPreloader共用
+ * 按播放器参数设置解复用选项，网络流经过StreamCache磁盘缓存、本地文件经过LocalFileIO内存映射读取，
+ * 查找媒体流信息时使用ProbeCache，并按播放器参数创建和打开解码器
+ * 自定义IO跟随该对象，需要在解复用上下文关闭之后释放
+ */
+class StreamOpener {
+
+    const char *const TAG = "[MP][NATIVE][StreamOpener]";
+
+    const char *const OPT_SCALL_ALL_PMTS = "scan_all_pmts";
+
+    const char *const OPT_HEADERS = "headers";
+
+    const char *const OPT_HTTP_PERSISTENT = "http_persistent";
+
+    const char *const FORMAT_RTMP = "rtmp";
+
+    const char *const FORMAT_RTSP = "rtsp";
+
+    const char *const OPT_KEY_TIMEOUT = "timeout";
+
+    const char *const OPT_LOW_RESOLUTION = "lowResolution";
+
+    const char *const OPT_THREADS = "threads";
+
+    const char *const OPT_THREAD_TYPE = "thread_type";
+
+    const char *const OPT_REF_COUNTED_FRAMES = "refcounted_frames";
+
+public:
+
+    StreamOpener();
+
+    virtual ~StreamOpener();
+
+    // 打开媒体，formatContext需要已经设置中断回调，失败时formatContext被释放
+    int openInput(AVFormatContext **formatContext, PlayerInfoStatus *playerState);
+
+    // 查找媒体流信息
+    int findStreamInfo(AVFormatContext *formatContext, PlayerInfoStatus *playerState, bool *hit);
+
+    // 创建并打开解码器，失败时不返回解码上下文
+    int openCodec(AVFormatContext *formatContext, int streamIndex, PlayerInfoStatus *playerState,
+                  AVCodecContext **codecContext, AVDictionary **opts);
+
+    // 释放没有使用的预先打开的解码器
+    static void freePreparedCodecs(std::vector<PreparedCodec> *codecs);
+
+private:
+
+    void setupDecodeThreads(AVCodecContext *codecContext, AVCodec *codec,
+                            PlayerInfoStatus *playerState, AVDictionary **opts);
+
+private:
+
+    /// 网络流磁盘缓存
+    StreamCache *streamCache = nullptr;
+
+    /// 本地文件内存映射读取
+    LocalFileIO *localFileIO = nullptr;
+};
+
+#endif
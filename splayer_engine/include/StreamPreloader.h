@@ -0,0 +1,102 @@
+#ifndef ENGINE_STREAM_PRELOADER_H
+#define ENGINE_STREAM_PRELOADER_H
+
+#include <atomic>
+#include <deque>
+#include "ThreadPool.h"
+#include "PlayerInfoStatus.h"
+#include "StreamOpener.h"
+#include "FFmpegUtils.h"
+#include "Log.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/time.h>
+};
+
+/// 预加载的数据包最大内存
+#define PRELOAD_MAX_SIZE                            (5 * 1024 * 1024)
+
+/**
+ * 下一个媒体的预加载
+ * 在线程池中打开媒体、查找媒体流信息、打开解码器，并读取开头一段时长的数据包，
+ * 打开时和Stream使用同一个StreamOpener，同样经过磁盘缓存、内存映射和媒体流信息缓存，
+ * 切换到该媒体时Stream直接使用预加载的解复用上下文、解码器和数据包，不再等待网络、探测和解码器初始化
+ */
+class StreamPreloader : public Runnable {
+
+    const char *const TAG = "[MP][NATIVE][StreamPreloader]";
+
+    const char *const OPT_HEADERS = "headers";
+
+public:
+
+    StreamPreloader();
+
+    ~StreamPreloader() override;
+
+    // 开始预加载，之前的预加载结果被释放，options是播放器参数的副本，由预加载释放
+    int prepare(const char *url, int64_t offset, const char *headers, PlayerInfoStatus *options,
+                int64_t preloadDuration);
+
+    // 取出预加载结果，url和偏移量一致时返回SUCCESS
+    // 还在打开时等待打开完成，正在读包时读完当前数据包后停止，交出已经读到的数据包和打开的解码器
+    int take(const char *url, int64_t offset, AVFormatContext **formatContext,
+             StreamOpener **streamOpener, std::deque<AVPacket> *packets,
+             std::vector<PreparedCodec> *codecs);
+
+    // 取消预加载并释放结果
+    void cancel();
+
+    void run() override;
+
+private:
+
+    int openInput();
+
+    void openCodecs();
+
+    int readPackets();
+
+    void joinThread();
+
+    void release();
+
+    static int interruptCb(void *ctx);
+
+private:
+
+    Mutex mutex;
+
+    Condition condition;
+
+    ThreadTask *preloadThread = nullptr;
+
+    /// 正在锁外等待预加载线程结束
+    bool joining = false;
+
+    std::atomic<bool> abortRequest;
+
+    /// 切换到预加载的媒体，停止读包但保留结果
+    std::atomic<bool> stopRequest;
+
+    /// 预加载的url、偏移量和播放器参数的副本
+    PlayerInfoStatus *playerState = nullptr;
+
+    /// 预加载时长，微秒
+    int64_t preloadDuration = 0;
+
+    /// 预加载结果
+    int result = ERROR;
+
+    AVFormatContext *formatContext = nullptr;
+
+    StreamOpener *streamOpener = nullptr;
+
+    std::deque<AVPacket> packets;
+
+    /// 预先打开的解码器
+    std::vector<PreparedCodec> codecs;
+};
+
+#endif
@@ -27,6 +27,12 @@ typedef enum {
     FMT_YUYV422,
     FMT_UYVY422,
     FMT_YUVJ420P,
+    FMT_NV12,
+    FMT_NV21,
+    FMT_YUV422P,
+    FMT_YUV444P,
+    FMT_P010,
+    FMT_YUV420P10,
 } TextureFormat;
 
 /**
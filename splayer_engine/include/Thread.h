@@ -44,11 +44,12 @@ public:
 
     bool isActive() const;
 
+    // 设置当前线程的优先级
+    static int schedPriority(ThreadPriority priority);
+
 protected:
     static void *threadEntry(void *arg);
 
-    int schedPriority(ThreadPriority priority);
-
     virtual void run();
 
 protected:
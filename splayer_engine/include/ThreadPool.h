@@ -0,0 +1,132 @@
+#ifndef ENGINE_THREAD_POOL_H
+#define ENGINE_THREAD_POOL_H
+
+#include <vector>
+#include "Mutex.h"
+#include "Condition.h"
+#include "Thread.h"
+#include "Log.h"
+
+/// 核心线程数量，核心线程空闲时不退出
+#define THREAD_POOL_CORE_SIZE                       5
+
+/// 非核心线程空闲多久之后退出，纳秒
+#define THREAD_POOL_KEEP_ALIVE_TIME                 (60 * 1000 * 1000 * 1000LL)
+
+class ThreadPool;
+
+/**
+ * 线程池任务，接口和Thread保持一致：
+ * start把Runnable提交到线程池中执行，join等待Runnable执行结束
+ * Runnable通常是组件的循环，比如读包、解码、消息处理，执行期间独占一个工作线程，
+ * 循环不会把线程让回线程池，一个正在播放的实例占用读包、音视频解码、同步和消息处理大约5个工作线程
+ */
+class ThreadTask {
+
+    friend class ThreadPool;
+
+public:
+
+    ThreadTask(Runnable *runnable);
+
+    ThreadTask(Runnable *runnable, ThreadPriority priority);
+
+    virtual ~ThreadTask();
+
+    int start();
+
+    void join();
+
+    bool isActive();
+
+private:
+
+    void run();
+
+private:
+
+    Mutex mutex;
+
+    Condition condition;
+
+    Runnable *runnable;
+
+    ThreadPriority priority;
+
+    bool running;
+};
+
+/**
+ * 引擎全局的线程池
+ * 工作线程执行完任务之后不退出，等待下一个任务，打开新的媒体时不需要再创建线程
+ * 没有空闲线程时创建新的工作线程
+ * 线程池只节省线程的创建和销毁，不减少同时存在的线程数量：任务执行期间独占工作线程，
+ * N个同时播放的实例仍然需要大约5N个工作线程，实例销毁之后线程回到线程池给下一个实例使用
+ * 工作线程不分离，非核心线程超时退出之后在下一次创建线程时回收，shutdown等待并回收所有工作线程
+ */
+class ThreadPool {
+
+    const char *const TAG = "[MP][NATIVE][ThreadPool]";
+
+    typedef struct Worker {
+        ThreadPool *pool;
+        ThreadTask *task;
+        Condition condition;
+        pthread_t id;
+    } Worker;
+
+public:
+
+    static ThreadPool *getInstance();
+
+    // 执行任务
+    int execute(ThreadTask *task);
+
+    // 预先创建核心线程，让线程创建不在打开媒体的路径上
+    int prestartCoreThreads();
+
+    // 工作线程数量
+    int getPoolSize();
+
+    // 正在执行任务的线程数量
+    int getActiveCount();
+
+    // 等待正在执行的任务结束，回收所有工作线程，之后可以继续提交任务
+    // 不能在工作线程中调用，需要在所有播放器实例销毁之后调用，否则一直等待到组件的循环退出
+    int shutdown();
+
+private:
+
+    ThreadPool();
+
+    ~ThreadPool();
+
+    int createWorker(ThreadTask *task);
+
+    void reapExitedWorkers();
+
+    static void *workerEntry(void *arg);
+
+    void runWorker(Worker *worker);
+
+private:
+
+    Mutex mutex;
+
+    /// 所有还没有回收的工作线程
+    std::vector<Worker *> workers;
+
+    /// 空闲的工作线程
+    std::vector<Worker *> idleWorkers;
+
+    /// 超时退出，等待回收的工作线程
+    std::vector<Worker *> exitedWorkers;
+
+    /// 工作线程数量
+    int poolSize = 0;
+
+    /// 正在关闭，工作线程执行完当前任务之后退出
+    bool quit = false;
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef ENGINE_THUMBNAIL_EXTRACTOR_H
+#define ENGINE_THUMBNAIL_EXTRACTOR_H
+
+#include <atomic>
+#include <vector>
+#include "ThreadPool.h"
+#include "FFmpegUtils.h"
+#include "IThumbnailListener.h"
+#include "KeyframeIndex.h"
+#include "Errors.h"
+#include "Log.h"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/time.h>
+#include <libswscale/swscale.h>
+};
+
+/// 默认工作线程数量
+#define THUMBNAIL_WORKERS                           2
+
+/// 最多的工作线程数量
+#define THUMBNAIL_MAX_WORKERS                       4
+
+/// 定位之后查找关键帧最多读取的视频包数量
+#define THUMBNAIL_MAX_PACKETS                       600
+
+class ThumbnailExtractor;
+
+/**
+ * 缩略图工作线程，独立的解复用和解码上下文，按时间顺序处理分配到的时间戳
+ */
+class ThumbnailWorker : public Runnable {
+
+    const char *const TAG = "[MP][NATIVE][ThumbnailWorker]";
+
+    typedef struct Request {
+        int index;
+        int64_t timestamp;
+    } Request;
+
+public:
+
+    ThumbnailWorker(ThumbnailExtractor *extractor, const char *url, int width, int height);
+
+    ~ThumbnailWorker() override;
+
+    void addRequest(int index, int64_t timestamp);
+
+    int start();
+
+    void join();
+
+    void run() override;
+
+private:
+
+    int openInput();
+
+    int openDecoder();
+
+    // 定位到时间戳之前最近的关键帧并解码
+    int decodeKeyframe(int64_t timestamp);
+
+    int scale();
+
+    void release();
+
+    static int interruptCb(void *ctx);
+
+private:
+
+    ThumbnailExtractor *extractor;
+
+    ThreadTask *workerThread = nullptr;
+
+    char *url = nullptr;
+
+    std::vector<Request> requests;
+
+    AVFormatContext *formatContext = nullptr;
+
+    AVCodecContext *codecContext = nullptr;
+
+    KeyframeIndex *keyframeIndex = nullptr;
+
+    SwsContext *swsContext = nullptr;
+
+    AVFrame *frame = nullptr;
+
+    int streamIndex = -1;
+
+    /// 目标尺寸，高度为0时按宽度保持宽高比
+    int width = 0;
+
+    int height = 0;
+
+    /// 缩放结果
+    uint8_t *data[4] = {nullptr};
+
+    int linesize[4] = {0};
+
+    int dstWidth = 0;
+
+    int dstHeight = 0;
+
+    /// 上一次解码的关键帧，相邻时间戳落在同一个关键帧时直接复用缩放结果
+    int64_t lastKeyframePts = AV_NOPTS_VALUE;
+};
+
+/**
+ * 缩略图提取
+ * 不创建播放器和输出设备，把时间戳分配给多个工作线程，每个时间戳只解码之前最近的关键帧，
+ * 解码时跳过非关键帧并尽量使用低分辨率解码，用sws_scale缩放到目标尺寸后通过回调返回
+ */
+class ThumbnailExtractor {
+
+    friend class ThumbnailWorker;
+
+    const char *const TAG = "[MP][NATIVE][ThumbnailExtractor]";
+
+public:
+
+    ThumbnailExtractor();
+
+    virtual ~ThumbnailExtractor();
+
+    void setListener(IThumbnailListener *listener);
+
+    /**
+     * 开始提取，之前的提取被取消
+     * @param url
+     * @param timestamps 时间戳，微秒，相对媒体开始时间
+     * @param width 目标宽度
+     * @param height 目标高度，为0时按宽度保持宽高比
+     * @param workers 工作线程数量
+     * @return
+     */
+    int start(const char *url, const std::vector<int64_t> &timestamps, int width, int height,
+              int workers);
+
+    // 取消提取并等待工作线程结束，不能在回调中调用
+    void cancel();
+
+private:
+
+    void onThumbnail(int index, int64_t timestamp, int64_t pts, const uint8_t *data,
+                     int width, int height, int linesize);
+
+    void onWorkerFinish();
+
+private:
+
+    Mutex mutex;
+
+    /// 回调锁，保证同一时间只有一个回调
+    Mutex listenerMutex;
+
+    IThumbnailListener *listener = nullptr;
+
+    std::vector<ThumbnailWorker *> workers;
+
+    std::atomic<bool> abortRequest;
+
+    std::atomic<int> activeWorkers;
+
+    std::atomic<int> thumbnailCount;
+
+    int64_t startTime = 0;
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include "MediaDecoder.h"
 #include "PlayerInfoStatus.h"
 #include "MediaClock.h"
+#include "VideoDevice.h"
+#include "FrameConverter.h"
 
 class VideoDecoder : public MediaDecoder {
     const char *const TAG = "[MP][NATIVE][VideoDecoder]";
@@ -14,7 +16,7 @@ public:
                  int streamIndex,
                  PlayerInfoStatus *playerState,
                  AVPacket *flushPacket,
-                 Condition *pCondition,
+                 Event *readEvent,
                  AVDictionary *opts,
                  MessageCenter *messageCenter);
 
@@ -22,6 +24,9 @@ public:
 
     void setMasterClock(MediaClock *masterClock);
 
+    // 设置视频输出设备，设备不能直接渲染的格式在解码线程转换
+    void setVideoDevice(VideoDevice *videoDevice);
+
     void start() override;
 
     void stop() override;
@@ -40,6 +45,8 @@ public:
 
     int64_t getFrameQueueLastPos();
 
+    int64_t getFrameQueueMemorySize();
+
 private:
 
     /// 解复用上下文
@@ -52,11 +59,26 @@ private:
     int rotate;
 
     /// 解码线程
-    Thread *decodeThread;
+    ThreadTask *decodeThread;
 
     /// 主时钟
     MediaClock *masterClock;
 
+    /// 是否正在跳过部分帧的解码
+    bool skipping = false;
+
+    /// 跳过之前的skip_frame
+    AVDiscard skipFrame = AVDISCARD_DEFAULT;
+
+    /// 视频输出设备
+    VideoDevice *videoDevice = nullptr;
+
+    /// 像素格式转换，第一次需要转换时创建
+    FrameConverter *frameConverter = nullptr;
+
+    /// 转换后的帧
+    AVFrame *convertedFrame = nullptr;
+
 private:
 
     int decodeVideo();
@@ -67,6 +89,12 @@ private:
 
     int pushFrame(AVFrame *srcFrame, double pts, double duration, int64_t pos, int serial);
 
+    AVFrame *convertFrame(AVFrame *frame);
+
+    void skipFrames(AVDiscard discard);
+
+    void restoreSkipFrame();
+
 };
 
 
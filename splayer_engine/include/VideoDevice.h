@@ -4,6 +4,7 @@
 #include "PlayerInfoStatus.h"
 #include "Texture.h"
 #include "FrameQueue.h"
+#include "DisplayClock.h"
 
 class VideoDevice {
 
@@ -13,6 +14,9 @@ protected:
 
     PlayerInfoStatus *playerInfoStatus = nullptr;
 
+    /// 显示时钟，显示画面之后上报显示时间和vsync
+    DisplayClock *displayClock = nullptr;
+
     Mutex mutex;
     Condition condition;
 
@@ -34,6 +38,9 @@ public:
     // 更新YUV数据
     virtual int onUpdateYUV(uint8_t *yData, int yPitch, uint8_t *uData, int uPitch, uint8_t *vData, int vPitch);
 
+    // 更新半平面YUV数据，NV12、NV21和P010，UV交错存放在一个平面
+    virtual int onUpdateNV(uint8_t *yData, int yPitch, uint8_t *uvData, int uvPitch);
+
     // 更新ARGB数据
     virtual int onUpdateARGB(uint8_t *rgba, int pitch);
 
@@ -43,7 +50,7 @@ public:
     // 请求渲染
     virtual int onRequestRenderEnd(Frame *frame, bool flip);
 
-    // 获取纹理格式
+    // 获取纹理格式，设备不能直接渲染的格式返回FMT_NONE，转换成BGRA之后渲染
     virtual TextureFormat getTextureFormat(int format);
 
     // 获取混合模式
@@ -51,6 +58,8 @@ public:
 
     void setPlayerInfoStatus(PlayerInfoStatus *playerState);
 
+    void setDisplayClock(DisplayClock *clock);
+
 
 };
 
@@ -0,0 +1,288 @@
+#include "AdaptiveBitrate.h"
+#include "Msg.h"
+#include <algorithm>
+
+AdaptiveBitrate::AdaptiveBitrate(MessageCenter *messageCenter) {
+    this->messageCenter = messageCenter;
+}
+
+AdaptiveBitrate::~AdaptiveBitrate() {
+    messageCenter = nullptr;
+    formatContext = nullptr;
+}
+
+bool AdaptiveBitrate::isSupported(AVFormatContext *formatContext) {
+    if (!formatContext->iformat || formatContext->nb_programs < 2) {
+        return false;
+    }
+    const char *name = formatContext->iformat->name;
+    return !strcmp(name, "hls") || !strcmp(name, "hls,applehttp");
+}
+
+int AdaptiveBitrate::open(AVFormatContext *formatContext, int videoIndex, int audioIndex) {
+    this->formatContext = formatContext;
+    this->videoIndex = videoIndex;
+    this->audioIndex = audioIndex;
+
+    for (unsigned int i = 0; i < formatContext->nb_programs; i++) {
+        AVProgram *program = formatContext->programs[i];
+        AVDictionaryEntry *entry = av_dict_get(program->metadata, "variant_bitrate", nullptr, 0);
+        Variant variant = {entry ? strtoll(entry->value, nullptr, 10) : 0, -1, -1, 0, 0};
+        for (unsigned int j = 0; j < program->nb_stream_indexes; j++) {
+            int index = program->stream_index[j];
+            AVCodecParameters *codecpar = formatContext->streams[index]->codecpar;
+            if (codecpar->codec_type == AVMEDIA_TYPE_VIDEO && variant.videoIndex < 0) {
+                variant.videoIndex = index;
+                variant.width = codecpar->width;
+                variant.height = codecpar->height;
+            } else if (codecpar->codec_type == AVMEDIA_TYPE_AUDIO && variant.audioIndex < 0) {
+                variant.audioIndex = index;
+            }
+        }
+        // 没有解码器对应类型的流，或者和当前解码器不兼容的码率不参与切换
+        if (variant.bitrate <= 0 || (videoIndex >= 0 && variant.videoIndex < 0) ||
+            (audioIndex >= 0 && variant.audioIndex < 0) || !isCompatible(variant)) {
+            continue;
+        }
+        variants.push_back(variant);
+    }
+    std::sort(variants.begin(), variants.end(), [](const Variant &a, const Variant &b) {
+        return a.bitrate < b.bitrate;
+    });
+
+    for (int i = 0; i < (int) variants.size(); i++) {
+        if ((videoIndex < 0 || variants[i].videoIndex == videoIndex) &&
+            (audioIndex < 0 || variants[i].audioIndex == audioIndex)) {
+            current = i;
+            break;
+        }
+    }
+    if (current < 0 || variants.size() < 2) {
+        return ERROR;
+    }
+    if (videoIndex >= 0) {
+        activeParams = formatContext->streams[videoIndex]->codecpar;
+    }
+    lastSwitchTime = av_gettime_relative();
+
+    if (ENGINE_DEBUG) {
+        for (int i = 0; i < (int) variants.size(); i++) {
+            ALOGD(TAG, "[%s] variant %d bitrate = %lld size = %dx%d%s", __func__, i,
+                  (long long) variants[i].bitrate, variants[i].width, variants[i].height,
+                  i == current ? " current" : "");
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * 读包耗时主要是等待网络数据，按采样窗口计算带宽后分别做快速和慢速的指数平滑，
+ * 取较小值，带宽下降时快速响应，上升时需要持续一段时间
+ */
+void AdaptiveBitrate::addSample(int64_t bytes, int64_t cost) {
+    sampleBytes += bytes;
+    sampleTime += cost;
+    if (sampleTime < ABR_SAMPLE_TIME) {
+        return;
+    }
+    double bandwidth = sampleBytes * 8.0 * AV_TIME_BASE / sampleTime;
+    if (slowBandwidth <= 0) {
+        fastBandwidth = bandwidth;
+        slowBandwidth = bandwidth;
+    } else {
+        fastBandwidth = fastBandwidth * 0.5 + bandwidth * 0.5;
+        slowBandwidth = slowBandwidth * 0.9 + bandwidth * 0.1;
+    }
+    sampleBytes = 0;
+    sampleTime = 0;
+}
+
+int64_t AdaptiveBitrate::getBandwidth() {
+    return (int64_t) FFMIN(fastBandwidth, slowBandwidth);
+}
+
+void AdaptiveBitrate::update(int64_t bufferDuration, bool bufferFull) {
+    int64_t now = av_gettime_relative();
+    if (now - lastCheckTime < ABR_CHECK_INTERVAL) {
+        return;
+    }
+    lastCheckTime = now;
+
+    if (pending >= 0) {
+        if (now - switchStartTime > ABR_SWITCH_TIMEOUT) {
+            cancelSwitch();
+        }
+        return;
+    }
+
+    int64_t bandwidth = getBandwidth();
+    if (bandwidth <= 0) {
+        return;
+    }
+    bool lowBuffer = bufferDuration < ABR_LOW_BUFFER && !bufferFull;
+    double usable = bandwidth * (lowBuffer ? ABR_LOW_BUFFER_FACTOR : ABR_BANDWIDTH_FACTOR);
+    int target = 0;
+    for (int i = 0; i < (int) variants.size(); i++) {
+        if (variants[i].bitrate <= usable) {
+            target = i;
+        }
+    }
+    if (target == current) {
+        return;
+    }
+
+    if (target > current) {
+        // 缓冲充足并且距离上次切换足够久才提高码率
+        if ((!bufferFull && bufferDuration < ABR_HIGH_BUFFER) ||
+            now - lastSwitchTime < ABR_SWITCH_INTERVAL) {
+            return;
+        }
+    } else {
+        // 带宽仍然足够当前码率并且缓冲没有下降时不降低
+        if (!lowBuffer && (variants[current].bitrate <= bandwidth * ABR_BANDWIDTH_FACTOR ||
+                           now - lastSwitchTime < ABR_SWITCH_INTERVAL)) {
+            return;
+        }
+    }
+
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] bandwidth = %lld buffer = %lld ms full = %d, switch %lld -> %lld",
+              __func__, (long long) bandwidth, (long long) bufferDuration / 1000, bufferFull,
+              (long long) variants[current].bitrate, (long long) variants[target].bitrate);
+    }
+    startSwitch(target);
+}
+
+/**
+ * 新码率从第一个视频关键帧开始送入解码器，之前的数据包丢弃
+ * HLS解复用器按解码时间交错返回各个码率的数据包，读到新码率的关键帧时旧码率中更早的数据包
+ * 都已经送入解码器，直接停用旧码率，画面和声音都不会中断
+ */
+bool AdaptiveBitrate::filterPacket(AVPacket *pkt) {
+    int index = pkt->stream_index;
+    bool isCurrent = index == variants[current].videoIndex ||
+                     index == variants[current].audioIndex;
+    bool isPending = pending >= 0 &&
+                     (index == variants[pending].videoIndex ||
+                      index == variants[pending].audioIndex);
+    if (!isCurrent && !isPending) {
+        return false;
+    }
+    if (isPending && !isCurrent) {
+        if (!isPrimary(variants[pending], index) || !(pkt->flags & AV_PKT_FLAG_KEY)) {
+            return false;
+        }
+        finishSwitch();
+    }
+    attachExtradata(pkt);
+    remap(pkt, variants[current]);
+    return true;
+}
+
+void AdaptiveBitrate::flush() {
+    if (pending < 0) {
+        return;
+    }
+    // 定位之后解码器会被清空，直接使用新码率
+    finishSwitch();
+}
+
+bool AdaptiveBitrate::isCompatible(const Variant &variant) {
+    if (videoIndex >= 0 && variant.videoIndex != videoIndex) {
+        AVStream *stream = formatContext->streams[videoIndex];
+        AVStream *other = formatContext->streams[variant.videoIndex];
+        if (other->codecpar->codec_id != stream->codecpar->codec_id ||
+            av_cmp_q(other->time_base, stream->time_base) != 0) {
+            return false;
+        }
+    }
+    if (audioIndex >= 0 && variant.audioIndex != audioIndex) {
+        AVStream *stream = formatContext->streams[audioIndex];
+        AVStream *other = formatContext->streams[variant.audioIndex];
+        if (other->codecpar->codec_id != stream->codecpar->codec_id ||
+            other->codecpar->sample_rate != stream->codecpar->sample_rate ||
+            other->codecpar->channels != stream->codecpar->channels ||
+            av_cmp_q(other->time_base, stream->time_base) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AdaptiveBitrate::startSwitch(int index) {
+    pending = index;
+    switchStartTime = av_gettime_relative();
+    setDiscard(variants[pending], variants[current], AVDISCARD_DEFAULT);
+}
+
+void AdaptiveBitrate::finishSwitch() {
+    const Variant &next = variants[pending];
+    setDiscard(variants[current], next, AVDISCARD_ALL);
+    if (videoIndex >= 0) {
+        AVCodecParameters *codecpar = formatContext->streams[next.videoIndex]->codecpar;
+        extradataPending = codecpar->extradata_size > 0 &&
+                           (codecpar->extradata_size != activeParams->extradata_size ||
+                            memcmp(codecpar->extradata, activeParams->extradata,
+                                   (size_t) codecpar->extradata_size) != 0);
+        activeParams = codecpar;
+    }
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] bitrate %lld -> %lld cost = %lld ms", __func__,
+              (long long) variants[current].bitrate, (long long) next.bitrate,
+              (long long) (av_gettime_relative() - switchStartTime) / 1000);
+    }
+    current = pending;
+    pending = -1;
+    lastSwitchTime = av_gettime_relative();
+    if (messageCenter) {
+        messageCenter->notifyMsg(Msg::MSG_VARIANT_CHANGED, (int) (next.bitrate / 1000),
+                                 next.height);
+    }
+}
+
+void AdaptiveBitrate::cancelSwitch() {
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] no keyframe from bitrate %lld", __func__,
+              (long long) variants[pending].bitrate);
+    }
+    setDiscard(variants[pending], variants[current], AVDISCARD_ALL);
+    pending = -1;
+    lastSwitchTime = av_gettime_relative();
+}
+
+/// 设置码率中不和另一个码率共用的流
+void AdaptiveBitrate::setDiscard(const Variant &variant, const Variant &other, AVDiscard discard) {
+    if (variant.videoIndex >= 0 && variant.videoIndex != other.videoIndex) {
+        formatContext->streams[variant.videoIndex]->discard = discard;
+    }
+    if (variant.audioIndex >= 0 && variant.audioIndex != other.audioIndex) {
+        formatContext->streams[variant.audioIndex]->discard = discard;
+    }
+}
+
+/// 决定切换点的流，有视频时为视频
+bool AdaptiveBitrate::isPrimary(const Variant &variant, int streamIndex) {
+    return streamIndex == (videoIndex >= 0 ? variant.videoIndex : variant.audioIndex);
+}
+
+void AdaptiveBitrate::remap(AVPacket *pkt, const Variant &variant) {
+    if (pkt->stream_index == variant.videoIndex && videoIndex >= 0) {
+        pkt->stream_index = videoIndex;
+    } else if (pkt->stream_index == variant.audioIndex && audioIndex >= 0) {
+        pkt->stream_index = audioIndex;
+    }
+}
+
+/// 扩展数据不同时附加到新码率的第一个视频包上，解码器不需要重新打开
+void AdaptiveBitrate::attachExtradata(AVPacket *pkt) {
+    if (!extradataPending || pkt->stream_index != variants[current].videoIndex) {
+        return;
+    }
+    const AVCodecParameters *codecpar = activeParams;
+    uint8_t *data = av_packet_new_side_data(pkt, AV_PKT_DATA_NEW_EXTRADATA,
+                                            codecpar->extradata_size);
+    if (data) {
+        memcpy(data, codecpar->extradata, (size_t) codecpar->extradata_size);
+    }
+    extradataPending = false;
+}
@@ -6,16 +6,16 @@ AudioDecoder::AudioDecoder(AVFormatContext *formatCtx,
                            int streamIndex,
                            PlayerInfoStatus *playerState,
                            AVPacket *flushPacket,
-                           Condition *readWaitCond, AVDictionary *opts,
+                           Event *readEvent, AVDictionary *opts,
                            MessageCenter *messageCenter)
         : MediaDecoder(avctx,
                        stream,
                        streamIndex,
                        playerState,
                        flushPacket,
-                       readWaitCond, opts, messageCenter) {
+                       readEvent, opts, messageCenter) {
     formatContext = formatCtx;
-    frameQueue = new FrameQueue(AUDIO_QUEUE_SIZE, 0, packetQueue);
+    frameQueue = new FrameQueue(playerState->audioQueueSize, 0, packetQueue, readEvent);
     decodeThread = nullptr;
 }
 
@@ -30,7 +30,7 @@ void AudioDecoder::start() {
     MediaDecoder::start();
     frameQueue->start();
     if (!decodeThread) {
-        decodeThread = new Thread(this);
+        decodeThread = new ThreadTask(this);
         decodeThread->start();
     }
 }
@@ -51,8 +51,8 @@ void AudioDecoder::stop() {
 }
 
 void AudioDecoder::flush() {
+    // 帧队列由消费者线程根据seekSerial丢弃seek之前的帧，这里只刷新数据包队列
     MediaDecoder::flush();
-    frameQueue->flush();
 }
 
 int AudioDecoder::getFrameSize() {
@@ -110,6 +110,15 @@ int AudioDecoder::decodeAudio() {
             continue;
         }
 
+        // 精确定位时丢弃目标之前的帧
+        if (isBeforeSeekTarget(avFrame->pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE :
+                               av_rescale(avFrame->pts, AV_TIME_BASE, avFrame->sample_rate),
+                               av_rescale(avFrame->nb_samples, AV_TIME_BASE,
+                                          avFrame->sample_rate))) {
+            av_frame_unref(avFrame);
+            continue;
+        }
+
         // 从队列中获取一个可写的Frame对象
         if (!(frame = frameQueue->peekWritable())) {
             ALOGE(TAG, "[%s] audio peek not writable", __func__);
@@ -189,6 +198,7 @@ int AudioDecoder::decodeFrame(AVFrame *frame) {
                 if (ret == AVERROR_EOF) {
                     finished = packetQueue->getFirstSeekSerial();
                     avcodec_flush_buffers(codecContext);
+                    readEvent->signal();
                     return SUCCESS;
                 }
 
@@ -201,11 +211,6 @@ int AudioDecoder::decodeFrame(AVFrame *frame) {
 
         do {
 
-            // 同步读取序列
-            if (getPacketQueueSize() == 0) {
-                readWaitCond->signal();
-            }
-
             if (isPendingPacket) {
                 av_packet_move_ref(&packet, &pendingPacket);
                 isPendingPacket = false;
@@ -214,6 +219,8 @@ int AudioDecoder::decodeFrame(AVFrame *frame) {
                     ALOGE(TAG, "[%s] audio get packet", __func__);
                     return ERROR;
                 }
+                // 数据包队列有了空间，通知读包线程
+                readEvent->signal();
             }
         } while (!isSamePacketSerial());
 
@@ -222,6 +229,7 @@ int AudioDecoder::decodeFrame(AVFrame *frame) {
             finished = 0;
             nextPts = startPts;
             nextPtsTb = startPtsTb;
+            startAccurateSeek();
         } else {
             if (codecContext->codec_type == AVMEDIA_TYPE_AUDIO) {
                 if (avcodec_send_packet(codecContext, &packet) == AVERROR(EAGAIN)) {
@@ -245,5 +253,9 @@ int64_t AudioDecoder::getFrameQueueLastPos() {
     return frameQueue->currentPos();
 }
 
+int64_t AudioDecoder::getFrameQueueMemorySize() {
+    return frameQueue->getMemorySize();
+}
+
 
 
@@ -141,10 +141,14 @@ void AudioResample::onPCMDataCallback(uint8_t *stream, int len) {
     audioState->audioWriteBufferSize = audioState->audioBufferSize - audioState->audioBufferIndex;
 
     if (!isnan(audioState->audioClock) && mediaSync) {
+        // 变速时缓冲中每个字节对应的媒体时长按速度放大
         double pts = audioState->audioClock - (double) (2 * audioState->audioHardwareBufSize +
                                                         audioState->audioWriteBufferSize) /
-                                              audioState->audioParamsTarget.bytesPerSec;
+                                              audioState->audioParamsTarget.bytesPerSec * tempo;
         double time = audioState->audioCallbackTime / 1000000.0;
+        if (mediaSync->getAudioClock()->getSpeed() != tempo) {
+            mediaSync->getAudioClock()->setSpeed(tempo);
+        }
         mediaSync->updateAudioClock(pts, audioState->seekSerial, time);
     }
 }
@@ -302,10 +306,25 @@ int AudioResample::audioFrameReSample() {
                                                        (AVSampleFormat) srcFrame->format, 1);;
     }
 
-    // 利用pts更新音频时钟
+    // 低延时模式以音频为主时钟时按延时变速追赶
+    double speed = 1.0;
+    LatencyController *latencyController = mediaSync ? mediaSync->getLatencyController() : nullptr;
+    if (latencyController && latencyController->isEnabled() &&
+        playerInfoStatus->syncType == AV_SYNC_AUDIO) {
+        speed = latencyController->update(mediaSync->getMasterClock());
+    }
+    if (speed != 1.0 || tempo != 1.0) {
+        reSampledDataSize = changeTempo(reSampledDataSize, speed);
+    }
+
+    // 利用pts更新音频时钟，SoundTouch中还没有输出的采样不计入
     if (srcFrame->pts != AV_NOPTS_VALUE) {
         audioState->audioClock = srcFrame->pts * av_q2d((AVRational) {1, srcFrame->sample_rate}) +
                                  (double) srcFrame->nb_samples / srcFrame->sample_rate;
+        if (tempo != 1.0) {
+            audioState->audioClock -= (double) soundTouchWrapper->getPendingSamples() /
+                                      audioState->audioParamsTarget.sampleRate;
+        }
     } else {
         audioState->audioClock = NAN;
     }
@@ -318,6 +337,37 @@ int AudioResample::audioFrameReSample() {
     return reSampledDataSize;
 }
 
+/**
+ * 变速不变调，输出写入SoundTouch缓冲
+ * 恢复正常速度时取出SoundTouch中已经处理好的采样，剩余不足一个处理窗口的采样丢弃
+ */
+int AudioResample::changeTempo(int dataSize, double speed) {
+    AudioParams &target = audioState->audioParamsTarget;
+    if (!soundTouchWrapper) {
+        soundTouchWrapper = new SoundTouchWrapper();
+    }
+    int inputSamples = dataSize / target.frameSize;
+    int maxSamples = inputSamples + soundTouchWrapper->getPendingSamples() + 256;
+    av_fast_malloc(&audioState->soundTouchBuffer, &audioState->soundTouchBufferSize,
+                   (size_t) maxSamples * target.frameSize);
+    if (!audioState->soundTouchBuffer) {
+        return dataSize;
+    }
+    int count = soundTouchWrapper->changeTempo((const short *) audioState->audioOutputBuffer,
+                                               inputSamples, audioState->soundTouchBuffer,
+                                               maxSamples, (float) speed, target.channels,
+                                               target.sampleRate);
+    if (speed == 1.0) {
+        soundTouchWrapper->clear();
+    }
+    if (ENGINE_DEBUG && speed != tempo) {
+        ALOGD(TAG, "[%s] tempo %.2f -> %.2f", __func__, tempo, speed);
+    }
+    tempo = speed;
+    audioState->audioOutputBuffer = (uint8_t *) audioState->soundTouchBuffer;
+    return count * target.frameSize;
+}
+
 uint64_t AudioResample::getChannelLayout() const {
     if (srcFrame->channel_layout &&
         srcFrame->channels == av_get_channel_layout_nb_channels(srcFrame->channel_layout)) {
@@ -442,7 +492,8 @@ int AudioResample::convertAudio(int wantedNbSamples, AVFrame *frame) const {
 int AudioResample::create() {
     audioState = (AudioState *) av_mallocz(sizeof(AudioState));
     memset(audioState, 0, sizeof(AudioState));
-    soundTouchWrapper = new SoundTouchWrapper();
+    // 变速时才创建SoundTouch，多实例时不占用内存
+    soundTouchWrapper = nullptr;
     return SUCCESS;
 }
 
@@ -454,6 +505,7 @@ int AudioResample::destroy() {
     if (audioState) {
         swr_free(&audioState->swrContext);
         av_freep(&audioState->reSampleBuffer);
+        av_freep(&audioState->soundTouchBuffer);
         memset(audioState, 0, sizeof(AudioState));
         av_free(audioState);
         audioState = nullptr;
@@ -0,0 +1,183 @@
+#include "DisplayClock.h"
+#include <time.h>
+#include <sys/resource.h>
+
+/**
+ * 当前线程的CPU时间，微秒
+ */
+static int64_t getThreadCpuTime() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * 进程的CPU时间，包括用户态和内核态，微秒
+ */
+static int64_t getProcessCpuTime() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (int64_t) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+DisplayClock::DisplayClock() = default;
+
+DisplayClock::~DisplayClock() {
+    listener = nullptr;
+}
+
+void DisplayClock::reset() {
+    mutex.lock();
+    wakeUpRequest = false;
+    mutex.unlock();
+    targetTime = NAN;
+    statStartTime = 0;
+}
+
+void DisplayClock::setRefreshRate(double refreshRate) {
+    double value = 0;
+    if (refreshRate >= DISPLAY_CLOCK_MIN_REFRESH_RATE &&
+        refreshRate <= DISPLAY_CLOCK_MAX_REFRESH_RATE) {
+        value = 1.0 / refreshRate;
+    }
+    if (value != period) {
+        period = value;
+        lastVsync = NAN;
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] refresh rate = %.2f Hz", __func__, getRefreshRate());
+        }
+    }
+}
+
+double DisplayClock::getRefreshRate() {
+    return period > 0 ? 1.0 / period : 0;
+}
+
+/**
+ * 显示阻塞到vsync时，返回的时间就是画面开始显示的vsync，以此更新相位
+ */
+void DisplayClock::onPresent(double time, bool vsync) {
+    presentCount++;
+    if (vsync && period > 0) {
+        lastVsync = time;
+    }
+    if (!isnan(targetTime)) {
+        double jitter = fabs(time - targetTime);
+        // 定位和追赶时计划时间会重置，偏差过大的不计入统计
+        if (jitter < DISPLAY_CLOCK_VSYNC_TIMEOUT) {
+            jitterSum += jitter;
+            jitterMax = FFMAX(jitterMax, jitter);
+            jitterCount++;
+        }
+        targetTime = NAN;
+    }
+}
+
+void DisplayClock::setTargetTime(double time) {
+    targetTime = time;
+}
+
+/**
+ * 现在提交的画面在下一个vsync显示，加上半个周期之后，计划时间在[vsync - period / 2, vsync + period / 2)
+ * 之间的帧都在该vsync显示，也就是取整到最近的vsync
+ */
+double DisplayClock::getDisplayTime(double now) {
+    if (!hasVsync(now)) {
+        return now;
+    }
+    return getNextVsync(now) + period / 2;
+}
+
+/**
+ * 目标vsync是计划时间取整后的vsync，在它的前一个vsync之后唤醒，此时提交的画面正好在目标vsync显示
+ */
+double DisplayClock::getWaitTime(double now, double time) {
+    if (!hasVsync(now)) {
+        return time - now;
+    }
+    double target = lastVsync + ceil((time - period / 2 - lastVsync) / period) * period;
+    return FFMAX(target - period + DISPLAY_CLOCK_WAKE_UP_MARGIN - now, 0);
+}
+
+void DisplayClock::wait(double seconds) {
+    if (seconds <= 0) {
+        return;
+    }
+    mutex.lock();
+    if (!wakeUpRequest) {
+        condition.waitRelative(mutex, (nsecs_t) (seconds * 1000000000.0));
+    }
+    wakeUpRequest = false;
+    waitCount++;
+    mutex.unlock();
+}
+
+void DisplayClock::wakeUp() {
+    mutex.lock();
+    wakeUpRequest = true;
+    condition.signal();
+    IDisplayClockListener *wakeUpListener = listener;
+    mutex.unlock();
+    // 监听者可能回调到持有其他锁的线程，不持有时钟的锁调用
+    if (wakeUpListener) {
+        wakeUpListener->onWakeUp();
+    }
+}
+
+void DisplayClock::setListener(IDisplayClockListener *listener) {
+    mutex.lock();
+    this->listener = listener;
+    mutex.unlock();
+}
+
+/**
+ * 暂停和播放分开统计，状态变化时立即结束当前窗口
+ * 抖动是画面实际显示时间和计划时间的偏差，CPU占用按窗口时长计算
+ */
+void DisplayClock::updateStats(bool paused) {
+    double now = av_gettime_relative() / 1000000.0;
+    if (statStartTime == 0) {
+        resetStats(now, paused);
+        return;
+    }
+    double elapsed = now - statStartTime;
+    if (paused == statPaused && elapsed < DISPLAY_CLOCK_STAT_INTERVAL) {
+        return;
+    }
+    if (ENGINE_DEBUG && elapsed > 0) {
+        double threadCpu = (getThreadCpuTime() - statThreadCpu) / (elapsed * 10000.0);
+        double processCpu = (getProcessCpuTime() - statProcessCpu) / (elapsed * 10000.0);
+        ALOGD(TAG,
+              "[%s] %s %.1f s presents = %d wakeups = %d jitter avg = %.2f ms max = %.2f ms "
+              "refresh = %.2f Hz cpu thread = %.1f%% process = %.1f%%", __func__,
+              statPaused ? "paused" : "playing", elapsed, presentCount, waitCount,
+              jitterCount > 0 ? jitterSum / jitterCount * 1000 : 0, jitterMax * 1000,
+              getRefreshRate(), threadCpu, processCpu);
+    }
+    resetStats(now, paused);
+}
+
+bool DisplayClock::hasVsync(double now) {
+    return period > 0 && !isnan(lastVsync) && now - lastVsync < DISPLAY_CLOCK_VSYNC_TIMEOUT;
+}
+
+double DisplayClock::getNextVsync(double now) {
+    return lastVsync + (floor((now - lastVsync) / period) + 1) * period;
+}
+
+void DisplayClock::resetStats(double now, bool paused) {
+    statPaused = paused;
+    statStartTime = now;
+    statThreadCpu = getThreadCpuTime();
+    statProcessCpu = getProcessCpuTime();
+    presentCount = 0;
+    waitCount = 0;
+    jitterCount = 0;
+    jitterSum = 0;
+    jitterMax = 0;
+}
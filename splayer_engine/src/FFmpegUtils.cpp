@@ -200,6 +200,21 @@ int isRealTime(AVFormatContext *s) {
     return 0;
 }
 
+/**
+ * 默认值取自选项表，不依赖FFmpeg版本，调用者显式设置为默认值时同样认为没有设置
+ * @param obj
+ * @param name
+ * @return
+ */
+int isDefaultOption(void *obj, const char *name) {
+    const AVOption *option = av_opt_find(obj, name, nullptr, 0, 0);
+    int64_t value = 0;
+    if (!option || av_opt_get_int(obj, name, 0, &value) < 0) {
+        return 0;
+    }
+    return value == option->default_val.i64;
+}
+
 
 #ifdef __cplusplus
 };
@@ -0,0 +1,167 @@
+#include "FrameBufferPool.h"
+
+/// 需要调色板的格式交给FFmpeg默认的分配方式
+#ifdef AV_PIX_FMT_FLAG_PSEUDOPAL
+#define FRAME_BUFFER_PAL_FLAGS  (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_PSEUDOPAL)
+#else
+#define FRAME_BUFFER_PAL_FLAGS  AV_PIX_FMT_FLAG_PAL
+#endif
+
+FrameBufferPool::FrameBufferPool() {
+    memset(pools, 0, sizeof(pools));
+    memset(linesize, 0, sizeof(linesize));
+    allocCount = 0;
+}
+
+FrameBufferPool::~FrameBufferPool() {
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] alloc count = %d", __func__, allocCount.load());
+    }
+    // 还在FrameQueue中的帧持有缓冲的引用，AVBufferPool在最后一个缓冲释放后才真正销毁
+    releasePools();
+}
+
+bool FrameBufferPool::install(AVCodecContext *codecContext, AVCodec *codec) {
+    if (codecContext->codec_type != AVMEDIA_TYPE_VIDEO ||
+        !(codec->capabilities & AV_CODEC_CAP_DR1)) {
+        return false;
+    }
+    codecContext->opaque = new FrameBufferPool();
+    codecContext->get_buffer2 = getBuffer2;
+    codecContext->thread_safe_callbacks = 1;
+    return true;
+}
+
+FrameBufferPool *FrameBufferPool::from(AVCodecContext *codecContext) {
+    if (codecContext && codecContext->get_buffer2 == getBuffer2) {
+        return (FrameBufferPool *) codecContext->opaque;
+    }
+    return nullptr;
+}
+
+int FrameBufferPool::getAllocCount() {
+    return allocCount;
+}
+
+int FrameBufferPool::getBuffer2(AVCodecContext *codecContext, AVFrame *frame, int flags) {
+    auto *bufferPool = (FrameBufferPool *) codecContext->opaque;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat) frame->format);
+    // 硬解、调色板格式交给FFmpeg默认的分配方式
+    if (!bufferPool || !desc || codecContext->hw_frames_ctx ||
+        (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | FRAME_BUFFER_PAL_FLAGS))) {
+        return avcodec_default_get_buffer2(codecContext, frame, flags);
+    }
+    return bufferPool->getVideoBuffer(codecContext, frame);
+}
+
+AVBufferRef *FrameBufferPool::allocBuffer(void *opaque, int size) {
+    auto *bufferPool = (FrameBufferPool *) opaque;
+    bufferPool->allocCount++;
+    return av_buffer_allocz(size);
+}
+
+int FrameBufferPool::getVideoBuffer(AVCodecContext *codecContext, AVFrame *frame) {
+    Mutex::Autolock lock(mutex);
+    int ret;
+
+    if (frame->format != format || frame->width != width || frame->height != height) {
+        if ((ret = updatePools(codecContext, frame)) < 0) {
+            return ret;
+        }
+    }
+
+    memset(frame->data, 0, sizeof(frame->data));
+    frame->extended_data = frame->data;
+    for (int i = 0; i < planes; i++) {
+        frame->buf[i] = av_buffer_pool_get(pools[i]);
+        if (!frame->buf[i]) {
+            av_frame_unref(frame);
+            return AVERROR(ENOMEM);
+        }
+        frame->linesize[i] = linesize[i];
+        frame->data[i] = (uint8_t *) FFALIGN((uintptr_t) frame->buf[i]->data, FRAME_BUFFER_ALIGN);
+    }
+    for (int i = planes; i < 4; i++) {
+        frame->linesize[i] = 0;
+    }
+    return 0;
+}
+
+/**
+ * 按解码器的对齐要求计算每个平面的行字节数和大小，重建缓冲池
+ */
+int FrameBufferPool::updatePools(AVCodecContext *codecContext, AVFrame *frame) {
+    int linesizeAlign[AV_NUM_DATA_POINTERS];
+    uint8_t *data[4];
+    int sizes[4];
+    int alignedWidth = frame->width;
+    int alignedHeight = frame->height;
+    int unaligned;
+    int ret;
+
+    releasePools();
+
+    avcodec_align_dimensions2(codecContext, &alignedWidth, &alignedHeight, linesizeAlign);
+
+    do {
+        // 宽度不断加上其最低位，直到每个平面的行字节数都满足对齐
+        ret = av_image_fill_linesizes(linesize, (AVPixelFormat) frame->format, alignedWidth);
+        if (ret < 0) {
+            return ret;
+        }
+        alignedWidth += alignedWidth & ~(alignedWidth - 1);
+        unaligned = 0;
+        for (int i = 0; i < 4; i++) {
+            unaligned |= linesize[i] % FFMAX(linesizeAlign[i], FRAME_BUFFER_ALIGN);
+        }
+    } while (unaligned);
+
+    // 起始地址为空时，返回的平面地址即为各平面在整块内存中的偏移
+    ret = av_image_fill_pointers(data, (AVPixelFormat) frame->format, alignedHeight, nullptr,
+                                 linesize);
+    if (ret < 0) {
+        return ret;
+    }
+    memset(sizes, 0, sizeof(sizes));
+    for (int i = 0; i < 3 && data[i + 1]; i++) {
+        sizes[i] = (int) (data[i + 1] - data[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        if (!sizes[i]) {
+            sizes[i] = ret - (int) (data[i] - data[0]);
+            break;
+        }
+    }
+
+    planes = 0;
+    for (int i = 0; i < 4 && sizes[i] > 0; i++) {
+        // 额外的空间给解码器越界读写的SIMD优化使用
+        pools[i] = av_buffer_pool_init2(sizes[i] + 16 + FRAME_BUFFER_ALIGN - 1, this,
+                                        allocBuffer, nullptr);
+        if (!pools[i]) {
+            releasePools();
+            return AVERROR(ENOMEM);
+        }
+        planes++;
+    }
+
+    format = frame->format;
+    width = frame->width;
+    height = frame->height;
+
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] format = %s size = %dx%d planes = %d", __func__,
+              av_get_pix_fmt_name((AVPixelFormat) format), width, height, planes);
+    }
+    return SUCCESS;
+}
+
+void FrameBufferPool::releasePools() {
+    for (int i = 0; i < 4; i++) {
+        av_buffer_pool_uninit(&pools[i]);
+    }
+    planes = 0;
+    format = -1;
+    width = 0;
+    height = 0;
+}
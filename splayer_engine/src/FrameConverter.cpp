@@ -0,0 +1,232 @@
+#include "FrameConverter.h"
+#include <unistd.h>
+
+FrameConverter::FrameConverter() = default;
+
+FrameConverter::~FrameConverter() {
+    stop();
+}
+
+/**
+ * 线程数为CPU核数，不超过FRAME_CONVERTER_MAX_THREADS，第一个分片在调用convert的线程中转换
+ */
+void FrameConverter::start() {
+    if (!slices.empty()) {
+        return;
+    }
+    long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+    int threadCount = (int) FFMAX(1, FFMIN(cpuCount, FRAME_CONVERTER_MAX_THREADS));
+    abortRequest = false;
+    for (int i = 0; i < threadCount; i++) {
+        auto *slice = new Slice();
+        slice->converter = this;
+        slice->index = i;
+        slice->generation = generation;
+        slice->y = 0;
+        slice->height = 0;
+        slice->swsContext = nullptr;
+        slice->task = nullptr;
+        if (i > 0) {
+            slice->task = new ThreadTask(slice);
+            slice->task->start();
+        }
+        slices.push_back(slice);
+    }
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] threads = %d", __func__, threadCount);
+    }
+}
+
+void FrameConverter::stop() {
+    mutex.lock();
+    abortRequest = true;
+    condition.broadcast();
+    mutex.unlock();
+    for (Slice *slice : slices) {
+        if (slice->task) {
+            slice->task->join();
+            delete slice->task;
+            slice->task = nullptr;
+        }
+        if (slice->swsContext) {
+            sws_freeContext(slice->swsContext);
+            slice->swsContext = nullptr;
+        }
+        delete slice;
+    }
+    slices.clear();
+    sliceCount = 0;
+    // 帧队列中还没有释放的缓冲在释放时回收缓冲池
+    av_buffer_pool_uninit(&bufferPool);
+    poolWidth = 0;
+    poolHeight = 0;
+}
+
+int FrameConverter::convert(const AVFrame *src, AVFrame *dst) {
+    if (slices.empty()) {
+        return ERROR;
+    }
+    int64_t startTime = av_gettime_relative();
+    if (prepare(src) < 0) {
+        return ERROR;
+    }
+    AVBufferRef *buffer = av_buffer_pool_get(bufferPool);
+    if (!buffer) {
+        return ERROR_NOT_MEMORY;
+    }
+    dst->buf[0] = buffer;
+    dst->data[0] = buffer->data;
+    dst->linesize[0] = dstLinesize;
+    dst->width = src->width;
+    dst->height = src->height;
+    dst->format = FRAME_CONVERTER_FORMAT;
+    av_frame_copy_props(dst, src);
+
+    // 唤醒工作线程转换其余分片
+    mutex.lock();
+    srcFrame = src;
+    dstFrame = dst;
+    pending = sliceCount - 1;
+    failed = false;
+    generation++;
+    condition.broadcast();
+    mutex.unlock();
+
+    int ret = convertSlice(slices[0]);
+
+    mutex.lock();
+    while (pending > 0 && !abortRequest) {
+        doneCondition.wait(mutex);
+    }
+    if (ret < 0 || pending > 0) {
+        failed = true;
+    }
+    bool success = !failed;
+    srcFrame = nullptr;
+    dstFrame = nullptr;
+    mutex.unlock();
+
+    if (!success) {
+        av_frame_unref(dst);
+        return ERROR;
+    }
+    updateConvertCost(startTime);
+    return SUCCESS;
+}
+
+/**
+ * 尺寸变化时重建缓冲池，按图像高度决定分片数量，每个分片的SwsContext按分片的尺寸缓存
+ * 分片的边界按FRAME_CONVERTER_SLICE_ALIGN对齐，调色板格式的第二个平面不是图像数据，不分片
+ */
+int FrameConverter::prepare(const AVFrame *src) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat) src->format);
+    if (!desc || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL) || src->width <= 0 ||
+        src->height <= 0) {
+        return ERROR;
+    }
+
+    if (!bufferPool || src->width != poolWidth || src->height != poolHeight) {
+        av_buffer_pool_uninit(&bufferPool);
+        dstLinesize = FFALIGN(src->width * 4, FRAME_CONVERTER_LINE_ALIGN);
+        bufferPool = av_buffer_pool_init(dstLinesize * src->height, nullptr);
+        if (!bufferPool) {
+            return ERROR_NOT_MEMORY;
+        }
+        poolWidth = src->width;
+        poolHeight = src->height;
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] %dx%d %s -> %s", __func__, src->width, src->height, desc->name,
+                  av_get_pix_fmt_name(FRAME_CONVERTER_FORMAT));
+        }
+    }
+
+    int count = 1;
+    if (!(desc->flags & AV_PIX_FMT_FLAG_PAL)) {
+        count = FFMAX(1, FFMIN(src->height / FRAME_CONVERTER_MIN_SLICE_HEIGHT, (int) slices.size()));
+    }
+    for (int i = 0; i < count; i++) {
+        Slice *slice = slices[i];
+        int y = i == 0 ? 0 : FFALIGN(src->height * i / count, FRAME_CONVERTER_SLICE_ALIGN);
+        int end = i == count - 1 ? src->height :
+                  FFALIGN(src->height * (i + 1) / count, FRAME_CONVERTER_SLICE_ALIGN);
+        slice->y = y;
+        slice->height = FFMIN(end, src->height) - y;
+        slice->swsContext = sws_getCachedContext(slice->swsContext, src->width, slice->height,
+                                                 (AVPixelFormat) src->format, src->width,
+                                                 slice->height, FRAME_CONVERTER_FORMAT,
+                                                 SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+        if (!slice->swsContext) {
+            ALOGE(TAG, "[%s] not support format %s", __func__, desc->name);
+            return ERROR;
+        }
+    }
+    sliceCount = count;
+    return SUCCESS;
+}
+
+/**
+ * 每个分片作为一幅独立的图像转换，色度平面的起始行按色度抽样换算
+ */
+int FrameConverter::convertSlice(Slice *slice) {
+    const AVFrame *src = srcFrame;
+    AVFrame *dst = dstFrame;
+    if (!src || !dst || slice->height <= 0) {
+        return ERROR;
+    }
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat) src->format);
+    const uint8_t *srcData[4] = {nullptr};
+    for (int i = 0; i < 4 && src->data[i]; i++) {
+        int shift = (i == 1 || i == 2) ? desc->log2_chroma_h : 0;
+        srcData[i] = src->data[i];
+        if (!(desc->flags & AV_PIX_FMT_FLAG_PAL) || i == 0) {
+            srcData[i] += (ptrdiff_t) (slice->y >> shift) * src->linesize[i];
+        }
+    }
+    uint8_t *dstData[4] = {dst->data[0] + (ptrdiff_t) slice->y * dst->linesize[0], nullptr,
+                           nullptr, nullptr};
+    int ret = sws_scale(slice->swsContext, srcData, src->linesize, 0, slice->height, dstData,
+                        dst->linesize);
+    return ret > 0 ? SUCCESS : ERROR;
+}
+
+/**
+ * 工作线程循环，任务序号变化时转换自己的分片，完成后通知调用convert的线程
+ */
+void FrameConverter::runSlice(Slice *slice) {
+    mutex.lock();
+    while (!abortRequest) {
+        if (slice->generation != generation) {
+            slice->generation = generation;
+            if (slice->index < sliceCount) {
+                mutex.unlock();
+                int ret = convertSlice(slice);
+                mutex.lock();
+                if (ret < 0) {
+                    failed = true;
+                }
+                if (--pending == 0) {
+                    doneCondition.signal();
+                }
+            }
+            continue;
+        }
+        condition.wait(mutex);
+    }
+    mutex.unlock();
+}
+
+/**
+ * 统计每帧转换的耗时，每FRAME_CONVERTER_STAT_FRAMES帧输出一次平均值
+ */
+void FrameConverter::updateConvertCost(int64_t startTime) {
+    convertTime += av_gettime_relative() - startTime;
+    convertCount++;
+    if (convertCount >= FRAME_CONVERTER_STAT_FRAMES) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] %dx%d slices = %d convert cost = %lld us/frame", __func__, poolWidth,
+                  poolHeight, sliceCount, (long long) (convertTime / convertCount));
+        }
+        convertTime = 0;
+        convertCount = 0;
+    }
+}
@@ -1,9 +1,10 @@
 #include "FrameQueue.h"
 
-FrameQueue::FrameQueue(int max_size, int keep_last, PacketQueue *packetQueue) {
+FrameQueue::FrameQueue(int max_size, int keep_last, PacketQueue *packetQueue, Event *readEvent) {
     this->packetQueue = packetQueue;
-    memset(queue, 0, sizeof(Frame) * FRAME_QUEUE_SIZE);
-    maxSize = FFMIN(max_size, FRAME_QUEUE_SIZE);
+    this->readEvent = readEvent;
+    maxSize = FFMAX(max_size, 1);
+    queue = (Frame *) av_mallocz_array(maxSize, sizeof(Frame));
     keepPreviousFrame = (keep_last != 0);
     for (int i = 0; i < this->maxSize; ++i) {
         queue[i].frame = av_frame_alloc();
@@ -12,7 +13,10 @@ FrameQueue::FrameQueue(int max_size, int keep_last, PacketQueue *packetQueue) {
     readIndex = 0;
     writeIndex = 0;
     size = 0;
+    memorySize = 0;
     readIndexShown = 0;
+    _condWriteableWait = false;
+    _condReadableWait = false;
 }
 
 FrameQueue::~FrameQueue() {
@@ -21,6 +25,7 @@ FrameQueue::~FrameQueue() {
         unrefFrame(vp);
         av_frame_free(&vp->frame);
     }
+    av_freep(&queue);
 }
 
 void FrameQueue::start() {
@@ -33,7 +38,7 @@ void FrameQueue::start() {
 void FrameQueue::abort() {
     mutex.lock();
     abortRequest = true;
-    condition.signal();
+    condition.broadcast();
     mutex.unlock();
 }
 
@@ -53,18 +58,19 @@ Frame *FrameQueue::peekNextFrame() {
 }
 
 Frame *FrameQueue::peekWritable() {
-    mutex.lock();
-    while (size >= maxSize && !abortRequest) {
-        if (!_condWriteableWait) {
-            _condWriteableWait = true;
+    if (size.load() >= maxSize && !abortRequest) {
+        mutex.lock();
+        _condWriteableWait = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (size.load() >= maxSize && !abortRequest) {
 //            if (ENGINE_DEBUG) {
-//                ALOGD(TAG, "[%s] size = %d maxSize = %d do waiting", __func__, size, maxSize);
+//                ALOGD(TAG, "[%s] size = %d maxSize = %d do waiting", __func__, size.load(), maxSize);
 //            }
+            condition.wait(mutex);
         }
-        condition.wait(mutex);
+        _condWriteableWait = false;
+        mutex.unlock();
     }
-    _condWriteableWait = false;
-    mutex.unlock();
 
     if (abortRequest) {
         return nullptr;
@@ -74,13 +80,12 @@ Frame *FrameQueue::peekWritable() {
 }
 
 void FrameQueue::pushFrame() {
+    memorySize += frameMemorySize(&queue[writeIndex]);
     if (++writeIndex == maxSize) {
         writeIndex = 0;
     }
-    mutex.lock();
-    size++;
-    condition.signal();
-    mutex.unlock();
+    size.fetch_add(1);
+    wakeWaiter(_condReadableWait);
 }
 
 void FrameQueue::popFrame() {
@@ -88,14 +93,29 @@ void FrameQueue::popFrame() {
         readIndexShown = 1;
         return;
     }
+    memorySize -= frameMemorySize(&queue[readIndex]);
     unrefFrame(&queue[readIndex]);
     if (++readIndex == maxSize) {
         readIndex = 0;
     }
-    mutex.lock();
-    size--;
-    condition.signal();
-    mutex.unlock();
+    size.fetch_sub(1);
+    wakeWaiter(_condWriteableWait);
+    if (readEvent) {
+        readEvent->signal();
+    }
+}
+
+void FrameQueue::wakeWaiter(std::atomic<bool> &waiting) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed)) {
+        mutex.lock();
+        condition.broadcast();
+        mutex.unlock();
+    }
+}
+
+bool FrameQueue::isAbort() {
+    return abortRequest || (packetQueue && packetQueue->isAbort());
 }
 
 void FrameQueue::flush() {
@@ -106,6 +126,20 @@ void FrameQueue::flush() {
 
 int FrameQueue::getFrameSize() { return size - readIndexShown; }
 
+int64_t FrameQueue::getMemorySize() { return memorySize; }
+
+int64_t FrameQueue::frameMemorySize(Frame *frame) {
+    int64_t bufferSize = 0;
+    AVFrame *avFrame = frame->frame;
+    for (int i = 0; i < AV_NUM_DATA_POINTERS && avFrame->buf[i]; i++) {
+        bufferSize += avFrame->buf[i]->size;
+    }
+    for (int i = 0; i < avFrame->nb_extended_buf; i++) {
+        bufferSize += avFrame->extended_buf[i]->size;
+    }
+    return bufferSize;
+}
+
 void FrameQueue::unrefFrame(Frame *frame) {
     av_frame_unref(frame->frame);
     avsubtitle_free(&frame->sub);
@@ -115,21 +149,22 @@ int FrameQueue::isShownIndex() const { return readIndexShown; }
 
 Frame *FrameQueue::peekReadable() {
     // wait until we have a readable a new frame
-    mutex.lock();
-    while ((size - readIndexShown) <= 0 && !packetQueue->isAbort()) {
-        if (!_condReadableWait) {
-            _condReadableWait = true;
-            if (ENGINE_DEBUG) {
-                ALOGD(TAG, "[%s] size = %d maxSize = %d do waiting", __func__, size, maxSize);
-            }
+    if ((size.load() - readIndexShown) <= 0 && !isAbort()) {
+        mutex.lock();
+        _condReadableWait = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] size = %d maxSize = %d do waiting", __func__, size.load(), maxSize);
         }
-        condition.wait(mutex);
+        while ((size.load() - readIndexShown) <= 0 && !isAbort()) {
+            condition.wait(mutex);
+        }
+        _condReadableWait = false;
+        mutex.unlock();
     }
-    _condReadableWait = false;
-    mutex.unlock();
 
     // abort
-    if (packetQueue->isAbort()) {
+    if (isAbort()) {
         return nullptr;
     }
 
@@ -0,0 +1,227 @@
+#include "KeyframeIndex.h"
+#include "StreamCache.h"
+#include <cstdio>
+#include <unistd.h>
+#include <sys/stat.h>
+
+KeyframeIndex::KeyframeIndex() {
+    timeBase = (AVRational) {1, AV_TIME_BASE};
+}
+
+KeyframeIndex::~KeyframeIndex() {
+    close();
+}
+
+/**
+ * TS、FLV、PS没有完整的原生索引，按时间定位时需要在文件中二分查找
+ */
+bool KeyframeIndex::isSupported(AVFormatContext *formatContext) {
+    if (!formatContext->iformat || !formatContext->pb ||
+        !(formatContext->pb->seekable & AVIO_SEEKABLE_NORMAL) ||
+        (formatContext->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+        return false;
+    }
+    const char *name = formatContext->iformat->name;
+    return !strcmp(name, "mpegts") || !strcmp(name, "flv") || !strcmp(name, "mpeg");
+}
+
+int KeyframeIndex::open(AVFormatContext *formatContext, int streamIndex, const char *url,
+                        const char *cacheDir) {
+    this->streamIndex = streamIndex;
+    this->timeBase = formatContext->streams[streamIndex]->time_base;
+    this->mediaSize = avio_size(formatContext->pb);
+    if (mediaSize <= 0) {
+        return ERROR;
+    }
+
+    // 本地文件的索引保存在文件旁边，网络资源的索引保存在缓存目录中
+    const char *file = url;
+    av_strstart(url, "file:", &file);
+    struct stat st;
+    if (!strstr(file, "://") && stat(file, &st) == 0) {
+        path = std::string(file) + KEYFRAME_INDEX_SUFFIX;
+        mediaTime = st.st_mtime;
+    } else if (cacheDir) {
+        path = StreamCache::getCachePath(cacheDir, url) + KEYFRAME_INDEX_SUFFIX;
+    }
+
+    load();
+
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] %s keyframes = %d spans = %d", __func__, path.c_str(),
+              (int) keyframes.size(), (int) spans.size());
+    }
+    return SUCCESS;
+}
+
+void KeyframeIndex::close() {
+    commitSpan();
+    if (dirty) {
+        save();
+        dirty = false;
+    }
+}
+
+void KeyframeIndex::addPacket(const AVPacket *pkt) {
+    if (pkt->stream_index != streamIndex || pkt->pos < 0) {
+        return;
+    }
+    int64_t timestamp = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+    if (timestamp == AV_NOPTS_VALUE) {
+        return;
+    }
+    timestamp = av_rescale_q(timestamp, timeBase, AV_TIME_BASE_Q);
+
+    if (pkt->flags & AV_PKT_FLAG_KEY) {
+        auto it = keyframes.find(timestamp);
+        if (it == keyframes.end() || it->second != pkt->pos) {
+            keyframes[timestamp] = pkt->pos;
+            dirty = true;
+        }
+        if (spanStart == AV_NOPTS_VALUE) {
+            spanStart = timestamp;
+            spanEnd = timestamp;
+        }
+        commitSpan();
+    }
+
+    // 区间从关键帧开始，区间内的关键帧都已经记录
+    if (spanStart != AV_NOPTS_VALUE && timestamp > spanEnd) {
+        spanEnd = timestamp;
+    }
+}
+
+void KeyframeIndex::discontinue() {
+    commitSpan();
+    spanStart = AV_NOPTS_VALUE;
+    spanEnd = AV_NOPTS_VALUE;
+}
+
+bool KeyframeIndex::find(int64_t target, int64_t *pts, int64_t *pos) {
+    bool covered = spanStart != AV_NOPTS_VALUE && target >= spanStart && target <= spanEnd;
+    if (!covered) {
+        auto it = spans.upper_bound(target);
+        covered = it != spans.begin() && std::prev(it)->second >= target;
+    }
+    if (!covered) {
+        return false;
+    }
+    auto it = keyframes.upper_bound(target);
+    if (it == keyframes.begin()) {
+        return false;
+    }
+    --it;
+    *pts = it->first;
+    *pos = it->second;
+    return true;
+}
+
+void KeyframeIndex::commitSpan() {
+    if (spanStart == AV_NOPTS_VALUE) {
+        return;
+    }
+    int64_t start = spanStart;
+    int64_t end = spanEnd;
+    auto it = spans.upper_bound(start);
+    if (it != spans.begin()) {
+        auto prev = std::prev(it);
+        if (prev->second >= start) {
+            if (prev->second >= end) {
+                return;
+            }
+            start = prev->first;
+            it = spans.erase(prev);
+        }
+    }
+    while (it != spans.end() && it->first <= end) {
+        end = FFMAX(end, it->second);
+        it = spans.erase(it);
+    }
+    spans[start] = end;
+    dirty = true;
+}
+
+void KeyframeIndex::load() {
+    if (path.empty()) {
+        return;
+    }
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return;
+    }
+    int32_t magic = 0;
+    int64_t size = 0;
+    int64_t time = 0;
+    int32_t index = -1;
+    int32_t count = 0;
+    bool valid = fread(&magic, sizeof(magic), 1, file) == 1 && magic == KEYFRAME_INDEX_MAGIC &&
+                 fread(&size, sizeof(size), 1, file) == 1 && size == mediaSize &&
+                 fread(&time, sizeof(time), 1, file) == 1 && time == mediaTime &&
+                 fread(&index, sizeof(index), 1, file) == 1 && index == streamIndex;
+    if (valid && fread(&count, sizeof(count), 1, file) == 1) {
+        for (int i = 0; i < count; i++) {
+            int64_t entry[2];
+            if (fread(entry, sizeof(entry), 1, file) != 1) {
+                valid = false;
+                break;
+            }
+            keyframes[entry[0]] = entry[1];
+        }
+    }
+    if (valid && fread(&count, sizeof(count), 1, file) == 1) {
+        for (int i = 0; i < count; i++) {
+            int64_t entry[2];
+            if (fread(entry, sizeof(entry), 1, file) != 1) {
+                valid = false;
+                break;
+            }
+            spans[entry[0]] = entry[1];
+        }
+    }
+    fclose(file);
+
+    // 媒体已经改变或者索引文件不完整，重新建立
+    if (!valid) {
+        keyframes.clear();
+        spans.clear();
+    }
+}
+
+void KeyframeIndex::save() {
+    if (path.empty()) {
+        return;
+    }
+    std::string tempPath = path + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] could not write %s", __func__, tempPath.c_str());
+        }
+        return;
+    }
+    int32_t magic = KEYFRAME_INDEX_MAGIC;
+    int32_t index = streamIndex;
+    fwrite(&magic, sizeof(magic), 1, file);
+    fwrite(&mediaSize, sizeof(mediaSize), 1, file);
+    fwrite(&mediaTime, sizeof(mediaTime), 1, file);
+    fwrite(&index, sizeof(index), 1, file);
+    auto count = (int32_t) keyframes.size();
+    fwrite(&count, sizeof(count), 1, file);
+    for (auto &it : keyframes) {
+        int64_t entry[2] = {it.first, it.second};
+        fwrite(entry, sizeof(entry), 1, file);
+    }
+    count = (int32_t) spans.size();
+    fwrite(&count, sizeof(count), 1, file);
+    for (auto &it : spans) {
+        int64_t entry[2] = {it.first, it.second};
+        fwrite(entry, sizeof(entry), 1, file);
+    }
+    bool failed = ferror(file) != 0;
+    fclose(file);
+
+    // 先写临时文件再替换，避免中途退出留下不完整的索引
+    if (failed || rename(tempPath.c_str(), path.c_str()) < 0) {
+        unlink(tempPath.c_str());
+    }
+}
@@ -0,0 +1,169 @@
+#include "LatencyController.h"
+#include "Msg.h"
+
+LatencyController::LatencyController() {
+    enabled = false;
+    liveEdge = NAN;
+    latency = NAN;
+    speed = 1.0;
+    resetRequest = false;
+}
+
+LatencyController::~LatencyController() {
+    messageCenter = nullptr;
+}
+
+void LatencyController::open(MessageCenter *messageCenter, AVFormatContext *formatContext,
+                             int64_t targetLatency, int64_t maxLatency) {
+    this->messageCenter = messageCenter;
+    this->targetLatency = targetLatency / 1000.0;
+    this->maxLatency = FFMAX(maxLatency, targetLatency * 2) / 1000.0;
+    startTimeRealtime = formatContext->start_time_realtime;
+    startTime = formatContext->start_time;
+    liveEdge = NAN;
+    latency = NAN;
+    endToEndLatency = NAN;
+    speed = 1.0;
+    resetRequest = false;
+    lastCheckTime = 0;
+    lastNotifyTime = 0;
+    lastDropTime = 0;
+    catchUpCount = 0;
+    dropCount = 0;
+    enabled = true;
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] target = %lld ms max = %lld ms realtime = %lld", __func__,
+              (long long) targetLatency, (long long) (this->maxLatency * 1000),
+              (long long) startTimeRealtime);
+    }
+}
+
+void LatencyController::close() {
+    if (ENGINE_DEBUG && enabled) {
+        ALOGD(TAG, "[%s] catch up = %d drop = %d", __func__, catchUpCount, dropCount);
+    }
+    enabled = false;
+    speed = 1.0;
+}
+
+bool LatencyController::isEnabled() const {
+    return enabled;
+}
+
+/**
+ * 时间戳回绕或者推流端重启时直播边缘会大幅后退，直接使用新的时间戳
+ */
+void LatencyController::onPacket(const AVPacket *pkt, AVRational timeBase) {
+    int64_t timestamp = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+    if (!enabled || timestamp == AV_NOPTS_VALUE) {
+        return;
+    }
+    double pts = timestamp * av_q2d(timeBase);
+    double edge = liveEdge;
+    if (isnan(edge) || pts > edge || edge - pts > LOW_LATENCY_DISCONTINUITY) {
+        liveEdge = pts;
+    }
+}
+
+/**
+ * 延时做指数平滑，避免数据包成批到达时速度来回变化
+ * 超出目标的部分按固定时长追回，速度逐步变化并限制在最大速度以内，延时回到容差内时恢复正常速度
+ */
+double LatencyController::update(double masterClock) {
+    if (!enabled) {
+        return 1.0;
+    }
+    if (resetRequest.exchange(false)) {
+        latency = NAN;
+        speed = 1.0;
+    }
+    double now = av_gettime_relative() / 1000000.0;
+    if (now - lastCheckTime < LOW_LATENCY_CHECK_INTERVAL) {
+        return speed;
+    }
+    lastCheckTime = now;
+
+    double edge = liveEdge;
+    if (isnan(masterClock) || isnan(edge)) {
+        return speed;
+    }
+    double current = FFMAX(edge - masterClock, 0);
+    double smoothed = latency;
+    smoothed = isnan(smoothed) ? current : smoothed * 0.8 + current * 0.2;
+    latency = smoothed;
+
+    // 发送端的绝对时间对应流的起始时间
+    if (startTimeRealtime != AV_NOPTS_VALUE && startTimeRealtime > 0) {
+        double start = startTime != AV_NOPTS_VALUE ? (double) startTime / AV_TIME_BASE : 0;
+        endToEndLatency = (av_gettime() - startTimeRealtime) / 1000000.0 - (masterClock - start);
+    }
+
+    double excess = smoothed - targetLatency;
+    double wanted = 1.0;
+    if (excess > LOW_LATENCY_TOLERANCE) {
+        wanted = FFMIN(1.0 + excess / LOW_LATENCY_CATCH_UP_TIME, LOW_LATENCY_MAX_SPEED);
+    }
+    double value = speed;
+    double next = value;
+    if (wanted > value) {
+        next = FFMIN(value + LOW_LATENCY_SPEED_STEP, wanted);
+    } else if (wanted < value) {
+        next = FFMAX(value - LOW_LATENCY_SPEED_STEP, wanted);
+    }
+    if (value == 1.0 && next > 1.0) {
+        catchUpCount++;
+    }
+    speed = next;
+
+    if (now - lastNotifyTime >= LOW_LATENCY_NOTIFY_INTERVAL) {
+        lastNotifyTime = now;
+        int64_t reported = getLatency();
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] latency = %lld ms buffer = %d ms speed = %.2f", __func__,
+                  (long long) reported, (int) (smoothed * 1000), next);
+        }
+        if (messageCenter) {
+            messageCenter->notifyMsg(Msg::MSG_LIVE_LATENCY, (int) reported,
+                                     (int) lrint(next * 100));
+        }
+    }
+    return next;
+}
+
+bool LatencyController::isStale() {
+    double value = latency;
+    if (!enabled || isnan(value) || value <= maxLatency) {
+        return false;
+    }
+    double now = av_gettime_relative() / 1000000.0;
+    if (now - lastDropTime < LOW_LATENCY_DROP_INTERVAL) {
+        return false;
+    }
+    lastDropTime = now;
+    dropCount++;
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] latency = %d ms exceeds %d ms", __func__, (int) (value * 1000),
+              (int) (maxLatency * 1000));
+    }
+    return true;
+}
+
+void LatencyController::reset() {
+    latency = NAN;
+    resetRequest = true;
+}
+
+double LatencyController::getSpeed() const {
+    return speed;
+}
+
+/**
+ * 有发送端的绝对时间时返回端到端延时，否则返回客户端缓冲的延时
+ */
+int64_t LatencyController::getLatency() const {
+    double value = !isnan(endToEndLatency) ? endToEndLatency : (double) latency;
+    if (isnan(value)) {
+        return -1;
+    }
+    return (int64_t) (value * 1000);
+}
@@ -0,0 +1,184 @@
+#include "LocalFileIO.h"
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+LocalFileIO::LocalFileIO() = default;
+
+LocalFileIO::~LocalFileIO() {
+    closeInput();
+}
+
+bool LocalFileIO::isSupported(const char *url) {
+    if (!url) {
+        return false;
+    }
+    const char *file = url;
+    av_strstart(url, "file:", &file);
+    struct stat st;
+    return !strstr(file, "://") && stat(file, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+int LocalFileIO::openInput(AVFormatContext *formatContext, const char *url) {
+    const char *file = url;
+    av_strstart(url, "file:", &file);
+    path = file;
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        ALOGE(TAG, "[%s] open %s failure", __func__, path.c_str());
+        return ERROR_NOT_OPEN_INPUT;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        closeInput();
+        return ERROR_NOT_OPEN_INPUT;
+    }
+    size = st.st_size;
+
+    // 地址空间不够时映射会失败，退回到pread；最近修改过的文件可能正在写入，也使用pread
+    int bufferSize = LOCAL_FILE_READ_BUFFER_SIZE;
+    bool stable = time(nullptr) - st.st_mtime >= LOCAL_FILE_STABLE_TIME;
+    if (stable && (uint64_t) size <= SIZE_MAX) {
+        void *addr = mmap(nullptr, (size_t) size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            data = (uint8_t *) addr;
+            mappedSize = size;
+            madvise(data, (size_t) size, MADV_SEQUENTIAL);
+            bufferSize = LOCAL_FILE_MAP_BUFFER_SIZE;
+        }
+    }
+    if (!data) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    auto *buffer = (uint8_t *) av_malloc((size_t) bufferSize);
+    if (!buffer) {
+        closeInput();
+        return ERROR_NOT_MEMORY;
+    }
+    ioContext = avio_alloc_context(buffer, bufferSize, 0, this, readPacket, nullptr, seekPacket);
+    if (!ioContext) {
+        av_free(buffer);
+        closeInput();
+        return ERROR_NOT_MEMORY;
+    }
+    ioContext->seekable = AVIO_SEEKABLE_NORMAL;
+    // 映射时定位只是移动位置，大块读取直接写入调用者的缓冲，比如数据包，少一次复制
+    ioContext->direct = data ? 1 : 0;
+
+    formatContext->pb = ioContext;
+    formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] %s size = %lld mmap = %d", __func__, path.c_str(), (long long) size,
+              data != nullptr);
+    }
+    return SUCCESS;
+}
+
+void LocalFileIO::closeInput() {
+    if (ENGINE_DEBUG && ioContext) {
+        ALOGD(TAG, "[%s] reads = %lld syscalls = %lld bytes = %lld", __func__,
+              (long long) readCount, (long long) syscallCount, (long long) readBytes);
+    }
+    if (ioContext) {
+        av_freep(&ioContext->buffer);
+        avio_context_free(&ioContext);
+    }
+    if (data) {
+        munmap(data, (size_t) mappedSize);
+        data = nullptr;
+        mappedSize = 0;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * 读到已知的结尾或者pread读到结尾时重新获取文件大小，文件还在增长时继续读取
+ */
+int LocalFileIO::read(uint8_t *buf, int size) {
+    if (position >= this->size && updateSize() <= position) {
+        return AVERROR_EOF;
+    }
+    size = (int) FFMIN(size, this->size - position);
+    readCount++;
+
+    if (data && position < mappedSize) {
+        size = (int) FFMIN(size, mappedSize - position);
+        memcpy(buf, data + position, (size_t) size);
+    } else {
+        syscallCount++;
+        ssize_t length = pread(fd, buf, (size_t) size, (off_t) position);
+        if (length < 0) {
+            return AVERROR(errno);
+        }
+        if (length == 0) {
+            // 文件被截断
+            updateSize();
+            return AVERROR_EOF;
+        }
+        size = (int) length;
+    }
+    position += size;
+    readBytes += size;
+    return size;
+}
+
+int64_t LocalFileIO::seek(int64_t offset, int whence) {
+    int64_t pos;
+    switch (whence & ~AVSEEK_FORCE) {
+        case AVSEEK_SIZE:
+            return updateSize();
+        case SEEK_SET:
+            pos = offset;
+            break;
+        case SEEK_CUR:
+            pos = position + offset;
+            break;
+        case SEEK_END:
+            pos = updateSize() + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+    if (pos < 0) {
+        return AVERROR(EINVAL);
+    }
+    // 定位之后提示内核从新位置开始预读
+    if (!data && pos != position && pos < size) {
+        syscallCount++;
+        posix_fadvise(fd, (off_t) pos, LOCAL_FILE_READ_BUFFER_SIZE * 4, POSIX_FADV_WILLNEED);
+    }
+    position = pos;
+    return position;
+}
+
+/**
+ * 读取长度按文件大小限制，文件被截断之后不再读取结尾之后的映射内存
+ */
+int64_t LocalFileIO::updateSize() {
+    struct stat st;
+    syscallCount++;
+    if (fstat(fd, &st) == 0 && st.st_size != size) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] %s size %lld -> %lld", __func__, path.c_str(), (long long) size,
+                  (long long) st.st_size);
+        }
+        size = st.st_size;
+    }
+    return size;
+}
+
+int LocalFileIO::readPacket(void *opaque, uint8_t *buf, int size) {
+    return ((LocalFileIO *) opaque)->read(buf, size);
+}
+
+int64_t LocalFileIO::seekPacket(void *opaque, int64_t offset, int whence) {
+    return ((LocalFileIO *) opaque)->seek(offset, whence);
+}
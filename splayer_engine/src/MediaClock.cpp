@@ -4,7 +4,7 @@ MediaClock::MediaClock() { queueSerial = nullptr; }
 
 MediaClock::~MediaClock() { queueSerial = nullptr; }
 
-void MediaClock::init(int *queueSeekSerial) {
+void MediaClock::init(std::atomic<int> *queueSeekSerial) {
     speed = 1.0;
     paused = 0;
     queueSerial = queueSeekSerial;
@@ -2,7 +2,7 @@
 
 MediaDecoder::MediaDecoder(AVCodecContext *codecContext, AVStream *stream,
                            int streamIndex, PlayerInfoStatus *playerState,
-                           AVPacket *flushPacket, Condition *readWaitCond, AVDictionary *opts,
+                           AVPacket *flushPacket, Event *readEvent, AVDictionary *opts,
                            MessageCenter *messageCenter) {
     this->packetQueue = new PacketQueue(flushPacket);
     this->codecContext = codecContext;
@@ -10,9 +10,10 @@ MediaDecoder::MediaDecoder(AVCodecContext *codecContext, AVStream *stream,
     this->streamIndex = streamIndex;
     this->playerState = playerState;
     this->flushPacket = flushPacket;
-    this->readWaitCond = readWaitCond;
+    this->readEvent = readEvent;
     this->opts = opts;
     this->messageCenter = messageCenter;
+    this->seekTarget = AV_NOPTS_VALUE;
 }
 
 MediaDecoder::~MediaDecoder() {
@@ -20,9 +21,11 @@ MediaDecoder::~MediaDecoder() {
     delete packetQueue;
     packetQueue = nullptr;
     if (codecContext != nullptr) {
+        FrameBufferPool *bufferPool = FrameBufferPool::from(codecContext);
         avcodec_close(codecContext);
         avcodec_free_context(&codecContext);
         codecContext = nullptr;
+        delete bufferPool;
     }
     if (opts) {
         av_dict_free(&opts);
@@ -60,7 +63,7 @@ int MediaDecoder::hasEnoughPackets() {
     return streamIndex < 0 || (packetQueue == nullptr) ||
            packetQueue->isAbort() ||
            (stream->disposition & AV_DISPOSITION_ATTACHED_PIC) ||
-           ((packetQueue->getPacketSize() > MIN_FRAMES) &&
+           ((packetQueue->getPacketSize() > playerState->minFrames) &&
             (!packetQueue->getDuration() ||
              av_q2d(stream->time_base) * packetQueue->getDuration() > 1.0));
 }
@@ -119,3 +122,31 @@ int MediaDecoder::notifyMsg(int what, int arg1, int arg2) {
     }
     return ERROR;
 }
+
+void MediaDecoder::setSeekTarget(int64_t seekTarget) {
+    this->seekTarget = seekTarget;
+}
+
+void MediaDecoder::startAccurateSeek() {
+    accurateSeekPts = seekTarget;
+    accurateSeekStart = av_gettime_relative();
+    accurateSeekDrops = 0;
+}
+
+bool MediaDecoder::isBeforeSeekTarget(int64_t pts, int64_t duration) {
+    if (accurateSeekPts == AV_NOPTS_VALUE || pts == AV_NOPTS_VALUE) {
+        return false;
+    }
+    // 目标时间落在帧的显示区间内时，这一帧就是目标帧
+    if (pts + FFMAX(duration, 1) <= accurateSeekPts) {
+        accurateSeekDrops++;
+        return true;
+    }
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] stream = %d target = %lld frame = %lld drops = %d cost = %lld ms",
+              __func__, streamIndex, (long long) accurateSeekPts, (long long) pts,
+              accurateSeekDrops, (long long) (av_gettime_relative() - accurateSeekStart) / 1000);
+    }
+    accurateSeekPts = AV_NOPTS_VALUE;
+    return false;
+}
@@ -0,0 +1,71 @@
+#include "MediaEngine.h"
+
+Mutex MediaEngine::mutex;
+
+int MediaEngine::instanceCount = 0;
+
+int MediaEngine::acquire() {
+    Mutex::Autolock lock(mutex);
+    if (instanceCount == 0) {
+        avformat_network_init();
+    }
+    instanceCount++;
+    return SUCCESS;
+}
+
+int MediaEngine::release() {
+    Mutex::Autolock lock(mutex);
+    if (instanceCount <= 0) {
+        return ERROR;
+    }
+    instanceCount--;
+    if (instanceCount == 0) {
+        avformat_network_deinit();
+    }
+    return SUCCESS;
+}
+
+int MediaEngine::shutdown() {
+    Mutex::Autolock lock(mutex);
+    if (instanceCount > 0) {
+        return ERROR;
+    }
+    return ThreadPool::getInstance()->shutdown();
+}
+
+int MediaEngine::getInstanceCount() {
+    Mutex::Autolock lock(mutex);
+    return instanceCount;
+}
+
+void MediaEngine::getStats(EngineStats *stats) {
+    stats->instanceCount = getInstanceCount();
+    stats->poolSize = ThreadPool::getInstance()->getPoolSize();
+    stats->activeCount = ThreadPool::getInstance()->getActiveCount();
+    stats->processThreads = -1;
+    stats->processRss = -1;
+#if defined(__linux__)
+    // Linux和Android从/proc读取进程的线程数量和常驻内存
+    FILE *file = fopen("/proc/self/status", "r");
+    if (file) {
+        char line[128];
+        while (fgets(line, sizeof(line), file)) {
+            long value;
+            if (sscanf(line, "Threads: %ld", &value) == 1) {
+                stats->processThreads = (int) value;
+            } else if (sscanf(line, "VmRSS: %ld", &value) == 1) {
+                stats->processRss = value;
+            }
+        }
+        fclose(file);
+    }
+#endif
+}
+
+void MediaEngine::dumpStats(const char *tag) {
+    EngineStats stats;
+    getStats(&stats);
+    ALOGD(tag, "[%s] instances = %d pool size = %d active = %d threads = %d rss = %lld KB",
+          __func__, stats.instanceCount, stats.poolSize, stats.activeCount,
+          stats.processThreads, (long long) stats.processRss);
+}
@@ -6,12 +6,19 @@ void audioPCMQueueCallback(void *opaque, uint8_t *stream, int len) {
 }
 
 MediaPlayer::MediaPlayer() {
+    // 预先创建工作线程，打开媒体时直接复用
+    ThreadPool::getInstance()->prestartCoreThreads();
+    streamPreloader = new StreamPreloader();
     messageCenter = new MessageCenter(this, this);
     messageCenter->startMsgQueue();
     changeStatus(IDLED);
 };
 
 MediaPlayer::~MediaPlayer() {
+    if (streamPreloader) {
+        delete streamPreloader;
+        streamPreloader = nullptr;
+    }
     if (audioDevice) {
         delete audioDevice;
         audioDevice = nullptr;
@@ -107,6 +114,33 @@ int MediaPlayer::setDataSource(const char *url, int64_t offset, const char *head
     return syncSetDataSource(url, offset, headers);
 }
 
+/**
+ * 在后台预加载下一个媒体，之后对同一个url调用setDataSource和start时直接使用预加载的结果
+ * 预加载使用当前播放器的解复用和解码参数
+ */
+int MediaPlayer::prepareNext(const char *url, int64_t offset, const char *headers) {
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] url = %s offset = %lld", __func__, url, offset);
+    }
+    if (!url) {
+        return ERROR_PARAMS;
+    }
+    // 预加载在后台使用播放器参数的副本，播放器参数在预加载期间可以被修改或者重置
+    auto *options = new PlayerInfoStatus();
+    int64_t preloadDuration = PRELOAD_DURATION;
+    mutex.lock();
+    if (playerInfoStatus) {
+        options->copyOpenOptions(playerInfoStatus);
+        preloadDuration = playerInfoStatus->preloadDuration;
+    }
+    mutex.unlock();
+    return streamPreloader->prepare(url, offset, headers, options, preloadDuration * 1000);
+}
+
+StreamPreloader *MediaPlayer::getStreamPreloader() {
+    return streamPreloader;
+}
+
 int MediaPlayer::seekTo(float increment) {
     if (ENGINE_DEBUG) {
         ALOGD(TAG, "[%s] increment = %lf", __func__, increment);
@@ -115,6 +149,96 @@ int MediaPlayer::seekTo(float increment) {
     return notifyMsg(Msg::MSG_REQUEST_SEEK, increment);
 }
 
+int MediaPlayer::startScrub() {
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s]", __func__);
+    }
+    if (!(isPLAYING() || isPAUSED()) || !playerInfoStatus || playerInfoStatus->realTime) {
+        notExecuteWarning();
+        return ERROR;
+    }
+    if (playerInfoStatus->scrubbing) {
+        return SUCCESS;
+    }
+    scrubResume = isPLAYING();
+    scrubPosition = AV_NOPTS_VALUE;
+    scrubStartTime = av_gettime_relative();
+    scrubStartCpu = clock();
+    playerInfoStatus->scrubRequests = 0;
+    playerInfoStatus->scrubSeeks = 0;
+    playerInfoStatus->scrubFrames = 0;
+    playerInfoStatus->scrubTarget = AV_NOPTS_VALUE;
+    playerInfoStatus->scrubbing = 1;
+    if (scrubResume) {
+        notifyMsg(Msg::MSG_REQUEST_PAUSE);
+    }
+    return SUCCESS;
+}
+
+/**
+ * 不经过消息队列，读包线程每次只取最新的位置，来不及处理的位置直接被覆盖
+ * @param positionMs
+ * @return
+ */
+int MediaPlayer::scrubTo(int64_t positionMs) {
+    if (!playerInfoStatus || !playerInfoStatus->scrubbing) {
+        notExecuteWarning();
+        return ERROR;
+    }
+    int64_t pos = av_rescale(positionMs, AV_TIME_BASE, 1000);
+    if (formatContext && formatContext->start_time != AV_NOPTS_VALUE) {
+        pos += formatContext->start_time;
+    }
+    scrubPosition = pos;
+    playerInfoStatus->scrubTarget = pos;
+    playerInfoStatus->scrubRequests++;
+    if (mediaStream) {
+        mediaStream->getReadEvent()->signal();
+    }
+    return SUCCESS;
+}
+
+int MediaPlayer::stopScrub() {
+    if (!playerInfoStatus || !playerInfoStatus->scrubbing) {
+        notExecuteWarning();
+        return ERROR;
+    }
+    if (ENGINE_DEBUG) {
+        double elapsed = (av_gettime_relative() - scrubStartTime) / (double) AV_TIME_BASE;
+        double cpu = (clock() - scrubStartCpu) / (double) CLOCKS_PER_SEC;
+        ALOGD(TAG, "[%s] requests = %d seeks = %d frames = %d elapsed = %.3lf s "
+                   "fps = %.1lf cpu = %.1lf%%", __func__,
+              (int) playerInfoStatus->scrubRequests, (int) playerInfoStatus->scrubSeeks,
+              (int) playerInfoStatus->scrubFrames, elapsed,
+              elapsed > 0 ? playerInfoStatus->scrubFrames / elapsed : 0,
+              elapsed > 0 ? cpu * 100 / elapsed : 0);
+    }
+
+    // 精确定位到最后的位置，覆盖尚未处理的定位请求
+    // 先发出定位请求再结束拖动，和读包线程的定位在同一个锁内，结束拖动之后读出的数据包都在定位之后
+    if (scrubPosition != AV_NOPTS_VALUE) {
+        notifyMsg(Msg::MSG_SEEK_START);
+    }
+    playerInfoStatus->mutex.lock();
+    if (scrubPosition != AV_NOPTS_VALUE) {
+        playerInfoStatus->seekPos = scrubPosition;
+        playerInfoStatus->seekRel = 0;
+        playerInfoStatus->seekFlags &= ~AVSEEK_FLAG_BYTE;
+        playerInfoStatus->accurateSeekRequest = 1;
+        playerInfoStatus->seekRequest = 1;
+    }
+    playerInfoStatus->scrubbing = 0;
+    playerInfoStatus->scrubTarget = AV_NOPTS_VALUE;
+    playerInfoStatus->mutex.unlock();
+    if (mediaStream) {
+        mediaStream->getReadEvent()->signal();
+    }
+    if (scrubResume) {
+        notifyMsg(Msg::MSG_REQUEST_PLAY);
+    }
+    return SUCCESS;
+}
+
 void MediaPlayer::setLooping(int looping) {
     mutex.lock();
     if (playerInfoStatus) {
@@ -267,121 +391,20 @@ void MediaPlayer::setVideoDevice(VideoDevice *videoDevice) {
 
 int MediaPlayer::openDecoder(int streamIndex) {
     AVCodecContext *codecContext = nullptr;
-    AVCodec *codec = nullptr;
     AVDictionary *opts = nullptr;
-    AVDictionaryEntry *t = nullptr;
-    char *forcedCodecName = nullptr;
-    int ret = 0;
-
-    // 判断流索引的合法性
-    if (!formatContext || streamIndex < 0 || streamIndex >= formatContext->nb_streams) {
-        ALOGE(TAG, "[%s] illegal stream index", __func__);
-        return ERROR_STREAM_INDEX;
-    }
-
-    // 创建解码上下文
-    codecContext = avcodec_alloc_context3(nullptr);
-    if (!codecContext) {
-        ALOGE(TAG, "[%s] alloc codec context failure", __func__);
-        return ERROR_NOT_MEMORY;
-    }
 
-    // 复制解码上下文参数
-    ret = avcodec_parameters_to_context(codecContext,
-                                        formatContext->streams[streamIndex]->codecpar);
+    // 优先使用预加载时已经打开的解码器
+    int ret = mediaStream->openCodec(streamIndex, &codecContext, &opts);
     if (ret < 0) {
-        ALOGE(TAG, "[%s] copy codec params to context failure", __func__);
-        return ERROR_COPY_CODEC_PARAM_TO_CONTEXT;
+        return ret;
     }
 
-    // 设置时钟基准
-    codecContext->pkt_timebase = formatContext->streams[streamIndex]->time_base;
-
-    // 优先使用指定的解码器
-    if (codecContext->codec_type == AVMEDIA_TYPE_AUDIO) {
-        forcedCodecName = playerInfoStatus->audioCodecName;
-    } else if (codecContext->codec_type == AVMEDIA_TYPE_VIDEO) {
-        forcedCodecName = playerInfoStatus->videoCodecName;
-    }
-
-    // 如果指定了解码器，则查找指定解码器
-    if (forcedCodecName) {
-        codec = avcodec_find_decoder_by_name(forcedCodecName);
-    }
-
-    // 如果没有找到指定的解码器，则查找默认的解码器
-    if (!codec) {
-        if (forcedCodecName) {
-            if (ENGINE_DEBUG) {
-                ALOGD(TAG, "[%s] No codec could be found with name forcedCodecName=%s", __func__,
-                      forcedCodecName);
-            }
-        }
-        codec = avcodec_find_decoder(codecContext->codec_id);
-    }
-
-    // 判断是否成功得到解码器
-    if (!codec) {
-        ALOGE(TAG, "[%s] No codec could be found with id index=%d codec_id=%d", __func__,
-              streamIndex, codecContext->codec_id);
-        return ERROR_NOT_FOUND_DCODE;
-    }
-
-    // 设置解码器的Id
-    codecContext->codec_id = codec->id;
-
-    // 判断是否需要重新设置lowres的值
-    int streamLowResolution = playerInfoStatus->lowResolution;
-    if (streamLowResolution > codec->max_lowres) {
-        if (ENGINE_DEBUG) {
-            ALOGD(TAG, "[%s] The maximum value for low Resolution supported by the decoder is %d",
-                  __func__, codec->max_lowres);
-        }
-        streamLowResolution = codec->max_lowres;
-    }
-    codecContext->lowres = streamLowResolution;
-
-#if FF_API_EMU_EDGE
-    if (stream_lowres) {
-      codecContext->flags |= CODEC_FLAG_EMU_EDGE;
-    }
-#endif
-
-    if (playerInfoStatus->fast) {
-        codecContext->flags2 |= AV_CODEC_FLAG2_FAST;
-    }
-
-#if FF_API_EMU_EDGE
-    if (codec->capabilities & AV_CODEC_CAP_DR1) {
-      codecContext->flags |= CODEC_FLAG_EMU_EDGE;
-    }
-#endif
-
-    opts = filterCodecOptions(playerInfoStatus->codecOpts, codecContext->codec_id, formatContext,
-                              formatContext->streams[streamIndex], codec);
-    if (!av_dict_get(opts, OPT_THREADS, nullptr, 0)) {
-        av_dict_set(&opts, OPT_THREADS, "auto", 0);
-    }
-
-    if (streamLowResolution) {
-        av_dict_set_int(&opts, OPT_LOW_RESOLUTION, streamLowResolution, 0);
-    }
-
-    if (codecContext->codec_type == AVMEDIA_TYPE_VIDEO ||
-        codecContext->codec_type == AVMEDIA_TYPE_AUDIO) {
-        av_dict_set(&opts, OPT_REF_COUNTED_FRAMES, "1", 0);
-    }
-
-    // 打开解码器
-    if (avcodec_open2(codecContext, codec, &opts) < 0) {
-        ALOGE(TAG, "[%s] open codec failure", __func__);
-        return ERROR_NOT_OPEN_DECODE;
-    }
-
-    if ((t = av_dict_get(opts, "", nullptr, AV_DICT_IGNORE_SUFFIX))) {
-        ALOGE(TAG, "[%s] option %s not found", __func__, t->key);
-        return ERROR_CODEC_OPTIONS;
+    // 上报实际使用的解码线程数量
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] stream %d decode threads = %d thread type = %d", __func__, streamIndex,
+              codecContext->thread_count, codecContext->active_thread_type);
     }
+    notifyMsg(Msg::MSG_DECODER_THREADS, streamIndex, codecContext->thread_count);
 
     playerInfoStatus->eof = 0;
 
@@ -393,7 +416,7 @@ int MediaPlayer::openDecoder(int streamIndex) {
                                         formatContext->streams[streamIndex], streamIndex,
                                         playerInfoStatus,
                                         mediaStream->getFlushPacket(),
-                                        mediaStream->getWaitCondition(),
+                                        mediaStream->getReadEvent(),
                                         opts, messageCenter);
         mediaStream->setAudioDecoder(audioDecoder);
     } else if (codecContext->codec_type == AVMEDIA_TYPE_VIDEO) {
@@ -401,8 +424,9 @@ int MediaPlayer::openDecoder(int streamIndex) {
                                         formatContext->streams[streamIndex], streamIndex,
                                         playerInfoStatus,
                                         mediaStream->getFlushPacket(),
-                                        mediaStream->getWaitCondition(), opts,
+                                        mediaStream->getReadEvent(), opts,
                                         messageCenter);
+        videoDecoder->setVideoDevice(videoDevice);
         mediaStream->setVideoDecoder(videoDecoder);
         playerInfoStatus->attachmentRequest = 1;
     }
@@ -761,6 +785,10 @@ int MediaPlayer::syncCreate() {
     changeStatus(CREATED);
     notifyMsg(Msg::MSG_STATUS_CREATED);
 
+    if (ENGINE_DEBUG) {
+        MediaEngine::dumpStats(TAG);
+    }
+
     return SUCCESS;
 }
 
@@ -780,10 +808,14 @@ int MediaPlayer::syncStart() {
 }
 
 int MediaPlayer::syncTogglePause() {
+    int ret = SUCCESS;
     if (mediaSync) {
-        return mediaSync->togglePause();
+        ret = mediaSync->togglePause();
     }
-    return SUCCESS;
+    if (mediaStream) {
+        mediaStream->getReadEvent()->signal();
+    }
+    return ret;
 }
 
 int MediaPlayer::syncSeekTo(float increment) {
@@ -848,7 +880,7 @@ int MediaPlayer::syncSeekTo(int64_t pos, int64_t rel, int seekByBytes) {
         }
         playerInfoStatus->setSeekRequest(true);
         if (mediaStream) {
-            mediaStream->getWaitCondition()->signal();
+            mediaStream->getReadEvent()->signal();
         }
     }
     return SUCCESS;
@@ -870,6 +902,10 @@ int MediaPlayer::syncStop() {
         playerInfoStatus->setAbortRequest(1);
     }
 
+    if (mediaStream) {
+        mediaStream->getReadEvent()->signal();
+    }
+
     if (mediaSync) {
         mediaSync->stop();
     }
@@ -965,6 +1001,10 @@ int MediaPlayer::syncDestroy() {
     changeStatus(IDLED);
     notifyMsg(Msg::MSG_STATUS_IDLED);
 
+    if (ENGINE_DEBUG) {
+        MediaEngine::dumpStats(TAG);
+    }
+
     return SUCCESS;
 }
 
@@ -1027,13 +1067,11 @@ int MediaPlayer::syncPlay() {
 
 
 int MediaPlayer::changeStatus(PlayerStatus state) {
-    mutex.lock();
+    PlayerStatus lastStatus = playerStatus.exchange(state);
     if (ENGINE_DEBUG) {
         ALOGD(TAG, "[%s] target status = %s, source status = %s", __func__, getStatus(state),
-              getStatus(playerStatus));
+              getStatus(lastStatus));
     }
-    playerStatus = state;
-    mutex.unlock();
     return SUCCESS;
 }
 
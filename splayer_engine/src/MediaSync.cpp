@@ -15,6 +15,7 @@ void MediaSync::start(VideoDecoder *pVideoDecoder, AudioDecoder *pAudioDecoder)
     videoClock->init(pVideoDecoder->getPacketQueue()->getPointLastSeekSerial());
     audioClock->init(pVideoDecoder->getPacketQueue()->getPointLastSeekSerial());
     externalClock->init(pVideoDecoder->getPacketQueue()->getPointLastSeekSerial());
+    displayClock->reset();
     abortRequest = false;
     mutex.unlock();
 }
@@ -27,24 +28,23 @@ void MediaSync::stop() {
     abortRequest = true;
     videoDecoder = nullptr;
     audioDecoder = nullptr;
-    if (frameARGB) {
-        av_frame_free(&frameARGB);
-        av_free(frameARGB);
-        frameARGB = nullptr;
-    }
-    if (buffer) {
-        av_freep(&buffer);
-        buffer = nullptr;
-    }
-    if (swsContext) {
-        sws_freeContext(swsContext);
-        swsContext = nullptr;
+    if (latencyController) {
+        latencyController->close();
     }
     mutex.unlock();
+    if (displayClock) {
+        displayClock->wakeUp();
+    }
 }
 
 void MediaSync::setVideoDevice(VideoDevice *device) {
+    if (videoDevice) {
+        videoDevice->setDisplayClock(nullptr);
+    }
     this->videoDevice = device;
+    if (videoDevice) {
+        videoDevice->setDisplayClock(displayClock);
+    }
 }
 
 void MediaSync::setMaxDuration(double maxDuration) {
@@ -89,13 +89,21 @@ MediaClock *MediaSync::getVideoClock() { return videoClock; }
 
 MediaClock *MediaSync::getExternalClock() { return externalClock; }
 
+LatencyController *MediaSync::getLatencyController() { return latencyController; }
+
+DisplayClock *MediaSync::getDisplayClock() { return displayClock; }
+
 void MediaSync::run() {}
 
 int MediaSync::refreshVideo() {
-    int ret = SUCCESS;
-    if (remainingTime > 0.0) {
-        av_usleep((unsigned int) (remainingTime * 1000000.0F));
+    if (remainingTime > 0.0 && displayClock) {
+        displayClock->wait(remainingTime);
     }
+    return updateVideo();
+}
+
+int MediaSync::updateVideo() {
+    int ret = SUCCESS;
     remainingTime = REFRESH_RATE;
     if (!playerInfoStatus) {
         ALOGE(TAG, "[%s] playerInfoStatus=%p", __func__, playerInfoStatus);
@@ -109,30 +117,53 @@ int MediaSync::refreshVideo() {
         ALOGE(TAG, "[%s] videoDevice=%p", __func__, videoDevice);
         return ERROR;
     }
-    if (playerInfoStatus && videoDecoder && videoDevice &&
-        (!playerInfoStatus->pauseRequest || forceRefresh)) {
+    if (!displayClock) {
+        ALOGE(TAG, "[%s] displayClock=%p", __func__, displayClock);
+        return ERROR;
+    }
+    // 播放时等待到下一帧的显示时间，暂停时等待唤醒，拖动进度时解码出的帧没有通知，继续轮询
+    if (!playerInfoStatus->pauseRequest) {
+        remainingTime = DISPLAY_CLOCK_MAX_WAIT;
+    } else if (!playerInfoStatus->scrubbing) {
+        remainingTime = DISPLAY_CLOCK_IDLE_WAIT;
+    }
+    if (!playerInfoStatus->pauseRequest || forceRefresh ||
+        (playerInfoStatus->scrubbing && videoDecoder->getFrameSize() > 0)) {
         ret = refreshVideo(&remainingTime);
     }
-
-//    if (ENGINE_DEBUG) {
-//        ALOGD(TAG, "[%s] playerInfoStatus = %p videoDecoder = %p videoDevice = %p pauseRequest = %d",
-//              __func__,
-//              playerInfoStatus,
-//              videoDecoder,
-//              videoDevice,
-//              (playerInfoStatus != nullptr ? playerInfoStatus->pauseRequest : -100)
-//        );
-//    }
+    displayClock->updateStats(playerInfoStatus->pauseRequest);
     return ret;
 }
 
+double MediaSync::getRemainingTime() {
+    return remainingTime;
+}
+
 int MediaSync::refreshVideo(double *remaining_time) {
-    double time;
+    double time, now;
 
-    // 检查外部时钟
-    if (playerInfoStatus && !playerInfoStatus->pauseRequest && playerInfoStatus->realTime &&
+    // 检查外部时钟，低延时模式按延时调整速度，视频跟随时钟丢帧追赶
+    if (playerInfoStatus && !playerInfoStatus->pauseRequest &&
         playerInfoStatus->syncType == AV_SYNC_EXTERNAL) {
-        checkExternalClockSpeed();
+        if (latencyController->isEnabled()) {
+            double speed = latencyController->update(externalClock->getClock());
+            if (speed != externalClock->getSpeed()) {
+                externalClock->setSpeed(speed);
+            }
+        } else if (playerInfoStatus->realTime) {
+            checkExternalClockSpeed();
+        }
+    }
+
+    // 以视频为主时钟时同样按延时追赶，没有音频变速，直接缩短每一帧的显示时长
+    if (playerInfoStatus && !playerInfoStatus->pauseRequest &&
+        playerInfoStatus->syncType == AV_SYNC_VIDEO) {
+        double speed = latencyController->isEnabled() ?
+                       latencyController->update(videoClock->getClock()) : 1.0;
+        if (speed != videoSpeed) {
+            videoSpeed = speed;
+            videoClock->setSpeed(speed);
+        }
     }
 
     FrameQueue *frameQueue = videoDecoder->getFrameQueue();
@@ -188,6 +219,19 @@ int MediaSync::refreshVideo(double *remaining_time) {
                 }
             }
 
+            // 拖动进度时不按时钟同步，解码出的关键帧直接显示
+            if (playerInfoStatus->scrubbing) {
+                videoDecoder->getFrameQueue()->getMutex()->lock();
+                if (!isnan(currentFrame->pts)) {
+                    videoClock->setClock(currentFrame->pts, currentFrame->seekSerial);
+                }
+                videoDecoder->getFrameQueue()->getMutex()->unlock();
+                frameQueue->popFrame();
+                forceRefresh = 1;
+                playerInfoStatus->scrubFrames++;
+                break;
+            }
+
             // 如果处于暂停状态，则直接显示
             if (playerInfoStatus->abortRequest || playerInfoStatus->pauseRequest) {
                 // to display
@@ -199,14 +243,19 @@ int MediaSync::refreshVideo(double *remaining_time) {
 
             // 根据帧显示的时长，计算延时
             syncDelay = calculateSyncDelay(duration);
+            if (playerInfoStatus->syncType == AV_SYNC_VIDEO && videoSpeed != 1.0) {
+                syncDelay /= videoSpeed;
+            }
 
-            // 获取当前时间
-            time = av_gettime_relative() / 1000000.0;
+            // 获取现在提交的画面的显示时间，设备提供vsync时取整到最近的vsync
+            now = av_gettime_relative() / 1000000.0;
+            time = displayClock->getDisplayTime(now);
 
             // 若上一帧持续显示时间超过当前帧的时间，那么代表上一帧还没显示结束，则继续显示当前帧
             // 如果当前时间小于帧计时器的时间 + 延时时间，则表示还没到当前帧
             if (time < (frameTimer + syncDelay)) {
-                *remaining_time = FFMIN(frameTimer + syncDelay - time, *remaining_time);
+                *remaining_time = FFMIN(displayClock->getWaitTime(now, frameTimer + syncDelay),
+                                        *remaining_time);
                 if (ENGINE_DEBUG) {
 //                    ALOGD(TAG, "[%s] need display pre frame, diff time = %lf remainingTime = %lf",
 //                          __func__, (frameTimer + syncDelay - time), *remaining_time);
@@ -253,10 +302,13 @@ int MediaSync::refreshVideo(double *remaining_time) {
             }
 
             // 下一帧
+            displayClock->setTargetTime(frameTimer);
             frameQueue->popFrame();
             forceRefresh = 1;
 
         } else {
+            // 解码线程没有通知，队列为空时按REFRESH_RATE轮询
+            *remaining_time = FFMIN(REFRESH_RATE, *remaining_time);
             if (ENGINE_DEBUG) {
                 ALOGW(TAG, "[%s] nothing to do, no picture to display in the queue", __func__);
             }
@@ -369,7 +421,9 @@ void MediaSync::renderVideo() {
 
         AVFrame *frame = currentFrame->frame;
 
-        TextureFormat format = videoDevice->getTextureFormat(currentFrame->frame->format);
+        // 解码线程转换过的帧是BGRA，按FMT_NONE上传
+        TextureFormat format = currentFrame->converted ? FMT_NONE :
+                               videoDevice->getTextureFormat(currentFrame->frame->format);
         BlendMode blendMode = videoDevice->getBlendMode(format);
 
         // 初始化纹理
@@ -383,7 +437,12 @@ void MediaSync::renderVideo() {
 
         switch (format) {
             case FMT_YUV420P:
-                // 根据图像格式更新纹理数据
+            case FMT_YUV422P:
+            case FMT_YUV444P:
+            case FMT_YUV420P10: {
+                // 根据图像格式更新纹理数据，U、V平面的高度由色度抽样决定
+                int chromaHeight = AV_CEIL_RSHIFT(frame->height, av_pix_fmt_desc_get(
+                        (AVPixelFormat) frame->format)->log2_chroma_h);
                 if (frame->linesize[0] > 0 && frame->linesize[1] > 0 && frame->linesize[2] > 0) {
                     ret = videoDevice->onUpdateYUV(
                             frame->data[0], frame->linesize[0],
@@ -391,7 +450,7 @@ void MediaSync::renderVideo() {
                             frame->data[2], frame->linesize[2]
                     );
                     if (ret < 0) {
-                        ALOGE(TAG, "[%s] update FMT_YUV420P error", __func__);
+                        ALOGE(TAG, "[%s] update YUV format = %d error", __func__, format);
                         return;
                     }
                 } else if (frame->linesize[0] < 0 && frame->linesize[1] < 0 &&
@@ -399,19 +458,38 @@ void MediaSync::renderVideo() {
                     ret = videoDevice->onUpdateYUV(
                             frame->data[0] + frame->linesize[0] * (frame->height - 1),
                             -frame->linesize[0],
-                            frame->data[1] +
-                            frame->linesize[1] * (AV_CEIL_RSHIFT(frame->height, 1) - 1),
+                            frame->data[1] + frame->linesize[1] * (chromaHeight - 1),
                             -frame->linesize[1],
-                            frame->data[2] +
-                            frame->linesize[2] * (AV_CEIL_RSHIFT(frame->height, 1) - 1),
+                            frame->data[2] + frame->linesize[2] * (chromaHeight - 1),
                             -frame->linesize[2]
                     );
                     if (ret < 0) {
-                        ALOGE(TAG, "[%s] update FMT_YUV420P error", __func__);
+                        ALOGE(TAG, "[%s] update YUV format = %d error", __func__, format);
                         return;
                     }
                 }
                 break;
+            }
+            case FMT_NV12:
+            case FMT_NV21:
+            case FMT_P010:
+                // 半平面格式由着色器拆分UV，不需要转换
+                if (frame->linesize[0] > 0 && frame->linesize[1] > 0) {
+                    ret = videoDevice->onUpdateNV(frame->data[0], frame->linesize[0],
+                                                  frame->data[1], frame->linesize[1]);
+                } else if (frame->linesize[0] < 0 && frame->linesize[1] < 0) {
+                    ret = videoDevice->onUpdateNV(
+                            frame->data[0] + frame->linesize[0] * (frame->height - 1),
+                            -frame->linesize[0],
+                            frame->data[1] +
+                            frame->linesize[1] * (AV_CEIL_RSHIFT(frame->height, 1) - 1),
+                            -frame->linesize[1]);
+                }
+                if (ret < 0) {
+                    ALOGE(TAG, "[%s] update NV format = %d error", __func__, format);
+                    return;
+                }
+                break;
             case FMT_ARGB:
                 // 直接渲染BGRA，对应的是shader->argb格式
                 ret = videoDevice->onUpdateARGB(frame->data[0], frame->linesize[0]);
@@ -420,29 +498,13 @@ void MediaSync::renderVideo() {
                     return;
                 }
                 break;
-                // 其他格式转码成BGRA格式再做渲染
+                // 设备不能直接渲染的格式已经在解码线程转换成BGRA
             case FMT_NONE:
-                swsContext = sws_getCachedContext(swsContext, frame->width, frame->height,
-                                                  (AVPixelFormat) frame->format, frame->width,
-                                                  frame->height, AV_PIX_FMT_BGRA, SWS_BICUBIC,
-                                                  nullptr, nullptr, nullptr);
-
-                if (!buffer) {
-                    int numBytes = av_image_get_buffer_size(AV_PIX_FMT_BGRA, frame->width,
-                                                            frame->height, 1);
-                    buffer = (uint8_t *) av_malloc(numBytes * sizeof(uint8_t));
-                    frameARGB = av_frame_alloc();
-                    av_image_fill_arrays(frameARGB->data, frameARGB->linesize, buffer,
-                                         AV_PIX_FMT_BGRA, frame->width, frame->height, 1);
-                }
-
-                if (swsContext != nullptr) {
-                    sws_scale(swsContext, (uint8_t const *const *) frame->data, frame->linesize, 0,
-                              frame->height, frameARGB->data, frameARGB->linesize);
+                if (!currentFrame->converted) {
+                    ALOGE(TAG, "[%s] not support format = %d", __func__, frame->format);
+                    return;
                 }
-
-                ret = videoDevice->onUpdateARGB(frameARGB->data[0], frameARGB->linesize[0]);
-
+                ret = videoDevice->onUpdateARGB(frame->data[0], frame->linesize[0]);
                 if (ret < 0) {
                     ALOGE(TAG, "[%s] update FMT_NONE error", __func__);
                     return;
@@ -484,6 +546,9 @@ int MediaSync::togglePause() {
         videoClock->setPaused(playerInfoStatus->pauseRequest);
         externalClock->setPaused(playerInfoStatus->pauseRequest);
     }
+    if (displayClock) {
+        displayClock->wakeUp();
+    }
     return SUCCESS;
 }
 
@@ -510,12 +575,17 @@ int MediaSync::notifyMsg(int what, int arg1, int arg2) {
 
 void MediaSync::setForceRefresh(int refresh) {
     MediaSync::forceRefresh = refresh;
+    if (refresh && displayClock) {
+        displayClock->wakeUp();
+    }
 }
 
 int MediaSync::create() {
     audioClock = new MediaClock();
     videoClock = new MediaClock();
     externalClock = new MediaClock();
+    latencyController = new LatencyController();
+    displayClock = new DisplayClock();
     abortRequest = true;
     forceRefresh = 0;
     maxFrameDuration = 10.0;
@@ -530,6 +600,13 @@ int MediaSync::destroy() {
     videoClock = nullptr;
     delete externalClock;
     externalClock = nullptr;
+    delete latencyController;
+    latencyController = nullptr;
+    if (videoDevice) {
+        videoDevice->setDisplayClock(nullptr);
+    }
+    delete displayClock;
+    displayClock = nullptr;
     return SUCCESS;
 }
 
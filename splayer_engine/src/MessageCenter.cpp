@@ -74,7 +74,7 @@ void MessageCenter::setMsgListener(IMessageListener *msgListener) {
 int MessageCenter::start() {
     abortRequest = false;
     if (msgThread == nullptr) {
-        msgThread = new Thread(this, Priority_High);
+        msgThread = new ThreadTask(this, Priority_High);
         if (!msgThread) {
             return ERROR_NOT_MEMORY;
         }
@@ -85,6 +85,7 @@ int MessageCenter::start() {
 
 int MessageCenter::stop() {
     abortRequest = true;
+    msgQueue->wakeUp();
     if (msgThread != nullptr) {
         // https://baike.baidu.com/item/pthread_join
         msgThread->join();
@@ -124,8 +125,6 @@ int MessageCenter::notifyMsg(int what, int arg1, int arg2) {
     return msgQueue->notifyMsg(what, arg1, arg2);
 }
 
-int MessageCenter::removeMsg(int what) { return msgQueue->removeMsg(what); }
-
 PlayerStatus MessageCenter::getStatus(int arg) {
     if (arg == ERRORED) {
         return ERRORED;
@@ -1,123 +1,231 @@
 #include "MessageQueue.h"
 
-MessageQueue::MessageQueue() { queue = new list<Msg *>(); }
+MessageQueue::MessageQueue() {
+    cells = new MsgCell[MSG_QUEUE_SIZE];
+    for (size_t i = 0; i < MSG_QUEUE_SIZE; i++) {
+        cells[i].sequence = i;
+    }
+    overflowMsgs = new Msg[MSG_OVERFLOW_SIZE];
+    enqueuePos = 0;
+    dequeuePos = 0;
+    overflowSize = 0;
+    // 直播延迟定时上报，只需要最新的值
+    addCoalesceMsg(Msg::MSG_LIVE_LATENCY);
+}
 
-MessageQueue::~MessageQueue() { delete queue; }
+MessageQueue::~MessageQueue() {
+    delete[] cells;
+    delete[] overflowMsgs;
+}
 
 int MessageQueue::putMsg(Msg *msg) {
-    int ret;
-    mutex.lock();
-    ret = _putMsg(msg);
-    condition.signal();
-    mutex.unlock();
+    if (!msg) {
+        return ERROR_PARAMS;
+    }
+    CoalesceMsg *coalesceMsg = findCoalesceMsg(msg->what);
+    if (coalesceMsg) {
+        // 先写参数再设置标志，消费者先清除标志再读参数，不会丢失最新的参数
+        coalesceMsg->argsI = (int64_t) ((uint64_t) (uint32_t) msg->arg2I << 32 |
+                                        (uint32_t) msg->arg1I);
+        coalesceMsg->arg1F = msg->arg1F;
+        // 队列中已经有同类型的消息，消费者处理时会读到最新的参数
+        if (coalesceMsg->pending.exchange(true)) {
+            return SUCCESS;
+        }
+    }
+    // 溢出队列不为空时继续写入溢出队列，保证先投递的消息先处理
+    int ret = SUCCESS;
+    if (overflowSize.load() > 0 || _putMsg(msg) < 0) {
+        ret = putOverflowMsg(msg);
+        if (ret < 0 && coalesceMsg) {
+            coalesceMsg->pending = false;
+        }
+    }
+    event.signal();
     return ret;
 }
 
-int MessageQueue::_putMsg(Msg *msg) {
-    if (!msg) {
-        return ERROR_PARAMS;
+/**
+ * 写入溢出队列，溢出队列在创建时分配，不再分配内存
+ * @param msg
+ * @return
+ */
+int MessageQueue::putOverflowMsg(const Msg *msg) {
+    Mutex::Autolock lock(mutex);
+    int size = overflowSize;
+    if (size == 0) {
+        ALOGE(TAG, "[%s] message queue is full, overflow what = %s", __func__,
+              Msg::getMsgSimpleName(msg->what));
+    }
+    if (size >= MSG_OVERFLOW_SIZE) {
+        ALOGE(TAG, "[%s] overflow queue is full, drop what = %s", __func__,
+              Msg::getMsgSimpleName(msg->what));
+        return ERROR_MSG_QUEUE_FULL;
     }
-    queue->push_back(msg);
+    overflowMsgs[(overflowHead + size) % MSG_OVERFLOW_SIZE] = *msg;
+    overflowSize = size + 1;
     return SUCCESS;
 }
 
-int MessageQueue::clearMsgQueue(IMessageListener *messageListener) {
-    mutex.lock();
-    if (queue != nullptr) {
-        while (!queue->empty()) {
-            Msg *message = queue->front();
-            if (message != nullptr) {
-                queue->pop_front();
-                if (messageListener) {
-                    messageListener->onMessage(message);
-                }
-                delete message;
+/**
+ * 写入消息，多个生产者通过CAS竞争写入位置
+ * @param msg
+ * @return
+ */
+int MessageQueue::_putMsg(const Msg *msg) {
+    MsgCell *cell;
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &cells[pos & (MSG_QUEUE_SIZE - 1)];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
             }
+        } else if (diff < 0) {
+            return ERROR_MSG_QUEUE_FULL;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
         }
     }
-    mutex.unlock();
+    cell->msg.what = msg->what;
+    cell->msg.arg1I = msg->arg1I;
+    cell->msg.arg2I = msg->arg2I;
+    cell->msg.arg1F = msg->arg1F;
+    cell->msg.arg2F = msg->arg2F;
+    cell->sequence.store(pos + 1, std::memory_order_release);
     return SUCCESS;
 }
 
-int MessageQueue::getMsg(Msg *msg, bool block) {
-    int ret = SUCCESS;
-    mutex.lock();
-    while (true) {
-        if (queue) {
-            Msg *message = queue->front();
-            if (message) {
-                queue->pop_front();
-                *msg = *message;
-                ret = 0;
-                break;
-            } else if (!block) {
-                ret = 0;
-                break;
-            } else {
-                condition.wait(mutex);
-            }
-        } else {
-            ALOGE(TAG, "[%s] queue is null", __func__);
-            break;
+/**
+ * 读取消息，只在消费者线程调用
+ * @param msg
+ * @return 是否读取到消息
+ */
+bool MessageQueue::_getMsg(Msg *msg) {
+    if (!_nextMsg(msg)) {
+        return false;
+    }
+    CoalesceMsg *coalesceMsg = findCoalesceMsg(msg->what);
+    if (coalesceMsg) {
+        // 先清除标志再读取参数，之后投递的消息会重新入队
+        coalesceMsg->pending = false;
+        int64_t argsI = coalesceMsg->argsI;
+        msg->arg1I = (int) (uint32_t) argsI;
+        msg->arg2I = (int) (argsI >> 32);
+        msg->arg1F = coalesceMsg->arg1F;
+    }
+    return true;
+}
+
+bool MessageQueue::_nextMsg(Msg *msg) {
+    MsgCell *cell = &cells[dequeuePos & (MSG_QUEUE_SIZE - 1)];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    if ((intptr_t) sequence - (intptr_t) (dequeuePos + 1) >= 0) {
+        *msg = cell->msg;
+        cell->sequence.store(dequeuePos + MSG_QUEUE_SIZE, std::memory_order_release);
+        dequeuePos++;
+        return true;
+    }
+    // 环形队列中还有已经占用位置、没有写完的消息时不读溢出队列，
+    // 否则同一个生产者写入溢出队列的消息会先于它之前写入环形队列的消息
+    if (overflowSize.load() == 0 || enqueuePos.load() != dequeuePos) {
+        return false;
+    }
+    Mutex::Autolock lock(mutex);
+    int size = overflowSize;
+    if (size == 0) {
+        return false;
+    }
+    *msg = overflowMsgs[overflowHead];
+    overflowHead = (overflowHead + 1) % MSG_OVERFLOW_SIZE;
+    overflowSize = size - 1;
+    return true;
+}
+
+CoalesceMsg *MessageQueue::findCoalesceMsg(int what) {
+    for (int i = 0; i < coalesceSize; i++) {
+        if (coalesceMsgs[i].what == what) {
+            return &coalesceMsgs[i];
         }
     }
-    mutex.unlock();
-    return ret;
+    return nullptr;
 }
 
-int MessageQueue::removeMsg(int what) {
-    mutex.lock();
-    std::list<Msg *>::iterator it;
-    Msg *message = nullptr;
-    for (it = queue->begin(); it != queue->end(); ++it) {
-        if (*it && (*it)->what == what) {
-            message = *it;
-            break;
+int MessageQueue::addCoalesceMsg(int what) {
+    if (findCoalesceMsg(what)) {
+        return SUCCESS;
+    }
+    if (coalesceSize >= MSG_COALESCE_SIZE) {
+        return ERROR_PARAMS;
+    }
+    CoalesceMsg *coalesceMsg = &coalesceMsgs[coalesceSize];
+    coalesceMsg->what = what;
+    coalesceMsg->pending = false;
+    coalesceMsg->argsI = 0;
+    coalesceMsg->arg1F = 0;
+    coalesceSize++;
+    return SUCCESS;
+}
+
+int MessageQueue::clearMsgQueue(IMessageListener *messageListener) {
+    Msg message;
+    while (_getMsg(&message)) {
+        if (messageListener) {
+            messageListener->onMessage(&message);
         }
+        message.free();
     }
-    queue->remove(message);
-    delete message;
-    mutex.unlock();
     return SUCCESS;
 }
 
-int MessageQueue::startMsgQueue() {
-    mutex.lock();
-    auto *message = new Msg();
-    message->what = Msg::MSG_FLUSH;
-    _putMsg(message);
-    mutex.unlock();
+int MessageQueue::getMsg(Msg *msg, bool block) {
+    if (_getMsg(msg)) {
+        return SUCCESS;
+    }
+    if (block) {
+        // 被唤醒之后可能没有消息，调用者需要判断msg->what
+        event.wait();
+        _getMsg(msg);
+    }
     return SUCCESS;
 }
 
+int MessageQueue::startMsgQueue() {
+    Msg message;
+    message.what = Msg::MSG_FLUSH;
+    return putMsg(&message);
+}
+
+void MessageQueue::wakeUp() {
+    event.signal();
+}
+
 int MessageQueue::notifyMsg(int what) {
-    auto *message = new Msg();
-    message->what = what;
-    putMsg(message);
-    return SUCCESS;
+    Msg message;
+    message.what = what;
+    return putMsg(&message);
 }
 
 int MessageQueue::notifyMsg(int what, int arg1) {
-    auto *message = new Msg();
-    message->what = what;
-    message->arg1I = arg1;
-    putMsg(message);
-    return SUCCESS;
+    Msg message;
+    message.what = what;
+    message.arg1I = arg1;
+    return putMsg(&message);
 }
 
 int MessageQueue::notifyMsg(int what, float arg1) {
-    auto *message = new Msg();
-    message->what = what;
-    message->arg1F = arg1;
-    putMsg(message);
-    return SUCCESS;
+    Msg message;
+    message.what = what;
+    message.arg1F = arg1;
+    return putMsg(&message);
 }
 
 int MessageQueue::notifyMsg(int what, int arg1, int arg2) {
-    auto *message = new Msg();
-    message->what = what;
-    message->arg1I = arg1;
-    message->arg2I = arg2;
-    putMsg(message);
-    return SUCCESS;
+    Msg message;
+    message.what = what;
+    message.arg1I = arg1;
+    message.arg2I = arg2;
+    return putMsg(&message);
 }
@@ -81,6 +81,14 @@ const char *Msg::getMsgSimpleName(int what) {
             return "MSG_TIMED_TEXT";
         case MSG_CURRENT_POSITION:
             return "MSG_CURRENT_POSITION";
+        case MSG_OPEN_TIMING:
+            return "MSG_OPEN_TIMING";
+        case MSG_VARIANT_CHANGED:
+            return "MSG_VARIANT_CHANGED";
+        case MSG_LIVE_LATENCY:
+            return "MSG_LIVE_LATENCY";
+        case MSG_DECODER_THREADS:
+            return "MSG_DECODER_THREADS";
 
             ///
 
@@ -3,21 +3,110 @@
 PacketQueue::PacketQueue(AVPacket *flushPacket) {
     this->flushPacket = flushPacket;
     abortRequest = false;
-    firstPacket = nullptr;
-    lastPacket = nullptr;
-    packetSize = 0;
-    memorySize = 0;
-    duration = 0;
+    waiting = false;
+    lastSeekSerial = 0;
+    firstSeekSerial = -1;
+    pushPacketSize = 0;
+    pushMemorySize = 0;
+    pushDuration = 0;
+    popPacketSize = 0;
+    popMemorySize = 0;
+    popDuration = 0;
+    flushPacketSize = 0;
+    flushDuration = 0;
+    poolSize = 0;
+    poolHighWaterMark = 0;
+    growPool(PACKET_POOL_INIT_SIZE);
+    // 哨兵节点
+    PacketData *packetData = freePacket;
+    freePacket = packetData->next;
+    packetData->next = nullptr;
+    lastPacket = packetData;
+    firstPacket = packetData;
+    recyclePacket = packetData;
+    recycleLimit = packetData;
 }
 
 PacketQueue::~PacketQueue() {
+    AVPacket pkt;
     abort();
     flush();
+    while (take(&pkt)) {
+        av_packet_unref(&pkt);
+    }
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "%s pool size = %d high water mark = %d", __func__, poolSize.load(),
+              poolHighWaterMark.load());
+    }
+    releasePool();
     this->flushPacket = nullptr;
 }
 
 /**
- * 入队数据包
+ * 获取节点，优先复用消费者已经出队的节点，其次从节点池中获取，节点池为空时扩容
+ * 只在生产者线程调用
+ * @return
+ */
+PacketData *PacketQueue::obtainPacketData() {
+    PacketData *packetData;
+    if (recyclePacket == recycleLimit) {
+        recycleLimit = firstPacket.load(std::memory_order_acquire);
+    }
+    if (recyclePacket != recycleLimit) {
+        packetData = recyclePacket;
+        recyclePacket = packetData->next.load(std::memory_order_relaxed);
+        return packetData;
+    }
+    if (!freePacket) {
+        growPool(PACKET_POOL_GROW_SIZE);
+    }
+    packetData = freePacket;
+    freePacket = packetData->next.load(std::memory_order_relaxed);
+    return packetData;
+}
+
+/**
+ * 归还节点到节点池
+ * @param packetData
+ */
+void PacketQueue::recyclePacketData(PacketData *packetData) {
+    packetData->next.store(freePacket, std::memory_order_relaxed);
+    freePacket = packetData;
+}
+
+/**
+ * 节点池扩容，新节点整块分配并挂到空闲链表
+ * 和工程中其它分配一样使用普通的new，分配失败时抛出异常，不会返回空指针
+ * @param size
+ */
+void PacketQueue::growPool(int size) {
+    PacketBlock *block = new PacketBlock();
+    block->packets = new PacketData[size];
+    for (int i = 0; i < size; i++) {
+        recyclePacketData(&block->packets[i]);
+    }
+    block->next = packetBlock;
+    packetBlock = block;
+    poolSize += size;
+}
+
+/**
+ * 释放节点池
+ */
+void PacketQueue::releasePool() {
+    PacketBlock *block, *next;
+    for (block = packetBlock; block; block = next) {
+        next = block->next;
+        delete[] block->packets;
+        delete block;
+    }
+    packetBlock = nullptr;
+    freePacket = nullptr;
+    poolSize = 0;
+}
+
+/**
+ * 入队数据包，只在生产者线程调用
  * @param pkt
  * @return
  */
@@ -28,43 +117,89 @@ int PacketQueue::put(AVPacket *pkt) {
         return EXIT;
     }
 
-    packetData = (PacketData *) av_malloc(sizeof(PacketData));
-    if (!packetData) {
-        return ERROR_NOT_MEMORY;
-    }
+    packetData = obtainPacketData();
     packetData->pkt = *pkt;
-    packetData->next = nullptr;
+    packetData->next.store(nullptr, std::memory_order_relaxed);
 
     if (pkt == flushPacket) {
         lastSeekSerial++;
     }
     packetData->serial = lastSeekSerial;
 
-    if (!lastPacket) {
-        firstPacket = packetData;
-    } else {
-        lastPacket->next = packetData;
-    }
+    // 先累加计数再链接节点，保证出队累计值不会超过入队累计值
+    // 累计值只有一个写入者，用release写入即可，不需要顺序一致的写入屏障
+    pushPacketSize.store(pushPacketSize.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+    pushMemorySize.store(pushMemorySize.load(std::memory_order_relaxed)
+                         + packetData->pkt.size + sizeof(*packetData), std::memory_order_release);
+    pushDuration.store(pushDuration.load(std::memory_order_relaxed) + packetData->pkt.duration,
+                       std::memory_order_release);
+    lastPacket->next.store(packetData, std::memory_order_release);
     lastPacket = packetData;
-    packetSize++;
-    memorySize += packetData->pkt.size + sizeof(*packetData);
-    duration += packetData->pkt.duration;
+
+    int packetSize = getPacketSize();
+    if (packetSize > poolHighWaterMark.load(std::memory_order_relaxed)) {
+        poolHighWaterMark.store(packetSize, std::memory_order_relaxed);
+    }
     return SUCCESS;
 }
 
+/**
+ * 出队数据包，刷新之前入队的数据包直接丢弃，只在消费者线程调用
+ * @param pkt
+ * @return
+ */
+bool PacketQueue::take(AVPacket *pkt) {
+    for (;;) {
+        PacketData *first = firstPacket.load(std::memory_order_relaxed);
+        PacketData *packetData = first->next.load(std::memory_order_acquire);
+        if (!packetData) {
+            return false;
+        }
+        AVPacket packet = packetData->pkt;
+        int serial = packetData->serial;
+        int64_t popSize = popPacketSize.load(std::memory_order_relaxed);
+        bool discard = popSize < flushPacketSize.load(std::memory_order_acquire);
+        popMemorySize.store(popMemorySize.load(std::memory_order_relaxed)
+                            + packet.size + sizeof(*packetData), std::memory_order_release);
+        popDuration.store(popDuration.load(std::memory_order_relaxed) + packet.duration,
+                          std::memory_order_release);
+        popPacketSize.store(popSize + 1, std::memory_order_release);
+        // 节点内容读取完毕之后才能交给生产者回收
+        firstPacket.store(packetData, std::memory_order_release);
+        if (discard) {
+            av_packet_unref(&packet);
+            continue;
+        }
+        *pkt = packet;
+        firstSeekSerial.store(serial, std::memory_order_release);
+        return true;
+    }
+}
+
+/**
+ * 唤醒等待中的消费者，消费者没有等待时不加锁
+ */
+void PacketQueue::wakeConsumer() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed)) {
+        mutex.lock();
+        condition.signal();
+        mutex.unlock();
+    }
+}
+
 /**
  * 入队数据包
  * @param pkt
  * @return
  */
 int PacketQueue::pushPacket(AVPacket *pkt) {
-    int ret;
-    mutex.lock();
-    ret = put(pkt);
-    condition.signal();
-    mutex.unlock();
+    int ret = put(pkt);
     if (ret < 0) {
         av_packet_unref(pkt);
+    } else {
+        wakeConsumer();
     }
     return ret;
 }
@@ -79,23 +214,12 @@ int PacketQueue::putNullPacket(int stream_index) {
 }
 
 /**
- * 刷新数据包
+ * 刷新数据包，记录当前的入队累计值，之前入队的数据包由消费者出队时释放
+ * 释放之前包数量和时长不再计入，内存大小仍然计入
  */
 void PacketQueue::flush() {
-    PacketData *pkt, *pkt1;
-    mutex.lock();
-    for (pkt = firstPacket; pkt; pkt = pkt1) {
-        pkt1 = pkt->next;
-        av_packet_unref(&pkt->pkt);
-        av_freep(&pkt);
-    }
-    lastPacket = nullptr;
-    firstPacket = nullptr;
-    packetSize = 0;
-    memorySize = 0;
-    duration = 0;
-    condition.signal();
-    mutex.unlock();
+    flushDuration = pushDuration.load();
+    flushPacketSize = pushPacketSize.load();
 }
 
 /**
@@ -112,11 +236,9 @@ void PacketQueue::abort() {
  * 队列开始
  */
 void PacketQueue::start() {
-    mutex.lock();
     abortRequest = false;
     put(flushPacket);
-    condition.signal();
-    mutex.unlock();
+    wakeConsumer();
 }
 
 /**
@@ -133,74 +255,60 @@ int PacketQueue::getPacket(AVPacket *pkt) { return getPacket(pkt, 1); }
  * @return
  */
 int PacketQueue::getPacket(AVPacket *pkt, int block) {
-    PacketData *pkt1;
-    int ret;
-    mutex.lock();
     for (;;) {
         if (abortRequest) {
-            ret = EXIT;
-            break;
+            return EXIT;
         }
-
-        pkt1 = firstPacket;
-        if (pkt1) {
-            firstPacket = pkt1->next;
-            if (!firstPacket) {
-                lastPacket = nullptr;
-            }
-            packetSize--;
-            memorySize -= pkt1->pkt.size + sizeof(*pkt1);
-            duration -= pkt1->pkt.duration;
-            *pkt = pkt1->pkt;
-            firstSeekSerial = pkt1->serial;
-            av_free(pkt1);
-            ret = SUCCESS;
-            break;
-        } else if (!block) {
-            ret = SUCCESS;
-            break;
-        } else {
+        if (take(pkt) || !block) {
+            return SUCCESS;
+        }
+        // 队列为空，先声明等待再重新检查，避免和生产者的唤醒错过
+        mutex.lock();
+        waiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        PacketData *first = firstPacket.load(std::memory_order_relaxed);
+        if (!abortRequest && !first->next.load(std::memory_order_acquire)) {
             condition.wait(mutex);
         }
+        waiting = false;
+        mutex.unlock();
     }
-    mutex.unlock();
-    return ret;
 }
 
 int PacketQueue::getPacketSize() {
-    Mutex::Autolock lock(mutex);
-    return packetSize;
+    int64_t popSize = FFMAX(popPacketSize.load(), flushPacketSize.load());
+    return (int) FFMAX(pushPacketSize.load() - popSize, 0);
 }
 
+/**
+ * 占用内存大小，包括已经刷新、还没有被消费者释放的数据包
+ * 解码线程阻塞时多次刷新的数据包都还在队列中，计入内存预算，避免读包线程继续读入
+ * @return
+ */
 int PacketQueue::getSize() {
-    Mutex::Autolock lock(mutex);
-    return memorySize;
+    return (int) FFMAX(pushMemorySize.load() - popMemorySize.load(), 0);
 }
 
 int64_t PacketQueue::getDuration() {
-    Mutex::Autolock lock(mutex);
-    return duration;
+    int64_t popSize = FFMAX(popDuration.load(), flushDuration.load());
+    return FFMAX(pushDuration.load() - popSize, 0);
 }
 
 bool PacketQueue::isAbort() {
-    Mutex::Autolock lock(mutex);
     return abortRequest;
 }
 
 /// 序列，seek时使用，向PacketQueue中存储Packet时，被更新为队尾的seekSerial
 int PacketQueue::getLastSeekSerial() {
-    Mutex::Autolock lock(mutex);
     return lastSeekSerial;
 }
 
 /// 序列，seek时使用，从PacketQueue从获取Packet时，被更新为队首的seekSerial
 int PacketQueue::getFirstSeekSerial() {
-    Mutex::Autolock lock(mutex);
     return firstSeekSerial;
 }
 
-int *PacketQueue::getPointLastSeekSerial() {
-    Mutex::Autolock lock(mutex);
+std::atomic<int> *PacketQueue::getPointLastSeekSerial() {
     return &lastSeekSerial;
 }
 
@@ -210,3 +318,11 @@ int PacketQueue::signal() {
     mutex.unlock();
     return SUCCESS;
 }
+
+int PacketQueue::getPoolSize() {
+    return poolSize;
+}
+
+int PacketQueue::getPoolHighWaterMark() {
+    return poolHighWaterMark;
+}
@@ -12,6 +12,13 @@ PlayerInfoStatus::~PlayerInfoStatus() {
         av_freep(&url);
         url = nullptr;
     }
+    // 缓存目录
+    if (cacheDir) {
+        av_freep(&cacheDir);
+    }
+    // 指定的解码器名称
+    av_freep(&audioCodecName);
+    av_freep(&videoCodecName);
 }
 
 void PlayerInfoStatus::init() {
@@ -101,6 +108,18 @@ void PlayerInfoStatus::reset() {
 
     seekRel = 0;
 
+    accurateSeekRequest = 0;
+
+    scrubbing = 0;
+
+    scrubTarget = AV_NOPTS_VALUE;
+
+    scrubRequests = 0;
+
+    scrubSeeks = 0;
+
+    scrubFrames = 0;
+
     autoExit = 1;
 
     loopTimes = 1;
@@ -127,6 +146,40 @@ void PlayerInfoStatus::reset() {
 
     audioIndex = -1;
 
+    videoQueueSize = VIDEO_QUEUE_SIZE;
+
+    audioQueueSize = AUDIO_QUEUE_SIZE;
+
+    maxQueueSize = MAX_QUEUE_SIZE;
+
+    minFrames = MIN_FRAMES;
+
+    maxFrameQueueSize = MAX_FRAME_QUEUE_SIZE;
+
+    videoDecodeThreads = DECODE_THREADS_AUTO;
+
+    audioDecodeThreads = DECODE_THREADS_AUTO;
+
+    videoThreadType = DECODE_THREAD_TYPE_AUTO;
+
+    audioThreadType = DECODE_THREAD_TYPE_AUTO;
+
+    cacheMaxSize = CACHE_MAX_SIZE;
+
+    preloadDuration = PRELOAD_DURATION;
+
+    fastStart = FAST_START;
+
+    accurateSeek = 0;
+
+    adaptiveBitrate = ADAPTIVE_BITRATE;
+
+    lowLatency = LOW_LATENCY;
+
+    targetLatency = LOW_LATENCY_TARGET;
+
+    maxLatency = LOW_LATENCY_MAX;
+
     mutex.unlock();
 }
 
@@ -192,6 +245,35 @@ void PlayerInfoStatus::setOptionLong(int category, const char *type, int64_t opt
     }
 }
 
+/**
+ * 复制打开媒体和解码器使用的参数，不包括url、偏移量和文件头
+ * @param playerState
+ */
+void PlayerInfoStatus::copyOpenOptions(PlayerInfoStatus *playerState) {
+    av_dict_copy(&formatOpts, playerState->formatOpts, 0);
+    av_dict_copy(&codecOpts, playerState->codecOpts, 0);
+    inputFormat = playerState->inputFormat;
+    av_freep(&audioCodecName);
+    av_freep(&videoCodecName);
+    audioCodecName = av_strdup(playerState->audioCodecName);
+    videoCodecName = av_strdup(playerState->videoCodecName);
+    audioDisable = playerState->audioDisable;
+    videoDisable = playerState->videoDisable;
+    fast = playerState->fast;
+    generateMissingPts = playerState->generateMissingPts;
+    lowResolution = playerState->lowResolution;
+    videoDecodeThreads = playerState->videoDecodeThreads;
+    audioDecodeThreads = playerState->audioDecodeThreads;
+    videoThreadType = playerState->videoThreadType;
+    audioThreadType = playerState->audioThreadType;
+    av_freep(&cacheDir);
+    cacheDir = av_strdup(playerState->cacheDir);
+    cacheMaxSize = playerState->cacheMaxSize;
+    preloadDuration = playerState->preloadDuration;
+    fastStart = playerState->fastStart;
+    lowLatency = playerState->lowLatency;
+}
+
 void PlayerInfoStatus::parse_string(const char *type, const char *option) {
     if (!strcmp("acodec", type)) { // 指定音频解码器名称
         audioCodecName = av_strdup(option);
@@ -212,7 +294,31 @@ void PlayerInfoStatus::parse_string(const char *type, const char *option) {
         if (!inputFormat) {
             ALOGD(TAG, "[%s] Unknown input format: %s", __func__, option);
         }
+    } else if (!strcmp("videoThreadType", type)) { // 视频解码线程模式
+        videoThreadType = parse_thread_type(option);
+    } else if (!strcmp("audioThreadType", type)) { // 音频解码线程模式
+        audioThreadType = parse_thread_type(option);
+    } else if (!strcmp("cacheDir", type)) { // 网络流磁盘缓存目录
+        av_freep(&cacheDir);
+        cacheDir = av_strdup(option);
+    }
+}
+
+/**
+ * 解析解码线程模式
+ * frame：帧级多线程，吞吐量高，但每多一个线程就多一帧延迟
+ * slice：片级多线程，没有额外延迟，依赖码流的slice划分
+ * auto或其他：自动选择
+ */
+int PlayerInfoStatus::parse_thread_type(const char *option) {
+    if (!strcmp("frame", option)) {
+        return FF_THREAD_FRAME;
+    } else if (!strcmp("slice", option)) {
+        return FF_THREAD_SLICE;
+    } else if (!strcmp("frame+slice", option)) {
+        return FF_THREAD_FRAME | FF_THREAD_SLICE;
     }
+    return DECODE_THREAD_TYPE_AUTO;
 }
 
 void PlayerInfoStatus::parse_int(const char *type, int64_t option) {
@@ -238,6 +344,36 @@ void PlayerInfoStatus::parse_int(const char *type, int64_t option) {
         dropFrameWhenSlow = (option != 0) ? 1 : 0;
     } else if (!strcmp("infbuf", type)) { // 无限缓冲区标志
         infiniteBuffer = (option > 0) ? 1 : ((option < 0) ? -1 : 0);
+    } else if (!strcmp("videoQueueSize", type)) { // 视频帧队列长度，需要保留上一帧，至少为2
+        videoQueueSize = (int) FFMAX(option, 2);
+    } else if (!strcmp("audioQueueSize", type)) { // 音频帧队列长度
+        audioQueueSize = (int) FFMAX(option, 1);
+    } else if (!strcmp("maxQueueSize", type)) { // 数据包队列最大内存
+        maxQueueSize = FFMAX(option, 0);
+    } else if (!strcmp("minFrames", type)) { // 数据包队列最少包数量
+        minFrames = (int) FFMAX(option, 0);
+    } else if (!strcmp("maxFrameQueueSize", type)) { // 帧队列最大内存
+        maxFrameQueueSize = FFMAX(option, 0);
+    } else if (!strcmp("videoDecodeThreads", type)) { // 视频解码线程数量，0表示自动
+        videoDecodeThreads = (int) FFMAX(option, 0);
+    } else if (!strcmp("audioDecodeThreads", type)) { // 音频解码线程数量，0表示自动
+        audioDecodeThreads = (int) FFMAX(option, 0);
+    } else if (!strcmp("cacheMaxSize", type)) { // 网络流磁盘缓存容量上限
+        cacheMaxSize = FFMAX(option, 0);
+    } else if (!strcmp("preloadDuration", type)) { // 预加载数据包时长，毫秒
+        preloadDuration = FFMAX(option, 0);
+    } else if (!strcmp("fastStart", type)) { // 快速起播
+        fastStart = (option != 0) ? 1 : 0;
+    } else if (!strcmp("accurateSeek", type)) { // 精确定位
+        accurateSeek = (option != 0) ? 1 : 0;
+    } else if (!strcmp("adaptiveBitrate", type)) { // HLS多码率自适应
+        adaptiveBitrate = (option != 0) ? 1 : 0;
+    } else if (!strcmp("lowLatency", type)) { // 直播低延时模式
+        lowLatency = (option != 0) ? 1 : 0;
+    } else if (!strcmp("targetLatency", type)) { // 低延时模式的目标延时，毫秒
+        targetLatency = FFMAX(option, 0);
+    } else if (!strcmp("maxLatency", type)) { // 低延时模式的最大延时，毫秒
+        maxLatency = FFMAX(option, 0);
     } else {
         ALOGE(TAG, "[%s] unknown option - '%s'", __func__, type);
     }
@@ -0,0 +1,258 @@
+#include "ProbeCache.h"
+#include <cstring>
+#include <sys/stat.h>
+
+ProbeEntry::ProbeEntry() = default;
+
+ProbeEntry::~ProbeEntry() {
+    for (auto &info : streams) {
+        avcodec_parameters_free(&info.codecpar);
+    }
+    streams.clear();
+}
+
+ProbeCache *ProbeCache::getInstance() {
+    // 和线程池一样在进程退出前一直存在
+    static ProbeCache *instance = new ProbeCache();
+    return instance;
+}
+
+ProbeCache::ProbeCache() = default;
+
+ProbeCache::~ProbeCache() {
+    clear();
+}
+
+void ProbeCache::clear() {
+    Mutex::Autolock lock(mutex);
+    for (auto &entry : entries) {
+        delete entry.second;
+    }
+    entries.clear();
+}
+
+int ProbeCache::findStreamInfo(AVFormatContext *formatContext, const char *url, int64_t offset,
+                               AVDictionary *codecOpts, bool fastStart, bool *hit) {
+    *hit = false;
+    if (!fastStart || !isCacheable(formatContext)) {
+        return probe(formatContext, codecOpts, fastStart);
+    }
+
+    std::string key = getKey(url, offset);
+    if (restore(key, formatContext)) {
+        *hit = true;
+        return 0;
+    }
+
+    int ret = probe(formatContext, codecOpts, true);
+    if (ret >= 0) {
+        store(key, formatContext);
+    }
+    return ret;
+}
+
+/**
+ * 本地文件加上文件大小和修改时间，文件被替换之后不再使用旧的缓存
+ */
+std::string ProbeCache::getKey(const char *url, int64_t offset) {
+    std::string key(url);
+    key.append("#").append(std::to_string(offset));
+
+    const char *path = url;
+    av_strstart(url, "file:", &path);
+    struct stat st;
+    if (!strstr(path, "://") && stat(path, &st) == 0) {
+        key.append("#").append(std::to_string((long long) st.st_size));
+        key.append("#").append(std::to_string((long long) st.st_mtime));
+    }
+    return key;
+}
+
+bool ProbeCache::isCacheable(AVFormatContext *formatContext) {
+    return formatContext->iformat && !isRealTime(formatContext) &&
+           strcmp(formatContext->iformat->name, "hls") != 0 &&
+           strcmp(formatContext->iformat->name, "hls,applehttp") != 0;
+}
+
+bool ProbeCache::restore(const std::string &key, AVFormatContext *formatContext) {
+    Mutex::Autolock lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return false;
+    }
+    ProbeEntry *entry = it->second;
+
+    // 读完文件头之后的流布局必须和缓存一致，否则仍然需要探测
+    if (entry->formatName != formatContext->iformat->name ||
+        entry->streams.size() != formatContext->nb_streams) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] stream layout changed, nb_streams = %d", __func__,
+                  formatContext->nb_streams);
+        }
+        return false;
+    }
+    for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+        AVCodecParameters *codecpar = formatContext->streams[i]->codecpar;
+        AVCodecParameters *cached = entry->streams[i].codecpar;
+        if (codecpar->codec_type != cached->codec_type ||
+            (codecpar->codec_id != AV_CODEC_ID_NONE && codecpar->codec_id != cached->codec_id)) {
+            return false;
+        }
+    }
+
+    for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+        AVStream *stream = formatContext->streams[i];
+        ProbeEntry::StreamInfo &info = entry->streams[i];
+        if (!hasCodecParameters(stream->codecpar) &&
+            avcodec_parameters_copy(stream->codecpar, info.codecpar) < 0) {
+            return false;
+        }
+        if (!stream->avg_frame_rate.num) {
+            stream->avg_frame_rate = info.avgFrameRate;
+        }
+        if (!stream->r_frame_rate.num) {
+            stream->r_frame_rate = info.rFrameRate;
+        }
+        if (!stream->sample_aspect_ratio.num) {
+            stream->sample_aspect_ratio = info.sampleAspectRatio;
+        }
+        if (stream->duration == AV_NOPTS_VALUE) {
+            stream->duration = info.duration;
+        }
+        if (stream->start_time == AV_NOPTS_VALUE) {
+            stream->start_time = info.startTime;
+        }
+    }
+    if (formatContext->duration == AV_NOPTS_VALUE) {
+        formatContext->duration = entry->duration;
+    }
+    if (formatContext->start_time == AV_NOPTS_VALUE) {
+        formatContext->start_time = entry->startTime;
+    }
+    if (!formatContext->bit_rate) {
+        formatContext->bit_rate = entry->bitRate;
+    }
+    entry->lastUsed = ++useCount;
+    return true;
+}
+
+void ProbeCache::store(const std::string &key, AVFormatContext *formatContext) {
+    for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+        if (!hasCodecParameters(formatContext->streams[i]->codecpar)) {
+            return;
+        }
+    }
+
+    ProbeEntry *entry = new ProbeEntry();
+    entry->formatName = formatContext->iformat->name;
+    entry->duration = formatContext->duration;
+    entry->startTime = formatContext->start_time;
+    entry->bitRate = formatContext->bit_rate;
+    for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+        AVStream *stream = formatContext->streams[i];
+        ProbeEntry::StreamInfo info;
+        info.codecpar = avcodec_parameters_alloc();
+        if (!info.codecpar || avcodec_parameters_copy(info.codecpar, stream->codecpar) < 0) {
+            avcodec_parameters_free(&info.codecpar);
+            delete entry;
+            return;
+        }
+        info.avgFrameRate = stream->avg_frame_rate;
+        info.rFrameRate = stream->r_frame_rate;
+        info.sampleAspectRatio = stream->sample_aspect_ratio;
+        info.duration = stream->duration;
+        info.startTime = stream->start_time;
+        entry->streams.push_back(info);
+    }
+
+    Mutex::Autolock lock(mutex);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        delete it->second;
+        entries.erase(it);
+    }
+    if (entries.size() >= PROBE_CACHE_MAX_ENTRIES) {
+        auto oldest = entries.begin();
+        for (auto iter = entries.begin(); iter != entries.end(); iter++) {
+            if (iter->second->lastUsed < oldest->second->lastUsed) {
+                oldest = iter;
+            }
+        }
+        delete oldest->second;
+        entries.erase(oldest);
+    }
+    entry->lastUsed = ++useCount;
+    entries[key] = entry;
+}
+
+/**
+ * 只降低调用者没有设置过的探测参数，第一次探测后仍有流缺少参数时恢复原来的参数继续探测，
+ * 已经读取的数据包保留在解复用器的缓冲中，不会重复读取
+ */
+int ProbeCache::probe(AVFormatContext *formatContext, AVDictionary *codecOpts, bool fastStart) {
+    int64_t probeSize = formatContext->probesize;
+    int64_t analyzeDuration = formatContext->max_analyze_duration;
+    int fpsProbeSize = formatContext->fps_probe_size;
+
+    if (!fastStart) {
+        return doFindStreamInfo(formatContext, codecOpts);
+    }
+
+    if (isDefaultOption(formatContext, OPT_PROBE_SIZE)) {
+        formatContext->probesize = FAST_PROBE_SIZE;
+    }
+    if (isDefaultOption(formatContext, OPT_ANALYZE_DURATION)) {
+        formatContext->max_analyze_duration = FAST_ANALYZE_DURATION;
+    }
+    if (isDefaultOption(formatContext, OPT_FPS_PROBE_SIZE)) {
+        formatContext->fps_probe_size = FAST_FPS_PROBE_SIZE;
+    }
+
+    int ret = doFindStreamInfo(formatContext, codecOpts);
+
+    bool complete = true;
+    for (unsigned int i = 0; ret >= 0 && i < formatContext->nb_streams; i++) {
+        if (!hasCodecParameters(formatContext->streams[i]->codecpar)) {
+            complete = false;
+        }
+    }
+
+    formatContext->probesize = probeSize;
+    formatContext->max_analyze_duration = analyzeDuration;
+    formatContext->fps_probe_size = fpsProbeSize;
+
+    if (ret >= 0 && !complete) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] fast probe incomplete, probe again", __func__);
+        }
+        ret = doFindStreamInfo(formatContext, codecOpts);
+    }
+    return ret;
+}
+
+int ProbeCache::doFindStreamInfo(AVFormatContext *formatContext, AVDictionary *codecOpts) {
+    AVDictionary **opts = setupStreamInfoOptions(formatContext, codecOpts);
+    int streams = formatContext->nb_streams;
+    int ret = avformat_find_stream_info(formatContext, opts);
+    if (opts) {
+        for (int i = 0; i < streams; i++) {
+            av_dict_free(&opts[i]);
+        }
+        av_freep(&opts);
+    }
+    return ret;
+}
+
+bool ProbeCache::hasCodecParameters(AVCodecParameters *codecpar) {
+    // 字幕和数据流不影响起播，不检查
+    switch (codecpar->codec_type) {
+        case AVMEDIA_TYPE_VIDEO:
+            return codecpar->codec_id != AV_CODEC_ID_NONE && codecpar->width > 0 &&
+                   codecpar->format >= 0;
+        case AVMEDIA_TYPE_AUDIO:
+            return codecpar->codec_id != AV_CODEC_ID_NONE && codecpar->sample_rate > 0 &&
+                   codecpar->channels > 0 && codecpar->format >= 0;
+        default:
+            return true;
+    }
+}
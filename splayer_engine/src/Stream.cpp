@@ -26,7 +26,7 @@ Stream::~Stream() {
 int Stream::start() {
     Mutex::Autolock lock(mutex);
     if (!readThread) {
-        readThread = new Thread(this);
+        readThread = new ThreadTask(this);
         if (readThread) {
             readThread->start();
             return SUCCESS;
@@ -40,6 +40,7 @@ int Stream::stop() {
     if (ENGINE_DEBUG) {
         ALOGD(TAG, "[%s]", __func__);
     }
+    readEvent.signal();
     mutex.lock();
     audioDecoder = nullptr;
     videoDecoder = nullptr;
@@ -48,12 +49,27 @@ int Stream::stop() {
         avformat_free_context(formatContext);
         formatContext = nullptr;
     }
+    // 自定义IO需要在解复用上下文关闭之后释放
+    if (streamOpener) {
+        delete streamOpener;
+        streamOpener = nullptr;
+    }
     mutex.unlock();
     if (readThread) {
         readThread->join();
         delete readThread;
         readThread = nullptr;
     }
+    clearPreloadPackets();
+    StreamOpener::freePreparedCodecs(&preparedCodecs);
+    if (keyframeIndex) {
+        delete keyframeIndex;
+        keyframeIndex = nullptr;
+    }
+    if (adaptiveBitrate) {
+        delete adaptiveBitrate;
+        adaptiveBitrate = nullptr;
+    }
     return SUCCESS;
 }
 
@@ -85,6 +101,7 @@ void Stream::run() {
 
 int Stream::readPackets() {
     AVPacket pkt1, *pkt = &pkt1;
+    int readRetries = 0;
 
     for (;;) {
 
@@ -113,6 +130,16 @@ int Stream::readPackets() {
             doSeek();
         }
 
+        // 拖动进度时定位到最新目标之前的关键帧，读到关键帧之后等待下一个目标
+        if (playerState->scrubbing) {
+            if (playerState->scrubTarget != AV_NOPTS_VALUE) {
+                doScrub();
+            } else if (scrubKeyframeRead) {
+                readEvent.wait();
+                continue;
+            }
+        }
+
         // 处理封面数据包
         if (playerState->attachmentRequest) {
             if (doAttachment() < 0) {
@@ -124,21 +151,23 @@ int Stream::readPackets() {
             }
         }
 
-        // 队列满，等待消耗
-        if (isNotReadMore()) {
-            waitMutex.lock();
-            waitCondition.waitRelative(waitMutex, 10);
-            waitMutex.unlock();
+        // 队列满，等待解码器消耗数据包，或者定位、暂停、退出请求
+        bool notReadMore = isNotReadMore();
+        if (adaptiveBitrate) {
+            adaptiveBitrate->update(getBufferDuration(), notReadMore);
+        }
+        if (notReadMore) {
+            readEvent.wait();
             continue;
         }
 
-        // 播放结束
-        if (isFinish()) {
+        // 播放结束，拖动时解码器会被清空，不算结束
+        if (!playerState->scrubbing && isFinish()) {
             doRetryPlay();
         }
 
         // 读出数据包
-        int ret = av_read_frame(formatContext, pkt);
+        int ret = readFrame(pkt);
 
         if (ret < 0) {
 
@@ -162,13 +191,62 @@ int Stream::readPackets() {
                 return ERROR_IO;
             }
 
-            waitMutex.lock();
-            waitCondition.waitRelative(waitMutex, 10);
-            waitMutex.unlock();
+            // 读到结尾之后没有数据可读，等待播放结束、定位、暂停或者退出请求
+            // 其他错误(如EAGAIN)立即重试，连续失败之后等待读包事件，不再定时轮询，
+            // 解码器每取出一个数据包都会通知，取空队列之后只有定位、暂停、退出请求才能唤醒
+            // 网络读取本身在AVIO中阻塞等待数据，由中断回调退出
+            if (playerState->eof || ++readRetries >= READ_RETRY_COUNT) {
+                readRetries = 0;
+                readEvent.wait();
+            }
 
             continue;
         } else {
             playerState->eof = 0;
+            readRetries = 0;
+        }
+
+        if (keyframeIndex) {
+            keyframeIndex->addPacket(pkt);
+        }
+
+        // 多码率时只送入当前码率的数据包，流索引改为解码器的流索引
+        if (adaptiveBitrate && !adaptiveBitrate->filterPacket(pkt)) {
+            av_packet_unref(pkt);
+            continue;
+        }
+
+        // 低延时模式更新直播边缘，延时超过上限时丢弃队列中的数据包，从视频关键帧继续
+        LatencyController *latencyController =
+                mediaSync ? mediaSync->getLatencyController() : nullptr;
+        if (latencyController && latencyController->isEnabled()) {
+            latencyController->onPacket(pkt, formatContext->streams[pkt->stream_index]->time_base);
+            if (latencyController->isStale()) {
+                dropStalePackets();
+            }
+            if (latencyKeyframeWait) {
+                if (!videoDecoder || (pkt->stream_index == videoDecoder->getStreamIndex() &&
+                                      (pkt->flags & AV_PKT_FLAG_KEY))) {
+                    latencyKeyframeWait = false;
+                } else {
+                    av_packet_unref(pkt);
+                    continue;
+                }
+            }
+        }
+
+        // 拖动时只送入一个视频关键帧
+        if (playerState->scrubbing) {
+            if (!scrubKeyframeRead && videoDecoder && (pkt->flags & AV_PKT_FLAG_KEY) &&
+                pkt->stream_index == videoDecoder->getStreamIndex()) {
+                videoDecoder->pushPacket(pkt);
+                // 送入空包让解码器立即输出，否则多线程解码要等到后续的数据包
+                videoDecoder->pushNullPacket();
+                scrubKeyframeRead = true;
+            } else {
+                av_packet_unref(pkt);
+            }
+            continue;
         }
 
         if (audioDecoder && pkt->stream_index == audioDecoder->getStreamIndex() &&
@@ -244,18 +322,56 @@ void Stream::doSeek() {
         int64_t seekMax =
                 playerState->seekRel < 0 ? seekTarget - playerState->seekRel - 2 : INT64_MAX;
 
+        int64_t seekStartTime = av_gettime_relative();
+        int64_t keyframePts = AV_NOPTS_VALUE;
+        int64_t keyframePos = -1;
+        int ret = -1;
+
+        // 目标在关键帧索引的完整区间内时，直接按字节定位到目标之前最近的关键帧
+        bool indexed = keyframeIndex && !(playerState->seekFlags & AVSEEK_FLAG_BYTE) &&
+                       keyframeIndex->find(seekTarget, &keyframePts, &keyframePos) &&
+                       keyframePts >= seekMin && keyframePts <= seekMax;
+
+        // 正在切换码率时直接使用新码率，旧码率不再参与定位
+        if (adaptiveBitrate) {
+            adaptiveBitrate->flush();
+        }
+
         // 定位
         playerState->mutex.lock();
-        int ret = avformat_seek_file(formatContext, -1, seekMin, seekTarget, seekMax,
+        if (indexed) {
+            ret = avformat_seek_file(formatContext, -1, keyframePos, keyframePos, keyframePos,
+                                     AVSEEK_FLAG_BYTE);
+            indexed = ret >= 0;
+        }
+        if (!indexed) {
+            ret = avformat_seek_file(formatContext, -1, seekMin, seekTarget, seekMax,
                                      playerState->seekFlags);
+        }
         playerState->mutex.unlock();
 
+        if (keyframeIndex) {
+            keyframeIndex->discontinue();
+        }
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] indexed = %d keyframe = %lld seek cost = %lld ms", __func__, indexed,
+                  (long long) keyframePts,
+                  (long long) (av_gettime_relative() - seekStartTime) / 1000);
+        }
+
         if (ret < 0) {
             if (ENGINE_DEBUG) {
                 ALOGD(TAG, "[%s] %s: error while seeking", __func__, playerState->url);
             }
         } else {
+            clearPreloadPackets();
+
+            // 精确定位只用于按时间定位
+            int64_t accurateTarget =
+                    (playerState->accurateSeek || playerState->accurateSeekRequest) &&
+                    !(playerState->seekFlags & AVSEEK_FLAG_BYTE) ? seekTarget : AV_NOPTS_VALUE;
             if (audioDecoder) {
+                audioDecoder->setSeekTarget(accurateTarget);
                 audioDecoder->flush();
                 audioDecoder->pushFlushPacket();
                 if (ENGINE_DEBUG) {
@@ -263,6 +379,7 @@ void Stream::doSeek() {
                 }
             }
             if (videoDecoder) {
+                videoDecoder->setSeekTarget(accurateTarget);
                 videoDecoder->flush();
                 videoDecoder->pushFlushPacket();
                 if (ENGINE_DEBUG) {
@@ -281,6 +398,7 @@ void Stream::doSeek() {
             }
         }
         playerState->attachmentRequest = 1;
+        playerState->accurateSeekRequest = 0;
         playerState->seekRequest = 0;
         playerState->eof = 0;
 
@@ -288,19 +406,88 @@ void Stream::doSeek() {
     }
 }
 
-int Stream::openStream() {
+/**
+ * 低延时模式下延时超过上限，清空解码器，和定位一样通过序列号丢弃已经解码的帧
+ */
+void Stream::dropStalePackets() {
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] audio packets = %d video packets = %d", __func__,
+              audioDecoder ? audioDecoder->getPacketQueueSize() : 0,
+              videoDecoder ? videoDecoder->getPacketQueueSize() : 0);
+    }
+    if (audioDecoder) {
+        audioDecoder->flush();
+        audioDecoder->pushFlushPacket();
+    }
+    if (videoDecoder) {
+        videoDecoder->flush();
+        videoDecoder->pushFlushPacket();
+    }
+    if (mediaSync) {
+        mediaSync->updateExternalClock(NAN, 0);
+        mediaSync->getLatencyController()->reset();
+    }
+    latencyKeyframeWait = videoDecoder != nullptr;
+}
 
-    AVDictionaryEntry *t;
-    AVDictionary **opts;
-    int scanAllProgramMapTableSet = 0;
-    int ret = 0;
+/**
+ * 拖动进度时定位到目标之前的关键帧，只清空视频解码器，音频在结束拖动的定位中清空
+ */
+void Stream::doScrub() {
+    int64_t target = playerState->scrubTarget.exchange(AV_NOPTS_VALUE);
+    if (target == AV_NOPTS_VALUE || !formatContext) {
+        return;
+    }
+    int64_t keyframePts = AV_NOPTS_VALUE;
+    int64_t keyframePos = -1;
+    int ret = -1;
 
-    if (streamListener) {
-        if ((ret = streamListener->onStartOpenStream()) < 0) {
-            return ret;
+    if (adaptiveBitrate) {
+        adaptiveBitrate->flush();
+    }
+
+    playerState->mutex.lock();
+    if (keyframeIndex && keyframeIndex->find(target, &keyframePts, &keyframePos)) {
+        ret = avformat_seek_file(formatContext, -1, keyframePos, keyframePos, keyframePos,
+                                 AVSEEK_FLAG_BYTE);
+    }
+    if (ret < 0) {
+        ret = avformat_seek_file(formatContext, -1, INT64_MIN, target, target, 0);
+    }
+    if (ret < 0) {
+        ret = avformat_seek_file(formatContext, -1, INT64_MIN, target, INT64_MAX, 0);
+    }
+    playerState->mutex.unlock();
+
+    if (keyframeIndex) {
+        keyframeIndex->discontinue();
+    }
+    if (ret < 0) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] %s: error while scrubbing", __func__, playerState->url);
         }
+        return;
     }
 
+    playerState->scrubSeeks++;
+    playerState->eof = 0;
+    scrubKeyframeRead = false;
+    clearPreloadPackets();
+    if (videoDecoder) {
+        videoDecoder->setSeekTarget(AV_NOPTS_VALUE);
+        videoDecoder->flush();
+        videoDecoder->pushFlushPacket();
+    }
+}
+
+/**
+ * 打开媒体并查找媒体流信息
+ * @return
+ */
+int Stream::openInput() {
+
+    int ret = 0;
+
     // 创建解复用上下文
     formatContext = avformat_alloc_context();
     if (!formatContext) {
@@ -316,76 +503,139 @@ int Stream::openStream() {
     formatContext->interrupt_callback.callback = avFormatInterruptCb;
     formatContext->interrupt_callback.opaque = playerState;
 
-    // https://zhuanlan.zhihu.com/p/43672062
-    // scan_all_pmts, 是mpegts的一个选项，这里在没有设定该选项的时候，强制设为1
-    // scan_all_pmts, 扫描全部的ts流的"Program Map Table"表。
-    if (!av_dict_get(playerState->formatOpts, OPT_SCALL_ALL_PMTS, nullptr, AV_DICT_MATCH_CASE)) {
-        av_dict_set(&playerState->formatOpts, OPT_SCALL_ALL_PMTS, "1", AV_DICT_DONT_OVERWRITE);
-        scanAllProgramMapTableSet = 1;
+    // 打开文件，和预加载使用同样的解复用选项和自定义IO
+    streamOpener = new StreamOpener();
+    int64_t stageTime = av_gettime_relative();
+    if ((ret = streamOpener->openInput(&formatContext, playerState)) < 0) {
+        return ret;
     }
 
-    // 处理文件头
-    if (playerState->headers) {
-        av_dict_set(&playerState->formatOpts, OPT_HEADERS, playerState->headers, 0);
-    }
+    // 打开文件回调
+    notifyMsg(Msg::MSG_OPEN_INPUT);
+    notifyMsg(Msg::MSG_OPEN_TIMING, Msg::OPEN_STAGE_INPUT,
+              (int) ((av_gettime_relative() - stageTime) / 1000));
 
-    // 处理文件偏移量
-    if (playerState->offset > 0) {
-        formatContext->skip_initial_bytes = playerState->offset;
+    // 查找媒体流信息，快速起播时优先使用缓存的媒体流信息
+    stageTime = av_gettime_relative();
+    if ((ret = streamOpener->findStreamInfo(formatContext, playerState, &probeCacheHit)) < 0) {
+        return ret;
     }
+    notifyMsg(Msg::MSG_OPEN_TIMING, Msg::OPEN_STAGE_STREAM_INFO,
+              (int) ((av_gettime_relative() - stageTime) / 1000));
 
-    // 设置rtmp/rtsp的超时值
-    if (av_stristart(playerState->url, FORMAT_RTMP, nullptr) ||
-        av_stristart(playerState->url, FORMAT_RTSP, nullptr)) {
-        // There is total different meaning for 'timeout' option in rtmp
-        if (ENGINE_DEBUG) {
-            ALOGD(TAG, "[%s] remove 'timeout' option for rtmp", __func__);
-        }
-        av_dict_set(&playerState->formatOpts, OPT_KEY_TIMEOUT, nullptr, 0);
+    return SUCCESS;
+}
+
+/**
+ * 使用预加载的媒体，预加载时已经打开媒体、查找过媒体流信息并打开了解码器
+ * @return
+ */
+int Stream::openPreparedInput() {
+    StreamPreloader *preloader = mediaPlayer->getStreamPreloader();
+    if (!preloader ||
+        preloader->take(playerState->url, playerState->offset, &formatContext, &streamOpener,
+                        &preloadPackets, &preparedCodecs) < 0) {
+        return ERROR;
     }
 
-    // 打开文件
-    ret = avformat_open_input(&formatContext, playerState->url, playerState->inputFormat,
-                              &playerState->formatOpts);
-    if (ret < 0) {
-        ALOGE(TAG, "[%s] avformat could not open input", __func__);
-        return ERROR_NOT_OPEN_INPUT;
+    playerState->setFormatContext(formatContext);
+    mediaPlayer->setFormatContext(formatContext);
+
+    // 中断回调切换到当前播放器
+    formatContext->interrupt_callback.callback = avFormatInterruptCb;
+    formatContext->interrupt_callback.opaque = playerState;
+
+    if (playerState->generateMissingPts) {
+        formatContext->flags |= AVFMT_FLAG_GENPTS;
     }
 
-    // 打开文件回调
     notifyMsg(Msg::MSG_OPEN_INPUT);
+    return SUCCESS;
+}
 
-    // 还原MPEGTS的特殊处理标记
-    if (scanAllProgramMapTableSet) {
-        av_dict_set(&playerState->formatOpts, OPT_SCALL_ALL_PMTS, nullptr, AV_DICT_MATCH_CASE);
+/**
+ * 读取数据包，优先返回预加载的数据包
+ * @param pkt
+ * @return
+ */
+int Stream::readFrame(AVPacket *pkt) {
+    int ret = 0;
+    if (!preloadPackets.empty()) {
+        *pkt = preloadPackets.front();
+        preloadPackets.pop_front();
+    } else {
+        int64_t readStartTime = av_gettime_relative();
+        ret = av_read_frame(formatContext, pkt);
+        if (ret >= 0 && adaptiveBitrate) {
+            adaptiveBitrate->addSample(pkt->size, av_gettime_relative() - readStartTime);
+        }
     }
+    // 首个数据包的耗时从开始打开媒体算起
+    if (ret >= 0 && !firstPacketRead) {
+        firstPacketRead = true;
+        notifyMsg(Msg::MSG_OPEN_TIMING, Msg::OPEN_STAGE_FIRST_PACKET,
+                  (int) ((av_gettime_relative() - openStartTime) / 1000));
+    }
+    return ret;
+}
 
-    if ((t = av_dict_get(playerState->formatOpts, "", nullptr, AV_DICT_IGNORE_SUFFIX))) {
-        ALOGE(TAG, "[%s] Option %s not found", __func__, t->key);
-        return ERROR_CODEC_OPTIONS;
+/**
+ * 打开解码器，预加载时已经打开的解码器直接交出
+ * @param streamIndex
+ * @param codecContext
+ * @param opts
+ * @return
+ */
+int Stream::openCodec(int streamIndex, AVCodecContext **codecContext, AVDictionary **opts) {
+    for (auto it = preparedCodecs.begin(); it != preparedCodecs.end(); ++it) {
+        if (it->streamIndex == streamIndex) {
+            *codecContext = it->codecContext;
+            *opts = it->opts;
+            preparedCodecs.erase(it);
+            return SUCCESS;
+        }
+    }
+    if (!streamOpener) {
+        return ERROR;
     }
+    return streamOpener->openCodec(formatContext, streamIndex, playerState, codecContext, opts);
+}
 
-    if (playerState->generateMissingPts) {
-        formatContext->flags |= AVFMT_FLAG_GENPTS;
+void Stream::clearPreloadPackets() {
+    for (auto &pkt : preloadPackets) {
+        av_packet_unref(&pkt);
     }
-    av_format_inject_global_side_data(formatContext);
+    preloadPackets.clear();
+}
 
-    opts = setupStreamInfoOptions(formatContext, playerState->codecOpts);
+int Stream::openStream() {
 
-    // 查找媒体流信息
-    ret = avformat_find_stream_info(formatContext, opts);
-    if (opts) {
-        for (int i = 0; i < formatContext->nb_streams; i++) {
-            if (opts[i]) {
-                av_dict_free(&opts[i]);
-            }
+    AVDictionaryEntry *t;
+    bool prepared = false;
+    int ret = 0;
+
+    openStartTime = av_gettime_relative();
+    firstPacketRead = false;
+    probeCacheHit = false;
+
+    if (streamListener) {
+        if ((ret = streamListener->onStartOpenStream()) < 0) {
+            return ret;
         }
-        av_freep(&opts);
     }
 
-    if (ret < 0) {
-        ALOGE(TAG, "[%s] %s: could not find codec parameters", __func__, playerState->url);
-        return ERROR_NOT_FOUND_STREAM_INFO;
+    // 优先使用预加载的媒体
+    if (openPreparedInput() >= 0) {
+        prepared = true;
+    } else if ((ret = openInput()) < 0) {
+        return ret;
+    }
+
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] prepared = %d probe cache hit = %d preload packets = %d "
+                   "open cost = %lld ms", __func__, prepared, probeCacheHit,
+              (int) preloadPackets.size(),
+              (long long) (av_gettime_relative() - openStartTime) / 1000);
     }
 
     // 已获取媒体信息
@@ -435,6 +685,7 @@ int Stream::openStream() {
         playerState->mutex.lock();
         ret = avformat_seek_file(formatContext, -1, INT64_MIN, timestamp, INT64_MAX, 0);
         playerState->mutex.unlock();
+        clearPreloadPackets();
         if (ret < 0) {
             ALOGE(TAG, "[%s] %s: could not _seek to position %0.3f", __func__, playerState->url,
                   (double) timestamp / AV_TIME_BASE);
@@ -487,6 +738,36 @@ int Stream::openStream() {
         return ERROR_DISABLE_ALL_STREAM;
     }
 
+    // 原生索引不完善的格式在读包时建立视频关键帧索引
+    if (videoIndex >= 0 && KeyframeIndex::isSupported(formatContext)) {
+        keyframeIndex = new KeyframeIndex();
+        if (keyframeIndex->open(formatContext, videoIndex, playerState->url,
+                                playerState->cacheDir) < 0) {
+            delete keyframeIndex;
+            keyframeIndex = nullptr;
+        }
+    }
+
+    // HLS多码率按带宽切换，切换时数据包送入已经打开的解码器
+    if (playerState->adaptiveBitrate && AdaptiveBitrate::isSupported(formatContext)) {
+        adaptiveBitrate = new AdaptiveBitrate(messageCenter);
+        if (adaptiveBitrate->open(formatContext,
+                                  videoDecoder ? videoDecoder->getStreamIndex() : -1,
+                                  audioDecoder ? audioDecoder->getStreamIndex() : -1) < 0) {
+            delete adaptiveBitrate;
+            adaptiveBitrate = nullptr;
+        }
+    }
+
+    // 直播低延时模式，没有时长的流按直播处理，减小队列并控制延时
+    if (playerState->lowLatency && (playerState->realTime || formatContext->duration <= 0) &&
+        mediaSync) {
+        playerState->maxQueueSize = FFMIN(playerState->maxQueueSize, LOW_LATENCY_MAX_QUEUE_SIZE);
+        mediaSync->getLatencyController()->open(messageCenter, formatContext,
+                                                playerState->targetLatency,
+                                                playerState->maxLatency);
+    }
+
     return SUCCESS;
 }
 
@@ -538,7 +819,7 @@ void Stream::setMediaSync(MediaSync *mediaSync) {
     Stream::mediaSync = mediaSync;
 }
 
-Condition *Stream::getWaitCondition() { return &waitCondition; }
+Event *Stream::getReadEvent() { return &readEvent; }
 
 AVPacket *Stream::getFlushPacket() { return &flushPacket; }
 
@@ -568,7 +849,7 @@ void Stream::setStreamListener(IStreamListener *streamListener) {
 }
 
 int Stream::create() {
-    avformat_network_init();
+    MediaEngine::acquire();
     av_init_packet(&flushPacket);
     flushPacket.data = (uint8_t *) &flushPacket;
     return SUCCESS;
@@ -577,7 +858,7 @@ int Stream::create() {
 int Stream::destroy() {
     flushPacket.data = nullptr;
     av_packet_unref(&flushPacket);
-    avformat_network_deinit();
+    MediaEngine::release();
     streamListener = nullptr;
     mediaSync = nullptr;
     return SUCCESS;
@@ -587,11 +868,34 @@ void Stream::setMessageCenter(MessageCenter *messageCenter) {
     Stream::messageCenter = messageCenter;
 }
 
+/**
+ * 解码器数据包队列中缓冲的时长，取音视频中较短的，微秒
+ */
+int64_t Stream::getBufferDuration() const {
+    int64_t duration = INT64_MAX;
+    MediaDecoder *decoders[] = {audioDecoder, videoDecoder};
+    for (MediaDecoder *decoder : decoders) {
+        if (decoder && decoder->getPacketQueue()) {
+            duration = FFMIN(duration, av_rescale_q(decoder->getPacketQueue()->getDuration(),
+                                                    decoder->getStream()->time_base,
+                                                    AV_TIME_BASE_Q));
+        }
+    }
+    return duration == INT64_MAX ? 0 : duration;
+}
+
 bool Stream::isNotReadMore() const {
     bool isNoInfiniteBuffer = playerState->infiniteBuffer < 1;
     bool isNoEnoughMemory = (audioDecoder ? audioDecoder->getPacketQueueMemorySize() : 0) +
                             (videoDecoder ? videoDecoder->getPacketQueueMemorySize() : 0) >
-                            MAX_QUEUE_SIZE;
+                            playerState->maxQueueSize;
+    // 解码后的帧数据也计入内存预算
+    if (playerState->maxFrameQueueSize > 0) {
+        isNoEnoughMemory = isNoEnoughMemory ||
+                           (audioDecoder ? audioDecoder->getFrameQueueMemorySize() : 0) +
+                           (videoDecoder ? videoDecoder->getFrameQueueMemorySize() : 0) >
+                           playerState->maxFrameQueueSize;
+    }
     bool isAudioEnoughPackets = !audioDecoder || audioDecoder->hasEnoughPackets();
     bool isVideoEnoughPackets = !videoDecoder || videoDecoder->hasEnoughPackets();
     bool isNotReadMore = isNoInfiniteBuffer &&
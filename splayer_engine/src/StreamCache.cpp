@@ -0,0 +1,665 @@
+#include "StreamCache.h"
+#include <vector>
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+extern "C" {
+#include <libavutil/base64.h>
+#include <libavutil/opt.h>
+};
+
+/// 索引文件标识，第二版加入了ETag/Last-Modified
+#define CACHE_INDEX_MAGIC                           0x53504332
+
+CacheFile::CacheFile(StreamCache *streamCache, AVIOContext *upstream, const std::string &path,
+                     const std::string &validator, bool validate) {
+    this->streamCache = streamCache;
+    this->upstream = upstream;
+    this->path = path;
+    this->validator = validator;
+    this->validate = validate;
+}
+
+CacheFile::~CacheFile() {
+    close();
+    streamCache = nullptr;
+    upstream = nullptr;
+}
+
+/**
+ * 打开缓存文件，文件大小和资源大小一致，未下载的部分不占用磁盘
+ * 大小或者ETag/Last-Modified变化时之前的缓存失效；服务器没有返回这两个响应头时只能按大小判断
+ * @return
+ */
+int CacheFile::open() {
+    size = avio_size(upstream);
+    if (size <= 0) {
+        return ERROR;
+    }
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        ALOGE(TAG, "[%s] open %s failure", __func__, path.c_str());
+        return ERROR;
+    }
+
+    struct stat st;
+    bool reuse = fstat(fd, &st) == 0 && st.st_size == size;
+    if (reuse && !loadIndex()) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] %s changed, drop cache", __func__, path.c_str());
+        }
+        reuse = false;
+    }
+    if (!reuse) {
+        // 资源变化，之前的缓存失效
+        ranges.clear();
+        if (ftruncate(fd, 0) < 0 || ftruncate(fd, (off_t) size) < 0) {
+            ALOGE(TAG, "[%s] truncate %s failure", __func__, path.c_str());
+            close();
+            return ERROR;
+        }
+    }
+
+    // 只读映射，写入通过pwrite，磁盘已满时返回错误而不是在写入映射时触发SIGBUS
+    void *addr = mmap(nullptr, (size_t) size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        ALOGE(TAG, "[%s] mmap %s failure", __func__, path.c_str());
+        ranges.clear();
+        close();
+        return ERROR;
+    }
+    data = (uint8_t *) addr;
+
+    auto *buffer = (uint8_t *) av_malloc(STREAM_CACHE_IO_BUFFER_SIZE);
+    if (!buffer) {
+        close();
+        return ERROR_NOT_MEMORY;
+    }
+    ioContext = avio_alloc_context(buffer, STREAM_CACHE_IO_BUFFER_SIZE, 0, this,
+                                   readPacket, nullptr, seekPacket);
+    if (!ioContext) {
+        av_free(buffer);
+        close();
+        return ERROR_NOT_MEMORY;
+    }
+    ioContext->seekable = AVIO_SEEKABLE_NORMAL;
+
+    // 更新修改时间，淘汰时按最近使用排序
+    utime(path.c_str(), nullptr);
+
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] %s size = %lld ranges = %d", __func__, path.c_str(), (long long) size,
+              (int) ranges.size());
+    }
+    return SUCCESS;
+}
+
+void CacheFile::close() {
+    if (ioContext) {
+        av_freep(&ioContext->buffer);
+        avio_context_free(&ioContext);
+    }
+    if (data) {
+        munmap(data, (size_t) size);
+        data = nullptr;
+        saveIndex();
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+int CacheFile::read(uint8_t *buf, int size) {
+    if (position >= this->size) {
+        return AVERROR_EOF;
+    }
+    size = (int) FFMIN(size, this->size - position);
+
+    // 命中缓存
+    int64_t cachedLength = getCachedLength(position);
+    if (cachedLength > 0) {
+        int length = (int) FFMIN(cachedLength, size);
+        memcpy(buf, data + position, (size_t) length);
+        position += length;
+        streamCache->hitBytes += length;
+        return length;
+    }
+
+    // 未命中，从网络读取到下一个已缓存区间为止
+    size = (int) FFMIN(size, getNextCachedPos(position) - position);
+    if (avio_tell(upstream) != position) {
+        int64_t ret = avio_seek(upstream, position, SEEK_SET);
+        if (ret < 0) {
+            return (int) ret;
+        }
+    }
+    int length = avio_read(upstream, buf, size);
+    if (length <= 0) {
+        return length == 0 ? AVERROR_EOF : length;
+    }
+    if (!writeFailed && writeData(buf, position, length) == SUCCESS) {
+        addRange(position, position + length);
+    }
+    position += length;
+    streamCache->missBytes += length;
+    return length;
+}
+
+int64_t CacheFile::seek(int64_t offset, int whence) {
+    int64_t pos;
+    switch (whence & ~AVSEEK_FORCE) {
+        case AVSEEK_SIZE:
+            return size;
+        case SEEK_SET:
+            pos = offset;
+            break;
+        case SEEK_CUR:
+            pos = position + offset;
+            break;
+        case SEEK_END:
+            pos = size + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+    if (pos < 0) {
+        return AVERROR(EINVAL);
+    }
+    // 只移动读取位置，未命中时才移动网络数据源
+    position = pos;
+    return position;
+}
+
+/**
+ * 写入失败时只影响缓存，读到的数据照常返回给解复用器
+ */
+int CacheFile::writeData(const uint8_t *buf, int64_t pos, int length) {
+    while (length > 0) {
+        ssize_t ret = pwrite(fd, buf, (size_t) length, (off_t) pos);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            ALOGE(TAG, "[%s] write %s failure: %s", __func__, path.c_str(), strerror(errno));
+            writeFailed = true;
+            return ERROR;
+        }
+        buf += ret;
+        pos += ret;
+        length -= (int) ret;
+    }
+    return SUCCESS;
+}
+
+int64_t CacheFile::getCachedLength(int64_t pos) {
+    auto it = ranges.upper_bound(pos);
+    if (it == ranges.begin()) {
+        return 0;
+    }
+    --it;
+    return it->second > pos ? it->second - pos : 0;
+}
+
+int64_t CacheFile::getNextCachedPos(int64_t pos) {
+    auto it = ranges.upper_bound(pos);
+    return it == ranges.end() ? size : it->first;
+}
+
+/**
+ * 添加已缓存区间，和相邻或者重叠的区间合并
+ */
+void CacheFile::addRange(int64_t start, int64_t end) {
+    auto it = ranges.upper_bound(start);
+    if (it != ranges.begin()) {
+        auto prev = std::prev(it);
+        if (prev->second >= start) {
+            start = prev->first;
+            end = FFMAX(end, prev->second);
+            it = ranges.erase(prev);
+        }
+    }
+    while (it != ranges.end() && it->first <= end) {
+        end = FFMAX(end, it->second);
+        it = ranges.erase(it);
+    }
+    ranges[start] = end;
+}
+
+/**
+ * 索引格式：标识、资源大小、ETag/Last-Modified的长度和内容、区间数量、区间
+ * 不校验时沿用索引中保存的ETag/Last-Modified，关闭时原样写回
+ */
+bool CacheFile::loadIndex() {
+    std::string indexPath = path + ".index";
+    FILE *file = fopen(indexPath.c_str(), "rb");
+    if (!file) {
+        return true;
+    }
+    bool valid = true;
+    int32_t magic = 0;
+    int64_t indexSize = 0;
+    int32_t length = 0;
+    int32_t count = 0;
+    if (fread(&magic, sizeof(magic), 1, file) == 1 && magic == CACHE_INDEX_MAGIC &&
+        fread(&indexSize, sizeof(indexSize), 1, file) == 1 && indexSize == size &&
+        fread(&length, sizeof(length), 1, file) == 1 && length >= 0 &&
+        length <= STREAM_CACHE_MAX_LINE) {
+        std::string stored((size_t) length, '\0');
+        if (length > 0 && fread(&stored[0], (size_t) length, 1, file) != 1) {
+            fclose(file);
+            return true;
+        }
+        if (!validate) {
+            validator = stored;
+        } else if (stored != validator) {
+            valid = false;
+        }
+        if (valid && fread(&count, sizeof(count), 1, file) == 1) {
+            for (int i = 0; i < count; i++) {
+                int64_t range[2];
+                if (fread(range, sizeof(range), 1, file) != 1) {
+                    break;
+                }
+                if (range[0] >= 0 && range[0] < range[1] && range[1] <= size) {
+                    addRange(range[0], range[1]);
+                }
+            }
+        }
+    }
+    fclose(file);
+    return valid;
+}
+
+void CacheFile::saveIndex() {
+    std::string indexPath = path + ".index";
+    FILE *file = fopen(indexPath.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+    int32_t magic = CACHE_INDEX_MAGIC;
+    auto length = (int32_t) validator.size();
+    auto count = (int32_t) ranges.size();
+    fwrite(&magic, sizeof(magic), 1, file);
+    fwrite(&size, sizeof(size), 1, file);
+    fwrite(&length, sizeof(length), 1, file);
+    fwrite(validator.data(), validator.size(), 1, file);
+    fwrite(&count, sizeof(count), 1, file);
+    for (auto &it : ranges) {
+        int64_t range[2] = {it.first, it.second};
+        fwrite(range, sizeof(range), 1, file);
+    }
+    fclose(file);
+}
+
+int CacheFile::readPacket(void *opaque, uint8_t *buf, int size) {
+    return ((CacheFile *) opaque)->read(buf, size);
+}
+
+int64_t CacheFile::seekPacket(void *opaque, int64_t offset, int whence) {
+    return ((CacheFile *) opaque)->seek(offset, whence);
+}
+
+StreamCache::StreamCache(const char *cacheDir, int64_t maxSize) {
+    this->cacheDir = cacheDir;
+    this->maxSize = maxSize;
+    hitBytes = 0;
+    missBytes = 0;
+    mkdir(cacheDir, 0700);
+}
+
+StreamCache::~StreamCache() {
+    closeInput();
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] hit bytes = %lld miss bytes = %lld", __func__,
+              (long long) hitBytes.load(), (long long) missBytes.load());
+    }
+}
+
+bool StreamCache::isSupported(const char *url) {
+    return url && (av_stristart(url, "http://", nullptr) || av_stristart(url, "https://", nullptr));
+}
+
+/**
+ * 只缓存http(s)资源，m3u8播放列表可能是直播，每次都需要重新获取
+ */
+bool StreamCache::isCacheable(const char *url) {
+    if (!isSupported(url)) {
+        return false;
+    }
+    const char *query = strchr(url, '?');
+    size_t length = query ? (size_t) (query - url) : strlen(url);
+    return !(length >= 5 && !av_strncasecmp(url + length - 5, ".m3u8", 5));
+}
+
+int StreamCache::openInput(AVFormatContext *formatContext, const char *url,
+                           AVDictionary **options) {
+    defaultIoOpen = formatContext->io_open;
+    defaultIoClose = formatContext->io_close;
+    formatContext->opaque = this;
+    formatContext->io_open = ioOpen;
+    formatContext->io_close = ioClose;
+
+    // 播放列表由avformat_open_input通过io_open打开，不使用自定义IO，
+    // 否则HLS不会把主输入的headers、cookies带到分片请求中
+    if (!isCacheable(url)) {
+        return SUCCESS;
+    }
+
+    int ret = open(formatContext, &inputContext, url, AVIO_FLAG_READ, options, true);
+    if (ret < 0) {
+        formatContext->io_open = defaultIoOpen;
+        formatContext->io_close = defaultIoClose;
+        formatContext->opaque = nullptr;
+        return ret;
+    }
+    formatContext->pb = inputContext;
+    formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+    trim();
+    return SUCCESS;
+}
+
+void StreamCache::closeInput() {
+    if (inputContext) {
+        close(inputContext);
+        inputContext = nullptr;
+        trim();
+    }
+}
+
+int64_t StreamCache::getHitBytes() {
+    return hitBytes;
+}
+
+int64_t StreamCache::getMissBytes() {
+    return missBytes;
+}
+
+int StreamCache::ioOpen(AVFormatContext *s, AVIOContext **pb, const char *url, int flags,
+                        AVDictionary **options) {
+    return ((StreamCache *) s->opaque)->open(s, pb, url, flags, options, false);
+}
+
+void StreamCache::ioClose(AVFormatContext *s, AVIOContext *pb) {
+    ((StreamCache *) s->opaque)->close(pb);
+}
+
+int StreamCache::open(AVFormatContext *s, AVIOContext **pb, const char *url, int flags,
+                      AVDictionary **options, bool validate) {
+    AVIOContext *upstream = nullptr;
+    int ret = defaultIoOpen(s, &upstream, url, flags, options);
+    if (ret < 0) {
+        return ret;
+    }
+    *pb = upstream;
+
+    if ((flags & AVIO_FLAG_WRITE) || !isCacheable(url) || !upstream->seekable) {
+        return ret;
+    }
+    int64_t size = avio_size(upstream);
+    if (size <= 0 || size > maxSize) {
+        return ret;
+    }
+
+    std::string path = getCachePath(cacheDir, url);
+    mutex.lock();
+    bool inUse = openPaths.count(path) > 0;
+    if (!inUse) {
+        openPaths.insert(path);
+    }
+    mutex.unlock();
+    if (inUse) {
+        return ret;
+    }
+
+    std::string validator;
+    if (validate) {
+        validator = fetchValidator(s, upstream, url);
+    }
+
+    auto *cacheFile = new CacheFile(this, upstream, path, validator, validate);
+    if (cacheFile->open() < 0) {
+        delete cacheFile;
+        Mutex::Autolock lock(mutex);
+        openPaths.erase(path);
+        return ret;
+    }
+    *pb = cacheFile->ioContext;
+    return ret;
+}
+
+void StreamCache::close(AVIOContext *pb) {
+    if (!pb) {
+        return;
+    }
+    if (pb->read_packet != CacheFile::readPacket) {
+        avio_close(pb);
+        return;
+    }
+    auto *cacheFile = (CacheFile *) pb->opaque;
+    AVIOContext *upstream = cacheFile->upstream;
+    std::string path = cacheFile->path;
+    delete cacheFile;
+    avio_close(upstream);
+    Mutex::Autolock lock(mutex);
+    openPaths.erase(path);
+}
+
+/**
+ * 读取一行响应，去掉行尾的\r\n，超长的部分丢弃
+ */
+static int readLine(AVIOContext *io, char *line, int size) {
+    int length = 0;
+    for (;;) {
+        int c = avio_r8(io);
+        if (avio_feof(io) || io->error < 0) {
+            return ERROR;
+        }
+        if (c == '\n') {
+            break;
+        }
+        if (c != '\r' && length < size - 1) {
+            line[length++] = (char) c;
+        }
+    }
+    line[length] = '\0';
+    return length;
+}
+
+/**
+ * 在tcp/tls连接上直接发送HEAD请求，带上数据源使用的User-Agent、Referer、自定义请求头和认证信息
+ * 跟随绝对地址和绝对路径的重定向，只解析状态行、Location、ETag和Last-Modified
+ */
+std::string StreamCache::fetchValidator(AVFormatContext *s, AVIOContext *upstream,
+                                        const char *url) {
+    char *value = nullptr;
+    std::string location = url;
+    if (av_opt_get(upstream, "location", AV_OPT_SEARCH_CHILDREN, (uint8_t **) &value) >= 0 &&
+        value && *value) {
+        location = value;
+    }
+    av_freep(&value);
+    std::string extraHeaders;
+    const char *const names[] = {"User-Agent", "Referer"};
+    const char *const options[] = {"user_agent", "referer"};
+    for (int i = 0; i < 2; i++) {
+        if (av_opt_get(upstream, options[i], AV_OPT_SEARCH_CHILDREN, (uint8_t **) &value) >= 0 &&
+            value && *value) {
+            extraHeaders += std::string(names[i]) + ": " + value + "\r\n";
+        }
+        av_freep(&value);
+    }
+    if (av_opt_get(upstream, "headers", AV_OPT_SEARCH_CHILDREN, (uint8_t **) &value) >= 0 &&
+        value && *value) {
+        extraHeaders += value;
+        if (extraHeaders.size() < 2 || extraHeaders.compare(extraHeaders.size() - 2, 2, "\r\n")) {
+            extraHeaders += "\r\n";
+        }
+    }
+    av_freep(&value);
+
+    for (int i = 0; i <= STREAM_CACHE_MAX_REDIRECTS; i++) {
+        char proto[16], auth[256], host[256], path[STREAM_CACHE_MAX_LINE];
+        int port = -1;
+        av_url_split(proto, sizeof(proto), auth, sizeof(auth), host, sizeof(host), &port,
+                     path, sizeof(path), location.c_str());
+        bool https = !av_strcasecmp(proto, "https");
+        if ((!https && av_strcasecmp(proto, "http")) || !host[0]) {
+            return "";
+        }
+        int defaultPort = https ? 443 : 80;
+        if (port < 0) {
+            port = defaultPort;
+        }
+        // IPv6地址需要加上方括号
+        std::string hostName = strchr(host, ':') ? std::string("[") + host + "]" : host;
+        std::string target = std::string(https ? "tls://" : "tcp://") + hostName + ":" +
+                             std::to_string(port);
+
+        std::string request = std::string("HEAD ") + (path[0] ? path : "/") + " HTTP/1.1\r\n";
+        request += "Host: " + hostName;
+        if (port != defaultPort) {
+            request += ":" + std::to_string(port);
+        }
+        request += "\r\n";
+        if (auth[0]) {
+            char encoded[AV_BASE64_SIZE(sizeof(auth))];
+            av_base64_encode(encoded, sizeof(encoded), (const uint8_t *) auth, (int) strlen(auth));
+            request += std::string("Authorization: Basic ") + encoded + "\r\n";
+        }
+        request += extraHeaders;
+        request += "Accept: */*\r\nConnection: close\r\n\r\n";
+
+        AVDictionary *ioOptions = nullptr;
+        av_dict_set_int(&ioOptions, "rw_timeout", STREAM_CACHE_VALIDATE_TIMEOUT, 0);
+        AVIOContext *io = nullptr;
+        int ret = avio_open2(&io, target.c_str(), AVIO_FLAG_READ_WRITE, &s->interrupt_callback,
+                             &ioOptions);
+        av_dict_free(&ioOptions);
+        if (ret < 0) {
+            return "";
+        }
+        avio_write(io, (const unsigned char *) request.data(), (int) request.size());
+        avio_flush(io);
+        // 同一个AVIOContext先写后读，清空写缓冲的状态，之后的读取直接从连接读
+        io->write_flag = 0;
+        io->buf_ptr = io->buf_end = io->buffer;
+
+        char line[STREAM_CACHE_MAX_LINE];
+        int status = 0;
+        std::string etag, lastModified, redirect;
+        if (readLine(io, line, sizeof(line)) > 0 && av_stristart(line, "HTTP/", nullptr)) {
+            const char *p = strchr(line, ' ');
+            status = p ? atoi(p + 1) : 0;
+            while (readLine(io, line, sizeof(line)) > 0) {
+                const char *p1 = nullptr;
+                std::string *header = nullptr;
+                if (av_stristart(line, "ETag:", &p1)) {
+                    header = &etag;
+                } else if (av_stristart(line, "Last-Modified:", &p1)) {
+                    header = &lastModified;
+                } else if (av_stristart(line, "Location:", &p1)) {
+                    header = &redirect;
+                }
+                if (header) {
+                    p1 += strspn(p1, " \t");
+                    *header = p1;
+                }
+            }
+        }
+        avio_closep(&io);
+
+        if (status >= 300 && status < 400 && !redirect.empty()) {
+            if (redirect[0] == '/') {
+                redirect = std::string(proto) + "://" + hostName + ":" + std::to_string(port) +
+                           redirect;
+            }
+            location = redirect;
+            continue;
+        }
+        if (status < 200 || status >= 300 || (etag.empty() && lastModified.empty())) {
+            return "";
+        }
+        return "etag=" + etag + ";last-modified=" + lastModified;
+    }
+    return "";
+}
+
+/**
+ * 缓存文件名为url的FNV-1a哈希值
+ */
+std::string StreamCache::getCachePath(const std::string &cacheDir, const char *url) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char *p = url; *p; p++) {
+        hash ^= (uint8_t) *p;
+        hash *= 1099511628211ULL;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.data", (unsigned long long) hash);
+    return cacheDir + "/" + name;
+}
+
+/**
+ * 统计缓存目录中数据文件实际占用的磁盘空间，超出上限时从最久未使用的文件开始删除
+ */
+void StreamCache::trim() {
+    struct CacheEntry {
+        std::string path;
+        time_t time;
+        int64_t usage;
+    };
+    std::vector<CacheEntry> entries;
+    int64_t totalUsage = 0;
+
+    DIR *dir = opendir(cacheDir.c_str());
+    if (!dir) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        size_t length = strlen(entry->d_name);
+        if (length < 5 || strcmp(entry->d_name + length - 5, ".data") != 0) {
+            continue;
+        }
+        std::string path = cacheDir + "/" + entry->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) < 0) {
+            continue;
+        }
+        auto usage = (int64_t) st.st_blocks * 512;
+        entries.push_back({path, st.st_mtime, usage});
+        totalUsage += usage;
+    }
+    closedir(dir);
+
+    if (totalUsage <= maxSize) {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(), [](const CacheEntry &a, const CacheEntry &b) {
+        return a.time < b.time;
+    });
+    Mutex::Autolock lock(mutex);
+    for (auto &it : entries) {
+        if (totalUsage <= maxSize) {
+            break;
+        }
+        if (openPaths.count(it.path)) {
+            continue;
+        }
+        unlink(it.path.c_str());
+        unlink((it.path + ".index").c_str());
+        // 同一资源的关键帧索引一起删除
+        unlink((it.path + ".kfi").c_str());
+        totalUsage -= it.usage;
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] evict %s", __func__, it.path.c_str());
+        }
+    }
+}
@@ -0,0 +1,350 @@
+#include "StreamOpener.h"
+
+StreamOpener::StreamOpener() = default;
+
+StreamOpener::~StreamOpener() {
+    if (streamCache) {
+        delete streamCache;
+        streamCache = nullptr;
+    }
+    if (localFileIO) {
+        delete localFileIO;
+        localFileIO = nullptr;
+    }
+}
+
+/**
+ * 打开媒体
+ * @param formatContext 已经创建并设置中断回调的解复用上下文
+ * @param playerState 播放器参数，使用url、偏移量、文件头、解复用参数、缓存目录和低延时模式
+ * @return
+ */
+int StreamOpener::openInput(AVFormatContext **formatContext, PlayerInfoStatus *playerState) {
+
+    AVDictionaryEntry *t;
+    int scanAllProgramMapTableSet = 0;
+    int ret = 0;
+
+    // https://zhuanlan.zhihu.com/p/43672062
+    // scan_all_pmts, 是mpegts的一个选项，这里在没有设定该选项的时候，强制设为1
+    // scan_all_pmts, 扫描全部的ts流的"Program Map Table"表。
+    if (!av_dict_get(playerState->formatOpts, OPT_SCALL_ALL_PMTS, nullptr, AV_DICT_MATCH_CASE)) {
+        av_dict_set(&playerState->formatOpts, OPT_SCALL_ALL_PMTS, "1", AV_DICT_DONT_OVERWRITE);
+        scanAllProgramMapTableSet = 1;
+    }
+
+    // 处理文件头
+    if (playerState->headers) {
+        av_dict_set(&playerState->formatOpts, OPT_HEADERS, playerState->headers, 0);
+    }
+
+    // 处理文件偏移量
+    if (playerState->offset > 0) {
+        (*formatContext)->skip_initial_bytes = playerState->offset;
+    }
+
+    // 低延时模式减小解复用器的重排缓冲
+    if (playerState->lowLatency && (*formatContext)->max_delay < 0) {
+        (*formatContext)->max_delay = LOW_LATENCY_MAX_DELAY;
+    }
+
+    // 设置rtmp/rtsp的超时值
+    if (av_stristart(playerState->url, FORMAT_RTMP, nullptr) ||
+        av_stristart(playerState->url, FORMAT_RTSP, nullptr)) {
+        // There is total different meaning for 'timeout' option in rtmp
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] remove 'timeout' option for rtmp", __func__);
+        }
+        av_dict_set(&playerState->formatOpts, OPT_KEY_TIMEOUT, nullptr, 0);
+    }
+
+    // 网络流经过磁盘缓存读取，缓存打开失败时直接读取网络
+    int httpPersistentSet = 0;
+    if (playerState->cacheDir && StreamCache::isSupported(playerState->url)) {
+        streamCache = new StreamCache(playerState->cacheDir, playerState->cacheMaxSize);
+        if (streamCache->openInput(*formatContext, playerState->url,
+                                   &playerState->formatOpts) < 0) {
+            ALOGE(TAG, "[%s] open stream cache failure", __func__);
+            delete streamCache;
+            streamCache = nullptr;
+        } else {
+            // HLS的分片经过缓存的AVIOContext读取，不是http的URLContext，不能复用分片的连接
+            av_dict_set(&playerState->formatOpts, OPT_HTTP_PERSISTENT, "0", 0);
+            httpPersistentSet = 1;
+        }
+    } else if (LocalFileIO::isSupported(playerState->url)) {
+        // 本地文件通过内存映射读取，失败时使用FFmpeg的file协议
+        localFileIO = new LocalFileIO();
+        if (localFileIO->openInput(*formatContext, playerState->url) < 0) {
+            ALOGE(TAG, "[%s] open local file io failure", __func__);
+            delete localFileIO;
+            localFileIO = nullptr;
+        }
+    }
+
+    // 打开文件
+    ret = avformat_open_input(formatContext, playerState->url, playerState->inputFormat,
+                              &playerState->formatOpts);
+    if (ret < 0) {
+        ALOGE(TAG, "[%s] avformat could not open input", __func__);
+        return ERROR_NOT_OPEN_INPUT;
+    }
+
+    // 还原MPEGTS的特殊处理标记
+    if (scanAllProgramMapTableSet) {
+        av_dict_set(&playerState->formatOpts, OPT_SCALL_ALL_PMTS, nullptr, AV_DICT_MATCH_CASE);
+    }
+
+    // 不是HLS时没有解复用器使用该选项
+    if (httpPersistentSet) {
+        av_dict_set(&playerState->formatOpts, OPT_HTTP_PERSISTENT, nullptr, AV_DICT_MATCH_CASE);
+    }
+
+    if ((t = av_dict_get(playerState->formatOpts, "", nullptr, AV_DICT_IGNORE_SUFFIX))) {
+        ALOGE(TAG, "[%s] Option %s not found", __func__, t->key);
+        return ERROR_CODEC_OPTIONS;
+    }
+
+    if (playerState->generateMissingPts) {
+        (*formatContext)->flags |= AVFMT_FLAG_GENPTS;
+    }
+    av_format_inject_global_side_data(*formatContext);
+
+    return SUCCESS;
+}
+
+/**
+ * 查找媒体流信息，快速起播时优先使用缓存的媒体流信息
+ * @param formatContext
+ * @param playerState
+ * @param hit 是否命中媒体流信息缓存
+ * @return
+ */
+int StreamOpener::findStreamInfo(AVFormatContext *formatContext, PlayerInfoStatus *playerState,
+                                 bool *hit) {
+    // 低延时模式不缓存探测时读到的数据包，只减小调用者没有设置过的探测参数
+    if (playerState->lowLatency) {
+        formatContext->flags |= AVFMT_FLAG_NOBUFFER;
+        if (isDefaultOption(formatContext, OPT_PROBE_SIZE)) {
+            formatContext->probesize = LOW_LATENCY_PROBE_SIZE;
+        }
+        if (isDefaultOption(formatContext, OPT_ANALYZE_DURATION)) {
+            formatContext->max_analyze_duration = LOW_LATENCY_ANALYZE_DURATION;
+        }
+        if (isDefaultOption(formatContext, OPT_FPS_PROBE_SIZE)) {
+            formatContext->fps_probe_size = LOW_LATENCY_FPS_PROBE_SIZE;
+        }
+    }
+
+    int ret = ProbeCache::getInstance()->findStreamInfo(formatContext, playerState->url,
+                                                        playerState->offset,
+                                                        playerState->codecOpts,
+                                                        playerState->fastStart != 0, hit);
+    if (ret < 0) {
+        ALOGE(TAG, "[%s] %s: could not find codec parameters", __func__, playerState->url);
+        return ERROR_NOT_FOUND_STREAM_INFO;
+    }
+    return SUCCESS;
+}
+
+/**
+ * 创建并打开解码器
+ * @param formatContext
+ * @param streamIndex
+ * @param playerState 播放器参数，使用指定的解码器、低分辨率、解码线程和解码参数
+ * @param codecContext 打开的解码上下文
+ * @param opts avcodec_open2没有使用的解码参数
+ * @return
+ */
+int StreamOpener::openCodec(AVFormatContext *formatContext, int streamIndex,
+                            PlayerInfoStatus *playerState, AVCodecContext **codecContext,
+                            AVDictionary **opts) {
+    AVCodec *codec = nullptr;
+    AVDictionaryEntry *t = nullptr;
+    char *forcedCodecName = nullptr;
+    int ret = 0;
+
+    // 判断流索引的合法性
+    if (!formatContext || streamIndex < 0 || streamIndex >= (int) formatContext->nb_streams) {
+        ALOGE(TAG, "[%s] illegal stream index", __func__);
+        return ERROR_STREAM_INDEX;
+    }
+
+    // 创建解码上下文
+    AVCodecContext *context = avcodec_alloc_context3(nullptr);
+    if (!context) {
+        ALOGE(TAG, "[%s] alloc codec context failure", __func__);
+        return ERROR_NOT_MEMORY;
+    }
+
+    // 复制解码上下文参数
+    ret = avcodec_parameters_to_context(context, formatContext->streams[streamIndex]->codecpar);
+    if (ret < 0) {
+        ALOGE(TAG, "[%s] copy codec params to context failure", __func__);
+        avcodec_free_context(&context);
+        return ERROR_COPY_CODEC_PARAM_TO_CONTEXT;
+    }
+
+    // 设置时钟基准
+    context->pkt_timebase = formatContext->streams[streamIndex]->time_base;
+
+    // 优先使用指定的解码器
+    if (context->codec_type == AVMEDIA_TYPE_AUDIO) {
+        forcedCodecName = playerState->audioCodecName;
+    } else if (context->codec_type == AVMEDIA_TYPE_VIDEO) {
+        forcedCodecName = playerState->videoCodecName;
+    }
+
+    // 如果指定了解码器，则查找指定解码器
+    if (forcedCodecName) {
+        codec = avcodec_find_decoder_by_name(forcedCodecName);
+    }
+
+    // 如果没有找到指定的解码器，则查找默认的解码器
+    if (!codec) {
+        if (forcedCodecName) {
+            if (ENGINE_DEBUG) {
+                ALOGD(TAG, "[%s] No codec could be found with name forcedCodecName=%s", __func__,
+                      forcedCodecName);
+            }
+        }
+        codec = avcodec_find_decoder(context->codec_id);
+    }
+
+    // 判断是否成功得到解码器
+    if (!codec) {
+        ALOGE(TAG, "[%s] No codec could be found with id index=%d codec_id=%d", __func__,
+              streamIndex, context->codec_id);
+        avcodec_free_context(&context);
+        return ERROR_NOT_FOUND_DCODE;
+    }
+
+    // 设置解码器的Id
+    context->codec_id = codec->id;
+
+    // 判断是否需要重新设置lowres的值
+    int streamLowResolution = playerState->lowResolution;
+    if (streamLowResolution > codec->max_lowres) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] The maximum value for low Resolution supported by the decoder is %d",
+                  __func__, codec->max_lowres);
+        }
+        streamLowResolution = codec->max_lowres;
+    }
+    context->lowres = streamLowResolution;
+
+#if FF_API_EMU_EDGE
+    if (stream_lowres) {
+      context->flags |= CODEC_FLAG_EMU_EDGE;
+    }
+#endif
+
+    if (playerState->fast) {
+        context->flags2 |= AV_CODEC_FLAG2_FAST;
+    }
+
+#if FF_API_EMU_EDGE
+    if (codec->capabilities & AV_CODEC_CAP_DR1) {
+      context->flags |= CODEC_FLAG_EMU_EDGE;
+    }
+#endif
+
+    *opts = filterCodecOptions(playerState->codecOpts, context->codec_id, formatContext,
+                               formatContext->streams[streamIndex], codec);
+    setupDecodeThreads(context, codec, playerState, opts);
+
+    // 视频帧缓冲从缓冲池中获取，帧释放后复用
+    FrameBufferPool::install(context, codec);
+
+    if (streamLowResolution) {
+        av_dict_set_int(opts, OPT_LOW_RESOLUTION, streamLowResolution, 0);
+    }
+
+    if (context->codec_type == AVMEDIA_TYPE_VIDEO ||
+        context->codec_type == AVMEDIA_TYPE_AUDIO) {
+        av_dict_set(opts, OPT_REF_COUNTED_FRAMES, "1", 0);
+    }
+
+    // 打开解码器
+    if (avcodec_open2(context, codec, opts) < 0) {
+        ALOGE(TAG, "[%s] open codec failure", __func__);
+        avcodec_free_context(&context);
+        av_dict_free(opts);
+        return ERROR_NOT_OPEN_DECODE;
+    }
+
+    if ((t = av_dict_get(*opts, "", nullptr, AV_DICT_IGNORE_SUFFIX))) {
+        ALOGE(TAG, "[%s] option %s not found", __func__, t->key);
+        avcodec_free_context(&context);
+        av_dict_free(opts);
+        return ERROR_CODEC_OPTIONS;
+    }
+
+    *codecContext = context;
+    return SUCCESS;
+}
+
+void StreamOpener::freePreparedCodecs(std::vector<PreparedCodec> *codecs) {
+    for (auto &codec : *codecs) {
+        avcodec_free_context(&codec.codecContext);
+        av_dict_free(&codec.opts);
+    }
+    codecs->clear();
+}
+
+/**
+ * 设置解码线程数量和线程模式
+ * 解码option中指定了threads/thread_type时以option为准，否则使用播放器参数，
+ * 播放器参数为自动时：
+ * 实时流使用片级多线程，避免帧级多线程带来的额外延迟；
+ * 点播使用帧级多线程，线程数量根据分辨率和CPU核数选择；音频使用单线程
+ */
+void StreamOpener::setupDecodeThreads(AVCodecContext *codecContext, AVCodec *codec,
+                                      PlayerInfoStatus *playerState, AVDictionary **opts) {
+    int threads = DECODE_THREADS_AUTO;
+    int threadType = DECODE_THREAD_TYPE_AUTO;
+    if (codecContext->codec_type == AVMEDIA_TYPE_VIDEO) {
+        threads = playerState->videoDecodeThreads;
+        threadType = playerState->videoThreadType;
+    } else if (codecContext->codec_type == AVMEDIA_TYPE_AUDIO) {
+        threads = playerState->audioDecodeThreads;
+        threadType = playerState->audioThreadType;
+    }
+
+    if (threadType == DECODE_THREAD_TYPE_AUTO) {
+        if (playerState->realTime || codecContext->codec_type != AVMEDIA_TYPE_VIDEO) {
+            threadType = FF_THREAD_SLICE;
+        } else {
+            threadType = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        }
+    }
+
+    if (threads == DECODE_THREADS_AUTO) {
+        int cpuCount = av_cpu_count();
+        if (codecContext->codec_type != AVMEDIA_TYPE_VIDEO) {
+            threads = 1;
+        } else {
+            int64_t pixels = (int64_t) codecContext->width * codecContext->height;
+            if (pixels <= 640 * 480) {
+                threads = 2;
+            } else if (pixels <= 1920 * 1080) {
+                threads = 4;
+            } else {
+                threads = 8;
+            }
+            threads = FFMAX(FFMIN(threads, cpuCount), 1);
+        }
+    }
+
+    // 解码器不支持多线程时只用单线程，只支持其中一种模式时由FFmpeg选择可用的模式
+    if (!(codec->capabilities & (AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_SLICE_THREADS))) {
+        threads = 1;
+    }
+
+    if (!av_dict_get(*opts, OPT_THREADS, nullptr, 0)) {
+        av_dict_set_int(opts, OPT_THREADS, threads, 0);
+    }
+    if (!av_dict_get(*opts, OPT_THREAD_TYPE, nullptr, 0)) {
+        av_dict_set_int(opts, OPT_THREAD_TYPE, threadType, 0);
+    }
+}
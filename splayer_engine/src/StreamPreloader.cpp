@@ -0,0 +1,209 @@
+#include "StreamPreloader.h"
+
+StreamPreloader::StreamPreloader() {
+    abortRequest = false;
+    stopRequest = false;
+}
+
+StreamPreloader::~StreamPreloader() {
+    cancel();
+}
+
+int StreamPreloader::prepare(const char *url, int64_t offset, const char *headers,
+                             PlayerInfoStatus *options, int64_t preloadDuration) {
+    cancel();
+    Mutex::Autolock lock(mutex);
+    playerState = options;
+    playerState->url = av_strdup(url);
+    playerState->offset = offset;
+    if (headers) {
+        av_dict_set(&playerState->formatOpts, OPT_HEADERS, headers, 0);
+    }
+    this->preloadDuration = preloadDuration;
+    result = ERROR;
+    abortRequest = false;
+    stopRequest = false;
+    preloadThread = new ThreadTask(this);
+    return preloadThread->start();
+}
+
+int StreamPreloader::take(const char *url, int64_t offset, AVFormatContext **formatContext,
+                          StreamOpener **streamOpener, std::deque<AVPacket> *packets,
+                          std::vector<PreparedCodec> *codecs) {
+    Mutex::Autolock lock(mutex);
+    if (!playerState || !url || strcmp(playerState->url, url) != 0 ||
+        playerState->offset != offset) {
+        return ERROR;
+    }
+    // 不等待预加载读满，正在进行的av_read_frame读完之后线程退出，中断读取会让解复用器停在数据包中间
+    stopRequest = true;
+    joinThread();
+    if (!playerState || result < 0) {
+        release();
+        return ERROR;
+    }
+    *formatContext = this->formatContext;
+    this->formatContext = nullptr;
+    *streamOpener = this->streamOpener;
+    this->streamOpener = nullptr;
+    packets->swap(this->packets);
+    codecs->swap(this->codecs);
+    release();
+    return SUCCESS;
+}
+
+void StreamPreloader::cancel() {
+    Mutex::Autolock lock(mutex);
+    abortRequest = true;
+    joinThread();
+    release();
+}
+
+void StreamPreloader::run() {
+    int64_t startTime = av_gettime_relative();
+    if ((result = openInput()) >= 0) {
+        openCodecs();
+        result = readPackets();
+    }
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] %s result = %d codecs = %d packets = %d cost = %lld ms", __func__,
+              playerState->url, result, (int) codecs.size(), (int) packets.size(),
+              (long long) (av_gettime_relative() - startTime) / 1000);
+    }
+}
+
+/**
+ * 打开媒体并查找媒体流信息，和Stream::openInput使用同样的StreamOpener
+ */
+int StreamPreloader::openInput() {
+    formatContext = avformat_alloc_context();
+    if (!formatContext) {
+        return ERROR_NOT_MEMORY;
+    }
+    formatContext->interrupt_callback.callback = interruptCb;
+    formatContext->interrupt_callback.opaque = this;
+
+    streamOpener = new StreamOpener();
+    int ret = streamOpener->openInput(&formatContext, playerState);
+    if (ret < 0) {
+        return ret;
+    }
+    bool hit = false;
+    return streamOpener->findStreamInfo(formatContext, playerState, &hit);
+}
+
+/**
+ * 按Stream::openStream的选择打开视频和音频解码器，打开失败时交给Stream重新打开并报告错误
+ */
+void StreamPreloader::openCodecs() {
+    playerState->realTime = isRealTime(formatContext);
+    int videoIndex = -1;
+    int audioIndex = -1;
+    if (!playerState->videoDisable) {
+        videoIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    }
+    if (!playerState->audioDisable) {
+        audioIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_AUDIO, -1, videoIndex,
+                                         nullptr, 0);
+    }
+    const int indexes[] = {videoIndex, audioIndex};
+    for (int streamIndex : indexes) {
+        if (streamIndex < 0 || abortRequest) {
+            continue;
+        }
+        PreparedCodec codec = {streamIndex, nullptr, nullptr};
+        if (streamOpener->openCodec(formatContext, streamIndex, playerState, &codec.codecContext,
+                                    &codec.opts) >= 0) {
+            codecs.push_back(codec);
+        }
+    }
+}
+
+/**
+ * 读取数据包，任意一个流的时长达到预加载时长或者内存达到上限时结束
+ * 时长按每个流的第一个时间戳到当前时间戳计算，很多封装格式的数据包没有duration
+ */
+int StreamPreloader::readPackets() {
+    AVPacket pkt;
+    int64_t memorySize = 0;
+    auto *startTimes = (int64_t *) av_malloc_array(formatContext->nb_streams, sizeof(int64_t));
+    if (!startTimes) {
+        return ERROR_NOT_MEMORY;
+    }
+    for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+        startTimes[i] = AV_NOPTS_VALUE;
+    }
+    while (!abortRequest && !stopRequest && memorySize < PRELOAD_MAX_SIZE) {
+        if (av_read_frame(formatContext, &pkt) < 0) {
+            break;
+        }
+        memorySize += pkt.size;
+        packets.push_back(pkt);
+
+        // 解码顺序的时间戳单调递增，优先使用dts
+        int64_t timestamp = pkt.dts != AV_NOPTS_VALUE ? pkt.dts : pkt.pts;
+        if (timestamp == AV_NOPTS_VALUE) {
+            continue;
+        }
+        if (startTimes[pkt.stream_index] == AV_NOPTS_VALUE) {
+            startTimes[pkt.stream_index] = timestamp;
+        }
+        AVStream *stream = formatContext->streams[pkt.stream_index];
+        int64_t duration = av_rescale_q(timestamp - startTimes[pkt.stream_index] + pkt.duration,
+                                        stream->time_base, AV_TIME_BASE_Q);
+        if (duration >= preloadDuration) {
+            break;
+        }
+    }
+    av_free(startTimes);
+    return abortRequest ? EXIT : SUCCESS;
+}
+
+/**
+ * 在锁外等待预加载线程结束，需要持有mutex，返回时仍然持有mutex
+ * 其他调用者在线程结束之前等待，不会释放线程正在使用的结果
+ */
+void StreamPreloader::joinThread() {
+    while (joining) {
+        condition.wait(mutex);
+    }
+    if (!preloadThread) {
+        return;
+    }
+    ThreadTask *thread = preloadThread;
+    preloadThread = nullptr;
+    joining = true;
+    mutex.unlock();
+    thread->join();
+    delete thread;
+    mutex.lock();
+    joining = false;
+    condition.broadcast();
+}
+
+/// 释放预加载结果，需要持有mutex并且预加载线程已结束
+void StreamPreloader::release() {
+    for (auto &pkt : packets) {
+        av_packet_unref(&pkt);
+    }
+    packets.clear();
+    StreamOpener::freePreparedCodecs(&codecs);
+    if (formatContext) {
+        avformat_close_input(&formatContext);
+    }
+    // 自定义IO需要在解复用上下文关闭之后释放
+    if (streamOpener) {
+        delete streamOpener;
+        streamOpener = nullptr;
+    }
+    if (playerState) {
+        delete playerState;
+        playerState = nullptr;
+    }
+    result = ERROR;
+}
+
+int StreamPreloader::interruptCb(void *ctx) {
+    auto *preloader = (StreamPreloader *) ctx;
+    return preloader->abortRequest ? AVERROR_EXIT : 0;
+}
@@ -0,0 +1,234 @@
+#include "ThreadPool.h"
+
+ThreadTask::ThreadTask(Runnable *runnable) {
+    this->runnable = runnable;
+    this->priority = Priority_Default;
+    this->running = false;
+}
+
+ThreadTask::ThreadTask(Runnable *runnable, ThreadPriority priority) {
+    this->runnable = runnable;
+    this->priority = priority;
+    this->running = false;
+}
+
+ThreadTask::~ThreadTask() {
+    join();
+    runnable = nullptr;
+}
+
+int ThreadTask::start() {
+    mutex.lock();
+    if (running) {
+        mutex.unlock();
+        return SUCCESS;
+    }
+    running = true;
+    mutex.unlock();
+    int ret = ThreadPool::getInstance()->execute(this);
+    if (ret < 0) {
+        mutex.lock();
+        running = false;
+        condition.broadcast();
+        mutex.unlock();
+    }
+    return ret;
+}
+
+void ThreadTask::join() {
+    mutex.lock();
+    while (running) {
+        condition.wait(mutex);
+    }
+    mutex.unlock();
+}
+
+bool ThreadTask::isActive() {
+    Mutex::Autolock lock(mutex);
+    return running;
+}
+
+/// 在工作线程中执行，结束之后不能再访问任务对象，join返回后任务可能已经被释放
+void ThreadTask::run() {
+    if (runnable) {
+        runnable->run();
+    }
+    mutex.lock();
+    running = false;
+    condition.broadcast();
+    mutex.unlock();
+}
+
+ThreadPool *ThreadPool::getInstance() {
+    // 线程池在进程退出前一直存在，shutdown回收工作线程之后仍然可以使用
+    static ThreadPool *instance = new ThreadPool();
+    return instance;
+}
+
+ThreadPool::ThreadPool() = default;
+
+ThreadPool::~ThreadPool() = default;
+
+int ThreadPool::execute(ThreadTask *task) {
+    Mutex::Autolock lock(mutex);
+    if (quit) {
+        return ERROR;
+    }
+    if (!idleWorkers.empty()) {
+        Worker *worker = idleWorkers.back();
+        idleWorkers.pop_back();
+        worker->task = task;
+        worker->condition.signal();
+        return SUCCESS;
+    }
+    return createWorker(task);
+}
+
+int ThreadPool::prestartCoreThreads() {
+    Mutex::Autolock lock(mutex);
+    if (quit) {
+        return ERROR;
+    }
+    while (poolSize < THREAD_POOL_CORE_SIZE) {
+        int ret = createWorker(nullptr);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return SUCCESS;
+}
+
+int ThreadPool::getPoolSize() {
+    Mutex::Autolock lock(mutex);
+    return poolSize;
+}
+
+int ThreadPool::getActiveCount() {
+    Mutex::Autolock lock(mutex);
+    return poolSize - (int) idleWorkers.size();
+}
+
+int ThreadPool::shutdown() {
+    mutex.lock();
+    for (Worker *worker : workers) {
+        if (pthread_equal(worker->id, pthread_self())) {
+            mutex.unlock();
+            ALOGE(TAG, "[%s] can not shutdown in worker thread", __func__);
+            return ERROR;
+        }
+    }
+    if (quit) {
+        mutex.unlock();
+        return ERROR;
+    }
+    quit = true;
+    for (Worker *worker : idleWorkers) {
+        worker->condition.signal();
+    }
+    std::vector<Worker *> joining = workers;
+    mutex.unlock();
+
+    // 空闲线程立即退出，正在执行任务的线程在任务结束之后退出
+    for (Worker *worker : joining) {
+        pthread_join(worker->id, nullptr);
+        delete worker;
+    }
+
+    mutex.lock();
+    workers.clear();
+    idleWorkers.clear();
+    exitedWorkers.clear();
+    poolSize = 0;
+    quit = false;
+    mutex.unlock();
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] joined %d workers", __func__, (int) joining.size());
+    }
+    return SUCCESS;
+}
+
+/// 创建工作线程，需要持有mutex
+int ThreadPool::createWorker(ThreadTask *task) {
+    reapExitedWorkers();
+    Worker *worker = new Worker();
+    worker->pool = this;
+    worker->task = task;
+    int ret = pthread_create(&worker->id, nullptr, workerEntry, worker);
+    if (ret != 0) {
+        ALOGE(TAG, "[%s] create worker failure, ret = %d", __func__, ret);
+        delete worker;
+        return ERROR;
+    }
+    workers.push_back(worker);
+    if (!task) {
+        idleWorkers.push_back(worker);
+    }
+    poolSize++;
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] pool size = %d", __func__, poolSize);
+    }
+    return SUCCESS;
+}
+
+/// 回收超时退出的工作线程，需要持有mutex，线程加入exitedWorkers之后不再获取mutex
+void ThreadPool::reapExitedWorkers() {
+    for (Worker *worker : exitedWorkers) {
+        pthread_join(worker->id, nullptr);
+        for (auto it = workers.begin(); it != workers.end(); ++it) {
+            if (*it == worker) {
+                workers.erase(it);
+                break;
+            }
+        }
+        delete worker;
+    }
+    exitedWorkers.clear();
+}
+
+void *ThreadPool::workerEntry(void *arg) {
+    auto *worker = (Worker *) arg;
+    worker->pool->runWorker(worker);
+    return nullptr;
+}
+
+void ThreadPool::runWorker(Worker *worker) {
+    // 记录线程原始的调度参数，每个任务执行完之后恢复
+    struct sched_param sched;
+    int policy;
+    pthread_getschedparam(pthread_self(), &policy, &sched);
+
+    mutex.lock();
+    for (;;) {
+        while (!worker->task && !quit) {
+            int ret = worker->condition.waitRelative(mutex, THREAD_POOL_KEEP_ALIVE_TIME);
+            if (ret == -ETIMEDOUT && !worker->task && poolSize > THREAD_POOL_CORE_SIZE) {
+                break;
+            }
+        }
+        if (!worker->task) {
+            // 关闭或者非核心线程超时，关闭时由shutdown回收，否则在下一次创建线程时回收
+            for (auto it = idleWorkers.begin(); it != idleWorkers.end(); ++it) {
+                if (*it == worker) {
+                    idleWorkers.erase(it);
+                    break;
+                }
+            }
+            poolSize--;
+            if (!quit) {
+                exitedWorkers.push_back(worker);
+            }
+            mutex.unlock();
+            return;
+        }
+        ThreadTask *task = worker->task;
+        mutex.unlock();
+
+        Thread::schedPriority(task->priority);
+        task->run();
+        pthread_setschedparam(pthread_self(), policy, &sched);
+
+        mutex.lock();
+        worker->task = nullptr;
+        idleWorkers.push_back(worker);
+    }
+}
@@ -0,0 +1,371 @@
+#include "ThumbnailExtractor.h"
+#include "MediaEngine.h"
+#include "ProbeCache.h"
+#include <algorithm>
+
+ThumbnailWorker::ThumbnailWorker(ThumbnailExtractor *extractor, const char *url, int width,
+                                 int height) {
+    this->extractor = extractor;
+    this->url = av_strdup(url);
+    this->width = width;
+    this->height = height;
+}
+
+ThumbnailWorker::~ThumbnailWorker() {
+    join();
+    release();
+    av_freep(&url);
+}
+
+void ThumbnailWorker::addRequest(int index, int64_t timestamp) {
+    Request request;
+    request.index = index;
+    request.timestamp = timestamp;
+    requests.push_back(request);
+}
+
+int ThumbnailWorker::start() {
+    if (!workerThread) {
+        workerThread = new ThreadTask(this);
+    }
+    return workerThread->start();
+}
+
+void ThumbnailWorker::join() {
+    if (workerThread) {
+        workerThread->join();
+        delete workerThread;
+        workerThread = nullptr;
+    }
+}
+
+void ThumbnailWorker::run() {
+    int ret = openInput();
+    if (ret >= 0) {
+        ret = openDecoder();
+    }
+    if (ret < 0) {
+        ALOGE(TAG, "[%s] %s could not open, ret = %d", __func__, url, ret);
+    }
+
+    int64_t startTime = formatContext && formatContext->start_time != AV_NOPTS_VALUE ?
+                        formatContext->start_time : 0;
+    for (int i = 0; ret >= 0 && i < (int) requests.size() && !extractor->abortRequest; i++) {
+        Request &request = requests[i];
+        if (decodeKeyframe(request.timestamp + startTime) < 0 || !data[0]) {
+            if (ENGINE_DEBUG) {
+                ALOGD(TAG, "[%s] no keyframe for index = %d timestamp = %lld", __func__,
+                      request.index, (long long) request.timestamp);
+            }
+            continue;
+        }
+        extractor->onThumbnail(request.index, request.timestamp, lastKeyframePts - startTime,
+                               data[0], dstWidth, dstHeight, linesize[0]);
+    }
+
+    release();
+    extractor->onWorkerFinish();
+}
+
+int ThumbnailWorker::openInput() {
+    formatContext = avformat_alloc_context();
+    if (!formatContext) {
+        return ERROR_NOT_MEMORY;
+    }
+    formatContext->interrupt_callback.callback = interruptCb;
+    formatContext->interrupt_callback.opaque = this;
+
+    if (avformat_open_input(&formatContext, url, nullptr, nullptr) < 0) {
+        return ERROR_NOT_OPEN_INPUT;
+    }
+
+    // 和快速起播共用流信息缓存，播放过的媒体不需要再探测
+    bool hit = false;
+    if (ProbeCache::getInstance()->findStreamInfo(formatContext, url, 0, nullptr, true,
+                                                  &hit) < 0) {
+        return ERROR_NOT_FOUND_STREAM_INFO;
+    }
+
+    streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (streamIndex < 0) {
+        return ERROR_STREAM_INDEX;
+    }
+    for (int i = 0; i < (int) formatContext->nb_streams; i++) {
+        formatContext->streams[i]->discard = i == streamIndex ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+
+    // 只读取播放时建立的关键帧索引，不写回索引文件
+    if (KeyframeIndex::isSupported(formatContext)) {
+        keyframeIndex = new KeyframeIndex();
+        if (keyframeIndex->open(formatContext, streamIndex, url, nullptr) < 0) {
+            delete keyframeIndex;
+            keyframeIndex = nullptr;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * 和MediaPlayer::openDecoder一致，另外只解码关键帧，并选择不小于目标尺寸的最低解码分辨率
+ */
+int ThumbnailWorker::openDecoder() {
+    AVStream *stream = formatContext->streams[streamIndex];
+    AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!codec) {
+        return ERROR_NOT_FOUND_DCODE;
+    }
+    codecContext = avcodec_alloc_context3(codec);
+    if (!codecContext) {
+        return ERROR_NOT_MEMORY;
+    }
+    if (avcodec_parameters_to_context(codecContext, stream->codecpar) < 0) {
+        return ERROR_COPY_CODEC_PARAM_TO_CONTEXT;
+    }
+    codecContext->pkt_timebase = stream->time_base;
+    codecContext->skip_frame = AVDISCARD_NONKEY;
+    codecContext->skip_loop_filter = AVDISCARD_ALL;
+    codecContext->flags2 |= AV_CODEC_FLAG2_FAST;
+    // 并行在工作线程之间，单个解码器不再开线程
+    codecContext->thread_count = 1;
+
+    int lowres = 0;
+    while (lowres < codec->max_lowres && width > 0 &&
+           (codecContext->width >> (lowres + 1)) >= width &&
+           (height <= 0 || (codecContext->height >> (lowres + 1)) >= height)) {
+        lowres++;
+    }
+    codecContext->lowres = lowres;
+
+    AVDictionary *opts = filterCodecOptions(nullptr, codecContext->codec_id, formatContext,
+                                            stream, codec);
+    int ret = avcodec_open2(codecContext, codec, &opts);
+    av_dict_free(&opts);
+    if (ret < 0) {
+        return ERROR_NOT_OPEN_DECODE;
+    }
+
+    frame = av_frame_alloc();
+    if (!frame) {
+        return ERROR_NOT_MEMORY;
+    }
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] codec = %s size = %dx%d lowres = %d", __func__, codec->name,
+              codecContext->width, codecContext->height, lowres);
+    }
+    return SUCCESS;
+}
+
+int ThumbnailWorker::decodeKeyframe(int64_t timestamp) {
+    int64_t pts = 0;
+    int64_t pos = 0;
+    int ret = -1;
+    if (keyframeIndex && keyframeIndex->find(timestamp, &pts, &pos)) {
+        if (pts == lastKeyframePts) {
+            return SUCCESS;
+        }
+        ret = avformat_seek_file(formatContext, -1, pos, pos, pos, AVSEEK_FLAG_BYTE);
+    }
+    if (ret < 0) {
+        // 定位到目标之前的关键帧，不能向后定位
+        ret = avformat_seek_file(formatContext, -1, INT64_MIN, timestamp, timestamp, 0);
+    }
+    if (ret < 0) {
+        ret = avformat_seek_file(formatContext, -1, INT64_MIN, timestamp, INT64_MAX, 0);
+    }
+    if (ret < 0) {
+        return ERROR;
+    }
+    avcodec_flush_buffers(codecContext);
+
+    AVPacket pkt;
+    AVStream *stream = formatContext->streams[streamIndex];
+    for (int packets = 0; packets < THUMBNAIL_MAX_PACKETS && !extractor->abortRequest;) {
+        if (av_read_frame(formatContext, &pkt) < 0) {
+            return ERROR_EOF;
+        }
+        if (pkt.stream_index != streamIndex || !(pkt.flags & AV_PKT_FLAG_KEY)) {
+            packets += pkt.stream_index == streamIndex;
+            av_packet_unref(&pkt);
+            continue;
+        }
+
+        int64_t keyframePts = pkt.pts != AV_NOPTS_VALUE ? pkt.pts : pkt.dts;
+        if (keyframePts != AV_NOPTS_VALUE) {
+            keyframePts = av_rescale_q(keyframePts, stream->time_base, AV_TIME_BASE_Q);
+        }
+        // 和上一个时间戳落在同一个关键帧
+        if (keyframePts != AV_NOPTS_VALUE && keyframePts == lastKeyframePts) {
+            av_packet_unref(&pkt);
+            return SUCCESS;
+        }
+
+        // 送入关键帧之后立即排空，有帧重排的解码器也能马上输出
+        ret = avcodec_send_packet(codecContext, &pkt);
+        av_packet_unref(&pkt);
+        if (ret >= 0) {
+            avcodec_send_packet(codecContext, nullptr);
+            ret = avcodec_receive_frame(codecContext, frame);
+        }
+        avcodec_flush_buffers(codecContext);
+        if (ret < 0) {
+            packets++;
+            continue;
+        }
+
+        lastKeyframePts = keyframePts;
+        if (lastKeyframePts == AV_NOPTS_VALUE && frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+            lastKeyframePts = av_rescale_q(frame->best_effort_timestamp, stream->time_base,
+                                           AV_TIME_BASE_Q);
+        }
+        ret = scale();
+        av_frame_unref(frame);
+        return ret;
+    }
+    return ERROR;
+}
+
+int ThumbnailWorker::scale() {
+    int targetWidth = width > 0 ? width : frame->width;
+    int targetHeight = height;
+    if (targetHeight <= 0) {
+        AVRational sar = frame->sample_aspect_ratio.num ? frame->sample_aspect_ratio :
+                         (AVRational) {1, 1};
+        targetHeight = (int) av_rescale(targetWidth, (int64_t) frame->height * sar.den,
+                                        (int64_t) frame->width * sar.num);
+        targetHeight = FFMAX(targetHeight & ~1, 2);
+    }
+
+    if (!data[0] || targetWidth != dstWidth || targetHeight != dstHeight) {
+        av_freep(&data[0]);
+        if (av_image_alloc(data, linesize, targetWidth, targetHeight, AV_PIX_FMT_RGBA, 16) < 0) {
+            return ERROR_NOT_MEMORY;
+        }
+        dstWidth = targetWidth;
+        dstHeight = targetHeight;
+    }
+
+    swsContext = sws_getCachedContext(swsContext, frame->width, frame->height,
+                                      (AVPixelFormat) frame->format, dstWidth, dstHeight,
+                                      AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!swsContext) {
+        return ERROR;
+    }
+    sws_scale(swsContext, (uint8_t const *const *) frame->data, frame->linesize, 0,
+              frame->height, data, linesize);
+    return SUCCESS;
+}
+
+void ThumbnailWorker::release() {
+    if (keyframeIndex) {
+        delete keyframeIndex;
+        keyframeIndex = nullptr;
+    }
+    if (swsContext) {
+        sws_freeContext(swsContext);
+        swsContext = nullptr;
+    }
+    av_freep(&data[0]);
+    av_frame_free(&frame);
+    avcodec_free_context(&codecContext);
+    if (formatContext) {
+        avformat_close_input(&formatContext);
+    }
+}
+
+int ThumbnailWorker::interruptCb(void *ctx) {
+    auto *worker = (ThumbnailWorker *) ctx;
+    return worker->extractor->abortRequest ? AVERROR_EXIT : 0;
+}
+
+ThumbnailExtractor::ThumbnailExtractor() {
+    abortRequest = false;
+    activeWorkers = 0;
+    thumbnailCount = 0;
+    MediaEngine::acquire();
+}
+
+ThumbnailExtractor::~ThumbnailExtractor() {
+    cancel();
+    MediaEngine::release();
+}
+
+void ThumbnailExtractor::setListener(IThumbnailListener *listener) {
+    Mutex::Autolock lock(listenerMutex);
+    this->listener = listener;
+}
+
+/**
+ * 时间戳排序后按连续的区间分给工作线程，每个工作线程只向后定位，相邻时间戳可以复用关键帧
+ */
+int ThumbnailExtractor::start(const char *url, const std::vector<int64_t> &timestamps,
+                              int width, int height, int workers) {
+    cancel();
+    if (!url || timestamps.empty() || width <= 0) {
+        return ERROR_PARAMS;
+    }
+    Mutex::Autolock lock(mutex);
+
+    std::vector<std::pair<int64_t, int>> requests;
+    for (int i = 0; i < (int) timestamps.size(); i++) {
+        requests.emplace_back(timestamps[i], i);
+    }
+    std::sort(requests.begin(), requests.end());
+
+    int count = FFMIN(FFMAX(workers, 1), THUMBNAIL_MAX_WORKERS);
+    count = FFMIN(count, (int) requests.size());
+    for (int i = 0; i < count; i++) {
+        auto *worker = new ThumbnailWorker(this, url, width, height);
+        int begin = (int) (requests.size() * i / count);
+        int end = (int) (requests.size() * (i + 1) / count);
+        for (int j = begin; j < end; j++) {
+            worker->addRequest(requests[j].second, requests[j].first);
+        }
+        this->workers.push_back(worker);
+    }
+
+    abortRequest = false;
+    thumbnailCount = 0;
+    activeWorkers = count;
+    startTime = av_gettime_relative();
+    for (auto worker : this->workers) {
+        if (worker->start() < 0) {
+            ALOGE(TAG, "[%s] could not start worker", __func__);
+            onWorkerFinish();
+        }
+    }
+    return SUCCESS;
+}
+
+void ThumbnailExtractor::cancel() {
+    Mutex::Autolock lock(mutex);
+    abortRequest = true;
+    for (auto worker : workers) {
+        delete worker;
+    }
+    workers.clear();
+}
+
+void ThumbnailExtractor::onThumbnail(int index, int64_t timestamp, int64_t pts,
+                                     const uint8_t *data, int width, int height, int linesize) {
+    thumbnailCount++;
+    Mutex::Autolock lock(listenerMutex);
+    if (listener && !abortRequest) {
+        listener->onThumbnail(index, timestamp, pts, data, width, height, linesize);
+    }
+}
+
+void ThumbnailExtractor::onWorkerFinish() {
+    if (--activeWorkers > 0 || abortRequest) {
+        return;
+    }
+    int64_t cost = av_gettime_relative() - startTime;
+    float thumbnailsPerSecond = cost > 0 ? thumbnailCount * 1000000.0f / cost : 0;
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] thumbnails = %d cost = %lld ms throughput = %.1f/s", __func__,
+              (int) thumbnailCount, (long long) cost / 1000, thumbnailsPerSecond);
+    }
+    Mutex::Autolock lock(listenerMutex);
+    if (listener) {
+        listener->onThumbnailComplete(thumbnailCount, thumbnailsPerSecond);
+    }
+}
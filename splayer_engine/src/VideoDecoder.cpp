@@ -6,12 +6,12 @@ VideoDecoder::VideoDecoder(AVFormatContext *formatCtx,
                            int streamIndex,
                            PlayerInfoStatus *playerState,
                            AVPacket *flushPacket,
-                           Condition *readWaitCond, AVDictionary *opts,
+                           Event *readEvent, AVDictionary *opts,
                            MessageCenter *messageCenter)
-        : MediaDecoder(avctx, stream, streamIndex, playerState, flushPacket, readWaitCond, opts,
+        : MediaDecoder(avctx, stream, streamIndex, playerState, flushPacket, readEvent, opts,
                        messageCenter) {
     formatContext = formatCtx;
-    frameQueue = new FrameQueue(VIDEO_QUEUE_SIZE, 1, packetQueue);
+    frameQueue = new FrameQueue(playerState->videoQueueSize, 1, packetQueue, readEvent);
     decodeThread = nullptr;
     masterClock = nullptr;
     // 旋转角度
@@ -28,6 +28,11 @@ VideoDecoder::VideoDecoder(AVFormatContext *formatCtx,
 
 VideoDecoder::~VideoDecoder() {
     formatContext = nullptr;
+    videoDevice = nullptr;
+    if (frameConverter) {
+        delete frameConverter;
+        frameConverter = nullptr;
+    }
     frameQueue->flush();
     delete frameQueue;
     frameQueue = nullptr;
@@ -38,11 +43,15 @@ void VideoDecoder::setMasterClock(MediaClock *masterClock) {
     this->masterClock = masterClock;
 }
 
+void VideoDecoder::setVideoDevice(VideoDevice *videoDevice) {
+    this->videoDevice = videoDevice;
+}
+
 void VideoDecoder::start() {
     MediaDecoder::start();
     frameQueue->start();
     if (!decodeThread) {
-        decodeThread = new Thread(this);
+        decodeThread = new ThreadTask(this);
         decodeThread->start();
     }
 }
@@ -60,11 +69,14 @@ void VideoDecoder::stop() {
         delete decodeThread;
         decodeThread = nullptr;
     }
+    if (frameConverter) {
+        frameConverter->stop();
+    }
 }
 
 void VideoDecoder::flush() {
+    // 帧队列由消费者线程根据seekSerial丢弃seek之前的帧，这里只刷新数据包队列
     MediaDecoder::flush();
-    frameQueue->flush();
 }
 
 int VideoDecoder::getFrameSize() {
@@ -103,7 +115,11 @@ int VideoDecoder::decodeVideo() {
     AVRational timeBase = stream->time_base;
     AVRational frameRate = av_guess_frame_rate(formatContext, stream, nullptr);
 
-    if (!frame) {
+    convertedFrame = av_frame_alloc();
+
+    if (!frame || !convertedFrame) {
+        av_frame_free(&frame);
+        av_frame_free(&convertedFrame);
         ALOGE(TAG, "[%s] not memory", __func__);
         return ERROR_NOT_MEMORY;
     }
@@ -118,6 +134,9 @@ int VideoDecoder::decodeVideo() {
         }
 
         if (ret == 0) {
+            if (packetQueue->isAbort()) {
+                break;
+            }
             if (ENGINE_DEBUG) {
                 ALOGD(TAG, "[%s] drop frame", __func__);
             }
@@ -130,11 +149,22 @@ int VideoDecoder::decodeVideo() {
                                                : 0;
         pts = (frame->pts == AV_NOPTS_VALUE) ? NAN : frame->pts * av_q2d(timeBase);
 
-        // 放入到已解码队列
-        ret = pushFrame(frame, pts, duration, frame->pkt_pos, packetQueue->getFirstSeekSerial());
+        // 精确定位时丢弃目标之前的帧
+        if (isBeforeSeekTarget(frame->pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE :
+                               av_rescale_q(frame->pts, timeBase, AV_TIME_BASE_Q),
+                               (int64_t) (duration * AV_TIME_BASE))) {
+            av_frame_unref(frame);
+            continue;
+        }
+
+        // 放入到已解码队列，需要转换时放入转换后的帧
+        AVFrame *outFrame = convertFrame(frame);
+        ret = pushFrame(outFrame, pts, duration, frame->pkt_pos,
+                        packetQueue->getFirstSeekSerial());
 
         // 重置帧
         av_frame_unref(frame);
+        av_frame_unref(convertedFrame);
 
         if (ret < 0) {
             if (ENGINE_DEBUG) {
@@ -147,10 +177,32 @@ int VideoDecoder::decodeVideo() {
     av_frame_free(&frame);
     av_free(frame);
     frame = nullptr;
+    av_frame_free(&convertedFrame);
 
     return ret;
 }
 
+/**
+ * 视频设备不能直接渲染的格式转换成BGRA，同步线程只需要上传，不会因为转换耽误显示时间
+ * 转换失败时放入原始帧，由同步器丢弃
+ */
+AVFrame *VideoDecoder::convertFrame(AVFrame *frame) {
+    if (!videoDevice || videoDevice->getTextureFormat(frame->format) != FMT_NONE) {
+        return frame;
+    }
+    if (!frameConverter) {
+        frameConverter = new FrameConverter();
+    }
+    frameConverter->start();
+    if (frameConverter->convert(frame, convertedFrame) < 0) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] convert format = %d failure", __func__, frame->format);
+        }
+        return frame;
+    }
+    return convertedFrame;
+}
+
 bool VideoDecoder::isFinished() {
     return MediaDecoder::isFinished() && getFrameSize() == 0;
 }
@@ -228,10 +280,12 @@ int VideoDecoder::decodeFrame(AVFrame *frame) {
                     }
                 }
 
+                // 解码器已经输出全部帧(结尾或者拖动时送入的空包)，没有新的帧
                 if (ret == AVERROR_EOF) {
                     finished = packetQueue->getFirstSeekSerial();
                     avcodec_flush_buffers(codecContext);
-                    return SUCCESS;
+                    readEvent->signal();
+                    return 0;
                 }
 
                 if (ret >= 0) {
@@ -242,11 +296,6 @@ int VideoDecoder::decodeFrame(AVFrame *frame) {
         }
 
         do {
-            // 同步读取序列
-            if (getPacketQueueSize() == 0) {
-                readWaitCond->signal();
-            }
-
             if (isPendingPacket) {
                 av_packet_move_ref(&packet, &pendingPacket);
                 isPendingPacket = false;
@@ -255,6 +304,8 @@ int VideoDecoder::decodeFrame(AVFrame *frame) {
                     ALOGE(TAG, "[%s] video get packet", __func__);
                     return EXIT;
                 }
+                // 数据包队列有了空间，通知读包线程
+                readEvent->signal();
             }
         } while (!isSamePacketSerial());
 
@@ -263,7 +314,25 @@ int VideoDecoder::decodeFrame(AVFrame *frame) {
             finished = 0;
             nextPts = startPts;
             nextPtsTb = startPtsTb;
+            startAccurateSeek();
+            if (playerState->scrubbing) {
+                // 拖动时只解码关键帧
+                skipFrames(AVDISCARD_NONKEY);
+            } else if (accurateSeekPts != AV_NOPTS_VALUE) {
+                skipFrames(AVDISCARD_NONREF);
+            } else {
+                restoreSkipFrame();
+            }
         } else {
+            // 到达定位目标附近之后恢复完整解码，目标帧本身可能是非参考帧
+            if (skipping && !playerState->scrubbing) {
+                int64_t pts = packet.pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE :
+                              av_rescale_q(packet.pts, stream->time_base, AV_TIME_BASE_Q);
+                if (accurateSeekPts == AV_NOPTS_VALUE || pts == AV_NOPTS_VALUE ||
+                    pts >= accurateSeekPts) {
+                    restoreSkipFrame();
+                }
+            }
             if (codecContext->codec_type == AVMEDIA_TYPE_VIDEO) {
                 if (avcodec_send_packet(codecContext, &packet) == AVERROR(EAGAIN)) {
                     ALOGE(TAG,
@@ -288,6 +357,7 @@ VideoDecoder::pushFrame(AVFrame *srcFrame, double pts, double duration, int64_t
 
     frame->sampleAspectRatio = srcFrame->sample_aspect_ratio;
     frame->uploaded = 0;
+    frame->converted = srcFrame == convertedFrame;
 
     frame->width = srcFrame->width;
     frame->height = srcFrame->height;
@@ -311,7 +381,30 @@ VideoDecoder::pushFrame(AVFrame *srcFrame, double pts, double duration, int64_t
     return SUCCESS;
 }
 
+/**
+ * 精确定位期间跳过非参考帧，拖动期间跳过非关键帧，不会降低原来设置的skip_frame
+ * @param discard
+ */
+void VideoDecoder::skipFrames(AVDiscard discard) {
+    if (!skipping) {
+        skipFrame = codecContext->skip_frame;
+        skipping = true;
+    }
+    codecContext->skip_frame = FFMAX(skipFrame, discard);
+}
+
+void VideoDecoder::restoreSkipFrame() {
+    if (skipping) {
+        codecContext->skip_frame = skipFrame;
+        skipping = false;
+    }
+}
+
 int64_t VideoDecoder::getFrameQueueLastPos() {
     return frameQueue->currentPos();
 }
 
+int64_t VideoDecoder::getFrameQueueMemorySize() {
+    return frameQueue->getMemorySize();
+}
+
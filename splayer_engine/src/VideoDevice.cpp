@@ -18,6 +18,10 @@ int VideoDevice::onUpdateYUV(
     return 0;
 }
 
+int VideoDevice::onUpdateNV(uint8_t *yData, int yPitch, uint8_t *uvData, int uvPitch) {
+    return 0;
+}
+
 int VideoDevice::onUpdateARGB(uint8_t *rgba, int pitch) { return 0; }
 
 int VideoDevice::onRequestRenderEnd(Frame *frame, bool flip) { return 0; }
@@ -58,6 +62,19 @@ TextureFormat VideoDevice::getTextureFormat(int format) {
             return FMT_BGR32_1;
         case AV_PIX_FMT_YUV420P:
             return FMT_YUV420P;
+        case AV_PIX_FMT_NV12:
+            return FMT_NV12;
+        case AV_PIX_FMT_NV21:
+            return FMT_NV21;
+        case AV_PIX_FMT_YUV422P:
+            return FMT_YUV422P;
+        case AV_PIX_FMT_YUV444P:
+            return FMT_YUV444P;
+        // 着色器按小端读取16位的分量
+        case AV_PIX_FMT_P010LE:
+            return FMT_P010;
+        case AV_PIX_FMT_YUV420P10LE:
+            return FMT_YUV420P10;
         case AV_PIX_FMT_YUYV422:
             return FMT_YUYV422;
         case AV_PIX_FMT_UYVY422:
@@ -85,6 +102,10 @@ void VideoDevice::setPlayerInfoStatus(PlayerInfoStatus *playerState) {
     this->playerInfoStatus = playerState;
 }
 
+void VideoDevice::setDisplayClock(DisplayClock *clock) {
+    this->displayClock = clock;
+}
+
 int VideoDevice::create() { return SUCCESS; }
 
 int VideoDevice::destroy() { return SUCCESS; }
@@ -11,6 +11,11 @@
 #include <OpenGLES/ES2/gl.h>
 #include <OpenGLES/ES2/glext.h>
 
+#else
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
 #endif
 
 /**
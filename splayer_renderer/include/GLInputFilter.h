@@ -9,6 +9,9 @@
 
 #define NUM_DATA_POINTERS 3
 
+/// 统计纹理上传耗时的帧数
+#define UPLOAD_STAT_FRAMES 120
+
 /**
  * 图像数据输入滤镜基类
  */
@@ -25,8 +28,57 @@ public:
 
     virtual GLboolean renderTexture(Texture *texture, float *vertices, float *textureVertices);
 
+    void destroyProgram() override;
+
+    /**
+     * 是否经过像素缓冲对象上传，默认关闭
+     * 帧数据在解码器的内存中，经过缓冲对象需要多复制一次，bench_gl_upload测得比直接上传慢
+     */
+    void setPixelBufferEnabled(bool enabled);
+
+protected:
+
+    /**
+     * 上传各个平面的数据，尺寸变化时才重新分配纹理存储，否则通过glTexSubImage2D更新
+     * 开启像素缓冲对象并且是OpenGLES 3.0时，先写入像素缓冲对象，由驱动异步传输到纹理
+     * @param planes 平面数量
+     * @param widths 每个平面的宽度，像素
+     * @param heights 每个平面的高度
+     * @param formats 每个平面的纹理格式，16位的分量用GL_LUMINANCE_ALPHA或GL_RGBA按字节上传
+     * @param bytesPerPixel 每个平面每个像素的字节数
+     * @param pixels 每个平面的数据，行之间没有间隔
+     */
+    void uploadPlanes(int planes, const GLsizei *widths, const GLsizei *heights,
+                      const GLenum *formats, const int *bytesPerPixel, uint8_t *const *pixels);
+
+private:
+
+    bool uploadPixelBuffer(int planes, const GLsizei *widths, const GLsizei *heights,
+                           const GLenum *formats, const int *bytesPerPixel,
+                           uint8_t *const *pixels);
+
+    void updateUploadCost(int64_t startTime);
+
 protected:
     GLuint textures[GLES_MAX_PLANE];        // 纹理id
+
+private:
+    /// 已经分配的纹理存储大小
+    GLsizei planeWidths[GLES_MAX_PLANE] = {0};
+
+    GLsizei planeHeights[GLES_MAX_PLANE] = {0};
+
+    bool pixelBufferEnabled = false;
+
+    /// 像素缓冲对象，-1表示还没有检查是否支持
+    int pixelBufferSupported = -1;
+
+    GLuint pixelBuffer = 0;
+
+    /// 纹理上传耗时统计，微秒
+    int64_t uploadTime = 0;
+
+    int uploadCount = 0;
 };
 
 
@@ -0,0 +1,78 @@
+#ifndef RENDERER_GLINPUTNV12FILTER_H
+#define RENDERER_GLINPUTNV12FILTER_H
+
+#include "GLInputFilter.h"
+
+/**
+ * UV平面按GL_LUMINANCE_ALPHA上传，U在r、V在a
+ */
+const std::string kNV12FragmentShader = SHADER_TO_STRING(
+        precision mediump float;
+        varying highp vec2 textureCoordinate;
+        uniform lowp sampler2D inputTextureY;
+        uniform lowp sampler2D inputTextureUV;
+
+        void main() {
+            vec3 yuv;
+            vec3 rgb;
+            vec4 uv = texture2D(inputTextureUV, textureCoordinate);
+            yuv.r = texture2D(inputTextureY, textureCoordinate).r - (16.0 / 255.0);
+            yuv.g = uv.r - 0.5;
+            yuv.b = uv.a - 0.5;
+            rgb = mat3(1.164,  1.164,  1.164,
+                       0.0,   -0.213,  2.112,
+                       1.793, -0.533,    0.0) * yuv;
+            gl_FragColor = vec4(rgb, 1.0);
+        }
+);
+
+/**
+ * NV21的UV顺序相反，V在r、U在a
+ */
+const std::string kNV21FragmentShader = SHADER_TO_STRING(
+        precision mediump float;
+        varying highp vec2 textureCoordinate;
+        uniform lowp sampler2D inputTextureY;
+        uniform lowp sampler2D inputTextureUV;
+
+        void main() {
+            vec3 yuv;
+            vec3 rgb;
+            vec4 vu = texture2D(inputTextureUV, textureCoordinate);
+            yuv.r = texture2D(inputTextureY, textureCoordinate).r - (16.0 / 255.0);
+            yuv.g = vu.a - 0.5;
+            yuv.b = vu.r - 0.5;
+            rgb = mat3(1.164,  1.164,  1.164,
+                       0.0,   -0.213,  2.112,
+                       1.793, -0.533,    0.0) * yuv;
+            gl_FragColor = vec4(rgb, 1.0);
+        }
+);
+
+/**
+ * NV12/NV21输入滤镜，硬解码器常用的半平面格式，直接上传Y、UV两个平面
+ */
+class GLInputNV12Filter : public GLInputFilter {
+
+    const char *const TAG = "[MP][RENDER][GLInputNV12Filter]";
+
+public:
+    explicit GLInputNV12Filter(bool swapUV = false);
+
+    virtual ~GLInputNV12Filter();
+
+    void initProgram() override;
+
+    void initProgram(const char *vertexShader, const char *fragmentShader) override;
+
+    GLboolean renderTexture(Texture *texture, float *vertices, float *textureVertices) override;
+
+    GLboolean uploadTexture(Texture *texture) override;
+
+private:
+    /// UV顺序相反，即NV21
+    bool swapUV;
+};
+
+
+#endif //GLINPUTNV12FILTER_H
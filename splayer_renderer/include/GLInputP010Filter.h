@@ -0,0 +1,50 @@
+#ifndef RENDERER_GLINPUTP010FILTER_H
+#define RENDERER_GLINPUTP010FILTER_H
+
+#include "GLInputNV12Filter.h"
+
+/**
+ * P010的10位数据在16位的高位，Y平面按GL_LUMINANCE_ALPHA上传，UV平面按GL_RGBA上传，
+ * U的低、高字节在r、g，V的在b、a
+ */
+const std::string kP010FragmentShader = SHADER_TO_STRING(
+        precision mediump float;
+        varying highp vec2 textureCoordinate;
+        uniform mediump sampler2D inputTextureY;
+        uniform mediump sampler2D inputTextureUV;
+
+        const vec2 kScale = vec2(255.0 / 65535.0, 65280.0 / 65535.0);
+
+        void main() {
+            vec3 yuv;
+            vec3 rgb;
+            vec4 uv = texture2D(inputTextureUV, textureCoordinate);
+            yuv.r = dot(texture2D(inputTextureY, textureCoordinate).ra, kScale) - (16.0 / 256.0);
+            yuv.g = dot(uv.rg, kScale) - 0.5;
+            yuv.b = dot(uv.ba, kScale) - 0.5;
+            rgb = mat3(1.164,  1.164,  1.164,
+                       0.0,   -0.213,  2.112,
+                       1.793, -0.533,    0.0) * yuv;
+            gl_FragColor = vec4(rgb, 1.0);
+        }
+);
+
+/**
+ * P010输入滤镜，10位硬解码输出，在着色器中还原
+ */
+class GLInputP010Filter : public GLInputNV12Filter {
+
+    const char *const TAG = "[MP][RENDER][GLInputP010Filter]";
+
+public:
+    GLInputP010Filter();
+
+    virtual ~GLInputP010Filter();
+
+    void initProgram() override;
+
+    GLboolean uploadTexture(Texture *texture) override;
+};
+
+
+#endif //GLINPUTP010FILTER_H
@@ -0,0 +1,52 @@
+#ifndef RENDERER_GLINPUTYUV420P10FILTER_H
+#define RENDERER_GLINPUTYUV420P10FILTER_H
+
+#include "GLInputYUV420PFilter.h"
+
+/**
+ * 每个分量两个字节，按GL_LUMINANCE_ALPHA上传，低字节在r、高字节在a，
+ * 采样器使用mediump，lowp的精度不够还原10位的值
+ */
+const std::string kYUV420P10FragmentShader = SHADER_TO_STRING(
+        precision mediump float;
+        varying highp vec2 textureCoordinate;
+        uniform mediump sampler2D inputTextureY;
+        uniform mediump sampler2D inputTextureU;
+        uniform mediump sampler2D inputTextureV;
+
+        float sample10(vec4 value) {
+            return dot(value.ra, vec2(255.0 / 1023.0, 65280.0 / 1023.0));
+        }
+
+        void main() {
+            vec3 yuv;
+            vec3 rgb;
+            yuv.r = sample10(texture2D(inputTextureY, textureCoordinate)) - (64.0 / 1023.0);
+            yuv.g = sample10(texture2D(inputTextureU, textureCoordinate)) - (512.0 / 1023.0);
+            yuv.b = sample10(texture2D(inputTextureV, textureCoordinate)) - (512.0 / 1023.0);
+            rgb = mat3(1.164,  1.164,  1.164,
+                       0.0,   -0.213,  2.112,
+                       1.793, -0.533,    0.0) * yuv;
+            gl_FragColor = vec4(rgb, 1.0);
+        }
+);
+
+/**
+ * YUV420P10输入滤镜，10位数据在着色器中还原，不需要转换成8位
+ */
+class GLInputYUV420P10Filter : public GLInputYUV420PFilter {
+
+    const char *const TAG = "[MP][RENDER][GLInputYUV420P10Filter]";
+
+public:
+    GLInputYUV420P10Filter();
+
+    virtual ~GLInputYUV420P10Filter();
+
+    void initProgram() override;
+
+    GLboolean uploadTexture(Texture *texture) override;
+};
+
+
+#endif //GLINPUTYUV420P10FILTER_H
@@ -25,7 +25,7 @@ const std::string kYUV420PFragmentShader = SHADER_TO_STRING(
 );
 
 /**
- * YUV420P输入滤镜
+ * 平面YUV输入滤镜，包括YUV420P、YUV422P和YUV444P，U、V平面按纹理坐标采样，不需要区分色度抽样
  */
 class GLInputYUV420PFilter : public GLInputFilter {
 
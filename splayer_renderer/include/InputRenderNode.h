@@ -8,6 +8,9 @@
 #include "GLInputFilter.h"
 #include "GLInputYUV420PFilter.h"
 #include "GLInputABGRFilter.h"
+#include "GLInputYUV420P10Filter.h"
+#include "GLInputNV12Filter.h"
+#include "GLInputP010Filter.h"
 
 /**
  * 输入渲染结点
@@ -21,7 +24,7 @@ public:
 
     virtual ~InputRenderNode();
 
-    /// 初始化滤镜
+    /// 初始化滤镜，纹理格式变化时重新创建
     void initFilter(Texture *texture);
 
     /// 上载纹理
@@ -35,6 +38,8 @@ public:
 
 private:
 
+    GLInputFilter *createFilter(TextureFormat format);
+
     void resetVertices();
 
     void resetTextureVertices(Texture *texture);
@@ -50,6 +55,9 @@ private:
 
     /// 纹理坐标
     GLfloat textureVertices[8];
+
+    /// 当前滤镜对应的纹理格式
+    TextureFormat inputFormat = FMT_NONE;
 };
 
 
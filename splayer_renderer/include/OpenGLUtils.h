@@ -11,10 +11,30 @@
 #include <GLES2/gl2ext.h>
 #include <GLES2/gl2platform.h>
 
+// API 18开始链接GLESv3，可以使用像素缓冲对象
+#if __ANDROID_API__ >= 18
+#include <GLES3/gl3.h>
+#define GLES3_SUPPORTED 1
+#endif
+
 #elif __APPLE__
 
 #include <OpenGLES/ES2/gl.h>
 #include <OpenGLES/ES2/glext.h>
+#include <OpenGLES/ES3/gl.h>
+
+#define GLES3_SUPPORTED 1
+
+#else
+
+// Linux使用Mesa等实现的OpenGLES，有GLES3头文件时才能使用像素缓冲对象
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#if __has_include(<GLES3/gl3.h>)
+#include <GLES3/gl3.h>
+#define GLES3_SUPPORTED 1
+#endif
 
 #endif
 
@@ -60,6 +80,9 @@ public:
     /// 绑定纹理，指定纹理类型
     static void bindTexture(int location, int texture, int index, int textureType);
 
+    /// 当前上下文是否OpenGLES 3.0及以上
+    static bool isGLES3();
+
 private:
     OpenGLUtils() = default;
 
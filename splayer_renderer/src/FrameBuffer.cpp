@@ -5,8 +5,8 @@ TextureAttributes FrameBuffer::defaultTextureAttributes = {
         .magFilter = GL_LINEAR,
         .wrapS = GL_CLAMP_TO_EDGE,
         .wrapT = GL_CLAMP_TO_EDGE,
-        .internalFormat = GL_RGBA,
         .format = GL_RGBA,
+        .internalFormat = GL_RGBA,
         .type = GL_UNSIGNED_BYTE};
 
 FrameBuffer::FrameBuffer(int width, int height, const TextureAttributes textureAttributes)
@@ -40,22 +40,13 @@ void GLInputABGRFilter::initProgram(const char *vertexShader, const char *fragme
 }
 
 GLboolean GLInputABGRFilter::uploadTexture(Texture *texture) {
-    // 需要设置4字节对齐
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glUseProgram(static_cast<GLuint>(programHandle));
-    // 更新纹理数据
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textures[0]);
-    glTexImage2D(GL_TEXTURE_2D,
-                 0,
-                 GL_RGBA,                 // 对于YUV来说，数据格式是GL_LUMINANCE亮度值，而对于BGRA来说，这个则是颜色通道值
-                 texture->pitches[0] /
-                 4, // pixels中存放的数据是BGRABGRABGRA方式排列的，这里除4是为了求出对齐后的宽度，也就是每个颜色通道的数值
-                 texture->height,
-                 0,
-                 GL_RGBA,
-                 GL_UNSIGNED_BYTE,
-                 texture->pixels[0]);
+    // pixels中存放的数据是BGRABGRABGRA方式排列的，这里除4是为了求出对齐后的宽度
+    const GLsizei widths[1] = {texture->pitches[0] / 4};
+    const GLsizei heights[1] = {texture->height};
+    const GLenum formats[1] = {GL_RGBA};
+    const int bytesPerPixel[1] = {4};
+    uploadPlanes(1, widths, heights, formats, bytesPerPixel, texture->pixels);
     glUniform1i(inputTextureHandle[0], 0);
     return GL_TRUE;
 }
@@ -80,6 +71,5 @@ GLInputABGRFilter::renderTexture(Texture *texture, float *vertices, float *textu
     unbindTextures();
     // 解绑program
     glUseProgram(0);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 0);
     return GL_TRUE;
 }
@@ -1,4 +1,13 @@
 #include "GLInputFilter.h"
+#include <cstring>
+#include <ctime>
+
+/// 单调时钟，微秒
+static int64_t getCurrentTime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
 
 GLInputFilter::GLInputFilter() {
 
@@ -15,3 +24,118 @@ GLboolean GLInputFilter::uploadTexture(Texture *texture) {
 GLboolean GLInputFilter::renderTexture(Texture *texture, float *vertices, float *textureVertices) {
     return GL_TRUE;
 }
+
+void GLInputFilter::destroyProgram() {
+#if GLES3_SUPPORTED
+    if (pixelBuffer != 0) {
+        glDeleteBuffers(1, &pixelBuffer);
+        pixelBuffer = 0;
+    }
+#endif
+    pixelBufferSupported = -1;
+    memset(planeWidths, 0, sizeof(planeWidths));
+    memset(planeHeights, 0, sizeof(planeHeights));
+    GLFilter::destroyProgram();
+}
+
+void GLInputFilter::setPixelBufferEnabled(bool enabled) {
+    pixelBufferEnabled = enabled;
+}
+
+void GLInputFilter::uploadPlanes(int planes, const GLsizei *widths, const GLsizei *heights,
+                                 const GLenum *formats, const int *bytesPerPixel,
+                                 uint8_t *const *pixels) {
+    int64_t startTime = getCurrentTime();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // 尺寸变化时重新分配纹理存储，之后只更新数据
+    for (int i = 0; i < planes; ++i) {
+        if (widths[i] != planeWidths[i] || heights[i] != planeHeights[i]) {
+            glActiveTexture((GLenum) (GL_TEXTURE0 + i));
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, formats[i], widths[i], heights[i], 0, formats[i],
+                         GL_UNSIGNED_BYTE, nullptr);
+            planeWidths[i] = widths[i];
+            planeHeights[i] = heights[i];
+        }
+    }
+
+    if (pixelBufferEnabled && pixelBufferSupported < 0) {
+        pixelBufferSupported = OpenGLUtils::isGLES3() ? 1 : 0;
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] pixel buffer supported = %d", __func__, pixelBufferSupported);
+        }
+    }
+
+    if (!pixelBufferEnabled || pixelBufferSupported <= 0 ||
+        !uploadPixelBuffer(planes, widths, heights, formats, bytesPerPixel, pixels)) {
+        for (int i = 0; i < planes; ++i) {
+            glActiveTexture((GLenum) (GL_TEXTURE0 + i));
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, widths[i], heights[i], formats[i],
+                            GL_UNSIGNED_BYTE, pixels[i]);
+        }
+    }
+    updateUploadCost(startTime);
+}
+
+/**
+ * 每一帧用glBufferData孤立缓冲对象，驱动分配新的存储，不需要等待GPU读完上一帧，
+ * 再用glBufferSubData写入，glTexSubImage2D从缓冲对象读取时立即返回
+ * 数据仍然在调用线程复制一次，解码器不能直接写入缓冲对象时不比直接上传快
+ */
+bool GLInputFilter::uploadPixelBuffer(int planes, const GLsizei *widths, const GLsizei *heights,
+                                      const GLenum *formats, const int *bytesPerPixel,
+                                      uint8_t *const *pixels) {
+#if GLES3_SUPPORTED
+    GLsizeiptr offsets[GLES_MAX_PLANE];
+    GLsizeiptr sizes[GLES_MAX_PLANE];
+    GLsizeiptr size = 0;
+    for (int i = 0; i < planes; ++i) {
+        offsets[i] = size;
+        sizes[i] = (GLsizeiptr) widths[i] * heights[i] * bytesPerPixel[i];
+        size += sizes[i];
+    }
+
+    if (pixelBuffer == 0) {
+        glGenBuffers(1, &pixelBuffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    for (int i = 0; i < planes; ++i) {
+        glBufferSubData(GL_PIXEL_UNPACK_BUFFER, offsets[i], sizes[i], pixels[i]);
+    }
+    if (glGetError() != GL_NO_ERROR) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pixelBufferSupported = 0;
+        return false;
+    }
+    for (int i = 0; i < planes; ++i) {
+        glActiveTexture((GLenum) (GL_TEXTURE0 + i));
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, widths[i], heights[i], formats[i],
+                        GL_UNSIGNED_BYTE, (const void *) offsets[i]);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * 统计每帧上传纹理的耗时，每UPLOAD_STAT_FRAMES帧输出一次平均值
+ */
+void GLInputFilter::updateUploadCost(int64_t startTime) {
+    uploadTime += getCurrentTime() - startTime;
+    uploadCount++;
+    if (uploadCount >= UPLOAD_STAT_FRAMES) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] %dx%d upload cost = %lld us/frame pbo = %d", __func__,
+                  planeWidths[0], planeHeights[0], (long long) (uploadTime / uploadCount),
+                  pixelBufferEnabled && pixelBufferSupported > 0);
+        }
+        uploadTime = 0;
+        uploadCount = 0;
+    }
+}
@@ -0,0 +1,100 @@
+#include "GLInputNV12Filter.h"
+
+GLInputNV12Filter::GLInputNV12Filter(bool swapUV) : swapUV(swapUV) {
+    for (int i = 0; i < GLES_MAX_PLANE; ++i) {
+        inputTextureHandle[i] = 0;
+        textures[i] = 0;
+    }
+}
+
+GLInputNV12Filter::~GLInputNV12Filter() {
+
+}
+
+void GLInputNV12Filter::initProgram() {
+    initProgram(kDefaultVertexShader.c_str(),
+                swapUV ? kNV21FragmentShader.c_str() : kNV12FragmentShader.c_str());
+}
+
+void GLInputNV12Filter::initProgram(const char *vertexShader, const char *fragmentShader) {
+
+    if (vertexShader && fragmentShader) {
+
+        programHandle = OpenGLUtils::createProgram(vertexShader, fragmentShader);
+        OpenGLUtils::checkGLError("createProgram");
+
+        positionHandle = glGetAttribLocation((GLuint) (programHandle), "aPosition");
+        texCoordinateHandle = glGetAttribLocation((GLuint) (programHandle), "aTextureCoord");
+
+        inputTextureHandle[0] = glGetUniformLocation((GLuint) (programHandle), "inputTextureY");
+        inputTextureHandle[1] = glGetUniformLocation((GLuint) (programHandle), "inputTextureUV");
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glUseProgram((GLuint) (programHandle));
+
+        if (textures[0] == 0) {
+            glGenTextures(2, textures);
+        }
+
+        for (int i = 0; i < 2; ++i) {
+            glActiveTexture((GLenum) (GL_TEXTURE0 + i));
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glUniform1i(inputTextureHandle[i], i);
+        }
+        setInitialized(true);
+    } else {
+        positionHandle = -1;
+        inputTextureHandle[0] = -1;
+        setInitialized(false);
+    }
+}
+
+GLboolean GLInputNV12Filter::uploadTexture(Texture *texture) {
+    glUseProgram((GLuint) programHandle);
+
+    // UV平面每个像素两个字节，高度向上取整
+    const GLsizei widths[2] = {texture->pitches[0], texture->pitches[1] / 2};
+    const GLsizei heights[2] = {texture->height, (texture->height + 1) / 2};
+    const GLenum formats[2] = {GL_LUMINANCE, GL_LUMINANCE_ALPHA};
+    const int bytesPerPixel[2] = {1, 2};
+    uploadPlanes(2, widths, heights, formats, bytesPerPixel, texture->pixels);
+    for (int i = 0; i < 2; ++i) {
+        glUniform1i(inputTextureHandle[i], i);
+    }
+    return GL_TRUE;
+}
+
+GLboolean GLInputNV12Filter::renderTexture(Texture *texture,
+                                           float *vertices, float *textureVertices) {
+    if (!isInitialized() || !texture) {
+        return GL_FALSE;
+    }
+
+    // 绑定属性值
+    bindAttributes(vertices, textureVertices);
+
+    // 绘制前处理
+    onDrawBegin();
+
+    // 绘制纹理
+    onDrawFrame();
+
+    // 绘制后处理
+    onDrawAfter();
+
+    // 解绑属性
+    unbindAttributes();
+
+    // 解绑纹理
+    unbindTextures();
+
+    // 解绑program
+    glUseProgram(0);
+
+    return GL_TRUE;
+}
@@ -0,0 +1,28 @@
+#include "GLInputP010Filter.h"
+
+GLInputP010Filter::GLInputP010Filter() : GLInputNV12Filter(false) {
+
+}
+
+GLInputP010Filter::~GLInputP010Filter() {
+
+}
+
+void GLInputP010Filter::initProgram() {
+    GLInputNV12Filter::initProgram(kDefaultVertexShader.c_str(), kP010FragmentShader.c_str());
+}
+
+GLboolean GLInputP010Filter::uploadTexture(Texture *texture) {
+    glUseProgram((GLuint) programHandle);
+
+    // linesize是字节数，Y每个像素两个字节，UV每个像素四个字节
+    const GLsizei widths[2] = {texture->pitches[0] / 2, texture->pitches[1] / 4};
+    const GLsizei heights[2] = {texture->height, (texture->height + 1) / 2};
+    const GLenum formats[2] = {GL_LUMINANCE_ALPHA, GL_RGBA};
+    const int bytesPerPixel[2] = {2, 4};
+    uploadPlanes(2, widths, heights, formats, bytesPerPixel, texture->pixels);
+    for (int i = 0; i < 2; ++i) {
+        glUniform1i(inputTextureHandle[i], i);
+    }
+    return GL_TRUE;
+}
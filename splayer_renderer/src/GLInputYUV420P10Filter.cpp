@@ -0,0 +1,31 @@
+#include "GLInputYUV420P10Filter.h"
+
+GLInputYUV420P10Filter::GLInputYUV420P10Filter() {
+
+}
+
+GLInputYUV420P10Filter::~GLInputYUV420P10Filter() {
+
+}
+
+void GLInputYUV420P10Filter::initProgram() {
+    GLInputYUV420PFilter::initProgram(kDefaultVertexShader.c_str(),
+                                      kYUV420P10FragmentShader.c_str());
+}
+
+GLboolean GLInputYUV420P10Filter::uploadTexture(Texture *texture) {
+    glUseProgram((GLuint) programHandle);
+
+    // linesize是字节数，每个像素两个字节
+    const GLsizei widths[3] = {texture->pitches[0] / 2, texture->pitches[1] / 2,
+                               texture->pitches[2] / 2};
+    const GLsizei heights[3] = {texture->height, (texture->height + 1) / 2,
+                                (texture->height + 1) / 2};
+    const GLenum formats[3] = {GL_LUMINANCE_ALPHA, GL_LUMINANCE_ALPHA, GL_LUMINANCE_ALPHA};
+    const int bytesPerPixel[3] = {2, 2, 2};
+    uploadPlanes(3, widths, heights, formats, bytesPerPixel, texture->pixels);
+    for (int i = 0; i < 3; ++i) {
+        glUniform1i(inputTextureHandle[i], i);
+    }
+    return GL_TRUE;
+}
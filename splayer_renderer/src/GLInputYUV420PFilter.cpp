@@ -56,27 +56,19 @@ void GLInputYUV420PFilter::initProgram(const char *vertexShader, const char *fra
 }
 
 GLboolean GLInputYUV420PFilter::uploadTexture(Texture *texture) {
-    // 需要设置4字节对齐
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glUseProgram((GLuint) programHandle);
 
-    // 更新绑定纹理的数据
-    const GLsizei heights[3] = {texture->height, texture->height / 2, texture->height / 2};
+    // 纹理宽度为linesize，U、V平面的高度向上取整，YUV422P和YUV444P没有垂直方向的色度抽样
+    GLsizei chromaHeight = (texture->format == FMT_YUV422P || texture->format == FMT_YUV444P)
+                           ? texture->height : (texture->height + 1) / 2;
+    const GLsizei widths[3] = {texture->pitches[0], texture->pitches[1], texture->pitches[2]};
+    const GLsizei heights[3] = {texture->height, chromaHeight, chromaHeight};
+    const GLenum formats[3] = {GL_LUMINANCE, GL_LUMINANCE, GL_LUMINANCE};
+    const int bytesPerPixel[3] = {1, 1, 1};
+    uploadPlanes(3, widths, heights, formats, bytesPerPixel, texture->pixels);
     for (int i = 0; i < 3; ++i) {
-        glActiveTexture((GLenum) GL_TEXTURE0 + i);
-        glBindTexture(GL_TEXTURE_2D, textures[i]);
-        glTexImage2D(GL_TEXTURE_2D,
-                     0,
-                     GL_LUMINANCE,
-                     texture->pitches[i],
-                     heights[i],
-                     0,
-                     GL_LUMINANCE,
-                     GL_UNSIGNED_BYTE,
-                     texture->pixels[i]);
         glUniform1i(inputTextureHandle[i], i);
     }
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 0);
     return GL_TRUE;
 }
 
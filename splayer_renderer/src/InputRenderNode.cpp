@@ -10,23 +10,44 @@ InputRenderNode::~InputRenderNode() {
 }
 
 void InputRenderNode::initFilter(Texture *texture) {
-    if (!glFilter) {
-        if (texture) {
-            if (texture->format == FMT_YUV420P) {
-                glFilter = new GLInputYUV420PFilter();
-            } else if (texture->format == FMT_ARGB) {
-                glFilter = new GLInputABGRFilter();
-            } else {
-                glFilter = new GLInputFilter();
-            }
-            init();
+    if (texture && (!glFilter || texture->format != inputFormat)) {
+        if (ENGINE_DEBUG && glFilter) {
+            ALOGD(TAG, "[%s] format %d -> %d", __func__, inputFormat, texture->format);
         }
+        inputFormat = texture->format;
+        changeFilter(createFilter(texture->format));
     }
     if (texture) {
         setTextureSize(texture->width, texture->height);
     }
 }
 
+/**
+ * YUV转RGB都在着色器中完成，不需要在CPU上转换
+ */
+GLInputFilter *InputRenderNode::createFilter(TextureFormat format) {
+    switch (format) {
+        case FMT_YUV420P:
+        case FMT_YUV422P:
+        case FMT_YUV444P:
+            return new GLInputYUV420PFilter();
+        case FMT_YUV420P10:
+            return new GLInputYUV420P10Filter();
+        case FMT_NV12:
+            return new GLInputNV12Filter(false);
+        case FMT_NV21:
+            return new GLInputNV12Filter(true);
+        case FMT_P010:
+            return new GLInputP010Filter();
+        // 其他格式由同步器转换成BGRA
+        case FMT_ARGB:
+        case FMT_NONE:
+            return new GLInputABGRFilter();
+        default:
+            return new GLInputFilter();
+    }
+}
+
 bool InputRenderNode::uploadTexture(Texture *texture) {
     if (glFilter && glFilter->isInitialized()) {
         return ((GLInputFilter *) glFilter)->uploadTexture(texture);
@@ -262,3 +262,13 @@ void OpenGLUtils::bindTexture(int location, int texture, int index, int textureT
     glBindTexture(static_cast<GLenum>(textureType), static_cast<GLuint>(texture));
     glUniform1i(location, index);
 }
+
+bool OpenGLUtils::isGLES3() {
+#if GLES3_SUPPORTED
+    const char *version = (const char *) glGetString(GL_VERSION);
+    int major = 0;
+    return version && sscanf(version, "OpenGL ES %d", &major) == 1 && major >= 3;
+#else
+    return false;
+#endif
+}
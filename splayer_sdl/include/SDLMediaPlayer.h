@@ -7,13 +7,14 @@
 #include <MediaSync.h>
 #include <SDL.h>
 #include <SDLVideoDevice.h>
+#include <IDisplayClockListener.h>
 
 #define MSG_REQUEST_SEEK_SDL 29000
 #define MSG_REQUEST_PLAY_OR_PAUSE 29001
 
 #define SPLAYER_COMMAND
 
-class SDLMediaPlayer : public MediaPlayer {
+class SDLMediaPlayer : public MediaPlayer, public IDisplayClockListener {
 
     const char *const TAG = "[MP][SDL][MediaPlayer]";
 
@@ -47,12 +48,16 @@ public:
 
     void doSeek(int increment);
 
-    int destroy() override;
+    int create() override;
 
-    void resetRemainingTime();
+    int destroy() override;
 
     void refreshVideo();
 
+    int getWaitTime();
+
+    void onWakeUp() override;
+
     void toggleFullScreen();
 };
 
@@ -11,6 +11,9 @@
 /// 1 second
 #define CURSOR_HIDE_DELAY                   (1000000*1.0F)
 
+/// 统计纹理上传耗时的帧数
+#define UPLOAD_STAT_FRAMES                  120
+
 class SDLVideoDevice : public VideoDevice {
 
     const char *const TAG = "[MP][SDL][VideoDevice]";
@@ -60,6 +63,22 @@ public:
     SDL_Texture *subtitleTexture = nullptr;
     SDL_Texture *visTexture = nullptr;
 
+    /// 视频纹理的宽高、格式和混合模式，不变时复用纹理
+    int textureWidth = 0;
+
+    int textureHeight = 0;
+
+    TextureFormat textureFormat = FMT_NONE;
+
+    BlendMode textureBlendMode = BLEND_NONE;
+
+    /// 纹理上传耗时统计，微秒
+    int64_t uploadTime = 0;
+
+    int uploadCount = 0;
+
+    /// 窗口所在的显示器，变化时重新读取刷新率
+    int displayIndex = -1;
 
 public:
 
@@ -76,6 +95,8 @@ public:
 
     int onUpdateYUV(uint8_t *yData, int yPitch, uint8_t *uData, int uPitch, uint8_t *vData, int vPitch) override;
 
+    int onUpdateNV(uint8_t *yData, int yPitch, uint8_t *uvData, int uvPitch) override;
+
     int onUpdateARGB(uint8_t *rgba, int pitch) override;
 
     void onRequestRenderStart(Frame *frame) override;
@@ -92,6 +113,8 @@ public:
 
     SDL_BlendMode getSDLBlendMode(BlendMode mode);
 
+    TextureFormat getTextureFormat(int format) override;
+
     TextureFormat getTextureFormat(Uint32 format);
 
     void displayWindow();
@@ -103,6 +126,10 @@ public:
 
     void destroyVideoTexture();
 
+    void updateUploadCost(int64_t startTime);
+
+    void updateRefreshRate();
+
 
     void toggleFullScreen();
 };
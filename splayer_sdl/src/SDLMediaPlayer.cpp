@@ -1,14 +1,15 @@
 #include <SDLMediaPlayer.h>
 
+/**
+ * 在事件上等待到下一帧的显示时间，不再按REFRESH_RATE轮询，暂停时由显示时钟唤醒
+ */
 int SDLMediaPlayer::eventLoop() {
     SDL_Event event;
     while (!quit) {
-        resetRemainingTime();
-        SDL_PumpEvents();
-        while (!SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT)) {
-            hideCursor();
-            refreshVideo();
-            SDL_PumpEvents();
+        hideCursor();
+        refreshVideo();
+        if (!SDL_WaitEventTimeout(&event, getWaitTime())) {
+            continue;
         }
         switch (event.type) {
             case SDL_KEYDOWN:
@@ -53,16 +54,21 @@ void SDLMediaPlayer::toggleFullScreen() {
 
 void SDLMediaPlayer::refreshVideo() {
     if (mediaSync != nullptr) {
-        mediaSync->refreshVideo();
+        mediaSync->updateVideo();
     }
 }
 
-void SDLMediaPlayer::resetRemainingTime() {
-    mutex.lock();
-    if (mediaSync != nullptr) {
-        mediaSync->resetRemainingTime();
-    }
-    mutex.unlock();
+int SDLMediaPlayer::getWaitTime() {
+    double remainingTime = mediaSync != nullptr ? mediaSync->getRemainingTime() : REFRESH_RATE;
+    // 向上取整，避免提前醒来之后再等待不足一毫秒
+    return (int) ceil(FFMAX(remainingTime, 0) * 1000);
+}
+
+void SDLMediaPlayer::onWakeUp() {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = SDL_USEREVENT;
+    SDL_PushEvent(&event);
 }
 
 
@@ -179,8 +185,6 @@ void SDLMediaPlayer::doKeySystem(const SDL_Event &event) {
             break;
         case SDLK_c:
             break;
-        case SDLK_t:
-            break;
         case SDLK_w:
             break;
         case SDLK_PAGEUP:
@@ -213,12 +217,29 @@ void SDLMediaPlayer::doSeek(int increment) {
     notifyMsg(MSG_REQUEST_SEEK_SDL, increment);
 }
 
+/**
+ * 显示时钟随MediaSync创建，每次创建之后设置监听，暂停和强制刷新时才能唤醒事件循环
+ */
+int SDLMediaPlayer::create() {
+    int ret = MediaPlayer::create();
+    mutex.lock();
+    if (mediaSync != nullptr && mediaSync->getDisplayClock() != nullptr) {
+        mediaSync->getDisplayClock()->setListener(this);
+    }
+    mutex.unlock();
+    return ret;
+}
+
 int SDLMediaPlayer::destroy() {
     if (ENGINE_DEBUG) {
         ALOGD(TAG, "[%s] destroy sdl media player", __func__);
     }
+    mutex.lock();
+    if (mediaSync != nullptr && mediaSync->getDisplayClock() != nullptr) {
+        mediaSync->getDisplayClock()->setListener(nullptr);
+    }
+    mutex.unlock();
     MediaPlayer::syncDestroy();
     quit = true;
     return SUCCESS;
 }
-
@@ -56,6 +56,7 @@ int SDLVideoDevice::create() {
             ALOGD(TAG, "[%s] initialized %s renderer", __func__, rendererInfo.name);
         }
     }
+    displayIndex = -1;
     if (!window || !renderer || !rendererInfo.num_texture_formats) {
         if (ENGINE_DEBUG) {
             ALOGD(TAG, "[%s] failed to create window or renderer: %s", __func__, SDL_GetError());
@@ -67,10 +68,7 @@ int SDLVideoDevice::create() {
 }
 
 int SDLVideoDevice::destroy() {
-    if (videoTexture) {
-        SDL_DestroyTexture(videoTexture);
-        videoTexture = nullptr;
-    }
+    destroyVideoTexture();
     if (subtitleTexture) {
         SDL_DestroyTexture(subtitleTexture);
         subtitleTexture = nullptr;
@@ -92,52 +90,152 @@ int SDLVideoDevice::destroy() {
     return SUCCESS;
 }
 
+/**
+ * 流式纹理一直保留，只有宽高或者格式变化时才重新创建
+ */
 int
 SDLVideoDevice::onInitTexture(int initTexture, int newWidth, int newHeight, TextureFormat newFormat,
                               BlendMode blendMode, int rotate) {
-    Uint32 format;
-    int access;
-    int width;
-    int height;
-    bool cond1 = videoTexture != nullptr;
-    bool cond2 = SDL_QueryTexture(videoTexture, &format, &access, &width, &height) < 0;
-    bool cond3 = newWidth != width;
-    bool cond4 = newHeight != height;
-    bool cond5 = newFormat != getTextureFormat(format);
-    if (cond1 || cond2 || cond3 || cond4 || cond5) {
-        void *pixels;
-        int pitch;
-        if (videoTexture) {
-            SDL_DestroyTexture(videoTexture);
-        }
-        if (!(videoTexture = SDL_CreateTexture(renderer, getSDLFormat(newFormat), SDL_TEXTUREACCESS_STREAMING, newWidth,
-                                               newHeight))) {
-            return ERROR;
-        }
-        if (SDL_SetTextureBlendMode(videoTexture, getSDLBlendMode(blendMode)) < 0) {
-            return ERROR;
-        }
-        if (initTexture) {
-            if (SDL_LockTexture(videoTexture, nullptr, &pixels, &pitch) < 0) {
+    if (videoTexture && newWidth == textureWidth && newHeight == textureHeight &&
+        newFormat == textureFormat) {
+        if (blendMode != textureBlendMode) {
+            if (SDL_SetTextureBlendMode(videoTexture, getSDLBlendMode(blendMode)) < 0) {
                 return ERROR;
             }
-            memset(pixels, 0, pitch * newHeight);
-            SDL_UnlockTexture(videoTexture);
+            textureBlendMode = blendMode;
         }
-        if (ENGINE_DEBUG) {
-            ALOGD(TAG, "[%s] Created %dx%d texture with %s", __func__, newWidth, newHeight,
-                  SDL_GetPixelFormatName(newFormat));
+        return SUCCESS;
+    }
+
+    destroyVideoTexture();
+    Uint32 format = getSDLFormat(newFormat);
+    if (!(videoTexture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING, newWidth,
+                                           newHeight))) {
+        return ERROR;
+    }
+    if (SDL_SetTextureBlendMode(videoTexture, getSDLBlendMode(blendMode)) < 0) {
+        destroyVideoTexture();
+        return ERROR;
+    }
+    if (initTexture) {
+        void *pixels;
+        int pitch;
+        if (SDL_LockTexture(videoTexture, nullptr, &pixels, &pitch) < 0) {
+            destroyVideoTexture();
+            return ERROR;
         }
+        memset(pixels, 0, pitch * newHeight);
+        SDL_UnlockTexture(videoTexture);
+    }
+    textureWidth = newWidth;
+    textureHeight = newHeight;
+    textureFormat = newFormat;
+    textureBlendMode = blendMode;
+    if (ENGINE_DEBUG) {
+        ALOGD(TAG, "[%s] Created %dx%d texture with %s", __func__, newWidth, newHeight,
+              SDL_GetPixelFormatName(format));
     }
     return SUCCESS;
 }
 
+/**
+ * 锁定流式纹理后直接写入，IYUV的三个平面在锁定的内存中连续存放，U、V平面的行宽为Y平面的一半
+ * 锁定失败时退回到SDL_UpdateYUVTexture
+ */
 int SDLVideoDevice::onUpdateYUV(uint8_t *yData, int yPitch, uint8_t *uData, int uPitch, uint8_t *vData, int vPitch) {
-    return SDL_UpdateYUVTexture(videoTexture, nullptr, yData, yPitch, uData, uPitch, vData, vPitch);
+    if (!videoTexture) {
+        return ERROR;
+    }
+    int64_t startTime = av_gettime_relative();
+    void *pixels;
+    int pitch;
+    if (textureFormat != FMT_YUV420P || SDL_LockTexture(videoTexture, nullptr, &pixels, &pitch) < 0) {
+        int ret = SDL_UpdateYUVTexture(videoTexture, nullptr, yData, yPitch, uData, uPitch, vData, vPitch);
+        updateUploadCost(startTime);
+        return ret;
+    }
+    auto *dst = (uint8_t *) pixels;
+    int chromaPitch = (pitch + 1) / 2;
+    int chromaWidth = (textureWidth + 1) / 2;
+    int chromaHeight = (textureHeight + 1) / 2;
+    av_image_copy_plane(dst, pitch, yData, yPitch, textureWidth, textureHeight);
+    dst += pitch * textureHeight;
+    av_image_copy_plane(dst, chromaPitch, uData, uPitch, chromaWidth, chromaHeight);
+    dst += chromaPitch * chromaHeight;
+    av_image_copy_plane(dst, chromaPitch, vData, vPitch, chromaWidth, chromaHeight);
+    SDL_UnlockTexture(videoTexture);
+    updateUploadCost(startTime);
+    return SUCCESS;
 }
 
+/**
+ * NV12、NV21的UV平面紧跟在Y平面之后，行宽为Y平面的行宽向上取偶数
+ * 锁定失败时退回到SDL_UpdateNVTexture
+ */
+int SDLVideoDevice::onUpdateNV(uint8_t *yData, int yPitch, uint8_t *uvData, int uvPitch) {
+    if (!videoTexture) {
+        return ERROR;
+    }
+    int64_t startTime = av_gettime_relative();
+    void *pixels;
+    int pitch;
+    if (SDL_LockTexture(videoTexture, nullptr, &pixels, &pitch) < 0) {
+#if SDL_VERSION_ATLEAST(2, 0, 16)
+        int ret = SDL_UpdateNVTexture(videoTexture, nullptr, yData, yPitch, uvData, uvPitch);
+        updateUploadCost(startTime);
+        return ret;
+#else
+        return ERROR;
+#endif
+    }
+    auto *dst = (uint8_t *) pixels;
+    int chromaPitch = (pitch + 1) & ~1;
+    av_image_copy_plane(dst, pitch, yData, yPitch, textureWidth, textureHeight);
+    dst += pitch * textureHeight;
+    av_image_copy_plane(dst, chromaPitch, uvData, uvPitch, (textureWidth + 1) & ~1,
+                        (textureHeight + 1) / 2);
+    SDL_UnlockTexture(videoTexture);
+    updateUploadCost(startTime);
+    return SUCCESS;
+}
+
+/**
+ * 打包格式按行复制到锁定的纹理内存
+ */
 int SDLVideoDevice::onUpdateARGB(uint8_t *rgba, int pitch) {
-    return VideoDevice::onUpdateARGB(rgba, pitch);
+    if (!videoTexture) {
+        return ERROR;
+    }
+    int64_t startTime = av_gettime_relative();
+    void *pixels;
+    int texturePitch;
+    if (SDL_LockTexture(videoTexture, nullptr, &pixels, &texturePitch) < 0) {
+        int ret = SDL_UpdateTexture(videoTexture, nullptr, rgba, pitch);
+        updateUploadCost(startTime);
+        return ret;
+    }
+    int bytesPerLine = SDL_BYTESPERPIXEL(getSDLFormat(textureFormat)) * textureWidth;
+    av_image_copy_plane((uint8_t *) pixels, texturePitch, rgba, pitch,
+                        FFMIN(bytesPerLine, FFMIN(pitch, texturePitch)), textureHeight);
+    SDL_UnlockTexture(videoTexture);
+    updateUploadCost(startTime);
+    return SUCCESS;
+}
+
+/**
+ * 统计每帧上传纹理的耗时，每UPLOAD_STAT_FRAMES帧输出一次平均值
+ */
+void SDLVideoDevice::updateUploadCost(int64_t startTime) {
+    uploadTime += av_gettime_relative() - startTime;
+    uploadCount++;
+    if (uploadCount >= UPLOAD_STAT_FRAMES) {
+        if (ENGINE_DEBUG) {
+            ALOGD(TAG, "[%s] %dx%d upload cost = %lld us/frame", __func__, textureWidth, textureHeight,
+                  (long long) (uploadTime / uploadCount));
+        }
+        uploadTime = 0;
+        uploadCount = 0;
+    }
 }
 
 void SDLVideoDevice::onRequestRenderStart(Frame *frame) {
@@ -167,6 +265,12 @@ int SDLVideoDevice::onRequestRenderEnd(Frame *frame, bool flip) {
             setYuvConversionMode(nullptr);
         }
         SDL_RenderPresent(renderer);
+        if (displayClock) {
+            // PRESENTVSYNC时SDL_RenderPresent阻塞到vsync，返回的时间就是vsync
+            updateRefreshRate();
+            displayClock->onPresent(av_gettime_relative() / 1000000.0,
+                                    (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC) != 0);
+        }
         return SUCCESS;
     }
     return ERROR;
@@ -215,7 +319,8 @@ void SDLVideoDevice::setYuvConversionMode(AVFrame *frame) {
 #if SDL_VERSION_ATLEAST(2, 0, 8)
     SDL_YUV_CONVERSION_MODE mode = SDL_YUV_CONVERSION_AUTOMATIC;
     if (frame && (frame->format == AV_PIX_FMT_YUV420P || frame->format == AV_PIX_FMT_YUYV422 ||
-                  frame->format == AV_PIX_FMT_UYVY422)) {
+                  frame->format == AV_PIX_FMT_UYVY422 || frame->format == AV_PIX_FMT_NV12 ||
+                  frame->format == AV_PIX_FMT_NV21)) {
         if (frame->color_range == AVCOL_RANGE_JPEG) {
             mode = SDL_YUV_CONVERSION_JPEG;
             if (ENGINE_DEBUG) {
@@ -254,6 +359,18 @@ SDL_BlendMode SDLVideoDevice::getSDLBlendMode(BlendMode mode) {
     return SDL_BLENDMODE_NONE;
 }
 
+/**
+ * SDL2的纹理没有YUV422P、YUV444P和10位格式，这些格式返回FMT_NONE，由同步器转换成BGRA
+ */
+TextureFormat SDLVideoDevice::getTextureFormat(int format) {
+    TextureFormat result = VideoDevice::getTextureFormat(format);
+    if (result == FMT_YUV422P || result == FMT_YUV444P || result == FMT_P010 ||
+        result == FMT_YUV420P10) {
+        return FMT_NONE;
+    }
+    return result;
+}
+
 TextureFormat SDLVideoDevice::getTextureFormat(Uint32 format) {
     switch (format) {
         case SDL_PIXELFORMAT_RGB332:
@@ -294,6 +411,10 @@ TextureFormat SDLVideoDevice::getTextureFormat(Uint32 format) {
             return FMT_YUYV422;
         case SDL_PIXELFORMAT_UYVY:
             return FMT_UYVY422;
+        case SDL_PIXELFORMAT_NV12:
+            return FMT_NV12;
+        case SDL_PIXELFORMAT_NV21:
+            return FMT_NV21;
         case SDL_PIXELFORMAT_UNKNOWN:
             return FMT_NONE;
         default:
@@ -386,8 +507,13 @@ Uint32 SDLVideoDevice::getSDLFormat(TextureFormat format) {
             return SDL_PIXELFORMAT_YUY2;
         case FMT_UYVY422:
             return SDL_PIXELFORMAT_UYVY;
+        case FMT_NV12:
+            return SDL_PIXELFORMAT_NV12;
+        case FMT_NV21:
+            return SDL_PIXELFORMAT_NV21;
+        // 同步器把其他格式转换成BGRA
         case FMT_NONE:
-            return SDL_PIXELFORMAT_UNKNOWN;
+            return SDL_PIXELFORMAT_BGRA32;
         default:
             return SDL_PIXELFORMAT_UNKNOWN;
     }
@@ -398,6 +524,9 @@ void SDLVideoDevice::destroyVideoTexture() {
         SDL_DestroyTexture(videoTexture);
         videoTexture = nullptr;
     }
+    textureWidth = 0;
+    textureHeight = 0;
+    textureFormat = FMT_NONE;
 }
 
 void SDLVideoDevice::toggleFullScreen() {
@@ -407,5 +536,17 @@ void SDLVideoDevice::toggleFullScreen() {
     }
 }
 
-
-
+/**
+ * 窗口移动到其他显示器时刷新率会变化，按窗口所在的显示器读取
+ */
+void SDLVideoDevice::updateRefreshRate() {
+    int index = SDL_GetWindowDisplayIndex(window);
+    if (index < 0 || index == displayIndex) {
+        return;
+    }
+    SDL_DisplayMode mode;
+    if (SDL_GetCurrentDisplayMode(index, &mode) == 0) {
+        displayIndex = index;
+        displayClock->setRefreshRate(mode.refresh_rate);
+    }
+}
@@ -23,11 +23,25 @@ public:
     // 销毁
     void destroy();
 
+    // 变速不变调，返回输出的每声道采样数
+    int changeTempo(const short *input, int inputSamples, short *output, int maxSamples,
+                    float tempo, int channels, int sampleRate);
+
+    // 还没有输出的每声道采样数
+    int getPendingSamples();
+
+    // 清空缓存的采样
+    void clear();
+
     // 获取SoundTouch对象
     SoundTouch *getSoundTouch();
 
 private:
     SoundTouch *mSoundTouch;
+
+    int mChannels = 0;
+
+    int mSampleRate = 0;
 };
 
 
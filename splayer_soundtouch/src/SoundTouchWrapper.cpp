@@ -61,6 +61,56 @@ int SoundTouchWrapper::translate(short *data, float speed, float pitch, int len,
     return pcm_data_size;
 }
 
+/**
+ * 变速不变调，SoundTouch内部会缓存不足一个处理窗口的采样，输出的采样数不固定
+ * @param input         交错的PCM数据
+ * @param inputSamples  输入的每声道采样数
+ * @param output        输出缓冲
+ * @param maxSamples    输出缓冲能容纳的每声道采样数
+ * @param tempo         速度
+ * @param channels      声道数
+ * @param sampleRate    采样率
+ * @return 输出的每声道采样数
+ */
+int SoundTouchWrapper::changeTempo(const short *input, int inputSamples, short *output,
+                                   int maxSamples, float tempo, int channels, int sampleRate) {
+    if (mSoundTouch == nullptr) {
+        return 0;
+    }
+    // 声道数和采样率变化时才重新设置，设置会清空处理状态
+    if (channels != mChannels || sampleRate != mSampleRate) {
+        mSoundTouch->clear();
+        mSoundTouch->setChannels((uint) channels);
+        mSoundTouch->setSampleRate((uint) sampleRate);
+        mChannels = channels;
+        mSampleRate = sampleRate;
+    }
+    mSoundTouch->setTempo(tempo);
+    mSoundTouch->putSamples((const SAMPLETYPE *) input, (uint) inputSamples);
+
+    int count = 0;
+    int nb;
+    while (count < maxSamples &&
+           (nb = mSoundTouch->receiveSamples((SAMPLETYPE *) output + count * channels,
+                                             (uint) (maxSamples - count))) > 0) {
+        count += nb;
+    }
+    return count;
+}
+
+int SoundTouchWrapper::getPendingSamples() {
+    if (mSoundTouch == nullptr) {
+        return 0;
+    }
+    return mSoundTouch->numUnprocessedSamples() + mSoundTouch->numSamples();
+}
+
+void SoundTouchWrapper::clear() {
+    if (mSoundTouch) {
+        mSoundTouch->clear();
+    }
+}
+
 /**
  * 获取SoundTouch对象
  * @return